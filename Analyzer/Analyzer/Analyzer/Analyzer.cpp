@@ -0,0 +1,128 @@
+// Analyzer.cpp : This file contains the 'main' function. Program execution begins and ends there.
+//
+// Usage: Analyzer [--format=text|xml|sarif] [--jobs=N] [--output=FILE] [--cache=FILE] path ...
+//   Directories are searched recursively for C++ sources. The exit code is 1 when anything was
+//   found, 2 on a usage error and 0 for a clean run, so the analyzer can gate a CI build.
+//   With --cache only files whose contents changed since the last run are analyzed again.
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "report.h"
+#include "scanner.h"
+
+namespace
+{
+    bool starts_with(const std::string& text, const std::string& prefix)
+    {
+        return text.compare(0, prefix.size(), prefix) == 0;
+    }
+
+    int usage()
+    {
+        std::cerr << "usage: Analyzer [--format=text|xml|sarif] [--jobs=N] [--output=FILE] [--cache=FILE] path ..." << std::endl;
+        return 2;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    report_format format = report_format::text;
+    unsigned jobs = 0;
+    std::string output;
+    std::string cache_path;
+    std::vector<std::string> paths;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string argument = argv[i];
+        if (starts_with(argument, "--format="))
+        {
+            const std::string name = argument.substr(9);
+            if (name == "text")
+            {
+                format = report_format::text;
+            }
+            else if (name == "xml")
+            {
+                format = report_format::xml;
+            }
+            else if (name == "sarif")
+            {
+                format = report_format::sarif;
+            }
+            else
+            {
+                return usage();
+            }
+        }
+        else if (starts_with(argument, "--jobs="))
+        {
+            jobs = static_cast<unsigned>(std::strtoul(argument.c_str() + 7, nullptr, 10));
+        }
+        else if (starts_with(argument, "--output="))
+        {
+            output = argument.substr(9);
+        }
+        else if (starts_with(argument, "--cache="))
+        {
+            cache_path = argument.substr(8);
+        }
+        else if (starts_with(argument, "--"))
+        {
+            return usage();
+        }
+        else
+        {
+            paths.push_back(argument);
+        }
+    }
+    if (paths.empty())
+    {
+        return usage();
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const std::vector<std::string> files = collect_sources(paths);
+    analysis_cache cache;
+    if (!cache_path.empty())
+    {
+        cache.load(cache_path);
+    }
+    const scan_result result = scan(files, jobs, cache_path.empty() ? nullptr : &cache);
+    if (!cache_path.empty() && !cache.save(cache_path))
+    {
+        std::cerr << "cannot write cache " << cache_path << std::endl;
+    }
+    const auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+
+    if (output.empty())
+    {
+        write_report(std::cout, format, result.findings);
+    }
+    else
+    {
+        std::ofstream stream(output);
+        write_report(stream, format, result.findings);
+        if (!stream)
+        {
+            std::cerr << "cannot write " << output << std::endl;
+            return 2;
+        }
+    }
+
+    for (const auto& file : result.unreadable)
+    {
+        std::cerr << "cannot read " << file << std::endl;
+    }
+    std::cerr << result.findings.size() << " findings in " << result.files << " files (" << result.cached << " from cache), " << elapsed.count() << " ms" << std::endl;
+
+    return result.findings.empty() ? 0 : 1;
+}
+
+// Run program: Ctrl + F5 or Debug > Start Without Debugging menu
+// Debug program: F5 or Debug > Start Debugging menu
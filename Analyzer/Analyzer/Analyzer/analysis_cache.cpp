@@ -0,0 +1,131 @@
+// analysis_cache.cpp : Content hashing and the on-disk form of the analysis cache.
+//
+// The file is plain text so it can be inspected and diffed:
+//   analyzer-cache <format> <analyzer_version>
+//   <hash> <finding count>
+//   <line> <column> <severity> <rule> <message>     (one line per finding)
+
+#include "analysis_cache.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace
+{
+    // bumped when the layout of the file changes
+    constexpr int format_version = 1;
+    constexpr const char* magic = "analyzer-cache";
+
+    std::uint64_t mix(std::uint64_t value) noexcept
+    {
+        value ^= value >> 33;
+        value *= 0xff51afd7ed558ccdull;
+        value ^= value >> 33;
+        value *= 0xc4ceb9fe1a85ec53ull;
+        value ^= value >> 33;
+        return value;
+    }
+}
+
+std::uint64_t analysis_cache::hash(std::string_view contents) noexcept
+{
+    // eight bytes per step with a multiply and rotate, finished with the murmur3 mixer; the length
+    // goes in first so contents differing only in trailing zero bytes still differ
+    std::uint64_t state = 0x9e3779b97f4a7c15ull ^ (contents.size() * 0x100000001b3ull);
+    const char* data = contents.data();
+    std::size_t remaining = contents.size();
+    for (; remaining >= 8; data += 8, remaining -= 8)
+    {
+        std::uint64_t word;
+        std::memcpy(&word, data, sizeof(word));
+        state = (state ^ (word * 0x87c37b91114253d5ull)) * 0x4cf5ad432745937full;
+        state = (state << 31) | (state >> 33);
+    }
+    std::uint64_t tail = 0;
+    std::memcpy(&tail, data, remaining);
+    state ^= tail * 0x87c37b91114253d5ull;
+    return mix(state);
+}
+
+bool analysis_cache::load(const std::string& path)
+{
+    entries_.clear();
+
+    std::ifstream stream(path);
+    std::string header;
+    int format = 0;
+    std::string version;
+    if (!(stream >> header >> format >> version) || header != magic || format != format_version || version != analyzer_version)
+    {
+        return false;
+    }
+
+    std::uint64_t key = 0;
+    std::size_t count = 0;
+    while (stream >> std::hex >> key >> std::dec >> count)
+    {
+        // count is whatever the file says, so the vector only grows by the findings actually read
+        std::vector<finding> findings;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            finding f;
+            std::string level;
+            if (!(stream >> f.line >> f.column >> level >> f.rule) || !std::getline(stream >> std::ws, f.message))
+            {
+                entries_.clear();
+                return false;
+            }
+            f.severity = level == "error" ? severity::error : severity::warning;
+            findings.push_back(std::move(f));
+        }
+        entries_.emplace(key, std::move(findings));
+    }
+
+    if (!stream.eof())
+    {
+        entries_.clear();
+        return false;
+    }
+    return !entries_.empty();
+}
+
+bool analysis_cache::save(const std::string& path) const
+{
+    const std::string temporary = path + ".tmp";
+    {
+        std::ofstream stream(temporary, std::ios::trunc);
+        stream << magic << ' ' << format_version << ' ' << analyzer_version << '\n';
+        for (const auto& entry : entries_)
+        {
+            stream << std::hex << entry.first << std::dec << ' ' << entry.second.size() << '\n';
+            for (const auto& f : entry.second)
+            {
+                stream << f.line << ' ' << f.column << ' ' << to_string(f.severity) << ' ' << f.rule << ' ' << f.message << '\n';
+            }
+        }
+        if (!stream.flush())
+        {
+            return false;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporary, path, error);
+    return !error;
+}
+
+const std::vector<finding>* analysis_cache::find(std::uint64_t key) const
+{
+    const auto entry = entries_.find(key);
+    return entry == entries_.end() ? nullptr : &entry->second;
+}
+
+void analysis_cache::insert(std::uint64_t key, std::vector<finding> findings)
+{
+    for (auto& f : findings)
+    {
+        f.file.clear();
+    }
+    entries_[key] = std::move(findings);
+}
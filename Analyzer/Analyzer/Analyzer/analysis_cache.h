@@ -0,0 +1,59 @@
+// analysis_cache.h : Findings of earlier runs, keyed by the hash of the file contents.
+//
+// A CI run usually changes a handful of files, yet every file used to be tokenized and checked
+// again. The cache maps a 64 bit hash of a file's bytes to the findings it produced, so a file whose
+// contents are unchanged is only read and hashed. Entries carry no path: a file that moves, or two
+// files with the same contents, share one entry. The whole cache is tied to analyzer_version and
+// is discarded when the checks change.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "checks.h"
+
+class analysis_cache
+{
+public:
+    /// <summary>
+    /// 64 bit hash of a file's contents, the cache key.
+    /// </summary>
+    static std::uint64_t hash(std::string_view contents) noexcept;
+
+    /// <summary>
+    /// Replaces the contents with the cache stored at path. A missing file, a file written by a
+    /// different analyzer_version or a damaged file leaves the cache empty.
+    /// </summary>
+    /// <returns>true when entries were loaded</returns>
+    bool load(const std::string& path);
+
+    /// <summary>
+    /// Writes the cache to path. The file is written under a temporary name and renamed, so a
+    /// concurrent reader or a crash never sees half a cache.
+    /// </summary>
+    /// <returns>false when the file could not be written</returns>
+    bool save(const std::string& path) const;
+
+    /// <summary>
+    /// Findings stored for a content hash, with an empty file name, or nullptr. Safe to call from
+    /// several threads as long as nothing is inserted at the same time.
+    /// </summary>
+    const std::vector<finding>* find(std::uint64_t key) const;
+
+    /// <summary>
+    /// Stores the findings of one file; their file names are not kept.
+    /// </summary>
+    void insert(std::uint64_t key, std::vector<finding> findings);
+
+    std::size_t size() const noexcept { return entries_.size(); }
+
+    void clear() noexcept { entries_.clear(); }
+
+private:
+    std::unordered_map<std::uint64_t, std::vector<finding>> entries_;
+};
@@ -0,0 +1,900 @@
+// checks.cpp : The defect patterns from QuestionableCode.cpp, detected on a token list.
+//
+
+#include "checks.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "tokenizer.h"
+
+namespace
+{
+    using token_list = std::vector<token>;
+    constexpr std::size_t npos = token::npos;
+
+    struct parameter
+    {
+        std::string_view name;
+        int pointer_depth = 0;
+        bool reference = false;
+    };
+
+    struct function
+    {
+        std::string_view name;
+        std::size_t name_index = 0;
+        std::vector<parameter> parameters;
+        // every parameter has a name
+        bool all_named = true;
+        bool is_const = false;
+        bool is_noexcept = false;
+        // the braces around the body
+        std::size_t body_open = 0;
+        std::size_t body_close = 0;
+    };
+
+    // a half open token range [begin, end)
+    struct range
+    {
+        std::size_t begin = 0;
+        std::size_t end = 0;
+
+        bool contains(std::size_t index) const noexcept { return index >= begin && index < end; }
+    };
+
+    bool is_keyword_call(std::string_view name)
+    {
+        static const std::unordered_set<std::string_view> keywords = {
+            "if", "for", "while", "switch", "catch", "return", "sizeof", "alignof", "decltype", "noexcept",
+            "static_assert", "throw", "new", "delete", "typeid", "alignas", "do", "else", "case", "defined"
+        };
+        return keywords.count(name) != 0;
+    }
+
+    bool is_assignment(const token& t)
+    {
+        static const std::unordered_set<std::string_view> operators = {
+            "=", "+=", "-=", "*=", "/=", "%=", "&=", "|=", "^=", "<<=", ">>="
+        };
+        return t.kind == token_kind::punctuation && operators.count(t.text) != 0;
+    }
+
+    bool is_increment(const token& t)
+    {
+        return t.kind == token_kind::punctuation && (t.is("++") || t.is("--"));
+    }
+
+    bool at(const token_list& tokens, std::size_t index, std::string_view text)
+    {
+        return index < tokens.size() && tokens[index].text == text;
+    }
+
+    bool identifier_at(const token_list& tokens, std::size_t index)
+    {
+        return index < tokens.size() && tokens[index].kind == token_kind::identifier;
+    }
+
+    bool parse_integer(const token& t, long long& value)
+    {
+        if (t.kind != token_kind::number)
+        {
+            return false;
+        }
+        const std::string text(t.text);
+        char* end = nullptr;
+        value = std::strtoll(text.c_str(), &end, 0);
+        // allow integer suffixes, reject floating point
+        for (; *end != '\0'; ++end)
+        {
+            if (*end != 'u' && *end != 'U' && *end != 'l' && *end != 'L')
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // where the statement starting at begin ends: a braced block, or the next ; outside brackets
+    range statement_at(const token_list& tokens, std::size_t begin)
+    {
+        if (at(tokens, begin, "{") && tokens[begin].match != npos)
+        {
+            return { begin, tokens[begin].match + 1 };
+        }
+        std::size_t i = begin;
+        while (i < tokens.size() && !tokens[i].is(";"))
+        {
+            if ((tokens[i].is("(") || tokens[i].is("[") || tokens[i].is("{")) && tokens[i].match != npos)
+            {
+                i = tokens[i].match;
+            }
+            ++i;
+        }
+        return { begin, std::min(i + 1, tokens.size()) };
+    }
+
+    // splits the tokens inside a bracket pair on top level commas
+    std::vector<range> split_arguments(const token_list& tokens, std::size_t open)
+    {
+        std::vector<range> arguments;
+        const std::size_t close = tokens[open].match;
+        std::size_t begin = open + 1;
+        int angle_depth = 0;
+        for (std::size_t i = open + 1; i < close; ++i)
+        {
+            const token& t = tokens[i];
+            if ((t.is("(") || t.is("[") || t.is("{")) && t.match != npos)
+            {
+                i = t.match;
+            }
+            else if (t.is("<"))
+            {
+                ++angle_depth;
+            }
+            else if (t.is(">") && angle_depth > 0)
+            {
+                --angle_depth;
+            }
+            else if (t.is(">>") && angle_depth > 0)
+            {
+                angle_depth = std::max(0, angle_depth - 2);
+            }
+            else if (t.is(",") && angle_depth == 0)
+            {
+                arguments.push_back({ begin, i });
+                begin = i + 1;
+            }
+        }
+        if (begin < close || !arguments.empty())
+        {
+            arguments.push_back({ begin, close });
+        }
+        return arguments;
+    }
+
+    parameter parse_parameter(const token_list& tokens, range segment, bool& named)
+    {
+        parameter result;
+        std::size_t end = segment.end;
+        // drop a default argument
+        for (std::size_t i = segment.begin; i < segment.end; ++i)
+        {
+            if (tokens[i].is("="))
+            {
+                end = i;
+                break;
+            }
+        }
+        for (std::size_t i = segment.begin; i < end; ++i)
+        {
+            if (tokens[i].is("*"))
+            {
+                ++result.pointer_depth;
+            }
+            else if (tokens[i].is("&") || tokens[i].is("&&"))
+            {
+                result.reference = true;
+            }
+        }
+        named = end - segment.begin >= 2 && tokens[end - 1].kind == token_kind::identifier;
+        if (named)
+        {
+            result.name = tokens[end - 1].text;
+        }
+        return result;
+    }
+
+    // skips "const", "noexcept(...)", "-> type" and friends after a parameter list, records what it saw
+    // and returns the index of the body's opening brace, or npos when this is not a definition
+    std::size_t find_body(const token_list& tokens, std::size_t close, function& result)
+    {
+        std::size_t i = close + 1;
+        while (i < tokens.size())
+        {
+            const token& t = tokens[i];
+            if (t.is("{"))
+            {
+                return t.match != npos ? i : npos;
+            }
+            if (t.is("const"))
+            {
+                result.is_const = true;
+                ++i;
+            }
+            else if (t.is("noexcept"))
+            {
+                result.is_noexcept = true;
+                if (at(tokens, i + 1, "(") && tokens[i + 1].match != npos)
+                {
+                    // noexcept(false) and noexcept(expression) do not promise anything we can check
+                    result.is_noexcept = tokens[i + 1].match == i + 3 && at(tokens, i + 2, "true");
+                    i = tokens[i + 1].match;
+                }
+                ++i;
+            }
+            else if (t.is("volatile") || t.is("override") || t.is("final") || t.is("&") || t.is("&&") || t.is("mutable"))
+            {
+                ++i;
+            }
+            else if (t.is("->"))
+            {
+                // trailing return type, runs up to the body
+                ++i;
+                while (i < tokens.size() && !tokens[i].is("{") && !tokens[i].is(";"))
+                {
+                    if ((tokens[i].is("(") || tokens[i].is("[")) && tokens[i].match != npos)
+                    {
+                        i = tokens[i].match;
+                    }
+                    ++i;
+                }
+            }
+            else if (t.is(":"))
+            {
+                // constructor initializer list: name(args) or name{args}, separated by commas
+                ++i;
+                while (i < tokens.size())
+                {
+                    while (i < tokens.size() && (tokens[i].kind == token_kind::identifier || tokens[i].is("::") || tokens[i].is("<") || tokens[i].is(">")))
+                    {
+                        ++i;
+                    }
+                    if (i >= tokens.size() || !(tokens[i].is("(") || tokens[i].is("{")) || tokens[i].match == npos)
+                    {
+                        return npos;
+                    }
+                    i = tokens[i].match + 1;
+                    if (at(tokens, i, ","))
+                    {
+                        ++i;
+                        continue;
+                    }
+                    break;
+                }
+            }
+            else
+            {
+                return npos;
+            }
+        }
+        return npos;
+    }
+
+    std::vector<function> find_functions(const token_list& tokens)
+    {
+        std::vector<function> functions;
+        for (std::size_t i = 0; i + 1 < tokens.size(); ++i)
+        {
+            const token& name = tokens[i];
+            if (name.kind != token_kind::identifier || !tokens[i + 1].is("(") || tokens[i + 1].match == npos || is_keyword_call(name.text))
+            {
+                continue;
+            }
+            // a member call or a constructor call inside an expression is not a definition
+            if (i > 0 && (tokens[i - 1].is(".") || tokens[i - 1].is("->") || tokens[i - 1].is("=") || tokens[i - 1].is("return")))
+            {
+                continue;
+            }
+
+            function result;
+            result.name = name.text;
+            result.name_index = i;
+            const std::size_t close = tokens[i + 1].match;
+            const std::size_t body = find_body(tokens, close, result);
+            if (body == npos)
+            {
+                continue;
+            }
+            result.body_open = body;
+            result.body_close = tokens[body].match;
+
+            for (const range& segment : split_arguments(tokens, i + 1))
+            {
+                if (segment.end - segment.begin == 1 && tokens[segment.begin].is("void"))
+                {
+                    continue;
+                }
+                bool named = false;
+                result.parameters.push_back(parse_parameter(tokens, segment, named));
+                result.all_named = result.all_named && named;
+            }
+            functions.push_back(std::move(result));
+        }
+        return functions;
+    }
+
+    bool names_parameter(const function& f, std::string_view name)
+    {
+        return std::any_of(f.parameters.begin(), f.parameters.end(), [name](const parameter& p) { return p.name == name; });
+    }
+
+    const parameter* find_parameter(const function& f, std::string_view name)
+    {
+        for (const auto& p : f.parameters)
+        {
+            if (p.name == name)
+            {
+                return &p;
+            }
+        }
+        return nullptr;
+    }
+
+    // names declared as plain (non static, non reference) locals in [begin, end)
+    std::unordered_set<std::string_view> find_locals(const token_list& tokens, std::size_t begin, std::size_t end)
+    {
+        static const std::unordered_set<std::string_view> not_types = {
+            "return", "else", "case", "goto", "throw", "delete", "new", "sizeof", "typedef", "using", "co_return", "co_yield"
+        };
+
+        std::unordered_set<std::string_view> locals;
+        for (std::size_t i = begin + 1; i + 1 < end; ++i)
+        {
+            const token& name = tokens[i];
+            const token& next = tokens[i + 1];
+            if (name.kind != token_kind::identifier || !(next.is(";") || next.is("=") || next.is("[") || next.is("{") || next.is(",")))
+            {
+                continue;
+            }
+
+            // walk back over the type: identifiers, ::, template arguments, * and const
+            std::size_t j = i;
+            bool has_type = false;
+            bool excluded = false;
+            while (j > begin)
+            {
+                const token& previous = tokens[j - 1];
+                if (previous.kind == token_kind::identifier)
+                {
+                    if (not_types.count(previous.text) != 0)
+                    {
+                        excluded = true;
+                        break;
+                    }
+                    if (previous.is("static") || previous.is("extern") || previous.is("thread_local"))
+                    {
+                        excluded = true;
+                    }
+                    has_type = true;
+                }
+                else if (previous.is("&") || previous.is("&&"))
+                {
+                    excluded = true;
+                }
+                else if (!(previous.is("::") || previous.is("*") || previous.is("<") || previous.is(">") || previous.is(",")))
+                {
+                    break;
+                }
+                --j;
+            }
+            // the type must start a statement
+            if (has_type && !excluded && j > 0 && (tokens[j - 1].is(";") || tokens[j - 1].is("{") || tokens[j - 1].is("}") || tokens[j - 1].is("(")))
+            {
+                locals.insert(name.text);
+            }
+        }
+        return locals;
+    }
+
+    finding make_finding(const std::string& file, const token& where, const char* rule, severity level, std::string message)
+    {
+        finding result;
+        result.file = file;
+        result.line = where.line;
+        result.column = where.column;
+        result.rule = rule;
+        result.severity = level;
+        result.message = std::move(message);
+        return result;
+    }
+
+    class analyzer
+    {
+    public:
+        analyzer(const token_list& tokens, const std::string& file)
+            : tokens_(tokens),
+              file_(file),
+              functions_(find_functions(tokens))
+        {
+        }
+
+        std::vector<finding> run()
+        {
+            for (const function& f : functions_)
+            {
+                check_endless_recursion(f);
+                check_dangling_pointer(f);
+                check_array_bounds(f);
+                check_throw_in_noexcept(f);
+            }
+            check_invalid_iterators();
+            check_assert_side_effects();
+
+            std::sort(findings_.begin(), findings_.end(), [](const finding& left, const finding& right) {
+                return left.line != right.line ? left.line < right.line : left.column < right.column;
+            });
+            return std::move(findings_);
+        }
+
+    private:
+        // is_type(type) inside is_type(int type): nothing changes between calls. Only reported when
+        // the function cannot have changed any other state first: a const member, or nothing assigned
+        void check_endless_recursion(const function& f)
+        {
+            if (f.parameters.empty() || !f.all_named)
+            {
+                return;
+            }
+
+            bool assigned = false;
+            for (std::size_t i = f.body_open + 1; i < f.body_close; ++i)
+            {
+                const token& t = tokens_[i];
+                if (is_assignment(t) || is_increment(t))
+                {
+                    assigned = true;
+                }
+                if (!t.is(f.name) || !at(tokens_, i + 1, "(") || tokens_[i + 1].match == npos)
+                {
+                    continue;
+                }
+                if (i > 0 && (tokens_[i - 1].is(".") || tokens_[i - 1].is("::") || (tokens_[i - 1].is("->") && !(i > 1 && tokens_[i - 2].is("this")))))
+                {
+                    continue;
+                }
+
+                const std::vector<range> arguments = split_arguments(tokens_, i + 1);
+                bool same = arguments.size() == f.parameters.size();
+                for (std::size_t a = 0; same && a < arguments.size(); ++a)
+                {
+                    same = arguments[a].end - arguments[a].begin == 1 && tokens_[arguments[a].begin].text == f.parameters[a].name;
+                }
+                if (same && (f.is_const || !assigned))
+                {
+                    add(t, "endlessRecursion", severity::error,
+                        "'" + std::string(f.name) + "' calls itself with the arguments it was given and nothing else changes, the recursion never ends");
+                }
+            }
+        }
+
+        // *a = &b with b a local of the function: the caller keeps the address after b is gone
+        void check_dangling_pointer(const function& f)
+        {
+            const auto locals = find_locals(tokens_, f.body_open, f.body_close);
+            if (locals.empty())
+            {
+                return;
+            }
+
+            for (std::size_t i = f.body_open + 1; i + 2 < f.body_close; ++i)
+            {
+                // return &local;
+                if (tokens_[i].is("return") && tokens_[i + 1].is("&") && locals.count(tokens_[i + 2].text) != 0 && at(tokens_, i + 3, ";"))
+                {
+                    add(tokens_[i + 1], "danglingPointer", severity::error,
+                        "returns the address of local variable '" + std::string(tokens_[i + 2].text) + "', which no longer exists when the caller uses it");
+                    continue;
+                }
+
+                if (!tokens_[i].is("=") || !tokens_[i + 1].is("&") || locals.count(tokens_[i + 2].text) == 0)
+                {
+                    continue;
+                }
+
+                // *param = &local with param a pointer to pointer, or param = &local with param a reference to pointer
+                std::string target;
+                if (i >= 2 && tokens_[i - 2].is("*") && !(i >= 3 && identifier_at(tokens_, i - 3)))
+                {
+                    const parameter* p = find_parameter(f, tokens_[i - 1].text);
+                    if (p != nullptr && p->pointer_depth >= 2)
+                    {
+                        target = "*" + std::string(p->name);
+                    }
+                }
+                else if (i >= 1)
+                {
+                    const parameter* p = find_parameter(f, tokens_[i - 1].text);
+                    if (p != nullptr && p->reference && p->pointer_depth >= 1 && !(i >= 2 && (tokens_[i - 2].is(".") || tokens_[i - 2].is("->"))))
+                    {
+                        target = std::string(p->name);
+                    }
+                }
+
+                if (!target.empty())
+                {
+                    add(tokens_[i + 1], "danglingPointer", severity::error,
+                        "the address of local variable '" + std::string(tokens_[i + 2].text) + "' is stored in '" + target
+                        + "', the caller is left with a dangling pointer when '" + std::string(f.name) + "' returns");
+                }
+            }
+        }
+
+        // buf[count] with int buf[10], reached only when count == 1000; also literal indexes and loops
+        void check_array_bounds(const function& f)
+        {
+            std::unordered_map<std::string_view, long long> arrays;
+            for (std::size_t i = f.body_open + 1; i + 4 < f.body_close; ++i)
+            {
+                long long size = 0;
+                if (identifier_at(tokens_, i) && tokens_[i + 1].is("[") && parse_integer(tokens_[i + 2], size) && tokens_[i + 3].is("]")
+                    && (tokens_[i + 4].is(";") || tokens_[i + 4].is("=") || tokens_[i + 4].is("{")) && identifier_at(tokens_, i - 1))
+                {
+                    arrays[tokens_[i].text] = size;
+                }
+            }
+            if (arrays.empty())
+            {
+                return;
+            }
+
+            // lower or upper limits on a variable that hold inside a range of tokens
+            struct limit
+            {
+                std::string_view variable;
+                long long highest_index;
+                range scope;
+                std::string condition;
+            };
+            std::vector<limit> limits;
+
+            for (std::size_t i = f.body_open + 1; i < f.body_close; ++i)
+            {
+                if (tokens_[i].is("if") && at(tokens_, i + 1, "(") && tokens_[i + 1].match != npos)
+                {
+                    const std::size_t open = i + 1;
+                    const std::size_t close = tokens_[open].match;
+                    if (close - open == 4)
+                    {
+                        long long value = 0;
+                        const token& left = tokens_[open + 1];
+                        const token& op = tokens_[open + 2];
+                        const token& right = tokens_[open + 3];
+                        const range body = statement_at(tokens_, close + 1);
+                        if (left.kind == token_kind::identifier && parse_integer(right, value))
+                        {
+                            if (op.is("==") || op.is(">="))
+                            {
+                                limits.push_back({ left.text, value, body, std::string(left.text) + " " + std::string(op.text) + " " + std::to_string(value) });
+                            }
+                            else if (op.is(">"))
+                            {
+                                limits.push_back({ left.text, value + 1, body, std::string(left.text) + " > " + std::to_string(value) });
+                            }
+                        }
+                        else if (right.kind == token_kind::identifier && parse_integer(left, value) && op.is("=="))
+                        {
+                            limits.push_back({ right.text, value, body, std::string(right.text) + " == " + std::to_string(value) });
+                        }
+                    }
+                }
+                else if (tokens_[i].is("for") && at(tokens_, i + 1, "(") && tokens_[i + 1].match != npos)
+                {
+                    // for (init; i <= K; step) reaches index K
+                    const std::size_t open = i + 1;
+                    const std::size_t close = tokens_[open].match;
+                    std::size_t first = open + 1;
+                    while (first < close && !tokens_[first].is(";"))
+                    {
+                        ++first;
+                    }
+                    long long value = 0;
+                    if (first + 4 < close && identifier_at(tokens_, first + 1) && parse_integer(tokens_[first + 3], value) && tokens_[first + 4].is(";"))
+                    {
+                        const token& op = tokens_[first + 2];
+                        const range body = statement_at(tokens_, close + 1);
+                        if (op.is("<="))
+                        {
+                            limits.push_back({ tokens_[first + 1].text, value, body, std::string(tokens_[first + 1].text) + " <= " + std::to_string(value) });
+                        }
+                        else if (op.is("<"))
+                        {
+                            limits.push_back({ tokens_[first + 1].text, value - 1, body, std::string(tokens_[first + 1].text) + " < " + std::to_string(value) });
+                        }
+                    }
+                }
+            }
+
+            for (std::size_t i = f.body_open + 1; i + 3 < f.body_close; ++i)
+            {
+                const auto array = arrays.find(tokens_[i].text);
+                if (array == arrays.end() || !tokens_[i + 1].is("[") || !tokens_[i + 3].is("]") || identifier_at(tokens_, i - 1))
+                {
+                    continue;
+                }
+
+                const long long size = array->second;
+                const token& index = tokens_[i + 2];
+                const std::string access = std::string(tokens_[i].text) + "[" + std::string(index.text) + "]";
+                long long value = 0;
+                if (parse_integer(index, value))
+                {
+                    if (value >= size || value < 0)
+                    {
+                        add(tokens_[i], "arrayIndexOutOfBounds", severity::error,
+                            "'" + access + "' is out of bounds, '" + std::string(tokens_[i].text) + "' has " + std::to_string(size) + " elements");
+                    }
+                    continue;
+                }
+                if (index.kind != token_kind::identifier)
+                {
+                    continue;
+                }
+                for (const limit& l : limits)
+                {
+                    if (l.variable == index.text && l.scope.contains(i) && l.highest_index >= size)
+                    {
+                        add(tokens_[i], "arrayIndexOutOfBounds", severity::error,
+                            "'" + access + "' is out of bounds when " + l.condition + ", '" + std::string(tokens_[i].text) + "' has " + std::to_string(size) + " elements");
+                        break;
+                    }
+                }
+            }
+        }
+
+        // a throw in a noexcept function that no try block inside the function catches
+        void check_throw_in_noexcept(const function& f)
+        {
+            if (!f.is_noexcept)
+            {
+                return;
+            }
+
+            std::vector<range> guarded;
+            for (std::size_t i = f.body_open + 1; i < f.body_close; ++i)
+            {
+                if (tokens_[i].is("try") && at(tokens_, i + 1, "{") && tokens_[i + 1].match != npos)
+                {
+                    guarded.push_back({ i + 1, tokens_[i + 1].match });
+                }
+            }
+
+            for (std::size_t i = f.body_open + 1; i < f.body_close; ++i)
+            {
+                if (!tokens_[i].is("throw"))
+                {
+                    continue;
+                }
+                const bool caught = std::any_of(guarded.begin(), guarded.end(), [i](const range& r) { return r.contains(i); });
+                if (!caught)
+                {
+                    add(tokens_[i], "throwInNoexcept", severity::error,
+                        "'" + std::string(f.name) + "' is noexcept, an exception thrown here calls std::terminate");
+                }
+            }
+        }
+
+        // true when the expression holding the call at call is the right hand side of variable = ...;
+        // whole bracket pairs are skipped and enclosing parentheses crossed, a statement boundary ends it
+        bool assigns_result_to(std::size_t call, std::size_t first, std::string_view variable) const
+        {
+            for (std::size_t k = call; k > first + 1;)
+            {
+                --k;
+                const token& t = tokens_[k];
+                if ((t.is(")") || t.is("]")) && t.match != npos)
+                {
+                    k = t.match;
+                }
+                else if (t.is(";") || t.is("{") || t.is("}"))
+                {
+                    return false;
+                }
+                else if (t.is("="))
+                {
+                    return tokens_[k - 1].is(variable) && !at(tokens_, k - 2, ".") && !at(tokens_, k - 2, "->");
+                }
+            }
+            return false;
+        }
+
+        // for (iter = items.begin(); ...) { items.erase(iter); } and range based for loops that grow or
+        // shrink the container they walk
+        void check_invalid_iterators()
+        {
+            static const std::unordered_set<std::string_view> modifiers = {
+                "erase", "insert", "push_back", "emplace_back", "emplace", "push_front", "emplace_front",
+                "pop_back", "pop_front", "clear", "resize", "assign"
+            };
+
+            for (std::size_t i = 0; i + 1 < tokens_.size(); ++i)
+            {
+                if (!tokens_[i].is("for") || !tokens_[i + 1].is("(") || tokens_[i + 1].match == npos)
+                {
+                    continue;
+                }
+                const std::size_t open = i + 1;
+                const std::size_t close = tokens_[open].match;
+
+                std::string_view container;
+                std::string_view iterator;
+                bool range_based = false;
+                for (std::size_t j = open + 1; j < close; ++j)
+                {
+                    if (tokens_[j].is(":") && j + 2 == close && identifier_at(tokens_, j + 1))
+                    {
+                        container = tokens_[j + 1].text;
+                        range_based = true;
+                        break;
+                    }
+                    if (identifier_at(tokens_, j) && at(tokens_, j + 1, ".") && (at(tokens_, j + 2, "begin") || at(tokens_, j + 2, "cbegin") || at(tokens_, j + 2, "rbegin")))
+                    {
+                        container = tokens_[j].text;
+                        if (j >= open + 3 && tokens_[j - 1].is("=") && identifier_at(tokens_, j - 2))
+                        {
+                            iterator = tokens_[j - 2].text;
+                        }
+                        break;
+                    }
+                }
+                if (container.empty())
+                {
+                    continue;
+                }
+
+                const range body = statement_at(tokens_, close + 1);
+                for (std::size_t j = body.begin; j + 3 < body.end; ++j)
+                {
+                    if (!tokens_[j].is(container) || !tokens_[j + 1].is(".") || modifiers.count(tokens_[j + 2].text) == 0 || !tokens_[j + 3].is("("))
+                    {
+                        continue;
+                    }
+                    if (j > 0 && (tokens_[j - 1].is(".") || tokens_[j - 1].is("->")))
+                    {
+                        continue;
+                    }
+                    // iter = items.erase(iter) is the correct idiom, also as one arm of a conditional
+                    if (!iterator.empty() && assigns_result_to(j, body.begin, iterator))
+                    {
+                        continue;
+                    }
+                    // leaving the loop straight away never touches the invalid iterator
+                    const range call = statement_at(tokens_, j);
+                    if (at(tokens_, call.end, "break") || at(tokens_, call.end, "return"))
+                    {
+                        continue;
+                    }
+
+                    const std::string call_text = std::string(container) + "." + std::string(tokens_[j + 2].text);
+                    if (range_based)
+                    {
+                        add(tokens_[j], "invalidIterator", severity::error,
+                            "'" + call_text + "' inside a range based for over '" + std::string(container) + "' invalidates the loop's iterator");
+                    }
+                    else
+                    {
+                        add(tokens_[j], "invalidIterator", severity::error,
+                            "'" + call_text + "' invalidates " + (iterator.empty() ? std::string("the loop's iterator") : "'" + std::string(iterator) + "'")
+                            + ", which the loop goes on to use");
+                    }
+                }
+            }
+        }
+
+        // assert(z = 2) and assert(f()) where f writes a global: the effect is gone with NDEBUG
+        void check_assert_side_effects()
+        {
+            const auto globals = find_globals();
+            std::unordered_map<std::string_view, std::string_view> writes_global;
+            for (const function& f : functions_)
+            {
+                const auto locals = find_locals(tokens_, f.body_open, f.body_close);
+                for (std::size_t i = f.body_open + 1; i + 1 < f.body_close; ++i)
+                {
+                    const token& t = tokens_[i];
+                    if (globals.count(t.text) == 0 || locals.count(t.text) != 0 || names_parameter(f, t.text) || tokens_[i - 1].is(".") || tokens_[i - 1].is("->"))
+                    {
+                        continue;
+                    }
+                    if (is_assignment(tokens_[i + 1]) || is_increment(tokens_[i + 1]) || is_increment(tokens_[i - 1]))
+                    {
+                        writes_global.emplace(f.name, t.text);
+                        break;
+                    }
+                }
+            }
+
+            for (std::size_t i = 0; i + 1 < tokens_.size(); ++i)
+            {
+                if (!tokens_[i].is("assert") || !tokens_[i + 1].is("(") || tokens_[i + 1].match == npos)
+                {
+                    continue;
+                }
+                const std::size_t close = tokens_[i + 1].match;
+                for (std::size_t j = i + 2; j < close; ++j)
+                {
+                    const token& t = tokens_[j];
+                    if (is_assignment(t) || is_increment(t))
+                    {
+                        add(tokens_[i], "assertWithSideEffect", severity::warning,
+                            "'" + std::string(t.text) + "' inside assert changes state, the change disappears when NDEBUG is defined");
+                        break;
+                    }
+                    const auto writer = writes_global.find(t.text);
+                    if (writer != writes_global.end() && at(tokens_, j + 1, "(") && !tokens_[j - 1].is(".") && !tokens_[j - 1].is("->"))
+                    {
+                        add(tokens_[i], "assertWithSideEffect", severity::warning,
+                            "'" + std::string(t.text) + "' called inside assert modifies global '" + std::string(writer->second)
+                            + "', the call disappears when NDEBUG is defined");
+                        break;
+                    }
+                }
+            }
+        }
+
+        // variables declared outside any function or class body
+        std::unordered_set<std::string_view> find_globals() const
+        {
+            std::unordered_set<std::string_view> globals;
+            int depth = 0;
+            std::vector<bool> namespace_braces;
+            for (std::size_t i = 0; i < tokens_.size(); ++i)
+            {
+                const token& t = tokens_[i];
+                if (t.is("{"))
+                {
+                    // namespace bodies still count as global scope
+                    const bool is_namespace = (i >= 2 && tokens_[i - 2].is("namespace")) || (i >= 1 && tokens_[i - 1].is("namespace"));
+                    namespace_braces.push_back(is_namespace);
+                    if (!is_namespace)
+                    {
+                        ++depth;
+                    }
+                }
+                else if (t.is("}"))
+                {
+                    if (!namespace_braces.empty())
+                    {
+                        if (!namespace_braces.back())
+                        {
+                            --depth;
+                        }
+                        namespace_braces.pop_back();
+                    }
+                }
+                else if (depth == 0 && t.kind == token_kind::identifier && i > 0 && identifier_at(tokens_, i - 1) && !tokens_[i - 1].is("return")
+                    && (at(tokens_, i + 1, ";") || at(tokens_, i + 1, "=")))
+                {
+                    globals.insert(t.text);
+                }
+            }
+            return globals;
+        }
+
+        void add(const token& where, const char* rule, severity level, std::string message)
+        {
+            findings_.push_back(make_finding(file_, where, rule, level, std::move(message)));
+        }
+
+        const token_list& tokens_;
+        const std::string& file_;
+        std::vector<function> functions_;
+        std::vector<finding> findings_;
+    };
+}
+
+const std::vector<rule_description>& analyzer_rules()
+{
+    static const std::vector<rule_description> rules = {
+        { "endlessRecursion", severity::error, "Function calls itself with unchanged arguments" },
+        { "invalidIterator", severity::error, "Container modified while a loop iterates over it" },
+        { "danglingPointer", severity::error, "Address of a local variable outlives the function" },
+        { "arrayIndexOutOfBounds", severity::error, "Fixed size array indexed past its end" },
+        { "throwInNoexcept", severity::error, "Exception thrown out of a noexcept function" },
+        { "assertWithSideEffect", severity::warning, "assert condition with a side effect that NDEBUG removes" },
+    };
+    return rules;
+}
+
+std::vector<finding> analyze_source(std::string_view source, const std::string& file)
+{
+    const token_list tokens = tokenize(source);
+    return analyzer(tokens, file).run();
+}
+
+const char* to_string(severity level) noexcept
+{
+    return level == severity::error ? "error" : "warning";
+}
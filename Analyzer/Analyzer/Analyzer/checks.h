@@ -0,0 +1,62 @@
+// checks.h : The defect patterns from QuestionableCode.cpp, detected on a token list.
+//
+// Each check looks for one class of bug that CppCheck reports on QuestionableCode.cpp:
+//   endlessRecursion       a function that calls itself with its own, unchanged arguments
+//   invalidIterator        a container modified inside a loop that iterates over it
+//   danglingPointer        the address of a local stored through a parameter or returned
+//   arrayIndexOutOfBounds  a fixed size local array indexed past its end
+//   throwInNoexcept        a throw that is not caught inside a noexcept function
+//   assertWithSideEffect   an assert whose condition changes state, which vanishes with NDEBUG
+// The checks are heuristics over tokens rather than a full parse, tuned to report these patterns
+// without flooding ordinary code with false positives.
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+// bumped whenever a check changes what it reports, so stored results can be told apart
+constexpr const char* analyzer_version = "1.0.0";
+
+enum class severity
+{
+    warning,
+    error
+};
+
+struct finding
+{
+    std::string file;
+    int line = 0;
+    int column = 0;
+    // one of the check ids listed above
+    std::string rule;
+    enum severity severity = severity::error;
+    std::string message;
+};
+
+/// <summary>
+/// Id, severity and one line description of a check, for report headers.
+/// </summary>
+struct rule_description
+{
+    const char* id;
+    enum severity severity;
+    const char* description;
+};
+
+/// <summary>
+/// Every check the analyzer runs.
+/// </summary>
+const std::vector<rule_description>& analyzer_rules();
+
+/// <summary>
+/// Runs every check over one source file.
+/// </summary>
+/// <param name="source">contents of the file</param>
+/// <param name="file">name recorded in the findings</param>
+/// <returns>findings in source order</returns>
+std::vector<finding> analyze_source(std::string_view source, const std::string& file);
+
+const char* to_string(severity level) noexcept;
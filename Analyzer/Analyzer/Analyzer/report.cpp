@@ -0,0 +1,145 @@
+// report.cpp : Text, XML and SARIF output for analyzer findings.
+//
+
+#include "report.h"
+
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+namespace
+{
+    std::string escape_xml(std::string_view text)
+    {
+        std::string escaped;
+        escaped.reserve(text.size());
+        for (const char c : text)
+        {
+            switch (c)
+            {
+            case '&': escaped += "&amp;"; break;
+            case '<': escaped += "&lt;"; break;
+            case '>': escaped += "&gt;"; break;
+            case '"': escaped += "&quot;"; break;
+            case '\'': escaped += "&apos;"; break;
+            default: escaped += c; break;
+            }
+        }
+        return escaped;
+    }
+
+    std::string escape_json(std::string_view text)
+    {
+        std::string escaped;
+        escaped.reserve(text.size() + 2);
+        escaped += '"';
+        for (const char c : text)
+        {
+            switch (c)
+            {
+            case '"': escaped += "\\\""; break;
+            case '\\': escaped += "\\\\"; break;
+            case '\n': escaped += "\\n"; break;
+            case '\r': escaped += "\\r"; break;
+            case '\t': escaped += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20)
+                {
+                    char code[8];
+                    std::snprintf(code, sizeof(code), "\\u%04x", static_cast<unsigned>(c));
+                    escaped += code;
+                }
+                else
+                {
+                    escaped += c;
+                }
+                break;
+            }
+        }
+        escaped += '"';
+        return escaped;
+    }
+}
+
+void write_text(std::ostream& stream, const std::vector<finding>& findings)
+{
+    for (const auto& f : findings)
+    {
+        stream << f.file << ':' << f.line << ':' << f.column << ": " << to_string(f.severity) << ": " << f.message << " [" << f.rule << "]\n";
+    }
+}
+
+void write_xml(std::ostream& stream, const std::vector<finding>& findings)
+{
+    stream << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+        << "<results version=\"2\">\n"
+        << "    <cppcheck version=\"" << analyzer_version << "\"/>\n"
+        << "    <errors>\n";
+    for (const auto& f : findings)
+    {
+        const std::string message = escape_xml(f.message);
+        stream << "        <error id=\"" << f.rule << "\" severity=\"" << to_string(f.severity) << "\" msg=\"" << message << "\" verbose=\"" << message << "\">\n"
+            << "            <location file=\"" << escape_xml(f.file) << "\" line=\"" << f.line << "\" column=\"" << f.column << "\"/>\n"
+            << "        </error>\n";
+    }
+    stream << "    </errors>\n"
+        << "</results>\n";
+}
+
+void write_sarif(std::ostream& stream, const std::vector<finding>& findings)
+{
+    const auto& rules = analyzer_rules();
+
+    stream << "{\n"
+        << "  \"$schema\": \"https://json.schemastore.org/sarif-2.1.0.json\",\n"
+        << "  \"version\": \"2.1.0\",\n"
+        << "  \"runs\": [\n"
+        << "    {\n"
+        << "      \"tool\": {\n"
+        << "        \"driver\": {\n"
+        << "          \"name\": \"Analyzer\",\n"
+        << "          \"version\": " << escape_json(analyzer_version) << ",\n"
+        << "          \"rules\": [\n";
+    for (std::size_t i = 0; i < rules.size(); ++i)
+    {
+        stream << "            { \"id\": " << escape_json(rules[i].id)
+            << ", \"shortDescription\": { \"text\": " << escape_json(rules[i].description) << " }"
+            << ", \"defaultConfiguration\": { \"level\": \"" << to_string(rules[i].severity) << "\" } }"
+            << (i + 1 < rules.size() ? ",\n" : "\n");
+    }
+    stream << "          ]\n"
+        << "        }\n"
+        << "      },\n"
+        << "      \"results\": [\n";
+    for (std::size_t i = 0; i < findings.size(); ++i)
+    {
+        const finding& f = findings[i];
+        stream << "        {\n"
+            << "          \"ruleId\": " << escape_json(f.rule) << ",\n"
+            << "          \"level\": \"" << to_string(f.severity) << "\",\n"
+            << "          \"message\": { \"text\": " << escape_json(f.message) << " },\n"
+            << "          \"locations\": [ { \"physicalLocation\": { \"artifactLocation\": { \"uri\": " << escape_json(f.file) << " }, "
+            << "\"region\": { \"startLine\": " << f.line << ", \"startColumn\": " << f.column << " } } } ]\n"
+            << "        }" << (i + 1 < findings.size() ? ",\n" : "\n");
+    }
+    stream << "      ]\n"
+        << "    }\n"
+        << "  ]\n"
+        << "}\n";
+}
+
+void write_report(std::ostream& stream, report_format format, const std::vector<finding>& findings)
+{
+    switch (format)
+    {
+    case report_format::xml:
+        write_xml(stream, findings);
+        break;
+    case report_format::sarif:
+        write_sarif(stream, findings);
+        break;
+    default:
+        write_text(stream, findings);
+        break;
+    }
+}
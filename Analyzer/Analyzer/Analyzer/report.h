@@ -0,0 +1,35 @@
+// report.h : Writes analyzer findings as compiler style text, cppcheck XML or SARIF.
+//
+// The XML follows cppcheck's --xml-version=2 layout so existing cppcheck viewers and CI plugins
+// read it unchanged; SARIF 2.1.0 is what GitHub code scanning and most IDEs import.
+
+#pragma once
+
+#include <ostream>
+#include <vector>
+
+#include "checks.h"
+
+enum class report_format
+{
+    text,
+    xml,
+    sarif
+};
+
+/// <summary>
+/// One line per finding: file:line:column: severity: message [rule]
+/// </summary>
+void write_text(std::ostream& stream, const std::vector<finding>& findings);
+
+/// <summary>
+/// cppcheck XML version 2 results document.
+/// </summary>
+void write_xml(std::ostream& stream, const std::vector<finding>& findings);
+
+/// <summary>
+/// SARIF 2.1.0 log with a single run, listing every rule and the findings as results.
+/// </summary>
+void write_sarif(std::ostream& stream, const std::vector<finding>& findings);
+
+void write_report(std::ostream& stream, report_format format, const std::vector<finding>& findings);
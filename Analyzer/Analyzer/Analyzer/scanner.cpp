@@ -0,0 +1,144 @@
+// scanner.cpp : Source discovery and the worker threads that run the checks.
+//
+
+#include "scanner.h"
+
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    bool is_source(const fs::path& path)
+    {
+        const std::string extension = path.extension().string();
+        return extension == ".cpp" || extension == ".cc" || extension == ".cxx" || extension == ".h" || extension == ".hpp";
+    }
+
+    bool read_file(const std::string& path, std::string& contents)
+    {
+        std::ifstream stream(path, std::ios::binary);
+        if (!stream)
+        {
+            return false;
+        }
+        contents.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+        return !stream.bad();
+    }
+
+    struct file_result
+    {
+        std::vector<finding> findings;
+        std::uint64_t key = 0;
+        bool readable = true;
+        bool cached = false;
+    };
+}
+
+std::vector<std::string> collect_sources(const std::vector<std::string>& paths)
+{
+    std::vector<std::string> files;
+    for (const auto& path : paths)
+    {
+        std::error_code error;
+        if (!fs::is_directory(path, error))
+        {
+            files.push_back(path);
+            continue;
+        }
+
+        for (fs::recursive_directory_iterator entry(path, fs::directory_options::skip_permission_denied, error), end; !error && entry != end; entry.increment(error))
+        {
+            if (entry->is_regular_file(error) && is_source(entry->path()))
+            {
+                files.push_back(entry->path().generic_string());
+            }
+        }
+    }
+
+    std::sort(files.begin(), files.end());
+    files.erase(std::unique(files.begin(), files.end()), files.end());
+    return files;
+}
+
+scan_result scan(const std::vector<std::string>& files, unsigned jobs, analysis_cache* cache)
+{
+    if (jobs == 0)
+    {
+        jobs = std::max(1u, std::thread::hardware_concurrency());
+    }
+    jobs = static_cast<unsigned>(std::min<std::size_t>(jobs, std::max<std::size_t>(files.size(), 1)));
+
+    // each worker takes the next file index and writes only that file's slot, so no locking is
+    // needed and the output order is the input order. The cache is only read while they run.
+    std::vector<file_result> results(files.size());
+    std::atomic<std::size_t> next{ 0 };
+    auto work = [&]() {
+        std::string contents;
+        for (std::size_t i = next.fetch_add(1); i < files.size(); i = next.fetch_add(1))
+        {
+            if (!read_file(files[i], contents))
+            {
+                results[i].readable = false;
+                continue;
+            }
+            file_result& result = results[i];
+            if (cache != nullptr)
+            {
+                result.key = analysis_cache::hash(contents);
+                if (const auto* stored = cache->find(result.key))
+                {
+                    result.findings = *stored;
+                    for (auto& f : result.findings)
+                    {
+                        f.file = files[i];
+                    }
+                    result.cached = true;
+                    continue;
+                }
+            }
+            result.findings = analyze_source(contents, files[i]);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned i = 1; i < jobs; ++i)
+    {
+        workers.emplace_back(work);
+    }
+    work();
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+
+    if (cache != nullptr)
+    {
+        cache->clear();
+        for (const auto& file : results)
+        {
+            if (file.readable)
+            {
+                cache->insert(file.key, file.findings);
+            }
+        }
+    }
+
+    scan_result result;
+    result.files = files.size();
+    for (std::size_t i = 0; i < files.size(); ++i)
+    {
+        if (!results[i].readable)
+        {
+            result.unreadable.push_back(files[i]);
+        }
+        result.cached += results[i].cached;
+        std::move(results[i].findings.begin(), results[i].findings.end(), std::back_inserter(result.findings));
+    }
+    return result;
+}
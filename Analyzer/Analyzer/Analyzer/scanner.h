@@ -0,0 +1,38 @@
+// scanner.h : Finds the C++ sources under a set of paths and analyzes them on a pool of threads.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "analysis_cache.h"
+#include "checks.h"
+
+struct scan_result
+{
+    // findings of every file, in the order of the files and then of their lines
+    std::vector<finding> findings;
+    std::size_t files = 0;
+    // files whose findings came from the cache
+    std::size_t cached = 0;
+    // files that could not be read
+    std::vector<std::string> unreadable;
+};
+
+/// <summary>
+/// Expands directories recursively into their .cpp, .cc, .cxx, .h and .hpp files. Files named
+/// directly are kept whatever their extension. The result is sorted and free of duplicates.
+/// </summary>
+std::vector<std::string> collect_sources(const std::vector<std::string>& paths);
+
+/// <summary>
+/// Analyzes every file, jobs files at a time. The result does not depend on jobs.
+/// </summary>
+/// <param name="files">paths from collect_sources</param>
+/// <param name="jobs">worker threads, 0 for one per hardware thread</param>
+/// <param name="cache">findings of earlier runs, may be null. Files whose contents have a cache
+/// entry are not analyzed again. Afterwards the cache holds exactly the files of this scan, so
+/// entries of deleted or changed files do not pile up.</param>
+scan_result scan(const std::vector<std::string>& files, unsigned jobs, analysis_cache* cache = nullptr);
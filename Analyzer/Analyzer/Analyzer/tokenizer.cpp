@@ -0,0 +1,266 @@
+// tokenizer.cpp : Lightweight C++ tokenizer for the analyzer checks.
+//
+
+#include "tokenizer.h"
+
+#include <cctype>
+
+namespace
+{
+    // longest first, so "<<=" wins over "<<" and "<"
+    const std::string_view operators[] = {
+        "<<=", ">>=", "->*", "...",
+        "::", "->", "++", "--", "==", "!=", "<=", ">=", "&&", "||",
+        "+=", "-=", "*=", "/=", "%=", "&=", "|=", "^=", "<<", ">>", ".*"
+    };
+
+    bool identifier_start(char c) noexcept
+    {
+        return std::isalpha(static_cast<unsigned char>(c)) || c == '_';
+    }
+
+    bool identifier_char(char c) noexcept
+    {
+        return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+    }
+
+    class scanner
+    {
+    public:
+        explicit scanner(std::string_view source)
+            : source_(source)
+        {
+        }
+
+        std::vector<token> run()
+        {
+            std::vector<token> tokens;
+            tokens.reserve(source_.size() / 4);
+
+            bool line_start = true;
+            while (position_ < source_.size())
+            {
+                const char c = source_[position_];
+
+                if (c == '\n')
+                {
+                    advance(1);
+                    line_start = true;
+                    continue;
+                }
+                if (std::isspace(static_cast<unsigned char>(c)))
+                {
+                    advance(1);
+                    continue;
+                }
+                if (starts_with("//"))
+                {
+                    skip_to_line_end();
+                    continue;
+                }
+                if (starts_with("/*"))
+                {
+                    skip_block_comment();
+                    continue;
+                }
+                if (c == '#' && line_start)
+                {
+                    skip_directive();
+                    continue;
+                }
+                line_start = false;
+
+                token next;
+                next.line = line_;
+                next.column = column_;
+                const std::size_t begin = position_;
+
+                if (c == 'R' && position_ + 1 < source_.size() && source_[position_ + 1] == '"')
+                {
+                    skip_raw_string();
+                    next.kind = token_kind::string;
+                }
+                else if (identifier_start(c))
+                {
+                    while (position_ < source_.size() && identifier_char(source_[position_]))
+                    {
+                        advance(1);
+                    }
+                    // prefixed literals such as u8"..." and L'x'
+                    if (position_ < source_.size() && (source_[position_] == '"' || source_[position_] == '\'') && position_ - begin <= 2)
+                    {
+                        next.kind = source_[position_] == '"' ? token_kind::string : token_kind::character;
+                        skip_quoted(source_[position_]);
+                    }
+                    else
+                    {
+                        next.kind = token_kind::identifier;
+                    }
+                }
+                else if (std::isdigit(static_cast<unsigned char>(c)) || (c == '.' && position_ + 1 < source_.size() && std::isdigit(static_cast<unsigned char>(source_[position_ + 1]))))
+                {
+                    // digits, digit separators, hex, exponents and suffixes
+                    while (position_ < source_.size() && (identifier_char(source_[position_]) || source_[position_] == '.' || source_[position_] == '\''
+                        || ((source_[position_] == '+' || source_[position_] == '-') && (source_[position_ - 1] == 'e' || source_[position_ - 1] == 'E'))))
+                    {
+                        advance(1);
+                    }
+                    next.kind = token_kind::number;
+                }
+                else if (c == '"' || c == '\'')
+                {
+                    next.kind = c == '"' ? token_kind::string : token_kind::character;
+                    skip_quoted(c);
+                }
+                else
+                {
+                    next.kind = token_kind::punctuation;
+                    std::size_t length = 1;
+                    for (const auto op : operators)
+                    {
+                        if (starts_with(op))
+                        {
+                            length = op.size();
+                            break;
+                        }
+                    }
+                    advance(length);
+                }
+
+                next.text = source_.substr(begin, position_ - begin);
+                tokens.push_back(next);
+            }
+
+            match_brackets(tokens);
+            return tokens;
+        }
+
+    private:
+        bool starts_with(std::string_view text) const noexcept
+        {
+            return source_.compare(position_, text.size(), text) == 0;
+        }
+
+        void advance(std::size_t count) noexcept
+        {
+            for (std::size_t i = 0; i < count && position_ < source_.size(); ++i, ++position_)
+            {
+                if (source_[position_] == '\n')
+                {
+                    ++line_;
+                    column_ = 1;
+                }
+                else
+                {
+                    ++column_;
+                }
+            }
+        }
+
+        void skip_to_line_end() noexcept
+        {
+            while (position_ < source_.size() && source_[position_] != '\n')
+            {
+                advance(1);
+            }
+        }
+
+        void skip_block_comment() noexcept
+        {
+            advance(2);
+            while (position_ < source_.size() && !starts_with("*/"))
+            {
+                advance(1);
+            }
+            advance(2);
+        }
+
+        // a directive runs to the end of the line unless the line ends in a backslash
+        void skip_directive() noexcept
+        {
+            while (position_ < source_.size() && source_[position_] != '\n')
+            {
+                if (source_[position_] == '\\' && position_ + 1 < source_.size() && source_[position_ + 1] == '\n')
+                {
+                    advance(1);
+                }
+                else if (starts_with("/*"))
+                {
+                    skip_block_comment();
+                    continue;
+                }
+                advance(1);
+            }
+        }
+
+        void skip_quoted(char quote) noexcept
+        {
+            advance(1);
+            while (position_ < source_.size() && source_[position_] != quote && source_[position_] != '\n')
+            {
+                advance(source_[position_] == '\\' ? 2 : 1);
+            }
+            advance(1);
+        }
+
+        // R"delimiter( ... )delimiter"
+        void skip_raw_string() noexcept
+        {
+            advance(2);
+            const std::size_t delimiter_begin = position_;
+            while (position_ < source_.size() && source_[position_] != '(')
+            {
+                advance(1);
+            }
+            const std::string_view delimiter = source_.substr(delimiter_begin, position_ - delimiter_begin);
+            while (position_ < source_.size())
+            {
+                if (source_[position_] == ')' && source_.compare(position_ + 1, delimiter.size(), delimiter) == 0
+                    && position_ + 1 + delimiter.size() < source_.size() && source_[position_ + 1 + delimiter.size()] == '"')
+                {
+                    advance(delimiter.size() + 2);
+                    return;
+                }
+                advance(1);
+            }
+        }
+
+        static void match_brackets(std::vector<token>& tokens)
+        {
+            std::vector<std::size_t> open;
+            for (std::size_t i = 0; i < tokens.size(); ++i)
+            {
+                if (tokens[i].kind != token_kind::punctuation)
+                {
+                    continue;
+                }
+                const std::string_view text = tokens[i].text;
+                if (text == "(" || text == "[" || text == "{")
+                {
+                    open.push_back(i);
+                }
+                else if (text == ")" || text == "]" || text == "}")
+                {
+                    // unbalanced code, usually from #if branches: leave the closer unmatched
+                    if (open.empty())
+                    {
+                        continue;
+                    }
+                    tokens[open.back()].match = i;
+                    tokens[i].match = open.back();
+                    open.pop_back();
+                }
+            }
+        }
+
+        std::string_view source_;
+        std::size_t position_ = 0;
+        int line_ = 1;
+        int column_ = 1;
+    };
+}
+
+std::vector<token> tokenize(std::string_view source)
+{
+    return scanner(source).run();
+}
@@ -0,0 +1,42 @@
+// tokenizer.h : Lightweight C++ tokenizer for the analyzer checks.
+//
+// Good enough to find functions, statements and expressions in ordinary source: comments and
+// preprocessor lines are dropped, literals are kept whole and multi character operators are single
+// tokens. There is no preprocessing and no parsing; the checks work on the flat token list.
+
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+enum class token_kind
+{
+    identifier,
+    number,
+    string,
+    character,
+    punctuation
+};
+
+struct token
+{
+    token_kind kind = token_kind::punctuation;
+    // points into the source text, which must outlive the tokens
+    std::string_view text;
+    int line = 0;
+    int column = 0;
+    // for ( [ { the index of the matching closer and the other way round, otherwise npos
+    std::size_t match = npos;
+
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    bool is(std::string_view value) const noexcept { return text == value; }
+};
+
+/// <summary>
+/// Splits source into tokens and pairs up every bracket with its partner.
+/// </summary>
+/// <param name="source">C++ source text</param>
+/// <returns>tokens in source order</returns>
+std::vector<token> tokenize(std::string_view source);
@@ -0,0 +1,96 @@
+// Benchmark.cpp : This file contains the 'main' function. Program execution begins and ends there.
+//
+// Usage: Benchmark [suite ...] [--max-size=N] [--min-time=SECONDS]
+//   With no suite names every suite is run.
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "benchmark.h"
+
+// suites, each defined in its own <name>_benchmark.cpp
+void run_analyzer_benchmarks(const bench::options& settings);
+void run_container_benchmarks(const bench::options& settings);
+void run_divide_benchmarks(const bench::options& settings);
+void run_encryption_benchmarks(const bench::options& settings);
+void run_erase_benchmarks(const bench::options& settings);
+void run_error_benchmarks(const bench::options& settings);
+void run_growth_benchmarks(const bench::options& settings);
+void run_line_reader_benchmarks(const bench::options& settings);
+void run_numeric_benchmarks(const bench::options& settings);
+void run_random_benchmarks(const bench::options& settings);
+void run_string_benchmarks(const bench::options& settings);
+
+namespace
+{
+    struct suite
+    {
+        const char* name;
+        void (*run)(const bench::options&);
+    };
+
+    const suite suites[] = {
+        { "analyzer", run_analyzer_benchmarks },
+        { "container", run_container_benchmarks },
+        { "divide", run_divide_benchmarks },
+        { "encryption", run_encryption_benchmarks },
+        { "erase", run_erase_benchmarks },
+        { "error", run_error_benchmarks },
+        { "growth", run_growth_benchmarks },
+        { "line_reader", run_line_reader_benchmarks },
+        { "numeric", run_numeric_benchmarks },
+        { "random", run_random_benchmarks },
+        { "string", run_string_benchmarks },
+    };
+
+    bool starts_with(const std::string& text, const std::string& prefix)
+    {
+        return text.compare(0, prefix.size(), prefix) == 0;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    std::cout << "Benchmarks!" << std::endl;
+
+    bench::options settings;
+    std::vector<std::string> selected;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string argument = argv[i];
+        if (starts_with(argument, "--max-size="))
+        {
+            settings.max_size = std::strtoull(argument.c_str() + 11, nullptr, 10);
+        }
+        else if (starts_with(argument, "--min-time="))
+        {
+            settings.min_seconds = std::strtod(argument.c_str() + 11, nullptr);
+        }
+        else
+        {
+            selected.push_back(argument);
+        }
+    }
+
+    for (const auto& entry : suites)
+    {
+        bool run = selected.empty();
+        for (const auto& name : selected)
+        {
+            run = run || name == entry.name;
+        }
+
+        if (run)
+        {
+            entry.run(settings);
+        }
+    }
+
+    return 0;
+}
+
+// Run program: Ctrl + F5 or Debug > Start Without Debugging menu
+// Debug program: F5 or Debug > Start Debugging menu
@@ -0,0 +1,99 @@
+// analyzer_benchmark.cpp : The analyzer on a synthetic source tree, without a cache, with a cold
+// cache and with a warm one. items = files.
+//
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "analysis_cache.h"
+#include "benchmark.h"
+#include "fast_random.h"
+#include "scanner.h"
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    // QuestionableCode.cpp style functions, some with the defects and most without; $ is replaced
+    // by a number unique to the file so no two files have the same contents
+    const char* const templates[] = {
+        "bool is_type_$(int type) const\n{\n    if (typedefs.find(type) != typedefs.end())\n    {\n        return true;\n    }\n    return is_type_$(type);\n}\n",
+        "void vector_test_$()\n{\n    std::vector<int> items = { 1, 2, 3, 4 };\n    for (auto iter = items.begin(); iter != items.end();)\n    {\n        if (*iter % 2 == 0)\n        {\n            iter = items.erase(iter);\n        }\n        else\n        {\n            ++iter;\n        }\n    }\n}\n",
+        "void fill_$(int count)\n{\n    int buf[10];\n    for (int i = 0; i < 10; ++i)\n    {\n        buf[i] = i * count;\n    }\n    if (count == 1000)\n    {\n        buf[count] = 0;\n    }\n}\n",
+        "void store_$(int** a)\n{\n    static int b = 1;\n    *a = &b;\n}\n",
+        "int sum_$(const std::vector<int>& values) noexcept\n{\n    int total = 0;\n    for (int value : values)\n    {\n        total += value;\n    }\n    return total;\n}\n",
+        "void check_$(int z)\n{\n    assert(z == 2);\n    std::cout << \"checked \" << z << std::endl;\n}\n",
+    };
+
+    // count files spread over 100 directories, 2 to 3 KB each
+    void make_tree(const fs::path& root, std::size_t count)
+    {
+        fast_random::xoshiro256ss random(42);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            const fs::path directory = root / ("module" + std::to_string(i % 100));
+            fs::create_directories(directory);
+
+            std::string text = "// generated file " + std::to_string(i) + "\n#include <vector>\n\n";
+            for (int function = 0; function < 12; ++function)
+            {
+                std::string body = templates[random.uniform(sizeof(templates) / sizeof(templates[0]))];
+                const std::string suffix = std::to_string(i) + "_" + std::to_string(function);
+                for (std::size_t at = body.find('$'); at != std::string::npos; at = body.find('$', at))
+                {
+                    body.replace(at, 1, suffix);
+                }
+                text += body;
+                text += '\n';
+            }
+            std::ofstream(directory / ("file" + std::to_string(i) + ".cpp")) << text;
+        }
+    }
+}
+
+void run_analyzer_benchmarks(const bench::options& settings)
+{
+    bench::print_header("analyzer: no cache vs cold cache vs warm cache, items = files");
+
+    const std::size_t count = std::min<std::size_t>(settings.max_size, 10000);
+    const fs::path root = fs::temp_directory_path() / "analyzer_benchmark";
+    fs::remove_all(root);
+    make_tree(root, count);
+    const std::vector<std::string> files = collect_sources({ root.string() });
+    const std::string cache_path = (root / "analyzer.cache").string();
+
+    bench::print(bench::measure("scan, no cache", files.size(), settings, [&]() {
+        bench::keep(scan(files, 0).findings.size());
+    }));
+
+    // every file is analyzed and the cache is written for the next run
+    bench::print(bench::measure("scan, cold cache (hash + analyze + save)", files.size(), settings, [&]() {
+        analysis_cache cache;
+        bench::keep(scan(files, 0, &cache).findings.size());
+        cache.save(cache_path);
+    }));
+
+    // what an unchanged CI rerun pays: load, read and hash every file, save
+    bench::print(bench::measure("scan, warm cache (load + hash + save)", files.size(), settings, [&]() {
+        analysis_cache cache;
+        cache.load(cache_path);
+        bench::keep(scan(files, 0, &cache).cached);
+        cache.save(cache_path);
+    }));
+
+    // one file in a hundred changed since the last run
+    const std::string edited = "\n// edited\n";
+    bench::print(bench::measure("scan, warm cache, 1% of files edited", files.size(), settings, [&]() {
+        analysis_cache cache;
+        cache.load(cache_path);
+        for (std::size_t i = 0; i < files.size(); i += 100)
+        {
+            std::ofstream(files[i], std::ios::app) << edited;
+        }
+        bench::keep(scan(files, 0, &cache).cached);
+        cache.save(cache_path);
+    }));
+
+    fs::remove_all(root);
+}
@@ -0,0 +1,184 @@
+// benchmark.h : Minimal timing harness shared by the benchmark suites.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#endif
+
+#include "allocation_counter.h"
+
+namespace bench
+{
+    /// <summary>
+    /// Command line controlled settings passed to every suite.
+    /// </summary>
+    struct options
+    {
+        // largest problem size a suite should run
+        std::size_t max_size = 100000000;
+        // keep repeating a case until at least this much time has been measured
+        double min_seconds = 0.25;
+    };
+
+    /// <summary>
+    /// Result of timing one case at one problem size.
+    /// </summary>
+    struct measurement
+    {
+        std::string name;
+        std::size_t size = 0;
+        std::size_t iterations = 0;
+        double nanoseconds_per_iteration = 0;
+        double items_per_second = 0;
+        double allocations_per_iteration = 0;
+        double bytes_per_iteration = 0;
+        std::size_t peak_live_bytes = 0;
+        std::size_t peak_rss_bytes = 0;
+    };
+
+    /// <summary>
+    /// Peak resident set size of the whole process so far. The operating system only keeps a
+    /// high water mark, so this never goes down between cases.
+    /// </summary>
+    /// <returns>peak resident set size in bytes</returns>
+    inline std::size_t peak_rss_bytes()
+    {
+#ifdef _WIN32
+        PROCESS_MEMORY_COUNTERS counters;
+        if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        {
+            return counters.PeakWorkingSetSize;
+        }
+        return 0;
+#else
+        struct rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) != 0)
+        {
+            return 0;
+        }
+#ifdef __APPLE__
+        return static_cast<std::size_t>(usage.ru_maxrss);
+#else
+        // linux reports kilobytes
+        return static_cast<std::size_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+    }
+
+    // written by keep() so the optimizer has to produce the value
+    inline volatile std::size_t sink = 0;
+
+    /// <summary>
+    /// Stops the optimizer from discarding a computed value.
+    /// </summary>
+    template <typename T>
+    inline void keep(const T& value)
+    {
+        sink = static_cast<std::size_t>(value);
+    }
+
+    /// <summary>
+    /// Problem sizes 0, 1, 10, 100 ... up to max_size.
+    /// </summary>
+    inline std::vector<std::size_t> decade_sizes(std::size_t max_size)
+    {
+        std::vector<std::size_t> sizes{ 0 };
+        for (std::size_t size = 1; size <= max_size; size *= 10)
+        {
+            sizes.push_back(size);
+            if (size > max_size / 10)
+            {
+                break;
+            }
+        }
+        return sizes;
+    }
+
+    /// <summary>
+    /// Runs body repeatedly until options.min_seconds have elapsed and reports the averages.
+    /// </summary>
+    /// <param name="name">name of the case</param>
+    /// <param name="size">number of items processed by one call to body</param>
+    /// <param name="settings">suite options</param>
+    /// <param name="body">the code to time</param>
+    /// <returns>the measurement</returns>
+    template <typename Body>
+    measurement measure(const std::string& name, std::size_t size, const options& settings, Body&& body)
+    {
+        using clock = std::chrono::steady_clock;
+
+        // one untimed run so lazy initialization is not charged to the first iteration
+        body();
+
+        allocation_counter::reset_peak();
+        const auto allocations_before = allocation_counter::current();
+        const auto start = clock::now();
+
+        std::size_t iterations = 0;
+        std::chrono::duration<double> elapsed{ 0 };
+        do
+        {
+            body();
+            ++iterations;
+            elapsed = clock::now() - start;
+        } while (elapsed.count() < settings.min_seconds);
+
+        const auto activity = allocation_counter::difference(allocations_before, allocation_counter::current());
+
+        measurement result;
+        result.name = name;
+        result.size = size;
+        result.iterations = iterations;
+        result.nanoseconds_per_iteration = elapsed.count() * 1e9 / static_cast<double>(iterations);
+        result.items_per_second = static_cast<double>(size) * static_cast<double>(iterations) / elapsed.count();
+        result.allocations_per_iteration = static_cast<double>(activity.allocations) / static_cast<double>(iterations);
+        result.bytes_per_iteration = static_cast<double>(activity.bytes_allocated) / static_cast<double>(iterations);
+        result.peak_live_bytes = activity.peak_live_bytes;
+        result.peak_rss_bytes = peak_rss_bytes();
+        return result;
+    }
+
+    inline void print_header(const std::string& suite)
+    {
+        std::cout << std::endl << "*** " << suite << " ***" << std::endl;
+        std::cout << std::left << std::setw(50) << "case"
+            << std::right << std::setw(11) << "size"
+            << std::setw(10) << "iters"
+            << std::setw(16) << "ns/iter"
+            << std::setw(14) << "Mitems/s"
+            << std::setw(12) << "allocs/it"
+            << std::setw(14) << "bytes/it"
+            << std::setw(14) << "peak live"
+            << std::setw(14) << "peak RSS" << std::endl;
+    }
+
+    inline void print(const measurement& result)
+    {
+        std::cout << std::left << std::setw(50) << result.name
+            << std::right << std::setw(11) << result.size
+            << std::setw(10) << result.iterations
+            << std::fixed << std::setprecision(1)
+            << std::setw(16) << result.nanoseconds_per_iteration
+            << std::setprecision(2)
+            << std::setw(14) << result.items_per_second / 1e6
+            << std::setw(12) << result.allocations_per_iteration
+            << std::setprecision(0)
+            << std::setw(14) << result.bytes_per_iteration
+            << std::setw(14) << result.peak_live_bytes
+            << std::setw(14) << result.peak_rss_bytes << std::endl;
+    }
+}
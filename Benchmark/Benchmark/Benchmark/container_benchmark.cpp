@@ -0,0 +1,115 @@
+// container_benchmark.cpp : Cost of the collection operations exercised by CollectionTest for
+// std::vector and the alternative collections in Common.
+//
+
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+#include "benchmark.h"
+#include "pool_allocator.h"
+#include "small_vector.h"
+
+namespace
+{
+    // same value range add_entries uses, without paying for rand() inside the timed loop
+    int entry_value(std::size_t i)
+    {
+        return static_cast<int>(i % 100);
+    }
+
+    // CollectionTest::add_entries - repeated push_back from empty
+    template <typename Collection>
+    void add_entries(Collection& collection, std::size_t count)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            collection.push_back(entry_value(i));
+        }
+    }
+
+    // VerifyReserveIncreasesCapacacityNotSize - reserve up front, then fill
+    template <typename Collection>
+    void reserve_then_add_entries(Collection& collection, std::size_t count)
+    {
+        collection.reserve(count);
+        add_entries(collection, count);
+    }
+
+    // the resize / shrink_to_fit / erase / clear tests run back to back on a filled collection
+    template <typename Collection>
+    void resize_shrink_erase(Collection& collection, std::size_t count)
+    {
+        add_entries(collection, count);
+        collection.resize(count / 2);
+        collection.shrink_to_fit();
+        collection.resize(count);
+        collection.erase(collection.begin(), collection.end());
+        collection.clear();
+    }
+
+    /// <summary>
+    /// Times every workload for one collection type. make_collection receives a callback and must
+    /// invoke it with a freshly constructed collection, which lets it own whatever resource the
+    /// collection allocates from for exactly one iteration.
+    /// </summary>
+    template <typename MakeCollection>
+    void run_workloads(const std::string& name, std::size_t size, const bench::options& settings, MakeCollection make_collection)
+    {
+        bench::print(bench::measure(name + " add_entries", size, settings, [&]() {
+            make_collection([&](auto& collection) {
+                add_entries(collection, size);
+                bench::keep(collection.size());
+            });
+        }));
+
+        bench::print(bench::measure(name + " reserve+add_entries", size, settings, [&]() {
+            make_collection([&](auto& collection) {
+                reserve_then_add_entries(collection, size);
+                bench::keep(collection.size());
+            });
+        }));
+
+        bench::print(bench::measure(name + " resize/shrink/erase", size, settings, [&]() {
+            make_collection([&](auto& collection) {
+                resize_shrink_erase(collection, size);
+                bench::keep(collection.capacity());
+            });
+        }));
+    }
+}
+
+void run_container_benchmarks(const bench::options& settings)
+{
+    bench::print_header("container: std::vector vs small_vector vs pmr vector vs pooled vector");
+
+    // the pool outlives the iterations so blocks freed by one iteration are reused by the next
+    block_pool pool;
+
+    for (const std::size_t size : bench::decade_sizes(settings.max_size))
+    {
+        run_workloads("std::vector<int>", size, settings, [](auto&& use) {
+            std::vector<int> collection;
+            use(collection);
+        });
+
+        run_workloads("small_vector<int, 16>", size, settings, [](auto&& use) {
+            small_vector<int, 16> collection;
+            use(collection);
+        });
+
+        run_workloads("pmr::vector<int> monotonic", size, settings, [](auto&& use) {
+            std::pmr::monotonic_buffer_resource resource;
+            std::pmr::vector<int> collection(&resource);
+            use(collection);
+        });
+
+        run_workloads("vector<int, pool_allocator>", size, settings, [&pool](auto&& use) {
+            std::vector<int, pool_allocator<int>> collection{ pool_allocator<int>(pool) };
+            use(collection);
+        });
+
+        // drop the cached blocks for this size so the peak RSS of the next size is not inflated by them
+        pool.release();
+    }
+}
@@ -0,0 +1,50 @@
+// divide_benchmark.cpp : Ratios one at a time through try_divide against whole arrays through
+// divide_batch, with a share of the denominators zero.
+//
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "application_logic.h"
+#include "batch_divide.h"
+#include "benchmark.h"
+#include "fast_random.h"
+
+void run_divide_benchmarks(const bench::options& settings)
+{
+    bench::print_header("divide: try_divide per element vs divide_batch (" + std::to_string(batch_divide_width()) + " lanes), items = divisions");
+
+    const std::size_t count = std::min<std::size_t>(settings.max_size, 1000000);
+
+    for (const int zero_percent : { 0, 10, 50 })
+    {
+        fast_random::xoshiro256ss random(11);
+        std::vector<float> numerators(count);
+        std::vector<float> denominators(count);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            numerators[i] = static_cast<float>(random.uniform(1000));
+            denominators[i] = static_cast<int>(random.uniform(100)) < zero_percent ? 0.0f : static_cast<float>(1 + random.uniform(100));
+        }
+
+        std::vector<float> results(count);
+        std::vector<std::uint64_t> bad_lanes(batch_divide_mask_words(count));
+        const std::string zeros = std::to_string(zero_percent) + "% zero";
+
+        bench::print(bench::measure("try_divide per element, " + zeros, count, settings, [&]() {
+            std::size_t bad = 0;
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                const auto quotient = try_divide(numerators[i], denominators[i]);
+                results[i] = quotient.value_or(0.0f);
+                bad += !quotient;
+            }
+            bench::keep(bad);
+        }));
+
+        bench::print(bench::measure("divide_batch with mask, " + zeros, count, settings, [&]() {
+            bench::keep(divide_batch(numerators.data(), denominators.data(), results.data(), count, bad_lanes.data()));
+        }));
+    }
+}
@@ -0,0 +1,305 @@
+// encryption_benchmark.cpp : The repeating key XOR of the Encryption program against ChaCha20-Poly1305
+// over buffers of increasing size and containers with and without LZ4 chunks, items = bytes, the
+// timestamp line of save_data_file, items = stamps, the header lines of input files, items = files,
+// and whole files encrypted through iostreams and through async_io, items = bytes.
+//
+
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "async_io.h"
+#include "benchmark.h"
+#include "chacha20_poly1305.h"
+#include "cipher.h"
+#include "data_container.h"
+#include "date_stamp.h"
+#include "encrypt_decrypt.h"
+#include "fast_random.h"
+#include "input_header.h"
+
+void run_encryption_benchmarks(const bench::options& settings)
+{
+    bench::print_header("encryption: encrypt_decrypt vs chacha20-poly1305, items = bytes");
+
+    const std::string key = "password";
+    // derived once, as the Encryption program does, so only the cipher itself is measured
+    const cipher_key derived(cipher_mode::chacha20_poly1305, key);
+    const cipher_key legacy(cipher_mode::legacy_xor, key);
+    const xor_key prepared(key);
+    for (std::size_t size = 1000; size <= std::min<std::size_t>(settings.max_size, 10000000); size *= 100)
+    {
+        fast_random::xoshiro256ss random(3);
+        std::string source(size, '\0');
+        for (auto& c : source)
+        {
+            c = static_cast<char>(' ' + random.uniform(95));
+        }
+
+        bench::print(bench::measure("encrypt_decrypt, 8 byte key", size, settings, [&]() {
+            bench::keep(encrypt_decrypt(source, key).size());
+        }));
+
+        bench::print(bench::measure("encrypt_decrypt twice (round trip)", size, settings, [&]() {
+            bench::keep(encrypt_decrypt(encrypt_decrypt(source, key), key)[size / 2]);
+        }));
+
+        // the same XOR with the key prepared once, as batch jobs reuse it, and prepared on every call
+        bench::print(bench::measure("xor_key (" + std::to_string(xor_key::width()) + " bytes/step), prepared once", size, settings, [&]() {
+            bench::keep(encrypt_decrypt(source, prepared).size());
+        }));
+
+        bench::print(bench::measure("xor_key, prepared per call", size, settings, [&]() {
+            bench::keep(encrypt_decrypt(source, xor_key(key)).size());
+        }));
+
+        bench::print(bench::measure("chacha20-poly1305 encrypt (" + std::to_string(chacha20_width()) + " blocks/pass)", size, settings, [&]() {
+            cipher_header header;
+            bench::keep(encrypt(derived, source, header).size());
+        }));
+
+        bench::print(bench::measure("chacha20-poly1305 round trip", size, settings, [&]() {
+            cipher_header header;
+            std::string decrypted;
+            bench::keep(decrypt(derived, header, encrypt(derived, source, header), decrypted));
+        }));
+
+        // the same cipher in 64 KB container chunks: whole file on one thread and on all of them, then
+        // the one chunk a reader after a single record needs
+        const std::string image = *seal_container("John Q. Smith", derived, source, default_chunk_size, 1);
+        const container_view view = *container_view::parse(reinterpret_cast<const std::uint8_t*>(image.data()), image.size());
+
+        bench::print(bench::measure("container seal, 1 thread", size, settings, [&]() {
+            bench::keep(seal_container("John Q. Smith", derived, source, default_chunk_size, 1)->size());
+        }));
+
+        bench::print(bench::measure("container seal, all threads", size, settings, [&]() {
+            bench::keep(seal_container("John Q. Smith", derived, source)->size());
+        }));
+
+        bench::print(bench::measure("container decrypt_all, all threads", size, settings, [&]() {
+            bench::keep(view.decrypt_all(derived)->size());
+        }));
+
+        std::string chunk(view.chunk(view.chunk_count() - 1).plain_size, '\0');
+        bench::print(bench::measure("container decrypt_chunk, last chunk", size, settings, [&]() {
+            bench::keep(view.decrypt_chunk(derived, view.chunk_count() - 1, &chunk[0]).has_value());
+        }));
+
+        // one 100 byte record from the end of the file on disk: mapping and parsing the whole index
+        // against positioned reads of just that record's entry and chunk
+        const std::string filename = "encryption_benchmark.scd";
+        write_container(filename, "John Q. Smith", derived, source);
+        const std::uint64_t record = size - 100;
+        char bytes[100];
+        bench::print(bench::measure("container_file open + decrypt_chunk, 100 bytes", size, settings, [&]() {
+            container_file file;
+            file.open(filename);
+            const std::size_t index = static_cast<std::size_t>(record / default_chunk_size);
+            std::string whole(file.view().chunk(index).plain_size, '\0');
+            file.view().decrypt_chunk(derived, index, &whole[0]);
+            bench::keep(whole[static_cast<std::size_t>(record % default_chunk_size)]);
+        }));
+
+        bench::print(bench::measure("decrypt_range, 100 bytes", size, settings, [&]() {
+            bench::keep(decrypt_range(filename, derived, record, bytes, sizeof(bytes)).has_value());
+        }));
+
+        {
+            container_reader reader;
+            reader.open(filename);
+            bench::print(bench::measure("decrypt_range, 100 bytes, open", size, settings, [&]() {
+                bench::keep(reader.decrypt_range(derived, record, bytes, sizeof(bytes)).has_value());
+            }));
+        }
+
+        // legacy_xor ranges carry no tag, so only the 100 bytes themselves are read
+        write_container(filename, "John Q. Smith", legacy, source);
+        {
+            container_reader reader;
+            reader.open(filename);
+            bench::print(bench::measure("decrypt_range, 100 bytes, open, legacy_xor", size, settings, [&]() {
+                bench::keep(reader.decrypt_range(legacy, record, bytes, sizeof(bytes)).has_value());
+            }));
+        }
+        std::remove(filename.c_str());
+    }
+
+    // text like the generated lorem ipsum the program stores, through the container as it is and
+    // LZ4 compressed chunk by chunk: sealed, then written, mapped and decrypted end to end
+    bench::print_header("encryption: container with and without lz4, items = bytes");
+
+    const char* words[] = { "prow", "scuttle", "parrel", "provost", "sail", "ho", "shrouds", "spirits", "boom", "mizzenmast", "yardarm",
+        "pirate", "jolly", "roger", "galleon", "bilge", "rat", "hornswaggle", "quarterdeck", "belay" };
+    const std::size_t text_size = std::min<std::size_t>(settings.max_size, 10000000);
+    std::string text;
+    {
+        fast_random::xoshiro256ss random(9);
+        while (text.size() < text_size)
+        {
+            text += words[random.uniform(sizeof(words) / sizeof(words[0]))];
+            text += random.uniform(12) == 0 ? '\n' : ' ';
+        }
+        text.resize(text_size);
+    }
+
+    const std::string text_file = "encryption_benchmark_text.scd";
+    for (const auto compression : { container_compression::none, container_compression::lz4 })
+    {
+        const std::string label = compression == container_compression::lz4 ? "lz4" : "none";
+        const std::string image = *seal_container("John Q. Smith", derived, text, default_chunk_size, 0, compression);
+        const container_view view = *container_view::parse(reinterpret_cast<const std::uint8_t*>(image.data()), image.size());
+
+        bench::print(bench::measure("container seal, all threads, " + label, text.size(), settings, [&]() {
+            bench::keep(seal_container("John Q. Smith", derived, text, default_chunk_size, 0, compression)->size());
+        }));
+
+        bench::print(bench::measure("container decrypt_all, all threads, " + label, text.size(), settings, [&]() {
+            bench::keep(view.decrypt_all(derived)->size());
+        }));
+
+        bench::print(bench::measure("write, open, decrypt_all, " + label, text.size(), settings, [&]() {
+            write_container(text_file, "John Q. Smith", derived, text, default_chunk_size, 0, compression);
+            container_file file;
+            file.open(text_file);
+            bench::keep(file.view().decrypt_all(derived)->size());
+        }));
+
+        std::cout << "    payload=" << text.size() << " container=" << image.size() << " (" << image.size() * 100 / text.size() << "%)"
+                  << std::endl;
+    }
+    std::remove(text_file.c_str());
+
+    bench::print_header("encryption: save_data_file timestamp, items = stamps");
+
+    const std::size_t stamps = 1000;
+    bench::print(bench::measure("localtime + ostringstream (old)", stamps, settings, [&]() {
+        std::size_t total = 0;
+        for (std::size_t i = 0; i < stamps; ++i)
+        {
+            std::tm local{};
+            const std::time_t now = std::time(nullptr);
+#ifdef _WIN32
+            ::localtime_s(&local, &now);
+#else
+            ::localtime_r(&now, &local);
+#endif
+            std::ostringstream stream;
+            stream << local.tm_year + 1900 << "-" << local.tm_mon + 1 << "-" << local.tm_mday;
+            total += stream.str().size();
+        }
+        bench::keep(total);
+    }));
+
+    bench::print(bench::measure("date_stamp (cached per thread)", stamps, settings, [&]() {
+        char buffer[date_stamp_length + 1];
+        std::size_t total = 0;
+        for (std::size_t i = 0; i < stamps; ++i)
+        {
+            total += date_stamp(buffer, sizeof(buffer));
+        }
+        bench::keep(total);
+    }));
+
+    // the student name of many input files: each file loaded whole and searched with find and substr
+    // as get_student_name used to, against reading just the first 4 KB
+    bench::print_header("encryption: input file header, items = files");
+
+    const std::size_t header_files = 20;
+    const std::size_t header_file_size = std::min<std::size_t>(settings.max_size, 1000000);
+    std::vector<std::string> header_names;
+    for (std::size_t i = 0; i < header_files; ++i)
+    {
+        header_names.push_back("encryption_benchmark_" + std::to_string(i) + ".txt");
+        std::ofstream file(header_names.back(), std::ios::binary | std::ios::trunc);
+        file << "Sam Student " << i << "\nhttps://pirateipsum.me/\n" << std::string(header_file_size, 'x');
+    }
+
+    bench::print(bench::measure("read whole file, find + substr (old)", header_files, settings, [&]() {
+        std::size_t total = 0;
+        for (const auto& name : header_names)
+        {
+            std::ifstream file(name);
+            std::stringstream buffer;
+            buffer << file.rdbuf();
+            const std::string text = buffer.str();
+            const std::size_t pos = text.find('\n');
+            total += pos != std::string::npos ? text.substr(0, pos).size() : 0;
+        }
+        bench::keep(total);
+    }));
+
+    bench::print(bench::measure("read_input_header", header_files, settings, [&]() {
+        char buffer[input_header_limit];
+        std::size_t total = 0;
+        for (const auto& name : header_names)
+        {
+            const auto header = read_input_header(name, buffer, sizeof(buffer));
+            total += header ? header->student_name.size() : 0;
+        }
+        bench::keep(total);
+    }));
+
+    const std::string header_text = "Sam Student\nhttps://pirateipsum.me/\n" + std::string(header_file_size, 'x');
+    bench::print(bench::measure("parse_input_header, in memory", header_files, settings, [&]() {
+        std::size_t total = 0;
+        for (std::size_t i = 0; i < header_files; ++i)
+        {
+            total += parse_input_header(header_text.data(), header_text.size())->payload_offset;
+        }
+        bench::keep(total);
+    }));
+
+    for (const auto& name : header_names)
+    {
+        std::remove(name.c_str());
+    }
+
+    // file to file in 1 MB blocks: read whole, encrypt, write whole with iostreams as the Encryption
+    // program does, against the async_io pipeline that overlaps the three on each backend
+    bench::print_header("encryption: file to file encrypt_decrypt, items = bytes");
+
+    const std::size_t file_size = std::min<std::size_t>(settings.max_size, 64 * 1024 * 1024);
+    const std::string input_name = "encryption_benchmark.in";
+    const std::string output_name = "encryption_benchmark.out";
+    {
+        fast_random::xoshiro256ss random(5);
+        std::string text(file_size, '\0');
+        for (auto& c : text)
+        {
+            c = static_cast<char>(' ' + random.uniform(95));
+        }
+        std::ofstream file(input_name, std::ios::binary | std::ios::trunc);
+        file.write(text.data(), static_cast<std::streamsize>(text.size()));
+    }
+
+    bench::print(bench::measure("iostream read, encrypt, write", file_size, settings, [&]() {
+        std::ifstream in(input_name, std::ios::binary);
+        std::stringstream buffer;
+        buffer << in.rdbuf();
+        const std::string encrypted = encrypt_decrypt(buffer.str(), key);
+        std::ofstream out(output_name, std::ios::binary | std::ios::trunc);
+        out.write(encrypted.data(), static_cast<std::streamsize>(encrypted.size()));
+        bench::keep(encrypted.size());
+    }));
+
+    for (const auto backend : { io_backend::thread_pool, io_backend::io_uring })
+    {
+        auto io = async_io::create(8, 1024 * 1024, backend);
+        if (!io || (*io)->backend() != backend)
+        {
+            continue;
+        }
+        bench::print(bench::measure(std::string("transform_file, ") + to_string(backend) + ", 8 x 1 MB", file_size, settings, [&]() {
+            bench::keep(*transform_file(**io, input_name, output_name, [&](std::uint8_t* data, std::size_t size, std::uint64_t position) {
+                encrypt_decrypt(reinterpret_cast<const char*>(data), reinterpret_cast<char*>(data), size, key, position);
+            }));
+        }));
+    }
+    std::remove(input_name.c_str());
+    std::remove(output_name.c_str());
+}
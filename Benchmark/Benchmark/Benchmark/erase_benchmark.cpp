@@ -0,0 +1,83 @@
+// erase_benchmark.cpp : Removing a share of a vector's elements: erase inside the loop (the fixed
+// vector_test() pattern), erase-remove, compact_if and bulk_erase_if. Every case starts from a copy
+// of the same vector, so "copy only" is the floor. items = elements.
+//
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "benchmark.h"
+#include "bulk_erase.h"
+#include "fast_random.h"
+
+namespace
+{
+    template <typename T>
+    void run_type(const std::string& type, std::size_t count, const bench::options& settings)
+    {
+        for (const int remove_percent : { 1, 10, 50, 90 })
+        {
+            // a random share is removed, so the predicate outcome cannot be predicted
+            fast_random::xoshiro256ss random(5);
+            std::vector<T> original(count);
+            for (auto& value : original)
+            {
+                value = static_cast<T>(random.uniform(100));
+            }
+            const auto remove = [remove_percent](T value) { return value < static_cast<T>(remove_percent); };
+            const std::string label = ", " + type + ", " + std::to_string(remove_percent) + "% removed";
+            std::vector<T> items;
+
+            bench::print(bench::measure("copy only" + label, count, settings, [&]() {
+                items = original;
+                bench::keep(items.size());
+            }));
+
+            // quadratic, only run where it finishes
+            if (count <= 100000)
+            {
+                bench::print(bench::measure("erase inside the loop" + label, count, settings, [&]() {
+                    items = original;
+                    for (auto iter = items.begin(); iter != items.end();)
+                    {
+                        iter = remove(*iter) ? items.erase(iter) : iter + 1;
+                    }
+                    bench::keep(items.size());
+                }));
+            }
+
+            bench::print(bench::measure("erase_remove_if" + label, count, settings, [&]() {
+                items = original;
+                bench::keep(erase_remove_if(items, remove));
+            }));
+
+            bench::print(bench::measure("compact_if" + label, count, settings, [&]() {
+                items = original;
+                items.erase(compact_if(items.begin(), items.end(), remove), items.end());
+                bench::keep(items.size());
+            }));
+
+            bench::print(bench::measure("bulk_erase_if" + label, count, settings, [&]() {
+                items = original;
+                bench::keep(bulk_erase_if(items, remove));
+            }));
+        }
+    }
+}
+
+void run_erase_benchmarks(const bench::options& settings)
+{
+    bench::print_header("erase: per element erase vs erase-remove vs compact_if vs bulk_erase_if (" + std::to_string(bulk_erase_width()) + " lanes), items = elements");
+
+    for (const std::size_t count : { std::size_t(100000), std::size_t(10000000) })
+    {
+        if (count > settings.max_size)
+        {
+            break;
+        }
+        run_type<std::int32_t>("int32", count, settings);
+        run_type<double>("double", count, settings);
+    }
+}
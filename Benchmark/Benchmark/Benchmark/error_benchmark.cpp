@@ -0,0 +1,111 @@
+// error_benchmark.cpp : Cost of reporting a zero denominator by throwing std::runtime_error, as the
+// original divide in Exceptions.cpp did, by throwing the allocation free divide_by_zero_error, and by
+// returning it in an expected from try_divide, as the share of failing divisions grows.
+//
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "application_logic.h"
+#include "benchmark.h"
+#include "fast_random.h"
+
+namespace
+{
+    float throwing_divide(float num, float den)
+    {
+        if (den == 0)
+        {
+            throw std::runtime_error("Denominator cannot be 0");
+        }
+        return num / den;
+    }
+
+    float application_throwing_divide(float num, float den)
+    {
+        if (den == 0)
+        {
+            throw divide_by_zero_error();
+        }
+        return num / den;
+    }
+
+    // denominators in 1..9, with error_percent of them replaced by 0
+    std::vector<float> make_denominators(std::size_t count, int error_percent)
+    {
+        fast_random::xoshiro256ss random(3);
+        std::vector<float> denominators(count);
+        for (auto& den : denominators)
+        {
+            den = static_cast<int>(random.uniform(100)) < error_percent ? 0.0f : static_cast<float>(1 + random.uniform(9));
+        }
+        return denominators;
+    }
+}
+
+void run_error_benchmarks(const bench::options& settings)
+{
+    bench::print_header("error: throw/catch vs expected on divide by zero, items = divisions");
+
+    const std::size_t count = std::min<std::size_t>(settings.max_size, 100000);
+
+    for (const int error_percent : { 0, 1, 10, 50, 100 })
+    {
+        const std::vector<float> denominators = make_denominators(count, error_percent);
+        const std::string rate = std::to_string(error_percent) + "% errors";
+
+        bench::print(bench::measure("throw/catch runtime_error, " + rate, count, settings, [&]() {
+            float total = 0;
+            std::size_t errors = 0;
+            for (const float den : denominators)
+            {
+                try
+                {
+                    total += throwing_divide(10.0f, den);
+                }
+                catch (const std::runtime_error&)
+                {
+                    ++errors;
+                }
+            }
+            bench::keep(total + static_cast<float>(errors));
+        }));
+
+        bench::print(bench::measure("throw/catch divide_by_zero_error, " + rate, count, settings, [&]() {
+            float total = 0;
+            std::size_t errors = 0;
+            for (const float den : denominators)
+            {
+                try
+                {
+                    total += application_throwing_divide(10.0f, den);
+                }
+                catch (const application_runtime_error&)
+                {
+                    ++errors;
+                }
+            }
+            bench::keep(total + static_cast<float>(errors));
+        }));
+
+        bench::print(bench::measure("expected<float, application_error>, " + rate, count, settings, [&]() {
+            float total = 0;
+            std::size_t errors = 0;
+            for (const float den : denominators)
+            {
+                const auto result = try_divide(10.0f, den);
+                if (result)
+                {
+                    total += *result;
+                }
+                else
+                {
+                    ++errors;
+                }
+            }
+            bench::keep(total + static_cast<float>(errors));
+        }));
+    }
+}
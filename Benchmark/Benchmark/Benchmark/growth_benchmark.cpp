@@ -0,0 +1,66 @@
+// growth_benchmark.cpp : add_entries style push_back cascades for std::vector against growable_vector
+// with each growth policy.
+//
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "benchmark.h"
+#include "growable_vector.h"
+
+namespace
+{
+    template <typename Collection>
+    void add_entries(Collection& collection, std::size_t count)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            collection.push_back(static_cast<int>(i % 100));
+        }
+    }
+
+    template <typename Policy>
+    void run_policy(const std::string& name, std::size_t size, const bench::options& settings)
+    {
+        growth_stats stats;
+
+        bench::print(bench::measure("growable_vector<int, " + name + ">", size, settings, [&]() {
+            growable_vector<int, Policy> collection;
+            add_entries(collection, size);
+            bench::keep(collection.size());
+            stats = collection.stats();
+        }));
+
+        // the growth history of one fill, identical for every iteration
+        std::cout << "    reallocations=" << stats.reallocations
+            << " relocations=" << stats.relocations
+            << " relocated_bytes=" << stats.relocated_bytes
+            << " in_place=" << stats.in_place
+            << " remapped_bytes=" << stats.remapped_bytes << std::endl;
+    }
+}
+
+void run_growth_benchmarks(const bench::options& settings)
+{
+    bench::print_header("growth: push_back cascades, std::vector vs growable_vector policies");
+
+    for (const std::size_t size : bench::decade_sizes(settings.max_size))
+    {
+        if (size < 1000)
+        {
+            continue;
+        }
+
+        bench::print(bench::measure("std::vector<int>", size, settings, [&]() {
+            std::vector<int> collection;
+            add_entries(collection, size);
+            bench::keep(collection.size());
+        }));
+
+        run_policy<growth_1_5x>("growth_1_5x", size, settings);
+        run_policy<growth_2x>("growth_2x", size, settings);
+        run_policy<chunked_growth<>>("chunked_growth<64K>", size, settings);
+        run_policy<huge_page_growth>("huge_page_growth", size, settings);
+    }
+}
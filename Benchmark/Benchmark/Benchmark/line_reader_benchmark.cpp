@@ -0,0 +1,98 @@
+// line_reader_benchmark.cpp : std::getline against line_reader from line_reader.h on input held in
+// memory, so the numbers measure line splitting rather than the disk or the terminal.
+//
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+
+#include "benchmark.h"
+#include "fast_random.h"
+#include "line_reader.h"
+
+namespace
+{
+    // serves a string in chunks the way read(2) would
+    struct memory_source
+    {
+        const std::string* text;
+        std::size_t position;
+
+        static std::ptrdiff_t read(void* context, char* buffer, std::size_t size)
+        {
+            auto& source = *static_cast<memory_source*>(context);
+            const std::size_t count = std::min(size, source.text->size() - source.position);
+            source.text->copy(buffer, count, source.position);
+            source.position += count;
+            return static_cast<std::ptrdiff_t>(count);
+        }
+    };
+
+    // account records "name,number,balance" of varying length, one per line
+    std::string make_input(std::size_t line_count)
+    {
+        fast_random::xoshiro256ss random(42);
+        std::string text;
+        text.reserve(line_count * 40);
+        for (std::size_t i = 0; i < line_count; ++i)
+        {
+            text.append(5 + random.uniform(20), 'a' + static_cast<char>(random.uniform(26)));
+            text += ',';
+            text += std::to_string(random.uniform(1000000));
+            text += ',';
+            text += std::to_string(random.uniform(100000));
+            text += '\n';
+        }
+        return text;
+    }
+}
+
+void run_line_reader_benchmarks(const bench::options& settings)
+{
+    bench::print_header("line_reader: std::getline vs line_reader, items = lines");
+
+    for (std::size_t line_count = 1000; line_count <= std::min<std::size_t>(settings.max_size, 10000000); line_count *= 100)
+    {
+        const std::string input = make_input(line_count);
+
+        bench::print(bench::measure("std::getline(istringstream)", line_count, settings, [&]() {
+            std::istringstream stream(input);
+            std::string line;
+            std::size_t total = 0;
+            while (std::getline(stream, line))
+            {
+                total += line.size();
+            }
+            bench::keep(total);
+        }));
+
+        bench::print(bench::measure("line_reader::next", line_count, settings, [&]() {
+            memory_source source{ &input, 0 };
+            line_reader reader(memory_source::read, &source);
+            input_line line;
+            std::size_t total = 0;
+            while (reader.next(line))
+            {
+                total += line.text.size();
+            }
+            bench::keep(total);
+        }));
+
+        bench::print(bench::measure("line_reader::next + split_fields", line_count, settings, [&]() {
+            static const std::size_t limits[] = { 32, 10, 10 };
+            memory_source source{ &input, 0 };
+            line_reader reader(memory_source::read, &source);
+            input_line line;
+            std::string_view fields[3];
+            std::size_t total = 0;
+            while (reader.next(line))
+            {
+                if (split_fields(line.text, ',', limits, fields, 3).status == field_status::ok)
+                {
+                    total += fields[1].size();
+                }
+            }
+            bench::keep(total);
+        }));
+    }
+}
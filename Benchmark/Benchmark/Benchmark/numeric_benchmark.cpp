@@ -0,0 +1,136 @@
+// numeric_benchmark.cpp : The overflow checked add_numbers / subtract_numbers loops of the
+// NumericOverflow program. The type lookup in is_overflow runs once per type, so what is measured
+// is the per step limits check: through float for the 64 bit types, exact for __int128 and the
+// carry chain of wide_int<256>. items = steps.
+// The reduction cases sum one array through checked_sum and widened_sum on one thread and on every
+// hardware thread, against a serial is_overflow loop over the same array. items = elements.
+//
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "NumericFunctions.h"
+#include "benchmark.h"
+#include "parallel_reduce.h"
+
+namespace
+{
+    // bench::keep takes what converts to size_t, a wide_integer folds all its limbs into one so the
+    // work on every limb stays observable
+    template <typename T>
+    T kept(const T& value)
+    {
+        return value;
+    }
+
+    template <std::size_t Bits, bool Signed>
+    std::uint64_t kept(const wide_integer<Bits, Signed>& value)
+    {
+        std::uint64_t folded = 0;
+        for (std::size_t i = 0; i < wide_integer<Bits, Signed>::limb_count; ++i)
+        {
+            folded ^= value.limb(i);
+        }
+        return folded;
+    }
+
+    template <typename T>
+    void run_type(const std::string& type, unsigned long steps, const bench::options& settings)
+    {
+        // increments small enough that the loop runs all steps without overflowing
+        const T increment = static_cast<T>(1);
+
+        bench::print(bench::measure("add_numbers<" + type + ">", steps, settings, [&]() {
+            bench::keep(kept(add_numbers<T>(static_cast<T>(0), increment, steps)));
+        }));
+
+        bench::print(bench::measure("subtract_numbers<" + type + ">", steps, settings, [&]() {
+            bench::keep(kept(subtract_numbers<T>(static_cast<T>(steps + 1), increment, steps)));
+        }));
+    }
+
+    template <typename T>
+    void run_integer_reduction(const std::string& type, std::size_t count, unsigned threads, const bench::options& settings)
+    {
+        std::vector<T> values(count);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            values[i] = static_cast<T>(i % 1000);
+        }
+
+        bench::print(bench::measure("is_overflow loop<" + type + ">", count, settings, [&]() {
+            T sum = 0;
+            for (const T value : values)
+            {
+                if (is_overflow(sum, value))
+                {
+                    break;
+                }
+                sum += value;
+            }
+            bench::keep(sum);
+        }));
+
+        bench::print(bench::measure("checked_sum<" + type + "> 1 thread", count, settings, [&]() {
+            bench::keep(checked_sum(values.data(), count, 1).value);
+        }));
+
+        bench::print(bench::measure("checked_sum<" + type + "> all threads", count, settings, [&]() {
+            bench::keep(checked_sum(values.data(), count, threads).value);
+        }));
+    }
+
+    void run_float_reduction(std::size_t count, unsigned threads, const bench::options& settings)
+    {
+        std::vector<double> values(count);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            values[i] = 1.0 / static_cast<double>(i + 1);
+        }
+
+        const struct
+        {
+            const char* name;
+            float_summation method;
+        } methods[] = {
+            { "plain", float_summation::plain },
+            { "kahan", float_summation::kahan },
+            { "pairwise", float_summation::pairwise },
+        };
+        for (const auto& method : methods)
+        {
+            bench::print(bench::measure(std::string("widened_sum<double> ") + method.name + " 1 thread", count, settings, [&]() {
+                bench::keep(widened_sum(values.data(), count, 1, method.method));
+            }));
+            bench::print(bench::measure(std::string("widened_sum<double> ") + method.name + " all threads", count,
+                settings, [&]() { bench::keep(widened_sum(values.data(), count, threads, method.method)); }));
+        }
+    }
+}
+
+void run_numeric_benchmarks(const bench::options& settings)
+{
+    bench::print_header("numeric: checked add / subtract loops, items = steps");
+
+    const auto steps = static_cast<unsigned long>(std::min<std::size_t>(settings.max_size, 1000000));
+    run_type<int>("int", steps, settings);
+    run_type<unsigned long long>("unsigned long long", steps, settings);
+    run_type<double>("double", steps, settings);
+#if defined(__SIZEOF_INT128__)
+    run_type<unsigned __int128>("unsigned __int128", steps, settings);
+#endif
+    run_type<wide_int<256>>("wide_int<256>", steps, settings);
+
+    bench::print_header("numeric: parallel checked reductions, items = elements");
+
+    const std::size_t count = std::min<std::size_t>(settings.max_size, 100000000);
+    const unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    std::cout << "    " << count << " elements, " << threads << " hardware threads" << std::endl;
+    run_integer_reduction<int>("int", count, threads, settings);
+    run_integer_reduction<long long>("long long", count, threads, settings);
+    run_float_reduction(count, threads, settings);
+}
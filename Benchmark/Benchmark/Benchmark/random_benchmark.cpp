@@ -0,0 +1,73 @@
+// random_benchmark.cpp : rand() against the per thread generator in fast_random.h as the number
+// of threads drawing numbers at the same time grows.
+//
+
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "benchmark.h"
+#include "fast_random.h"
+
+namespace
+{
+    // runs draw(values, count) on every thread at once, each thread with its own output buffer
+    template <typename Draw>
+    void run_threads(std::size_t thread_count, std::vector<std::vector<int>>& buffers, Draw draw)
+    {
+        std::vector<std::thread> threads;
+        threads.reserve(thread_count);
+        for (std::size_t t = 0; t < thread_count; ++t)
+        {
+            threads.emplace_back([&buffers, &draw, t]() {
+                draw(buffers[t].data(), buffers[t].size());
+            });
+        }
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+    }
+
+    template <typename Draw>
+    void run_case(const std::string& name, std::size_t thread_count, std::size_t per_thread, const bench::options& settings, Draw draw)
+    {
+        std::vector<std::vector<int>> buffers(thread_count, std::vector<int>(per_thread));
+
+        bench::print(bench::measure(name + " x" + std::to_string(thread_count) + " threads", thread_count * per_thread, settings, [&]() {
+            run_threads(thread_count, buffers, draw);
+            bench::keep(buffers[0][0]);
+        }));
+    }
+}
+
+void run_random_benchmarks(const bench::options& settings)
+{
+    bench::print_header("random: rand() % 100 vs fast_random, items = numbers drawn by all threads");
+
+    const std::size_t per_thread = std::min<std::size_t>(settings.max_size, 1000000);
+    const std::size_t hardware_threads = std::max(1u, std::thread::hardware_concurrency());
+
+    for (std::size_t thread_count = 1; thread_count <= hardware_threads; thread_count *= 2)
+    {
+        run_case("rand() % 100", thread_count, per_thread, settings, [](int* values, std::size_t count) {
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                values[i] = rand() % 100;
+            }
+        });
+
+        run_case("fast_random::uniform(100)", thread_count, per_thread, settings, [](int* values, std::size_t count) {
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                values[i] = fast_random::uniform(100);
+            }
+        });
+
+        run_case("fast_random::fill(100)", thread_count, per_thread, settings, [](int* values, std::size_t count) {
+            fast_random::fill(values, count, 100);
+        });
+    }
+}
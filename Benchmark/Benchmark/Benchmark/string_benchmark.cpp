@@ -0,0 +1,103 @@
+// string_benchmark.cpp : Records with std::string fields against records with fixed_string fields.
+// Account ids are short enough for the small string buffer, owner names are not, so the std::string
+// record shows both the SSO case and the heap case.
+//
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "benchmark.h"
+#include "fast_random.h"
+#include "fixed_string.h"
+
+namespace
+{
+    struct string_record
+    {
+        std::string account_number;
+        std::string owner;
+        int balance;
+    };
+
+    struct fixed_record
+    {
+        fixed_string<15> account_number;
+        fixed_string<31> owner;
+        int balance;
+    };
+
+    struct source_text
+    {
+        std::vector<std::string> account_numbers;
+        std::vector<std::string> owners;
+    };
+
+    source_text make_text(std::size_t count)
+    {
+        fast_random::xoshiro256ss random(7);
+        source_text text;
+        text.account_numbers.reserve(count);
+        text.owners.reserve(count);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            std::string account(8 + random.uniform(8), '0');
+            for (auto& c : account)
+            {
+                c = static_cast<char>('0' + random.uniform(10));
+            }
+            text.account_numbers.push_back(std::move(account));
+            text.owners.emplace_back(20 + random.uniform(12), static_cast<char>('a' + random.uniform(26)));
+        }
+        return text;
+    }
+
+    template <typename Record>
+    std::vector<Record> build(const source_text& text)
+    {
+        std::vector<Record> records(text.account_numbers.size());
+        for (std::size_t i = 0; i < records.size(); ++i)
+        {
+            records[i].account_number.assign(text.account_numbers[i]);
+            records[i].owner.assign(text.owners[i]);
+            records[i].balance = static_cast<int>(i);
+        }
+        return records;
+    }
+
+    template <typename Record>
+    void run_cases(const std::string& name, std::size_t size, const source_text& text, const bench::options& settings)
+    {
+        bench::print(bench::measure(name + " build", size, settings, [&]() {
+            auto records = build<Record>(text);
+            bench::keep(records.back().balance);
+        }));
+
+        const auto records = build<Record>(text);
+        bench::print(bench::measure(name + " copy", size, settings, [&]() {
+            auto copy = records;
+            bench::keep(copy.back().balance);
+        }));
+
+        auto sorted = records;
+        bench::print(bench::measure(name + " sort by account", size, settings, [&]() {
+            sorted = records;
+            std::sort(sorted.begin(), sorted.end(), [](const Record& left, const Record& right) {
+                return left.account_number < right.account_number;
+            });
+            bench::keep(sorted.front().balance);
+        }));
+    }
+}
+
+void run_string_benchmarks(const bench::options& settings)
+{
+    bench::print_header("string: records of std::string vs fixed_string, items = records");
+
+    for (std::size_t size = 1000; size <= std::min<std::size_t>(settings.max_size, 1000000); size *= 10)
+    {
+        const source_text text = make_text(size);
+        run_cases<string_record>("std::string", size, text, settings);
+        run_cases<fixed_record>("fixed_string", size, text, settings);
+    }
+}
@@ -4,6 +4,9 @@
 #include <iomanip>
 #include <iostream>
 
+#include "fixed_string.h"
+#include "line_reader.h"
+
 int main()
 {
 	std::cout << "Buffer Overflow Example" << std::endl;
@@ -13,13 +16,26 @@ int main()
 	//  You need to modify this method to prevent buffer overflow without changing the account_order
 	//  varaible, and its position in the declaration. It must always be directly before the variable used for input.
 
-	const std::string account_number = "CharlieBrown42";
-	char user_input[20];
-	std::cout << "Enter a value: ";
+	// Both fields are fixed_string: 19 characters stored inline, no heap, and every write is bounds checked,
+	// so nothing written to user_input can reach account_number.
+	const fixed_string<19> account_number = "CharlieBrown42";
+	fixed_string<19> user_input;
+	// the reader goes to the descriptor, not through std::cin, so nothing flushes the prompt for it
+	std::cout << "Enter a value: " << std::flush;
 
-	// Updated std::cin to std::cin.getline() which saves the user input to the specified amount of characters
-	// and ignores the remainder of the input that exceeds this threshold.
-	std::cin.getline(user_input, 20);
+	// Read the line with a bounded reader that never stores more than 19 characters. Unlike
+	// std::cin.getline() a long line is reported instead of silently cut, and the input stays usable afterwards.
+	// One byte per read, so nothing of stdin past the end of the line is consumed.
+	line_reader reader(0, user_input.capacity(), 1);
+	input_line line;
+	if (reader.next(line))
+	{
+		user_input.assign(line.text);
+		if (line.truncated)
+		{
+			std::cout << "Input was " << line.length << " characters, only the first " << user_input.size() << " were kept." << std::endl;
+		}
+	}
 
 	std::cout << "You entered: " << user_input << std::endl;
 	std::cout << "Account Number = " << account_number << std::endl;
@@ -0,0 +1,257 @@
+// allocation_counter.cpp : Replacement global operator new / delete that feed the allocation counters.
+//
+
+#include "allocation_counter.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+    std::atomic<std::size_t> allocations{ 0 };
+    std::atomic<std::size_t> deallocations{ 0 };
+    std::atomic<std::size_t> bytes_allocated{ 0 };
+    std::atomic<std::size_t> live_bytes{ 0 };
+    std::atomic<std::size_t> peak_live_bytes{ 0 };
+
+    // every block carries its requested size and the pointer malloc returned, stored directly
+    // in front of the memory handed to the caller. the header is 16 bytes so the default
+    // alignment of malloc is preserved for ordinary allocations.
+    struct alignas(16) block_header
+    {
+        void* base;
+        std::size_t size;
+    };
+
+    void record_allocation(std::size_t size) noexcept
+    {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+        bytes_allocated.fetch_add(size, std::memory_order_relaxed);
+
+        const std::size_t live = live_bytes.fetch_add(size, std::memory_order_relaxed) + size;
+
+        // raise the peak if we went above it, another thread may be racing us so loop on failure
+        std::size_t peak = peak_live_bytes.load(std::memory_order_relaxed);
+        while (live > peak && !peak_live_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    void* allocate_block(std::size_t size, std::size_t alignment)
+    {
+        const bool over_aligned = alignment > alignof(block_header);
+        const std::size_t padding = sizeof(block_header) + (over_aligned ? alignment : 0);
+        // a size this close to SIZE_MAX would wrap the total and get a block far too small
+        if (size > SIZE_MAX - padding)
+        {
+            throw std::bad_alloc();
+        }
+        const std::size_t total = size + padding;
+
+        void* base = std::malloc(total);
+        if (base == nullptr)
+        {
+            return nullptr;
+        }
+
+        std::uintptr_t address = reinterpret_cast<std::uintptr_t>(base) + sizeof(block_header);
+        if (over_aligned)
+        {
+            address = (address + alignment - 1) & ~(static_cast<std::uintptr_t>(alignment) - 1);
+        }
+
+        block_header* header = reinterpret_cast<block_header*>(address) - 1;
+        header->base = base;
+        header->size = size;
+
+        record_allocation(size);
+        return reinterpret_cast<void*>(address);
+    }
+
+    void* allocate_or_throw(std::size_t size, std::size_t alignment)
+    {
+        // operator new(0) must still return a unique pointer
+        if (size == 0)
+        {
+            size = 1;
+        }
+
+        for (;;)
+        {
+            void* block = allocate_block(size, alignment);
+            if (block != nullptr)
+            {
+                return block;
+            }
+
+            // give the installed new handler a chance to free memory, as the standard requires
+            std::new_handler handler = std::get_new_handler();
+            if (handler == nullptr)
+            {
+                throw std::bad_alloc();
+            }
+            handler();
+        }
+    }
+
+    void* allocate_nothrow(std::size_t size, std::size_t alignment) noexcept
+    {
+        try
+        {
+            return allocate_or_throw(size, alignment);
+        }
+        catch (...)
+        {
+            return nullptr;
+        }
+    }
+
+    void release_block(void* block) noexcept
+    {
+        if (block == nullptr)
+        {
+            return;
+        }
+
+        const block_header* header = static_cast<block_header*>(block) - 1;
+
+        deallocations.fetch_add(1, std::memory_order_relaxed);
+        live_bytes.fetch_sub(header->size, std::memory_order_relaxed);
+
+        std::free(header->base);
+    }
+}
+
+namespace allocation_counter
+{
+    snapshot current() noexcept
+    {
+        snapshot result;
+        result.allocations = allocations.load(std::memory_order_relaxed);
+        result.deallocations = deallocations.load(std::memory_order_relaxed);
+        result.bytes_allocated = bytes_allocated.load(std::memory_order_relaxed);
+        result.live_bytes = live_bytes.load(std::memory_order_relaxed);
+        result.peak_live_bytes = peak_live_bytes.load(std::memory_order_relaxed);
+        return result;
+    }
+
+    void reset_peak() noexcept
+    {
+        peak_live_bytes.store(live_bytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+
+    snapshot difference(const snapshot& begin, const snapshot& end) noexcept
+    {
+        snapshot result;
+        result.allocations = end.allocations - begin.allocations;
+        result.deallocations = end.deallocations - begin.deallocations;
+        result.bytes_allocated = end.bytes_allocated - begin.bytes_allocated;
+        result.live_bytes = end.live_bytes >= begin.live_bytes ? end.live_bytes - begin.live_bytes : 0;
+        result.peak_live_bytes = end.peak_live_bytes >= begin.live_bytes ? end.peak_live_bytes - begin.live_bytes : 0;
+        return result;
+    }
+}
+
+// replaceable allocation functions, see [new.delete] in the standard
+
+void* operator new(std::size_t size)
+{
+    return allocate_or_throw(size, alignof(block_header));
+}
+
+void* operator new[](std::size_t size)
+{
+    return allocate_or_throw(size, alignof(block_header));
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return allocate_nothrow(size, alignof(block_header));
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return allocate_nothrow(size, alignof(block_header));
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    return allocate_or_throw(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+    return allocate_or_throw(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return allocate_nothrow(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return allocate_nothrow(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* block) noexcept
+{
+    release_block(block);
+}
+
+void operator delete[](void* block) noexcept
+{
+    release_block(block);
+}
+
+void operator delete(void* block, std::size_t) noexcept
+{
+    release_block(block);
+}
+
+void operator delete[](void* block, std::size_t) noexcept
+{
+    release_block(block);
+}
+
+void operator delete(void* block, const std::nothrow_t&) noexcept
+{
+    release_block(block);
+}
+
+void operator delete[](void* block, const std::nothrow_t&) noexcept
+{
+    release_block(block);
+}
+
+void operator delete(void* block, std::align_val_t) noexcept
+{
+    release_block(block);
+}
+
+void operator delete[](void* block, std::align_val_t) noexcept
+{
+    release_block(block);
+}
+
+void operator delete(void* block, std::size_t, std::align_val_t) noexcept
+{
+    release_block(block);
+}
+
+void operator delete[](void* block, std::size_t, std::align_val_t) noexcept
+{
+    release_block(block);
+}
+
+void operator delete(void* block, std::align_val_t, const std::nothrow_t&) noexcept
+{
+    release_block(block);
+}
+
+void operator delete[](void* block, std::align_val_t, const std::nothrow_t&) noexcept
+{
+    release_block(block);
+}
@@ -0,0 +1,50 @@
+// allocation_counter.h : Process wide heap allocation counters.
+//
+// Linking allocation_counter.cpp into a program replaces the global operator new / delete family
+// so every heap allocation made through them is counted. The counters are plain atomics, so reading
+// them is cheap enough to do around every benchmark iteration or test case.
+
+#pragma once
+
+#include <cstddef>
+
+namespace allocation_counter
+{
+    /// <summary>
+    /// Point in time copy of the allocation counters.
+    /// </summary>
+    struct snapshot
+    {
+        // number of successful calls to operator new
+        std::size_t allocations = 0;
+        // number of calls to operator delete with a non null pointer
+        std::size_t deallocations = 0;
+        // total number of bytes requested from operator new
+        std::size_t bytes_allocated = 0;
+        // number of bytes currently allocated and not yet released
+        std::size_t live_bytes = 0;
+        // highest value live_bytes has reached since the last reset_peak()
+        std::size_t peak_live_bytes = 0;
+    };
+
+    /// <summary>
+    /// Reads the current value of every counter.
+    /// </summary>
+    /// <returns>snapshot of the counters</returns>
+    snapshot current() noexcept;
+
+    /// <summary>
+    /// Restarts peak tracking from the number of bytes that are live right now, so the next
+    /// snapshot reports the peak reached by the code that runs after this call.
+    /// </summary>
+    void reset_peak() noexcept;
+
+    /// <summary>
+    /// Computes the activity between two snapshots. The peak is taken from the end snapshot
+    /// and reported relative to the bytes that were already live at the start.
+    /// </summary>
+    /// <param name="begin">snapshot taken before the measured code</param>
+    /// <param name="end">snapshot taken after the measured code</param>
+    /// <returns>counter deltas</returns>
+    snapshot difference(const snapshot& begin, const snapshot& end) noexcept;
+}
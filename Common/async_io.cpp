@@ -0,0 +1,768 @@
+// async_io.cpp : io_uring and thread pool backends of async_io, and the transform_file pipeline.
+//
+
+#include "async_io.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <vector>
+
+#include "pipeline_metrics.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter) && defined(__NR_io_uring_register)
+#define ASYNC_IO_URING 1
+#endif
+#endif
+#endif
+
+namespace
+{
+    constexpr std::size_t buffer_alignment = 4096;
+
+    struct io_request
+    {
+        bool write = false;
+        const io_file* file = nullptr;
+        std::uint64_t offset = 0;
+        std::uint8_t* data = nullptr;
+        std::size_t size = 0;
+        std::uint64_t tag = 0;
+    };
+
+    // blocking positioned I/O on a few worker threads
+    class thread_pool_io final : public async_io
+    {
+    public:
+        thread_pool_io(unsigned buffer_count, std::size_t buffer_size)
+            : async_io(buffer_count, buffer_size)
+        {
+            const unsigned threads = std::max(1u, std::min(buffer_count, std::max(2u, std::thread::hardware_concurrency())));
+            for (unsigned i = 0; i < threads; ++i)
+            {
+                workers_.emplace_back([this]() { work(); });
+            }
+        }
+
+        ~thread_pool_io() override
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stopping_ = true;
+            }
+            work_ready_.notify_all();
+            for (auto& worker : workers_)
+            {
+                worker.join();
+            }
+        }
+
+        io_backend backend() const noexcept override { return io_backend::thread_pool; }
+
+        void read(const io_file& file, std::uint64_t offset, unsigned index, std::size_t start, std::size_t size, std::uint64_t tag) override
+        {
+            queued_.push_back({ false, &file, offset, buffer(index) + start, size, tag });
+        }
+
+        void write(const io_file& file, std::uint64_t offset, unsigned index, std::size_t start, std::size_t size, std::uint64_t tag) override
+        {
+            queued_.push_back({ true, &file, offset, buffer(index) + start, size, tag });
+        }
+
+        expected<bool, io_error> wait(io_completion& completion) override
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (!queued_.empty())
+            {
+                in_flight_ += queued_.size();
+                pending_.insert(pending_.end(), queued_.begin(), queued_.end());
+                queued_.clear();
+                work_ready_.notify_all();
+            }
+            if (in_flight_ == 0)
+            {
+                return false;
+            }
+            done_ready_.wait(lock, [this]() { return !completed_.empty(); });
+            completion = completed_.front();
+            completed_.pop_front();
+            --in_flight_;
+            return true;
+        }
+
+    private:
+        void work()
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            for (;;)
+            {
+                work_ready_.wait(lock, [this]() { return stopping_ || !pending_.empty(); });
+                if (pending_.empty())
+                {
+                    return;
+                }
+                const io_request request = pending_.front();
+                pending_.pop_front();
+
+                lock.unlock();
+                const std::ptrdiff_t result = request.write ? request.file->write_at(request.offset, request.data, request.size)
+                                                            : request.file->read_at(request.offset, request.data, request.size);
+                lock.lock();
+
+                completed_.push_back({ request.tag, result });
+                done_ready_.notify_one();
+            }
+        }
+
+        // queued_ belongs to the submitting thread, the rest is shared under mutex_
+        std::vector<io_request> queued_;
+        std::mutex mutex_;
+        std::condition_variable work_ready_;
+        std::condition_variable done_ready_;
+        std::deque<io_request> pending_;
+        std::deque<io_completion> completed_;
+        std::size_t in_flight_ = 0;
+        bool stopping_ = false;
+        std::vector<std::thread> workers_;
+    };
+
+#ifdef ASYNC_IO_URING
+    int io_uring_setup(unsigned entries, io_uring_params* params) noexcept
+    {
+        return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+    }
+
+    int io_uring_enter(int ring, unsigned to_submit, unsigned min_complete, unsigned flags) noexcept
+    {
+        return static_cast<int>(::syscall(__NR_io_uring_enter, ring, to_submit, min_complete, flags, nullptr, 0));
+    }
+
+    int io_uring_register(int ring, unsigned opcode, const void* arg, unsigned count) noexcept
+    {
+        return static_cast<int>(::syscall(__NR_io_uring_register, ring, opcode, arg, count));
+    }
+
+    // an io_uring driven through the raw system calls, so there is no liburing dependency
+    class uring_io final : public async_io
+    {
+    public:
+        uring_io(unsigned buffer_count, std::size_t buffer_size)
+            : async_io(buffer_count, buffer_size)
+        {
+        }
+
+        ~uring_io() override
+        {
+            // the kernel may still write into the buffers until every request has completed; if it
+            // cannot be waited for, closing the ring below cancels what is left
+            io_completion ignored;
+            for (auto waited = cqes_ != nullptr ? wait(ignored) : false; waited && *waited; waited = wait(ignored))
+            {
+            }
+            if (sq_ring_ != nullptr)
+            {
+                ::munmap(sq_ring_, sq_ring_size_);
+            }
+            if (cq_ring_ != nullptr && cq_ring_ != sq_ring_)
+            {
+                ::munmap(cq_ring_, cq_ring_size_);
+            }
+            if (sqes_ != nullptr)
+            {
+                ::munmap(sqes_, sqes_size_);
+            }
+            if (ring_ >= 0)
+            {
+                ::close(ring_);
+            }
+        }
+
+        // false when the kernel does not offer io_uring to this process
+        bool setup()
+        {
+            io_uring_params params{};
+            ring_ = io_uring_setup(buffer_count(), &params);
+            if (ring_ < 0)
+            {
+                return false;
+            }
+
+            sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+            cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+            const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+            if (single_mmap)
+            {
+                sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+            }
+            sq_ring_ = map(sq_ring_size_, IORING_OFF_SQ_RING);
+            cq_ring_ = single_mmap ? sq_ring_ : map(cq_ring_size_, IORING_OFF_CQ_RING);
+            sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+            sqes_ = static_cast<io_uring_sqe*>(map(sqes_size_, IORING_OFF_SQES));
+            if (sq_ring_ == nullptr || cq_ring_ == nullptr || sqes_ == nullptr)
+            {
+                return false;
+            }
+
+            auto* sq = static_cast<std::uint8_t*>(sq_ring_);
+            sq_head_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+            sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+            sq_mask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+            sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+            sq_entries_ = params.sq_entries;
+            auto* cq = static_cast<std::uint8_t*>(cq_ring_);
+            cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+            cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+            cq_mask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+            cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+            // registered buffers are pinned once here instead of on every request; a low
+            // RLIMIT_MEMLOCK refuses them, and plain reads and writes are used instead
+            std::vector<iovec> vectors(buffer_count());
+            for (unsigned i = 0; i < buffer_count(); ++i)
+            {
+                vectors[i].iov_base = buffer(i);
+                vectors[i].iov_len = buffer_size();
+            }
+            registered_ = io_uring_register(ring_, IORING_REGISTER_BUFFERS, vectors.data(), buffer_count()) == 0;
+            return true;
+        }
+
+        io_backend backend() const noexcept override { return io_backend::io_uring; }
+
+        void read(const io_file& file, std::uint64_t offset, unsigned index, std::size_t start, std::size_t size, std::uint64_t tag) override
+        {
+            queue(registered_ ? IORING_OP_READ_FIXED : IORING_OP_READ, file, offset, index, start, size, tag);
+        }
+
+        void write(const io_file& file, std::uint64_t offset, unsigned index, std::size_t start, std::size_t size, std::uint64_t tag) override
+        {
+            queue(registered_ ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE, file, offset, index, start, size, tag);
+        }
+
+        expected<bool, io_error> wait(io_completion& completion) override
+        {
+            for (;;)
+            {
+                // completions reaped to make room in the ring, and requests that never got into it
+                if (!ready_.empty())
+                {
+                    completion = ready_.front();
+                    ready_.pop_front();
+                    --in_flight_;
+                    return true;
+                }
+
+                // the completion queue is read without a system call when it already holds something
+                const unsigned head = *cq_head_;
+                if (head != __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE) && unsubmitted_ == 0)
+                {
+                    const io_uring_cqe& cqe = cqes_[head & cq_mask_];
+                    completion.tag = cqe.user_data;
+                    completion.result = cqe.res < 0 ? -1 : cqe.res;
+                    __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+                    --in_flight_;
+                    return true;
+                }
+                if (in_flight_ == 0)
+                {
+                    return false;
+                }
+                if (!enter(1))
+                {
+                    return unexpected(io_error::wait_failed);
+                }
+            }
+        }
+
+    private:
+        void* map(std::size_t size, std::uint64_t offset) const noexcept
+        {
+            void* memory = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_, static_cast<off_t>(offset));
+            return memory == MAP_FAILED ? nullptr : memory;
+        }
+
+        void queue(std::uint8_t opcode, const io_file& file, std::uint64_t offset, unsigned index, std::size_t start, std::size_t size,
+            std::uint64_t tag)
+        {
+            ++in_flight_;
+            if (submission_queue_full())
+            {
+                // hand what is there to the kernel without waiting; the slot at the tail is free only
+                // once the kernel has taken its entry, so a request that finds no room fails
+                if (!enter(0) || submission_queue_full())
+                {
+                    ready_.push_back(io_completion{ tag, -1 });
+                    return;
+                }
+            }
+
+            const unsigned tail = *sq_tail_;
+            io_uring_sqe& sqe = sqes_[tail & sq_mask_];
+            sqe = io_uring_sqe{};
+            sqe.opcode = opcode;
+            sqe.fd = file.native();
+            sqe.off = offset;
+            sqe.addr = reinterpret_cast<std::uint64_t>(buffer(index) + start);
+            sqe.len = static_cast<std::uint32_t>(size);
+            sqe.user_data = tag;
+            if (registered_)
+            {
+                sqe.buf_index = static_cast<std::uint16_t>(index);
+            }
+            sq_array_[tail & sq_mask_] = tail & sq_mask_;
+            __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+            ++unsubmitted_;
+        }
+
+        bool submission_queue_full() const noexcept
+        {
+            return *sq_tail_ - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) == sq_entries_;
+        }
+
+        // moves every completion in the ring to ready_, which wait hands out first
+        void reap()
+        {
+            unsigned head = *cq_head_;
+            for (const unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE); head != tail; ++head)
+            {
+                const io_uring_cqe& cqe = cqes_[head & cq_mask_];
+                ready_.push_back(io_completion{ cqe.user_data, cqe.res < 0 ? -1 : cqe.res });
+            }
+            __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+        }
+
+        // submits the queued requests and waits for min_complete completions, which may instead
+        // have been reaped into ready_
+        bool enter(unsigned min_complete)
+        {
+            for (;;)
+            {
+                const int submitted = io_uring_enter(ring_, unsubmitted_, min_complete, min_complete != 0 ? IORING_ENTER_GETEVENTS : 0);
+                if (submitted >= 0)
+                {
+                    unsubmitted_ -= static_cast<unsigned>(submitted);
+                    return true;
+                }
+                if (errno == EBUSY)
+                {
+                    // the completion queue is full and takes no more until it is read
+                    reap();
+                    if (min_complete != 0 && !ready_.empty())
+                    {
+                        return true;
+                    }
+                }
+                else if (errno != EINTR && errno != EAGAIN)
+                {
+                    return false;
+                }
+            }
+        }
+
+        int ring_ = -1;
+        bool registered_ = false;
+        void* sq_ring_ = nullptr;
+        void* cq_ring_ = nullptr;
+        io_uring_sqe* sqes_ = nullptr;
+        std::size_t sq_ring_size_ = 0;
+        std::size_t cq_ring_size_ = 0;
+        std::size_t sqes_size_ = 0;
+        unsigned* sq_head_ = nullptr;
+        unsigned* sq_tail_ = nullptr;
+        unsigned* sq_array_ = nullptr;
+        unsigned sq_mask_ = 0;
+        unsigned sq_entries_ = 0;
+        unsigned* cq_head_ = nullptr;
+        unsigned* cq_tail_ = nullptr;
+        unsigned cq_mask_ = 0;
+        io_uring_cqe* cqes_ = nullptr;
+        unsigned unsubmitted_ = 0;
+        std::size_t in_flight_ = 0;
+        std::deque<io_completion> ready_;
+    };
+#endif
+}
+
+const char* to_string(io_backend backend) noexcept
+{
+    switch (backend)
+    {
+    case io_backend::io_uring:
+        return "io_uring";
+    case io_backend::thread_pool:
+        return "thread pool";
+    }
+    return "unknown backend";
+}
+
+const char* to_string(io_error error) noexcept
+{
+    switch (error)
+    {
+    case io_error::open_failed:
+        return "the file could not be opened";
+    case io_error::setup_failed:
+        return "the I/O queue could not be created";
+    case io_error::read_failed:
+        return "the file could not be read";
+    case io_error::write_failed:
+        return "the file could not be written";
+    case io_error::wait_failed:
+        return "waiting for I/O to complete failed";
+    }
+    return "unknown I/O error";
+}
+
+io_file::~io_file()
+{
+    close();
+}
+
+bool io_file::open_read(const std::string& filename)
+{
+    close();
+
+#ifdef _WIN32
+    const HANDLE file = ::CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    LARGE_INTEGER size;
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+    if (!::GetFileSizeEx(file, &size))
+    {
+        ::CloseHandle(file);
+        return false;
+    }
+    handle_ = file;
+    size_ = static_cast<std::uint64_t>(size.QuadPart);
+#else
+    const int fd = ::open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return false;
+    }
+    struct stat status;
+    if (::fstat(fd, &status) != 0 || !S_ISREG(status.st_mode))
+    {
+        ::close(fd);
+        return false;
+    }
+    fd_ = fd;
+    size_ = static_cast<std::uint64_t>(status.st_size);
+#endif
+    return true;
+}
+
+bool io_file::open_write(const std::string& filename)
+{
+    close();
+
+#ifdef _WIN32
+    const HANDLE file = ::CreateFileA(filename.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+    handle_ = file;
+#else
+    const int fd = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0)
+    {
+        return false;
+    }
+    fd_ = fd;
+#endif
+    size_ = 0;
+    return true;
+}
+
+void io_file::close() noexcept
+{
+#ifdef _WIN32
+    if (handle_ != nullptr)
+    {
+        ::CloseHandle(handle_);
+        handle_ = nullptr;
+    }
+#else
+    if (fd_ >= 0)
+    {
+        ::close(fd_);
+        fd_ = -1;
+    }
+#endif
+    size_ = 0;
+}
+
+bool io_file::is_open() const noexcept
+{
+#ifdef _WIN32
+    return handle_ != nullptr;
+#else
+    return fd_ >= 0;
+#endif
+}
+
+std::ptrdiff_t io_file::read_at(std::uint64_t offset, void* buffer, std::size_t size) const noexcept
+{
+#ifdef _WIN32
+    OVERLAPPED position{};
+    position.Offset = static_cast<DWORD>(offset);
+    position.OffsetHigh = static_cast<DWORD>(offset >> 32);
+    DWORD count = 0;
+    if (!::ReadFile(handle_, buffer, static_cast<DWORD>(std::min<std::size_t>(size, 0x40000000)), &count, &position))
+    {
+        return ::GetLastError() == ERROR_HANDLE_EOF ? 0 : -1;
+    }
+    return static_cast<std::ptrdiff_t>(count);
+#else
+    for (;;)
+    {
+        const ssize_t count = ::pread(fd_, buffer, size, static_cast<off_t>(offset));
+        if (count >= 0 || errno != EINTR)
+        {
+            return count;
+        }
+    }
+#endif
+}
+
+std::ptrdiff_t io_file::write_at(std::uint64_t offset, const void* buffer, std::size_t size) const noexcept
+{
+#ifdef _WIN32
+    OVERLAPPED position{};
+    position.Offset = static_cast<DWORD>(offset);
+    position.OffsetHigh = static_cast<DWORD>(offset >> 32);
+    DWORD count = 0;
+    if (!::WriteFile(handle_, buffer, static_cast<DWORD>(std::min<std::size_t>(size, 0x40000000)), &count, &position))
+    {
+        return -1;
+    }
+    return static_cast<std::ptrdiff_t>(count);
+#else
+    for (;;)
+    {
+        const ssize_t count = ::pwrite(fd_, buffer, size, static_cast<off_t>(offset));
+        if (count >= 0 || errno != EINTR)
+        {
+            return count;
+        }
+    }
+#endif
+}
+
+async_io::async_io(unsigned buffer_count, std::size_t buffer_size)
+    : buffer_count_(buffer_count)
+    , buffer_size_(buffer_size)
+    , buffers_(static_cast<std::uint8_t*>(::operator new(buffer_count * buffer_size, std::align_val_t{ buffer_alignment })))
+{
+}
+
+async_io::~async_io() = default;
+
+void async_io::aligned_delete::operator()(std::uint8_t* memory) const noexcept
+{
+    ::operator delete(memory, std::align_val_t{ buffer_alignment });
+}
+
+expected<std::unique_ptr<async_io>, io_error> async_io::create(unsigned buffer_count, std::size_t buffer_size, io_backend preferred)
+{
+    if (buffer_count == 0 || buffer_size == 0 || buffer_count > 0xffff)
+    {
+        return unexpected(io_error::setup_failed);
+    }
+    // whole pages, so every buffer starts page aligned
+    buffer_size = (buffer_size + buffer_alignment - 1) / buffer_alignment * buffer_alignment;
+
+#ifdef ASYNC_IO_URING
+    if (preferred == io_backend::io_uring)
+    {
+        auto ring = std::make_unique<uring_io>(buffer_count, buffer_size);
+        if (ring->setup())
+        {
+            return std::unique_ptr<async_io>(std::move(ring));
+        }
+    }
+#else
+    (void)preferred;
+#endif
+    return std::unique_ptr<async_io>(std::make_unique<thread_pool_io>(buffer_count, buffer_size));
+}
+
+expected<std::uint64_t, io_error> transform_file(async_io& io, const std::string& input, const std::string& output,
+    const std::function<void(std::uint8_t* data, std::size_t size, std::uint64_t position)>& transform)
+{
+    io_file source;
+    io_file target;
+    if (!source.open_read(input) || !target.open_write(output))
+    {
+        return unexpected(io_error::open_failed);
+    }
+
+    // one block per buffer; a buffer goes read, transform, write, then takes the next unread block
+    struct block
+    {
+        std::uint64_t position = 0;
+        std::size_t size = 0;
+        std::size_t done = 0;
+        bool writing = false;
+        // when the read or the write of the block was first queued
+        std::chrono::steady_clock::time_point started;
+    };
+    std::vector<block> blocks(io.buffer_count());
+    const std::uint64_t size = source.size();
+    const std::size_t block_size = io.buffer_size();
+    std::uint64_t next = 0;
+    std::uint64_t written = 0;
+
+    // each stage is timed per block from queueing to completion, the transform on this thread
+    std::uint64_t in_flight = 0;
+    auto elapsed = [](std::chrono::steady_clock::time_point since) {
+        return static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - since).count());
+    };
+
+    auto start_read = [&](unsigned index) {
+        block& b = blocks[index];
+        b.position = next;
+        b.size = static_cast<std::size_t>(std::min<std::uint64_t>(block_size, size - next));
+        b.done = 0;
+        b.writing = false;
+        b.started = std::chrono::steady_clock::now();
+        next += b.size;
+        io.read(source, b.position, index, 0, b.size, index);
+        pipeline_metrics::set_queue_depth(++in_flight);
+    };
+
+    // after a failure nothing new is started, but what is in flight is still collected: the
+    // buffers belong to io and must not be reused while the kernel or a worker writes into them
+    bool failed = false;
+    io_error error = io_error::read_failed;
+    io_completion completion;
+    // an exception from transform (or a full allocator) must not leave requests in flight: they
+    // would go on reading and writing buffers and files that are gone once it has unwound
+    try
+    {
+        for (unsigned i = 0; i < io.buffer_count() && next < size; ++i)
+        {
+            start_read(i);
+        }
+
+        for (;;)
+        {
+            const auto waited = io.wait(completion);
+            if (!waited)
+            {
+                // requests may still be in flight, but no completion will come for them
+                if (!failed)
+                {
+                    failed = true;
+                    error = waited.error();
+                }
+                break;
+            }
+            if (!*waited)
+            {
+                break;
+            }
+
+            const unsigned index = static_cast<unsigned>(completion.tag);
+            block& b = blocks[index];
+            pipeline_metrics::set_queue_depth(--in_flight);
+            if (completion.result <= 0)
+            {
+                if (!failed)
+                {
+                    failed = true;
+                    error = b.writing ? io_error::write_failed : io_error::read_failed;
+                }
+                continue;
+            }
+            if (failed)
+            {
+                continue;
+            }
+
+            // a short transfer continues where it stopped
+            b.done += static_cast<std::size_t>(completion.result);
+            if (b.done < b.size)
+            {
+                if (b.writing)
+                {
+                    io.write(target, b.position + b.done, index, b.done, b.size - b.done, index);
+                }
+                else
+                {
+                    io.read(source, b.position + b.done, index, b.done, b.size - b.done, index);
+                }
+                pipeline_metrics::set_queue_depth(++in_flight);
+                continue;
+            }
+
+            if (!b.writing)
+            {
+                pipeline_metrics::record(pipeline_metrics::stage::read, b.size, elapsed(b.started));
+
+                // the other buffers' reads and writes proceed while this one is transformed
+                {
+                    pipeline_metrics::stage_timer timer(pipeline_metrics::stage::transform, b.size);
+                    transform(io.buffer(index), b.size, b.position);
+                }
+                b.writing = true;
+                b.done = 0;
+                b.started = std::chrono::steady_clock::now();
+                io.write(target, b.position, index, 0, b.size, index);
+                pipeline_metrics::set_queue_depth(++in_flight);
+            }
+            else
+            {
+                pipeline_metrics::record(pipeline_metrics::stage::write, b.size, elapsed(b.started));
+                written += b.size;
+                if (next < size)
+                {
+                    start_read(index);
+                }
+            }
+        }
+    }
+    catch (...)
+    {
+        io_completion ignored;
+        for (auto waited = io.wait(ignored); waited && *waited; waited = io.wait(ignored))
+        {
+        }
+        pipeline_metrics::set_queue_depth(0);
+        throw;
+    }
+
+    if (failed)
+    {
+        return unexpected(error);
+    }
+    // every block must have been written, whatever stopped the loop
+    if (written != size)
+    {
+        return unexpected(io_error::write_failed);
+    }
+    return written;
+}
@@ -0,0 +1,161 @@
+// async_io.h : Asynchronous positioned file reads and writes into a fixed set of buffers.
+//
+// read_file and save_data_file block on one stream at a time, so the disk idles while the data is
+// encrypted and the CPU idles while the disk works. An async_io keeps many reads and writes in
+// flight at once. On Linux it submits them to an io_uring with its buffers registered with the
+// kernel, which then skips pinning and mapping the pages on every request. Where io_uring is not
+// available (other systems, old kernels, seccomp filters) the same interface is served by a few
+// threads doing blocking pread and pwrite.
+//
+// transform_file builds a pipeline on top: while block N is transformed on the calling thread, the
+// read of block N + 1 and the write of block N - 1 (and more, up to the queue depth) are in flight.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "expected.h"
+
+enum class io_backend
+{
+    io_uring,
+    thread_pool
+};
+
+const char* to_string(io_backend backend) noexcept;
+
+enum class io_error
+{
+    open_failed,
+    setup_failed,
+    read_failed,
+    write_failed,
+    wait_failed
+};
+
+const char* to_string(io_error error) noexcept;
+
+/// <summary>
+/// A file opened for positioned reads or writes, used by both backends.
+/// </summary>
+class io_file
+{
+public:
+    io_file() noexcept = default;
+    io_file(const io_file&) = delete;
+    io_file& operator=(const io_file&) = delete;
+    ~io_file();
+
+    // opens an existing file to read
+    bool open_read(const std::string& filename);
+
+    // creates or truncates a file to write
+    bool open_write(const std::string& filename);
+
+    void close() noexcept;
+
+    bool is_open() const noexcept;
+
+    // size when the file was opened
+    std::uint64_t size() const noexcept { return size_; }
+
+    // one read or write at offset, possibly short; bytes done or -1
+    std::ptrdiff_t read_at(std::uint64_t offset, void* buffer, std::size_t size) const noexcept;
+    std::ptrdiff_t write_at(std::uint64_t offset, const void* buffer, std::size_t size) const noexcept;
+
+#ifdef _WIN32
+    void* native() const noexcept { return handle_; }
+#else
+    int native() const noexcept { return fd_; }
+#endif
+
+private:
+#ifdef _WIN32
+    void* handle_ = nullptr;
+#else
+    int fd_ = -1;
+#endif
+    std::uint64_t size_ = 0;
+};
+
+struct io_completion
+{
+    // the tag given when the request was submitted
+    std::uint64_t tag = 0;
+    // bytes transferred, or -1 when the request failed
+    std::ptrdiff_t result = 0;
+};
+
+/// <summary>
+/// Queue of asynchronous reads and writes. Every request names one of the queue's buffers, which
+/// stay valid and at fixed addresses for the life of the queue. Not thread safe: one thread submits
+/// and collects completions.
+/// </summary>
+class async_io
+{
+public:
+    virtual ~async_io();
+
+    /// <summary>
+    /// Creates a queue with buffer_count buffers of buffer_size bytes each, page aligned.
+    /// </summary>
+    /// <param name="buffer_count">buffers, which is also the most requests in flight</param>
+    /// <param name="buffer_size">bytes per buffer</param>
+    /// <param name="preferred">io_uring falls back to thread_pool when the kernel refuses it</param>
+    static expected<std::unique_ptr<async_io>, io_error> create(unsigned buffer_count, std::size_t buffer_size,
+        io_backend preferred = io_backend::io_uring);
+
+    virtual io_backend backend() const noexcept = 0;
+
+    unsigned buffer_count() const noexcept { return buffer_count_; }
+    std::size_t buffer_size() const noexcept { return buffer_size_; }
+    std::uint8_t* buffer(unsigned index) const noexcept { return buffers_.get() + index * buffer_size_; }
+
+    /// <summary>
+    /// Queues a read of size bytes at offset of file into buffer(index) + start. Requests are passed
+    /// to the backend by the next wait.
+    /// </summary>
+    virtual void read(const io_file& file, std::uint64_t offset, unsigned index, std::size_t start, std::size_t size,
+        std::uint64_t tag) = 0;
+
+    /// <summary>
+    /// Queues a write of size bytes from buffer(index) + start to offset of file.
+    /// </summary>
+    virtual void write(const io_file& file, std::uint64_t offset, unsigned index, std::size_t start, std::size_t size,
+        std::uint64_t tag) = 0;
+
+    /// <summary>
+    /// Submits what is queued and waits for at least one request to complete.
+    /// </summary>
+    /// <returns>true with a completion, false when nothing is in flight, or wait_failed when the
+    /// backend could not wait; requests may then still be in flight and own their buffers until the
+    /// queue is destroyed</returns>
+    virtual expected<bool, io_error> wait(io_completion& completion) = 0;
+
+protected:
+    async_io(unsigned buffer_count, std::size_t buffer_size);
+
+private:
+    struct aligned_delete
+    {
+        void operator()(std::uint8_t* memory) const noexcept;
+    };
+
+    unsigned buffer_count_;
+    std::size_t buffer_size_;
+    std::unique_ptr<std::uint8_t[], aligned_delete> buffers_;
+};
+
+/// <summary>
+/// Reads input block by block, transforms each block in place and writes it to the same position
+/// of output, keeping io.buffer_count() blocks in flight. Blocks may complete out of order. Each
+/// block's read, transform and write and the requests in flight are recorded in pipeline_metrics.
+/// </summary>
+/// <param name="transform">called on the calling thread with a block, its size and its position in the file</param>
+/// <returns>bytes written</returns>
+expected<std::uint64_t, io_error> transform_file(async_io& io, const std::string& input, const std::string& output,
+    const std::function<void(std::uint8_t* data, std::size_t size, std::uint64_t position)>& transform);
@@ -0,0 +1,156 @@
+// batch_divide.cpp : SSE2 / AVX / AVX-512 kernels behind divide_batch.
+//
+
+#include "batch_divide.h"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#if defined(__AVX512F__)
+#define BATCH_DIVIDE_WIDTH 16
+#elif defined(__AVX__)
+#define BATCH_DIVIDE_WIDTH 8
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BATCH_DIVIDE_WIDTH 4
+#else
+#define BATCH_DIVIDE_WIDTH 1
+#endif
+
+#if BATCH_DIVIDE_WIDTH > 1
+#include <immintrin.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace
+{
+    std::size_t count_bits(std::uint32_t bits) noexcept
+    {
+#if defined(_MSC_VER)
+        return __popcnt(bits);
+#elif defined(__GNUC__)
+        return static_cast<std::size_t>(__builtin_popcount(bits));
+#else
+        std::size_t count = 0;
+        for (; bits != 0; bits &= bits - 1)
+        {
+            ++count;
+        }
+        return count;
+#endif
+    }
+
+    // smallest accepted magnitude: every |den| below it, and NaN, is rejected
+    float threshold(const batch_divide_options& options) noexcept
+    {
+        return options.reject_subnormal ? std::numeric_limits<float>::min() : std::numeric_limits<float>::denorm_min();
+    }
+
+    // branch free scalar form, used for the elements after the last full register
+    std::size_t divide_scalar(const float* numerators, const float* denominators, float* results, std::size_t first, std::size_t last,
+        std::uint64_t* bad_lanes, float sentinel, float minimum) noexcept
+    {
+        std::size_t bad_count = 0;
+        for (std::size_t i = first; i < last; ++i)
+        {
+            const float den = denominators[i];
+            // written as "not >=" so NaN is rejected too
+            const bool bad = !(std::fabs(den) >= minimum);
+            const float quotient = numerators[i] / (bad ? 1.0f : den);
+            results[i] = bad ? sentinel : quotient;
+            if (bad_lanes != nullptr)
+            {
+                bad_lanes[i / 64] |= static_cast<std::uint64_t>(bad) << (i % 64);
+            }
+            bad_count += bad;
+        }
+        return bad_count;
+    }
+}
+
+std::size_t batch_divide_width() noexcept
+{
+    return BATCH_DIVIDE_WIDTH;
+}
+
+std::size_t divide_batch(const float* numerators, const float* denominators, float* results, std::size_t count,
+    std::uint64_t* bad_lanes, const batch_divide_options& options) noexcept
+{
+    if (bad_lanes != nullptr)
+    {
+        std::memset(bad_lanes, 0, batch_divide_mask_words(count) * sizeof(std::uint64_t));
+    }
+
+    const float minimum = threshold(options);
+    std::size_t bad_count = 0;
+    std::size_t i = 0;
+
+    // each register covers a run of lanes that starts at a multiple of its width, so its mask bits
+    // never straddle two words of bad_lanes
+#if BATCH_DIVIDE_WIDTH == 16
+    const __m512 sentinel = _mm512_set1_ps(options.sentinel);
+    const __m512 limit = _mm512_set1_ps(minimum);
+    for (; i + 16 <= count; i += 16)
+    {
+        const __m512 num = _mm512_loadu_ps(numerators + i);
+        const __m512 den = _mm512_loadu_ps(denominators + i);
+        const __mmask16 bad = _mm512_cmp_ps_mask(_mm512_abs_ps(den), limit, _CMP_NGE_UQ);
+        // only the good lanes are divided, the rest take the sentinel
+        _mm512_storeu_ps(results + i, _mm512_mask_div_ps(sentinel, static_cast<__mmask16>(~bad), num, den));
+
+        const std::uint32_t bits = bad;
+        if (bad_lanes != nullptr)
+        {
+            bad_lanes[i / 64] |= static_cast<std::uint64_t>(bits) << (i % 64);
+        }
+        bad_count += count_bits(bits);
+    }
+#elif BATCH_DIVIDE_WIDTH == 8
+    const __m256 sentinel = _mm256_set1_ps(options.sentinel);
+    const __m256 limit = _mm256_set1_ps(minimum);
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 magnitude = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m256 num = _mm256_loadu_ps(numerators + i);
+        const __m256 den = _mm256_loadu_ps(denominators + i);
+        const __m256 bad = _mm256_cmp_ps(_mm256_and_ps(den, magnitude), limit, _CMP_NGE_UQ);
+        // divide bad lanes by 1 so no divide by zero flag is raised, then overwrite them
+        const __m256 quotient = _mm256_div_ps(num, _mm256_blendv_ps(den, one, bad));
+        _mm256_storeu_ps(results + i, _mm256_blendv_ps(quotient, sentinel, bad));
+
+        const std::uint32_t bits = static_cast<std::uint32_t>(_mm256_movemask_ps(bad));
+        if (bad_lanes != nullptr)
+        {
+            bad_lanes[i / 64] |= static_cast<std::uint64_t>(bits) << (i % 64);
+        }
+        bad_count += count_bits(bits);
+    }
+#elif BATCH_DIVIDE_WIDTH == 4
+    const __m128 sentinel = _mm_set1_ps(options.sentinel);
+    const __m128 limit = _mm_set1_ps(minimum);
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 magnitude = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    for (; i + 4 <= count; i += 4)
+    {
+        const __m128 num = _mm_loadu_ps(numerators + i);
+        const __m128 den = _mm_loadu_ps(denominators + i);
+        const __m128 bad = _mm_cmpnge_ps(_mm_and_ps(den, magnitude), limit);
+        // SSE2 has no blend, select with and / andnot / or
+        const __m128 quotient = _mm_div_ps(num, _mm_or_ps(_mm_and_ps(bad, one), _mm_andnot_ps(bad, den)));
+        _mm_storeu_ps(results + i, _mm_or_ps(_mm_and_ps(bad, sentinel), _mm_andnot_ps(bad, quotient)));
+
+        const std::uint32_t bits = static_cast<std::uint32_t>(_mm_movemask_ps(bad));
+        if (bad_lanes != nullptr)
+        {
+            bad_lanes[i / 64] |= static_cast<std::uint64_t>(bits) << (i % 64);
+        }
+        bad_count += count_bits(bits);
+    }
+#endif
+
+    return bad_count + divide_scalar(numerators, denominators, results, i, count, bad_lanes, options.sentinel, minimum);
+}
@@ -0,0 +1,50 @@
+// batch_divide.h : Division of whole arrays of floats with zero denominators masked per lane.
+//
+// divide() in Exceptions.cpp checks one denominator at a time and reports a zero by returning an
+// error, so a loop over millions of ratios is a compare and branch per element. divide_batch()
+// checks and divides a full vector register at a time with SSE2, AVX or AVX-512, whichever the
+// compiler targets, writes a sentinel into the lanes whose denominator is zero and records those
+// lanes in a bitmask. There are no exceptions and no branches per element.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+struct batch_divide_options
+{
+    // written to results[i] when denominators[i] is rejected
+    float sentinel = 0.0f;
+    // reject subnormal denominators as well as zero, their quotients overflow or lose all precision
+    bool reject_subnormal = true;
+};
+
+/// <summary>
+/// Number of floats divide_batch handles per instruction in this build: 16 with AVX-512, 8 with AVX,
+/// 4 with SSE2 and 1 without any of them.
+/// </summary>
+std::size_t batch_divide_width() noexcept;
+
+/// <summary>
+/// Number of 64 bit words a bad lane mask for count elements needs.
+/// </summary>
+constexpr std::size_t batch_divide_mask_words(std::size_t count) noexcept
+{
+    return (count + 63) / 64;
+}
+
+/// <summary>
+/// results[i] = numerators[i] / denominators[i] for i in [0, count). A lane whose denominator is zero,
+/// NaN or, by default, subnormal gets options.sentinel instead and its bit is set in bad_lanes.
+/// results may alias numerators or denominators.
+/// </summary>
+/// <param name="numerators">count dividends</param>
+/// <param name="denominators">count divisors</param>
+/// <param name="results">receives count quotients</param>
+/// <param name="count">number of elements</param>
+/// <param name="bad_lanes">receives batch_divide_mask_words(count) words, bit i % 64 of word i / 64
+/// is set for each rejected lane; may be null</param>
+/// <param name="options">sentinel and rejection rule</param>
+/// <returns>number of rejected lanes</returns>
+std::size_t divide_batch(const float* numerators, const float* denominators, float* results, std::size_t count,
+    std::uint64_t* bad_lanes, const batch_divide_options& options = batch_divide_options()) noexcept;
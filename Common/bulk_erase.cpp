@@ -0,0 +1,169 @@
+// bulk_erase.cpp : AVX2 / AVX-512 compaction kernels behind bulk_erase_if.
+//
+
+#include "bulk_erase.h"
+
+#include <array>
+#include <cstring>
+
+#if defined(__AVX512F__)
+#define BULK_ERASE_WIDTH 16
+#elif defined(__AVX2__)
+#define BULK_ERASE_WIDTH 8
+#else
+#define BULK_ERASE_WIDTH 1
+#endif
+
+#if BULK_ERASE_WIDTH > 1
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    // branch free scalar form, for builds without a compress instruction and for the elements after
+    // the last full register
+    template <std::size_t Size>
+    std::size_t compact_scalar(unsigned char* data, std::size_t first, std::size_t last, std::size_t write, const std::uint8_t* keep) noexcept
+    {
+        for (std::size_t i = first; i < last; ++i)
+        {
+            std::memmove(data + write * Size, data + i * Size, Size);
+            write += keep[i - first] != 0;
+        }
+        return write;
+    }
+
+#if BULK_ERASE_WIDTH > 1
+    // bit i set when keep[i] != 0, for the next 16 bytes
+    inline unsigned keep_bits_16(const std::uint8_t* keep) noexcept
+    {
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(keep));
+        return ~static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_setzero_si128()))) & 0xffffu;
+    }
+
+    inline unsigned keep_bits_8(const std::uint8_t* keep) noexcept
+    {
+        const __m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(keep));
+        return ~static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_setzero_si128()))) & 0xffu;
+    }
+
+    inline unsigned keep_bits_4(const std::uint8_t* keep) noexcept
+    {
+        std::int32_t word;
+        std::memcpy(&word, keep, sizeof(word));
+        const __m128i bytes = _mm_cvtsi32_si128(word);
+        return ~static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_setzero_si128()))) & 0xfu;
+    }
+#endif
+
+#if BULK_ERASE_WIDTH == 8
+    // for every 8 bit keep mask, the indices of the kept 32 bit lanes packed to the front, one byte
+    // each; 64 bit elements use the low 4 bits and two 32 bit lanes per element
+    constexpr std::array<std::uint64_t, 256> make_permutations(bool pairs)
+    {
+        std::array<std::uint64_t, 256> table{};
+        for (unsigned mask = 0; mask < 256; ++mask)
+        {
+            std::uint64_t indices = 0;
+            unsigned slot = 0;
+            for (unsigned lane = 0; lane < (pairs ? 4u : 8u); ++lane)
+            {
+                if ((mask >> lane) & 1u)
+                {
+                    if (pairs)
+                    {
+                        indices |= static_cast<std::uint64_t>(2 * lane) << (8 * slot++);
+                        indices |= static_cast<std::uint64_t>(2 * lane + 1) << (8 * slot++);
+                    }
+                    else
+                    {
+                        indices |= static_cast<std::uint64_t>(lane) << (8 * slot++);
+                    }
+                }
+            }
+            table[mask] = indices;
+        }
+        return table;
+    }
+
+    constexpr std::array<std::uint64_t, 256> permutations_32 = make_permutations(false);
+    constexpr std::array<std::uint64_t, 256> permutations_64 = make_permutations(true);
+
+    inline __m256i permutation(const std::array<std::uint64_t, 256>& table, unsigned mask) noexcept
+    {
+        return _mm256_cvtepu8_epi32(_mm_cvtsi64_si128(static_cast<long long>(table[mask])));
+    }
+#endif
+
+    inline unsigned count_bits(unsigned bits) noexcept
+    {
+#if defined(__GNUC__)
+        return static_cast<unsigned>(__builtin_popcount(bits));
+#else
+        unsigned count = 0;
+        for (; bits != 0; bits &= bits - 1)
+        {
+            ++count;
+        }
+        return count;
+#endif
+    }
+}
+
+namespace bulk_erase_detail
+{
+    // a full register is stored at write even when fewer lanes are kept; write <= i, so it only
+    // overwrites elements that are already loaded
+    std::size_t compact_32(void* data, std::size_t first, std::size_t last, std::size_t write, const std::uint8_t* keep) noexcept
+    {
+        auto* const bytes = static_cast<unsigned char*>(data);
+        std::size_t i = first;
+#if BULK_ERASE_WIDTH == 16
+        for (; i + 16 <= last; i += 16)
+        {
+            const __mmask16 mask = static_cast<__mmask16>(keep_bits_16(keep + (i - first)));
+            const __m512i values = _mm512_loadu_si512(bytes + i * 4);
+            _mm512_storeu_si512(bytes + write * 4, _mm512_maskz_compress_epi32(mask, values));
+            write += count_bits(mask);
+        }
+#elif BULK_ERASE_WIDTH == 8
+        for (; i + 8 <= last; i += 8)
+        {
+            const unsigned mask = keep_bits_8(keep + (i - first));
+            const __m256i values = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bytes + i * 4));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(bytes + write * 4), _mm256_permutevar8x32_epi32(values, permutation(permutations_32, mask)));
+            write += count_bits(mask);
+        }
+#endif
+        return compact_scalar<4>(bytes, i, last, write, keep + (i - first));
+    }
+
+    std::size_t compact_64(void* data, std::size_t first, std::size_t last, std::size_t write, const std::uint8_t* keep) noexcept
+    {
+        auto* const bytes = static_cast<unsigned char*>(data);
+        std::size_t i = first;
+#if BULK_ERASE_WIDTH == 16
+        for (; i + 8 <= last; i += 8)
+        {
+            const __mmask8 mask = static_cast<__mmask8>(keep_bits_8(keep + (i - first)));
+            const __m512i values = _mm512_loadu_si512(bytes + i * 8);
+            _mm512_storeu_si512(bytes + write * 8, _mm512_maskz_compress_epi64(mask, values));
+            write += count_bits(mask);
+        }
+#elif BULK_ERASE_WIDTH == 8
+        for (; i + 4 <= last; i += 4)
+        {
+            const unsigned mask = keep_bits_4(keep + (i - first));
+            const __m256i values = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bytes + i * 8));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(bytes + write * 8), _mm256_permutevar8x32_epi32(values, permutation(permutations_64, mask)));
+            write += count_bits(mask);
+        }
+#endif
+        return compact_scalar<8>(bytes, i, last, write, keep + (i - first));
+    }
+}
+
+std::size_t bulk_erase_width() noexcept
+{
+    return BULK_ERASE_WIDTH;
+}
@@ -0,0 +1,156 @@
+// bulk_erase.h : Removal of every element matching a predicate in one pass.
+//
+// vector_test() in QuestionableCode.cpp calls items.erase(iter) inside a loop over items, which
+// invalidates iter; even the corrected loop (iter = items.erase(iter)) shifts the whole tail once
+// per removed element, O(n^2) for a large removal. These helpers decide what to keep in one pass
+// and move each surviving element at most once:
+//   erase_remove_if  the standard erase-remove idiom for any container with erase(first, last)
+//   compact_if       stable in-place compaction of a range, branch free for trivially copyable types
+//   bulk_erase_if    compact_if for std::vector, with AVX2 or AVX-512 compaction of 4 and 8 byte
+//                    trivially copyable elements; an SSE2 build (the default) has no such kernel
+//                    and falls back to compact_if
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace bulk_erase_detail
+{
+    // elements whose predicate results are gathered before the vector kernel runs over them
+    constexpr std::size_t block_size = 512;
+
+    // Moves the elements i in [first, last) with keep[i - first] != 0 down to write, write + 1, ...
+    // and returns the next write position. write <= first, elements at or above last are not touched.
+    std::size_t compact_32(void* data, std::size_t first, std::size_t last, std::size_t write, const std::uint8_t* keep) noexcept;
+    std::size_t compact_64(void* data, std::size_t first, std::size_t last, std::size_t write, const std::uint8_t* keep) noexcept;
+
+    // without a compress or permute instruction the two pass form is slower than compact_if
+#if defined(__AVX512F__) || defined(__AVX2__)
+    constexpr bool vector_kernels = true;
+#else
+    constexpr bool vector_kernels = false;
+#endif
+
+    template <typename T>
+    constexpr bool vector_compactable = vector_kernels && std::is_trivially_copyable<T>::value && (sizeof(T) == 4 || sizeof(T) == 8);
+}
+
+/// <summary>
+/// Number of elements bulk_erase_if's vector kernel moves per instruction in this build: 16 with
+/// AVX-512, 8 with AVX2 and 1 otherwise, for 4 byte elements.
+/// </summary>
+std::size_t bulk_erase_width() noexcept;
+
+/// <summary>
+/// Removes every element for which remove returns true with std::remove_if and one erase. The
+/// order of the remaining elements is kept.
+/// </summary>
+/// <returns>number of elements removed</returns>
+template <typename Container, typename Predicate>
+std::size_t erase_remove_if(Container& items, Predicate remove)
+{
+    const auto size = items.size();
+    items.erase(std::remove_if(items.begin(), items.end(), remove), items.end());
+    return static_cast<std::size_t>(size - items.size());
+}
+
+/// <summary>
+/// Stable compaction: moves the elements of [first, last) for which remove returns false to the
+/// front, in order, and returns the new end. The elements after it are left in a valid but
+/// unspecified state. Trivially copyable elements are copied unconditionally and the write position
+/// advanced by the predicate result, so an unpredictable predicate costs no branch mispredictions.
+/// </summary>
+template <typename ForwardIterator, typename Predicate>
+ForwardIterator compact_if(ForwardIterator first, ForwardIterator last, Predicate remove)
+{
+    using value_type = typename std::iterator_traits<ForwardIterator>::value_type;
+
+    // nothing moves until the first removed element
+    first = std::find_if(first, last, remove);
+    if (first == last)
+    {
+        return first;
+    }
+    ForwardIterator write = first;
+
+    if constexpr (std::is_trivially_copyable<value_type>::value
+        && std::is_base_of<std::random_access_iterator_tag, typename std::iterator_traits<ForwardIterator>::iterator_category>::value)
+    {
+        for (++first; first != last; ++first)
+        {
+            const value_type value = *first;
+            const bool keep = !remove(value);
+            *write = value;
+            write += keep;
+        }
+    }
+    else
+    {
+        for (++first; first != last; ++first)
+        {
+            if (!remove(*first))
+            {
+                *write = std::move(*first);
+                ++write;
+            }
+        }
+    }
+    return write;
+}
+
+/// <summary>
+/// Removes every element for which remove returns true and keeps the order of the rest. The
+/// predicate is called once per element, in order. In AVX2 and AVX-512 builds 4 and 8 byte trivially
+/// copyable elements are moved with vector compress instructions, everything else goes through
+/// compact_if.
+/// </summary>
+/// <returns>number of elements removed</returns>
+template <typename T, typename Allocator, typename Predicate>
+std::size_t bulk_erase_if(std::vector<T, Allocator>& items, Predicate remove)
+{
+    const std::size_t count = items.size();
+    std::size_t write = 0;
+
+    if constexpr (bulk_erase_detail::vector_compactable<T>)
+    {
+        // predicate results for one block at a time; every write lands below the block being
+        // evaluated, so the predicate always sees the original elements
+        std::uint8_t keep[bulk_erase_detail::block_size];
+        T* const data = items.data();
+        for (std::size_t first = 0; first < count; first += bulk_erase_detail::block_size)
+        {
+            const std::size_t last = std::min(count, first + bulk_erase_detail::block_size);
+            const T* const block = data + first;
+            if (last - first == bulk_erase_detail::block_size)
+            {
+                // a constant trip count lets the compiler vectorize simple predicates even at -O2
+                for (std::size_t i = 0; i < bulk_erase_detail::block_size; ++i)
+                {
+                    keep[i] = !remove(block[i]);
+                }
+            }
+            else
+            {
+                for (std::size_t i = 0; i < last - first; ++i)
+                {
+                    keep[i] = !remove(block[i]);
+                }
+            }
+            write = sizeof(T) == 4 ? bulk_erase_detail::compact_32(data, first, last, write, keep)
+                                   : bulk_erase_detail::compact_64(data, first, last, write, keep);
+        }
+    }
+    else
+    {
+        write = static_cast<std::size_t>(compact_if(items.begin(), items.end(), remove) - items.begin());
+    }
+
+    items.erase(items.begin() + static_cast<std::ptrdiff_t>(write), items.end());
+    return count - write;
+}
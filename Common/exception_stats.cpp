@@ -0,0 +1,339 @@
+// exception_stats.cpp : __cxa_throw / __cxa_begin_catch interposition feeding the exception counters.
+//
+
+#include "exception_stats.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <ostream>
+#include <sstream>
+#include <string>
+
+#if defined(__GNUC__) && !defined(_WIN32)
+#define EXCEPTION_STATS_HOOK 1
+// the stack sampling skips a fixed number of frames, so the recording function must stay a frame
+#define EXCEPTION_STATS_NOINLINE __attribute__((noinline))
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#else
+#define EXCEPTION_STATS_HOOK 0
+#define EXCEPTION_STATS_NOINLINE
+#endif
+
+namespace
+{
+    constexpr std::size_t slot_count = 256;
+
+    // a spin lock rather than std::mutex: it is taken inside the throw path and must not allocate
+    // or depend on static initialization order
+    std::atomic_flag table_lock = ATOMIC_FLAG_INIT;
+    exception_stats::site_stats slots[slot_count];
+    std::atomic<std::uint64_t> total{ 0 };
+    std::atomic<std::uint64_t> dropped{ 0 };
+    std::atomic<std::uint32_t> sample_interval{ 64 };
+
+    class table_guard
+    {
+    public:
+        table_guard() noexcept
+        {
+            while (table_lock.test_and_set(std::memory_order_acquire))
+            {
+            }
+        }
+
+        ~table_guard() { table_lock.clear(std::memory_order_release); }
+    };
+
+#if EXCEPTION_STATS_HOOK
+    // the first backtrace() loads the unwinder, which allocates; do that at start up rather than
+    // inside the first sampled throw
+    const bool backtrace_loaded = []() {
+        void* frame[1];
+        return backtrace(frame, 1) >= 0;
+    }();
+#endif
+
+    // the slot the current thread's exception in flight was counted in, and when it was thrown
+    thread_local exception_stats::site_stats* in_flight = nullptr;
+    thread_local std::chrono::steady_clock::time_point thrown_at;
+
+    std::size_t slot_index(const std::type_info* type, const void* site) noexcept
+    {
+        std::uint64_t key = reinterpret_cast<std::uintptr_t>(type) ^ (reinterpret_cast<std::uintptr_t>(site) * 0x9e3779b97f4a7c15ull);
+        key ^= key >> 29;
+        return static_cast<std::size_t>(key % slot_count);
+    }
+
+    // caller holds the lock; returns nullptr when the table is full
+    exception_stats::site_stats* find_slot(const std::type_info* type, const void* site) noexcept
+    {
+        const std::size_t start = slot_index(type, site);
+        for (std::size_t probe = 0; probe < slot_count; ++probe)
+        {
+            auto& slot = slots[(start + probe) % slot_count];
+            if (slot.type == type && slot.site == site)
+            {
+                return &slot;
+            }
+            if (slot.type == nullptr)
+            {
+                slot.type = type;
+                slot.site = site;
+                return &slot;
+            }
+        }
+        return nullptr;
+    }
+
+    EXCEPTION_STATS_NOINLINE void count_throw(const std::type_info* type, const void* site) noexcept
+    {
+        const std::uint64_t number = total.fetch_add(1, std::memory_order_relaxed) + 1;
+        const std::uint32_t interval = sample_interval.load(std::memory_order_relaxed);
+
+        // two more frames than kept: this function and __cxa_throw or record_throw are left out
+        void* stack[exception_stats::max_stack_depth + 2];
+        std::size_t depth = 0;
+#if EXCEPTION_STATS_HOOK
+        if (interval != 0 && number % interval == 0)
+        {
+            depth = static_cast<std::size_t>(backtrace(stack, static_cast<int>(exception_stats::max_stack_depth + 2)));
+            depth = depth > 2 ? depth - 2 : 0;
+        }
+#else
+        (void)number;
+        (void)interval;
+#endif
+
+        table_guard guard;
+        exception_stats::site_stats* slot = find_slot(type, site);
+        if (slot == nullptr)
+        {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            in_flight = nullptr;
+            return;
+        }
+
+        ++slot->throws;
+        if (depth != 0)
+        {
+            std::memcpy(slot->stack, stack + 2, depth * sizeof(void*));
+            slot->stack_depth = depth;
+        }
+        in_flight = slot;
+        thrown_at = std::chrono::steady_clock::now();
+    }
+
+    void count_catch() noexcept
+    {
+        exception_stats::site_stats* slot = in_flight;
+        if (slot == nullptr)
+        {
+            return;
+        }
+        in_flight = nullptr;
+
+        const auto elapsed = std::chrono::steady_clock::now() - thrown_at;
+        table_guard guard;
+        ++slot->catches;
+        slot->unwind_nanoseconds += static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    }
+
+    std::string describe_type(const std::type_info* type)
+    {
+#if EXCEPTION_STATS_HOOK
+        int status = 0;
+        char* name = abi::__cxa_demangle(type->name(), nullptr, nullptr, &status);
+        if (status == 0 && name != nullptr)
+        {
+            std::string result(name);
+            std::free(name);
+            return result;
+        }
+#endif
+        return type->name();
+    }
+
+    std::string describe_address(const void* address)
+    {
+        std::ostringstream text;
+#if EXCEPTION_STATS_HOOK
+        Dl_info info;
+        if (dladdr(address, &info) != 0 && info.dli_sname != nullptr)
+        {
+            int status = 0;
+            char* name = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+            text << (status == 0 && name != nullptr ? name : info.dli_sname)
+                << "+0x" << std::hex << (static_cast<const char*>(address) - static_cast<const char*>(info.dli_saddr));
+            std::free(name);
+            return text.str();
+        }
+#endif
+        text << address;
+        return text.str();
+    }
+}
+
+#if EXCEPTION_STATS_HOOK
+namespace __cxxabiv1
+{
+    // forwards to the C++ runtime after counting, the real function is looked up on first use
+    extern "C" void __cxa_throw(void* object, std::type_info* type, void (*destructor)(void*))
+    {
+        using throw_function = void (*)(void*, std::type_info*, void (*)(void*));
+        static const throw_function real_throw = reinterpret_cast<throw_function>(dlsym(RTLD_NEXT, "__cxa_throw"));
+
+        count_throw(type, __builtin_return_address(0));
+
+        if (real_throw == nullptr)
+        {
+            // statically linked runtime, nothing to forward to
+            std::abort();
+        }
+        real_throw(object, type, destructor);
+        __builtin_unreachable();
+    }
+
+    extern "C" void* __cxa_begin_catch(void* exception) noexcept
+    {
+        using begin_catch_function = void* (*)(void*);
+        static const begin_catch_function real_begin_catch = reinterpret_cast<begin_catch_function>(dlsym(RTLD_NEXT, "__cxa_begin_catch"));
+
+        count_catch();
+        return real_begin_catch(exception);
+    }
+}
+#endif
+
+namespace exception_stats
+{
+    bool hooked() noexcept
+    {
+        return EXCEPTION_STATS_HOOK != 0;
+    }
+
+    void record_throw(const std::type_info& type, const void* site) noexcept
+    {
+        count_throw(&type, site);
+    }
+
+    void set_sample_interval(std::uint32_t interval) noexcept
+    {
+        sample_interval.store(interval, std::memory_order_relaxed);
+    }
+
+    std::uint64_t total_throws() noexcept
+    {
+        return total.load(std::memory_order_relaxed);
+    }
+
+    std::vector<site_stats> snapshot()
+    {
+        // reserve up front so nothing allocates, and so nothing can throw, while the lock is held
+        std::vector<site_stats> used;
+        used.reserve(slot_count);
+        {
+            table_guard guard;
+            for (const auto& slot : slots)
+            {
+                if (slot.type != nullptr)
+                {
+                    used.push_back(slot);
+                }
+            }
+        }
+
+        std::sort(used.begin(), used.end(), [](const site_stats& left, const site_stats& right) {
+            return left.throws > right.throws;
+        });
+        return used;
+    }
+
+    void reset() noexcept
+    {
+        table_guard guard;
+        for (auto& slot : slots)
+        {
+            slot = site_stats();
+        }
+        total.store(0, std::memory_order_relaxed);
+        dropped.store(0, std::memory_order_relaxed);
+    }
+
+    void report(std::ostream& stream, std::size_t top)
+    {
+        const std::vector<site_stats> sites = snapshot();
+
+        stream << "*** exceptions: " << total_throws() << " thrown from " << sites.size() << " sites";
+        if (dropped.load(std::memory_order_relaxed) != 0)
+        {
+            stream << ", " << dropped.load(std::memory_order_relaxed) << " not tracked, table full";
+        }
+        if (!hooked())
+        {
+            stream << ", throw hook not available, only record_throw() is counted";
+        }
+        stream << " ***" << std::endl;
+
+        if (sites.empty())
+        {
+            return;
+        }
+
+        stream << std::right << std::setw(10) << "throws" << std::setw(10) << "caught" << std::setw(14) << "avg unwind us"
+            << "  " << std::left << "type / site" << std::endl;
+
+        const std::size_t shown = std::min(top, sites.size());
+        for (std::size_t i = 0; i < shown; ++i)
+        {
+            const site_stats& site = sites[i];
+            const double average = site.catches == 0 ? 0.0 : static_cast<double>(site.unwind_nanoseconds) / static_cast<double>(site.catches) / 1000.0;
+            stream << std::right << std::setw(10) << site.throws << std::setw(10) << site.catches
+                << std::fixed << std::setprecision(2) << std::setw(14) << average
+                << "  " << std::left << describe_type(site.type) << " at " << describe_address(site.site) << std::endl;
+        }
+
+        for (std::size_t i = 0; i < shown; ++i)
+        {
+            const site_stats& site = sites[i];
+            if (site.stack_depth == 0)
+            {
+                continue;
+            }
+            stream << "sampled stack of " << describe_type(site.type) << " at " << describe_address(site.site) << ":" << std::endl;
+            for (std::size_t frame = 0; frame < site.stack_depth; ++frame)
+            {
+                stream << "    #" << frame << " " << describe_address(site.stack[frame]) << std::endl;
+            }
+        }
+    }
+
+    periodic_report::periodic_report(std::ostream& stream, std::chrono::milliseconds interval, std::size_t top)
+        : stream_(stream),
+          interval_(interval),
+          top_(top)
+    {
+        thread_ = std::thread([this]() {
+            std::unique_lock<std::mutex> lock(mutex_);
+            while (!wake_.wait_for(lock, interval_, [this]() { return stopping_; }))
+            {
+                report(stream_, top_);
+            }
+        });
+    }
+
+    periodic_report::~periodic_report()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_one();
+        thread_.join();
+        report(stream_, top_);
+    }
+}
@@ -0,0 +1,100 @@
+// exception_stats.h : Process wide exception throw counters, unwind timing and sampled stack traces.
+//
+// Linking exception_stats.cpp into a program built with gcc or clang against the Itanium C++ ABI
+// interposes __cxa_throw and __cxa_begin_catch, so every throw is counted per exception type and
+// throwing call site and the time from throw to the matching catch is measured. Every Nth throw also
+// records a stack trace. Nothing is allocated while recording; the table has a fixed number of slots.
+// MSVC has no equivalent hook, there the counters only see throws passed to record_throw().
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <mutex>
+#include <thread>
+#include <typeinfo>
+#include <vector>
+
+namespace exception_stats
+{
+    constexpr std::size_t max_stack_depth = 16;
+
+    /// <summary>
+    /// Counters for one exception type thrown from one call site.
+    /// </summary>
+    struct site_stats
+    {
+        const std::type_info* type = nullptr;
+        // return address inside the function that threw
+        const void* site = nullptr;
+        std::uint64_t throws = 0;
+        // throws that reached a catch block, unwind time is summed over these
+        std::uint64_t catches = 0;
+        std::uint64_t unwind_nanoseconds = 0;
+        // most recent sampled stack, innermost frame first
+        std::size_t stack_depth = 0;
+        void* stack[max_stack_depth] = {};
+    };
+
+    /// <summary>
+    /// True when throws are counted automatically, false when only record_throw() feeds the counters.
+    /// </summary>
+    bool hooked() noexcept;
+
+    /// <summary>
+    /// Counts a throw by hand, for platforms without the hook.
+    /// </summary>
+    void record_throw(const std::type_info& type, const void* site) noexcept;
+
+    /// <summary>
+    /// Records a stack trace on every interval'th throw, 0 turns sampling off. The default is 64.
+    /// </summary>
+    void set_sample_interval(std::uint32_t interval) noexcept;
+
+    // throws since start up or the last reset(), including those that did not fit in the table
+    std::uint64_t total_throws() noexcept;
+
+    /// <summary>
+    /// Copy of every used slot, busiest first.
+    /// </summary>
+    std::vector<site_stats> snapshot();
+
+    /// <summary>
+    /// Clears every counter.
+    /// </summary>
+    void reset() noexcept;
+
+    /// <summary>
+    /// Writes a table of throws per type and site with average unwind time, followed by the sampled
+    /// stacks of the busiest sites.
+    /// </summary>
+    /// <param name="stream">where to write</param>
+    /// <param name="top">number of sites to list</param>
+    void report(std::ostream& stream, std::size_t top = 10);
+
+    /// <summary>
+    /// Writes report() to a stream at a fixed interval on a background thread until destroyed, and
+    /// once more on destruction so the last interval is not lost.
+    /// </summary>
+    class periodic_report
+    {
+    public:
+        periodic_report(std::ostream& stream, std::chrono::milliseconds interval, std::size_t top = 10);
+        ~periodic_report();
+
+        periodic_report(const periodic_report&) = delete;
+        periodic_report& operator=(const periodic_report&) = delete;
+
+    private:
+        std::ostream& stream_;
+        std::chrono::milliseconds interval_;
+        std::size_t top_;
+        std::mutex mutex_;
+        std::condition_variable wake_;
+        bool stopping_ = false;
+        std::thread thread_;
+    };
+}
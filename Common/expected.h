@@ -0,0 +1,211 @@
+// expected.h : Value or error return type, a C++17 stand in for std::expected.
+//
+// A throw costs a heap allocation for the exception object plus a table driven unwind through every
+// frame up to the handler, microseconds rather than nanoseconds. When failure is an ordinary outcome
+// (a zero denominator, a rejected input) returning expected<T, E> keeps the error path as cheap as
+// the success path. value_or_throw() turns an error back into an exception at the edges where the
+// surrounding code still expects one.
+
+#pragma once
+
+#include <exception>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+/// <summary>
+/// Wraps an error so it can be returned from a function that returns expected&lt;T, E&gt;.
+/// </summary>
+template <typename E>
+class unexpected
+{
+public:
+    constexpr explicit unexpected(E error)
+        : error_(std::move(error))
+    {
+    }
+
+    constexpr const E& error() const& noexcept { return error_; }
+    constexpr E&& error() && noexcept { return std::move(error_); }
+
+private:
+    E error_;
+};
+
+template <typename E>
+unexpected(E) -> unexpected<E>;
+
+/// <summary>
+/// Thrown by expected::value() when there is no value. Carries the error.
+/// </summary>
+template <typename E>
+class bad_expected_access : public std::exception
+{
+public:
+    explicit bad_expected_access(E error)
+        : error_(std::move(error))
+    {
+    }
+
+    const char* what() const noexcept override { return "bad expected access"; }
+    const E& error() const noexcept { return error_; }
+
+private:
+    E error_;
+};
+
+/// <summary>
+/// Holds either a T or an E.
+/// </summary>
+/// <typeparam name="T">value type</typeparam>
+/// <typeparam name="E">error type</typeparam>
+template <typename T, typename E>
+class expected
+{
+public:
+    using value_type = T;
+    using error_type = E;
+
+    template <typename U = T, typename = std::enable_if_t<std::is_constructible_v<T, U&&> && !std::is_same_v<std::decay_t<U>, expected>>>
+    constexpr expected(U&& value)
+        : storage_(std::in_place_index<0>, std::forward<U>(value))
+    {
+    }
+
+    template <typename G>
+    constexpr expected(unexpected<G> error)
+        : storage_(std::in_place_index<1>, std::move(error).error())
+    {
+    }
+
+    constexpr bool has_value() const noexcept { return storage_.index() == 0; }
+    constexpr explicit operator bool() const noexcept { return has_value(); }
+
+    constexpr T& operator*() & noexcept { return *std::get_if<0>(&storage_); }
+    constexpr const T& operator*() const& noexcept { return *std::get_if<0>(&storage_); }
+    constexpr T* operator->() noexcept { return std::get_if<0>(&storage_); }
+    constexpr const T* operator->() const noexcept { return std::get_if<0>(&storage_); }
+
+    // throws bad_expected_access<E> when there is no value
+    constexpr T& value() &
+    {
+        check();
+        return **this;
+    }
+
+    constexpr const T& value() const&
+    {
+        check();
+        return **this;
+    }
+
+    constexpr T&& value() &&
+    {
+        check();
+        return std::move(**this);
+    }
+
+    // only meaningful when has_value() is false
+    constexpr const E& error() const& noexcept { return *std::get_if<1>(&storage_); }
+    constexpr E&& error() && noexcept { return std::move(*std::get_if<1>(&storage_)); }
+
+    template <typename U>
+    constexpr T value_or(U&& fallback) const&
+    {
+        return has_value() ? **this : static_cast<T>(std::forward<U>(fallback));
+    }
+
+    /// <summary>
+    /// Calls function with the value, which returns another expected with the same error type.
+    /// An error is passed through untouched.
+    /// </summary>
+    template <typename Function>
+    constexpr auto and_then(Function&& function) const&
+    {
+        using result = std::invoke_result_t<Function, const T&>;
+        if (has_value())
+        {
+            return std::forward<Function>(function)(**this);
+        }
+        return result(unexpected<E>(error()));
+    }
+
+    /// <summary>
+    /// Transforms the value, passing an error through untouched.
+    /// </summary>
+    template <typename Function>
+    constexpr auto map(Function&& function) const& -> expected<std::invoke_result_t<Function, const T&>, E>
+    {
+        if (has_value())
+        {
+            return std::forward<Function>(function)(**this);
+        }
+        return unexpected<E>(error());
+    }
+
+private:
+    constexpr void check() const
+    {
+        if (!has_value())
+        {
+            throw bad_expected_access<E>(error());
+        }
+    }
+
+    std::variant<T, E> storage_;
+};
+
+/// <summary>
+/// Success or an E, for functions that return nothing.
+/// </summary>
+template <typename E>
+class expected<void, E>
+{
+public:
+    using value_type = void;
+    using error_type = E;
+
+    constexpr expected() noexcept = default;
+
+    template <typename G>
+    constexpr expected(unexpected<G> error)
+        : has_error_(true),
+          error_(std::move(error).error())
+    {
+    }
+
+    constexpr bool has_value() const noexcept { return !has_error_; }
+    constexpr explicit operator bool() const noexcept { return has_value(); }
+
+    constexpr void value() const
+    {
+        if (has_error_)
+        {
+            throw bad_expected_access<E>(error_);
+        }
+    }
+
+    constexpr const E& error() const& noexcept { return error_; }
+    constexpr E&& error() && noexcept { return std::move(error_); }
+
+private:
+    bool has_error_ = false;
+    E error_{};
+};
+
+/// <summary>
+/// Adapter for the edges that still use exceptions: returns the value, or hands the error to
+/// throw_exception(const E&), found by argument dependent lookup next to E, which must throw.
+/// </summary>
+template <typename T, typename E>
+T value_or_throw(expected<T, E>&& result)
+{
+    if (!result.has_value())
+    {
+        throw_exception(result.error());
+    }
+    if constexpr (!std::is_void_v<T>)
+    {
+        return std::move(*result);
+    }
+}
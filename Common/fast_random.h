@@ -0,0 +1,183 @@
+// fast_random.h : Seedable per thread random numbers to replace rand().
+//
+// rand() shares one hidden state between every thread, which glibc protects with a lock, so threads
+// that draw random numbers in parallel end up taking turns. Each thread here owns a xoshiro256**
+// generator. One global seed makes runs reproducible: thread N derives its stream from the seed and
+// N, where N counts threads in the order they first draw a number.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace fast_random
+{
+    /// <summary>
+    /// xoshiro256** by Blackman and Vigna: 256 bits of state, period 2^256 - 1, a handful of
+    /// shifts and rotates per 64 bit output. Satisfies UniformRandomBitGenerator.
+    /// </summary>
+    class xoshiro256ss
+    {
+    public:
+        using result_type = std::uint64_t;
+
+        explicit xoshiro256ss(std::uint64_t seed = 0) noexcept
+        {
+            reseed(seed);
+        }
+
+        /// <summary>
+        /// Expands a 64 bit seed into the full state with splitmix64, as the authors recommend.
+        /// </summary>
+        void reseed(std::uint64_t seed) noexcept
+        {
+            for (auto& word : state_)
+            {
+                seed += 0x9e3779b97f4a7c15ull;
+                std::uint64_t z = seed;
+                z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+                z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+                word = z ^ (z >> 31);
+            }
+        }
+
+        static constexpr result_type min() noexcept { return 0; }
+        static constexpr result_type max() noexcept { return std::numeric_limits<result_type>::max(); }
+
+        result_type operator()() noexcept
+        {
+            const std::uint64_t result = rotate_left(state_[1] * 5, 7) * 9;
+            const std::uint64_t t = state_[1] << 17;
+
+            state_[2] ^= state_[0];
+            state_[3] ^= state_[1];
+            state_[1] ^= state_[2];
+            state_[0] ^= state_[3];
+            state_[2] ^= t;
+            state_[3] = rotate_left(state_[3], 45);
+
+            return result;
+        }
+
+        /// <summary>
+        /// Unbiased value in [0, bound) using Lemire's multiply and shift, which needs no division
+        /// except on the rare rejection path.
+        /// </summary>
+        /// <param name="bound">exclusive upper bound, must not be zero</param>
+        /// <returns>random value below bound</returns>
+        std::uint32_t uniform(std::uint32_t bound) noexcept
+        {
+            return reduce(static_cast<std::uint32_t>((*this)() >> 32), bound);
+        }
+
+        /// <summary>
+        /// Fills count values in [0, bound), using both halves of each 64 bit output.
+        /// </summary>
+        template <typename Integer>
+        void fill(Integer* first, std::size_t count, std::uint32_t bound) noexcept
+        {
+            std::size_t i = 0;
+            for (; i + 1 < count; i += 2)
+            {
+                const std::uint64_t bits = (*this)();
+                first[i] = static_cast<Integer>(reduce(static_cast<std::uint32_t>(bits >> 32), bound));
+                first[i + 1] = static_cast<Integer>(reduce(static_cast<std::uint32_t>(bits), bound));
+            }
+            if (i < count)
+            {
+                first[i] = static_cast<Integer>(uniform(bound));
+            }
+        }
+
+    private:
+        static std::uint64_t rotate_left(std::uint64_t value, int bits) noexcept
+        {
+            return (value << bits) | (value >> (64 - bits));
+        }
+
+        std::uint32_t reduce(std::uint32_t random, std::uint32_t bound) noexcept
+        {
+            std::uint64_t product = static_cast<std::uint64_t>(random) * bound;
+            std::uint32_t low = static_cast<std::uint32_t>(product);
+            if (low < bound)
+            {
+                // reject the few values that would make the low buckets more likely
+                const std::uint32_t threshold = (0u - bound) % bound;
+                while (low < threshold)
+                {
+                    product = ((*this)() >> 32) * bound;
+                    low = static_cast<std::uint32_t>(product);
+                }
+            }
+            return static_cast<std::uint32_t>(product >> 32);
+        }
+
+        std::uint64_t state_[4];
+    };
+
+    namespace detail
+    {
+        inline std::atomic<std::uint64_t> global_seed{ 0x5eed5eed5eed5eedull };
+        // bumped by seed() so every thread notices it has to reseed on its next draw
+        inline std::atomic<std::uint64_t> seed_epoch{ 0 };
+        inline std::atomic<std::uint64_t> next_thread_ordinal{ 0 };
+
+        struct thread_state
+        {
+            xoshiro256ss generator;
+            std::uint64_t ordinal = next_thread_ordinal.fetch_add(1, std::memory_order_relaxed);
+            std::uint64_t epoch = ~0ull;
+        };
+
+        inline thread_state& current_thread_state() noexcept
+        {
+            thread_local thread_state state;
+
+            const std::uint64_t epoch = seed_epoch.load(std::memory_order_acquire);
+            if (state.epoch != epoch)
+            {
+                // a distinct, reproducible stream per thread: mix the ordinal into the global seed
+                state.generator.reseed(global_seed.load(std::memory_order_relaxed) ^ (state.ordinal * 0xd1b54a32d192ed03ull));
+                state.epoch = epoch;
+            }
+            return state;
+        }
+    }
+
+    /// <summary>
+    /// Sets the seed every thread derives its stream from. Threads reseed on their next draw.
+    /// </summary>
+    /// <param name="value">seed, the same value reproduces the same numbers</param>
+    inline void seed(std::uint64_t value) noexcept
+    {
+        detail::global_seed.store(value, std::memory_order_relaxed);
+        detail::seed_epoch.fetch_add(1, std::memory_order_release);
+    }
+
+    /// <summary>
+    /// The calling thread's generator, for use with the &lt;random&gt; distributions.
+    /// </summary>
+    inline xoshiro256ss& thread_generator() noexcept
+    {
+        return detail::current_thread_state().generator;
+    }
+
+    /// <summary>
+    /// Drop in for rand() % bound on the calling thread's generator, without the modulo bias.
+    /// </summary>
+    inline int uniform(int bound) noexcept
+    {
+        return static_cast<int>(thread_generator().uniform(static_cast<std::uint32_t>(bound)));
+    }
+
+    /// <summary>
+    /// Fills count values in [0, bound) from the calling thread's generator.
+    /// </summary>
+    template <typename Integer>
+    void fill(Integer* first, std::size_t count, int bound) noexcept
+    {
+        thread_generator().fill(first, count, static_cast<std::uint32_t>(bound));
+    }
+}
@@ -0,0 +1,235 @@
+// fixed_string.h : Fixed capacity string stored inline, for short identifiers and input fields.
+//
+// std::string keeps short text in its small string buffer but still carries a pointer, a size and a
+// capacity, and moves to the heap as soon as the text outgrows that buffer. fixed_string<N> is just
+// N + 1 chars and a length, so a record full of identifiers stays one flat block that copies with
+// memcpy. Writes never go past N: assign, append and push_back either truncate and say so, or the
+// checked forms throw std::length_error.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+
+template <std::size_t N>
+class fixed_string
+{
+public:
+    using value_type = char;
+    using size_type = std::size_t;
+    using iterator = char*;
+    using const_iterator = const char*;
+
+    constexpr fixed_string() noexcept = default;
+
+    /// <summary>
+    /// From a string literal, checked at compile time.
+    /// </summary>
+    template <std::size_t M>
+    constexpr fixed_string(const char (&literal)[M]) noexcept
+    {
+        static_assert(M - 1 <= N, "string literal does not fit in fixed_string");
+        copy_in(literal, M - 1);
+    }
+
+    /// <summary>
+    /// From any text, throws std::length_error when it does not fit.
+    /// </summary>
+    constexpr explicit fixed_string(std::string_view text)
+    {
+        if (text.size() > N)
+        {
+            throw std::length_error("fixed_string: text longer than capacity");
+        }
+        copy_in(text.data(), text.size());
+    }
+
+    static constexpr size_type capacity() noexcept { return N; }
+    static constexpr size_type max_size() noexcept { return N; }
+
+    constexpr size_type size() const noexcept { return length_; }
+    constexpr size_type length() const noexcept { return length_; }
+    constexpr bool empty() const noexcept { return length_ == 0; }
+    constexpr bool full() const noexcept { return length_ == N; }
+
+    constexpr char* data() noexcept { return data_; }
+    constexpr const char* data() const noexcept { return data_; }
+    // always null terminated
+    constexpr const char* c_str() const noexcept { return data_; }
+
+    constexpr iterator begin() noexcept { return data_; }
+    constexpr iterator end() noexcept { return data_ + length_; }
+    constexpr const_iterator begin() const noexcept { return data_; }
+    constexpr const_iterator end() const noexcept { return data_ + length_; }
+
+    constexpr char& operator[](size_type index) noexcept { return data_[index]; }
+    constexpr const char& operator[](size_type index) const noexcept { return data_[index]; }
+
+    constexpr char& at(size_type index)
+    {
+        check_index(index);
+        return data_[index];
+    }
+
+    constexpr const char& at(size_type index) const
+    {
+        check_index(index);
+        return data_[index];
+    }
+
+    constexpr operator std::string_view() const noexcept { return std::string_view(data_, length_); }
+    constexpr std::string_view view() const noexcept { return std::string_view(data_, length_); }
+
+    constexpr void clear() noexcept
+    {
+        length_ = 0;
+        data_[0] = '\0';
+    }
+
+    /// <summary>
+    /// Replaces the contents, keeping as much of text as fits.
+    /// </summary>
+    /// <returns>false when text was truncated</returns>
+    constexpr bool assign(std::string_view text) noexcept
+    {
+        const size_type count = text.size() < N ? text.size() : N;
+        copy_in(text.data(), count);
+        return count == text.size();
+    }
+
+    /// <summary>
+    /// Appends as much of text as fits.
+    /// </summary>
+    /// <returns>false when text was truncated</returns>
+    constexpr bool append(std::string_view text) noexcept
+    {
+        // written so the compiler can see length_ + count <= N
+        const size_type room = length_ < N ? N - length_ : 0;
+        const size_type count = text.size() < room ? text.size() : room;
+        for (size_type i = 0; i < count; ++i)
+        {
+            data_[length_ + i] = text[i];
+        }
+        set_length(length_ + count);
+        return count == text.size();
+    }
+
+    /// <returns>false when the string is already full</returns>
+    constexpr bool push_back(char c) noexcept
+    {
+        if (length_ == N)
+        {
+            return false;
+        }
+        data_[length_] = c;
+        set_length(length_ + 1);
+        return true;
+    }
+
+    // checked forms, for callers that treat overlong input as an error rather than truncating it
+    constexpr void assign_checked(std::string_view text)
+    {
+        check_fits(text.size());
+        copy_in(text.data(), text.size());
+    }
+
+    constexpr void append_checked(std::string_view text)
+    {
+        check_fits(length_ + text.size());
+        append(text);
+    }
+
+    constexpr fixed_string& operator+=(std::string_view text)
+    {
+        append_checked(text);
+        return *this;
+    }
+
+    // comparisons between fixed_strings are templates so a literal never converts to fixed_string,
+    // it goes through the string_view overloads instead
+    template <std::size_t M>
+    friend constexpr bool operator==(const fixed_string& left, const fixed_string<M>& right) noexcept
+    {
+        return left.view() == right.view();
+    }
+
+    template <std::size_t M>
+    friend constexpr bool operator!=(const fixed_string& left, const fixed_string<M>& right) noexcept
+    {
+        return left.view() != right.view();
+    }
+
+    template <std::size_t M>
+    friend constexpr bool operator<(const fixed_string& left, const fixed_string<M>& right) noexcept
+    {
+        return left.view() < right.view();
+    }
+
+    friend constexpr bool operator==(const fixed_string& left, std::string_view right) noexcept
+    {
+        return left.view() == right;
+    }
+
+    friend constexpr bool operator==(std::string_view left, const fixed_string& right) noexcept
+    {
+        return left == right.view();
+    }
+
+    friend constexpr bool operator!=(const fixed_string& left, std::string_view right) noexcept
+    {
+        return left.view() != right;
+    }
+
+    friend constexpr bool operator!=(std::string_view left, const fixed_string& right) noexcept
+    {
+        return left != right.view();
+    }
+
+    friend std::ostream& operator<<(std::ostream& stream, const fixed_string& text)
+    {
+        return stream << text.view();
+    }
+
+private:
+    // the smallest integer that can hold N keeps fixed_string<15> at 17 bytes
+    using length_type = std::conditional_t<N <= UINT8_MAX, std::uint8_t,
+        std::conditional_t<N <= UINT16_MAX, std::uint16_t, std::size_t>>;
+
+    constexpr void copy_in(const char* text, size_type count) noexcept
+    {
+        for (size_type i = 0; i < count; ++i)
+        {
+            data_[i] = text[i];
+        }
+        set_length(count);
+    }
+
+    constexpr void set_length(size_type length) noexcept
+    {
+        length_ = static_cast<length_type>(length);
+        data_[length] = '\0';
+    }
+
+    constexpr void check_index(size_type index) const
+    {
+        if (index >= length_)
+        {
+            throw std::out_of_range("fixed_string: index out of range");
+        }
+    }
+
+    static constexpr void check_fits(size_type length)
+    {
+        if (length > N)
+        {
+            throw std::length_error("fixed_string: text longer than capacity");
+        }
+    }
+
+    char data_[N + 1] = {};
+    length_type length_ = 0;
+};
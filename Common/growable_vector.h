@@ -0,0 +1,529 @@
+// growable_vector.h : Vector with a pluggable growth policy and counters for reallocation traffic.
+//
+// std::vector leaves its growth factor to the implementation (MSVC grows by 1.5x, libstdc++ by 2x), so
+// code that depends on exact capacities behaves differently per platform, and huge collections built
+// with repeated push_back pay for a cascade of copies. growable_vector makes the policy explicit and,
+// for trivially copyable elements, grows with realloc - or mremap on Linux once the block is large -
+// so the live elements are usually not copied at all.
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace growth_detail
+{
+    inline std::size_t round_up(std::size_t value, std::size_t multiple) noexcept
+    {
+        return (value + multiple - 1) / multiple * multiple;
+    }
+
+    constexpr std::size_t huge_page_bytes = 2 * 1024 * 1024;
+}
+
+/// <summary>
+/// Grows capacity by Numerator / Denominator each time the collection is full.
+/// </summary>
+template <std::size_t Numerator, std::size_t Denominator>
+struct geometric_growth
+{
+    static_assert(Numerator > Denominator, "the growth factor must be greater than one");
+
+    static constexpr bool huge_pages = false;
+
+    static std::size_t next_capacity(std::size_t capacity, std::size_t required, std::size_t /*element_size*/) noexcept
+    {
+        const std::size_t grown = capacity / Denominator * Numerator + capacity % Denominator * Numerator / Denominator;
+        return std::max(required, std::max(grown, capacity + 1));
+    }
+};
+
+// the factor MSVC uses for std::vector
+using growth_1_5x = geometric_growth<3, 2>;
+
+// the factor libstdc++ and libc++ use for std::vector
+using growth_2x = geometric_growth<2, 1>;
+
+/// <summary>
+/// Grows capacity in fixed steps of ChunkBytes. Wastes at most one chunk, but the number of
+/// reallocations is linear in the final size, so pair it with realloc / mremap growth.
+/// </summary>
+template <std::size_t ChunkBytes = 64 * 1024>
+struct chunked_growth
+{
+    static_assert(ChunkBytes > 0, "the chunk size must not be zero");
+
+    static constexpr bool huge_pages = false;
+
+    static std::size_t next_capacity(std::size_t capacity, std::size_t required, std::size_t element_size) noexcept
+    {
+        const std::size_t needed = std::max(required, capacity + 1);
+        return std::max(needed, growth_detail::round_up(needed * element_size, ChunkBytes) / element_size);
+    }
+};
+
+/// <summary>
+/// Doubles like growth_2x while the block is small, then keeps the block a whole number of 2 MiB
+/// huge pages and asks the kernel to back it with transparent huge pages.
+/// </summary>
+struct huge_page_growth
+{
+    static constexpr bool huge_pages = true;
+
+    static std::size_t next_capacity(std::size_t capacity, std::size_t required, std::size_t element_size) noexcept
+    {
+        const std::size_t needed = growth_2x::next_capacity(capacity, required, element_size);
+        if (needed * element_size < growth_detail::huge_page_bytes)
+        {
+            return needed;
+        }
+        return growth_detail::round_up(needed * element_size, growth_detail::huge_page_bytes) / element_size;
+    }
+};
+
+/// <summary>
+/// Counters describing the reallocation traffic of one collection.
+/// </summary>
+struct growth_stats
+{
+    // number of times the storage changed size
+    std::size_t reallocations = 0;
+    // reallocations where the live elements had to be copied or moved to a new block
+    std::size_t relocations = 0;
+    // bytes of live elements copied or moved by those relocations
+    std::size_t relocated_bytes = 0;
+    // reallocations satisfied without moving the block
+    std::size_t in_place = 0;
+    // bytes of live elements moved to a new address by remapping pages instead of copying
+    std::size_t remapped_bytes = 0;
+};
+
+/// <summary>
+/// Sequence container with an explicit growth policy. Supports the subset of the std::vector
+/// interface exercised by the collection tests.
+///
+/// reserve(n) and shrink_to_fit() give exactly the requested capacity, except that blocks of
+/// map_threshold bytes or more are page granular on Linux and may hold a few extra elements.
+/// </summary>
+/// <typeparam name="T">element type</typeparam>
+/// <typeparam name="GrowthPolicy">decides the new capacity when push_back finds the collection full</typeparam>
+template <typename T, typename GrowthPolicy = growth_2x>
+class growable_vector
+{
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using reference = T&;
+    using const_reference = const T&;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    // trivially copyable elements can be moved by realloc / mremap instead of element by element
+    static constexpr bool relocatable = std::is_trivially_copyable<T>::value && alignof(T) <= alignof(std::max_align_t);
+
+    // blocks at least this large are allocated with mmap and grown with mremap on Linux
+    static constexpr std::size_t map_threshold = 1024 * 1024;
+
+    growable_vector() noexcept = default;
+
+    growable_vector(const growable_vector& other)
+    {
+        reserve(other.size_);
+        std::uninitialized_copy(other.begin(), other.end(), data_);
+        size_ = other.size_;
+    }
+
+    growable_vector(growable_vector&& other) noexcept
+    {
+        swap(other);
+    }
+
+    ~growable_vector()
+    {
+        clear();
+        change_capacity(0);
+    }
+
+    growable_vector& operator=(growable_vector other) noexcept
+    {
+        swap(other);
+        return *this;
+    }
+
+    void swap(growable_vector& other) noexcept
+    {
+        std::swap(data_, other.data_);
+        std::swap(size_, other.size_);
+        std::swap(capacity_, other.capacity_);
+        std::swap(block_bytes_, other.block_bytes_);
+        std::swap(mapped_, other.mapped_);
+        std::swap(stats_, other.stats_);
+    }
+
+    iterator begin() noexcept { return data_; }
+    iterator end() noexcept { return data_ + size_; }
+    const_iterator begin() const noexcept { return data_; }
+    const_iterator end() const noexcept { return data_ + size_; }
+
+    T* data() noexcept { return data_; }
+    const T* data() const noexcept { return data_; }
+
+    size_type size() const noexcept { return size_; }
+    size_type capacity() const noexcept { return capacity_; }
+    bool empty() const noexcept { return size_ == 0; }
+    size_type max_size() const noexcept { return std::numeric_limits<size_type>::max() / sizeof(T) / 2; }
+
+    const growth_stats& stats() const noexcept { return stats_; }
+    void reset_stats() noexcept { stats_ = growth_stats(); }
+
+    reference operator[](size_type index) noexcept { return data_[index]; }
+    const_reference operator[](size_type index) const noexcept { return data_[index]; }
+
+    reference at(size_type index)
+    {
+        if (index >= size_)
+        {
+            throw std::out_of_range("growable_vector::at index out of range");
+        }
+        return data_[index];
+    }
+
+    const_reference at(size_type index) const
+    {
+        if (index >= size_)
+        {
+            throw std::out_of_range("growable_vector::at index out of range");
+        }
+        return data_[index];
+    }
+
+    reference front() noexcept { return data_[0]; }
+    reference back() noexcept { return data_[size_ - 1]; }
+
+    void push_back(const T& value) { emplace_back(value); }
+    void push_back(T&& value) { emplace_back(std::move(value)); }
+
+    template <typename... Args>
+    reference emplace_back(Args&&... args)
+    {
+        if (size_ == capacity_)
+        {
+            // construct into a temporary first in case args refer to one of our own elements
+            T value(std::forward<Args>(args)...);
+            change_capacity(grown_capacity(size_ + 1));
+            ::new (static_cast<void*>(data_ + size_)) T(std::move(value));
+        }
+        else
+        {
+            ::new (static_cast<void*>(data_ + size_)) T(std::forward<Args>(args)...);
+        }
+        return data_[size_++];
+    }
+
+    void pop_back() noexcept
+    {
+        --size_;
+        data_[size_].~T();
+    }
+
+    void reserve(size_type new_capacity)
+    {
+        if (new_capacity > capacity_)
+        {
+            change_capacity(checked(new_capacity));
+        }
+    }
+
+    void resize(size_type new_size)
+    {
+        resize_with(new_size, [](T* slot) { ::new (static_cast<void*>(slot)) T(); });
+    }
+
+    void resize(size_type new_size, const T& value)
+    {
+        resize_with(new_size, [&value](T* slot) { ::new (static_cast<void*>(slot)) T(value); });
+    }
+
+    void clear() noexcept
+    {
+        destroy(data_, data_ + size_);
+        size_ = 0;
+    }
+
+    void shrink_to_fit()
+    {
+        if (size_ != capacity_)
+        {
+            change_capacity(size_);
+        }
+    }
+
+    iterator erase(const_iterator position)
+    {
+        return erase(position, position + 1);
+    }
+
+    iterator erase(const_iterator first, const_iterator last)
+    {
+        iterator target = data_ + (first - data_);
+        iterator source = data_ + (last - data_);
+        if (target != source)
+        {
+            iterator new_end = std::move(source, end(), target);
+            destroy(new_end, end());
+            size_ -= static_cast<size_type>(source - target);
+        }
+        return target;
+    }
+
+private:
+    static void destroy(T* first, T* last) noexcept
+    {
+        if (!std::is_trivially_destructible<T>::value)
+        {
+            for (; first != last; ++first)
+            {
+                first->~T();
+            }
+        }
+    }
+
+    size_type checked(size_type count) const
+    {
+        if (count > max_size())
+        {
+            throw std::length_error("growable_vector capacity exceeds max_size");
+        }
+        return count;
+    }
+
+    size_type grown_capacity(size_type required) const
+    {
+        return checked(GrowthPolicy::next_capacity(capacity_, checked(required), sizeof(T)));
+    }
+
+    template <typename Construct>
+    void resize_with(size_type new_size, Construct construct)
+    {
+        if (new_size < size_)
+        {
+            destroy(data_ + new_size, data_ + size_);
+            size_ = new_size;
+            return;
+        }
+
+        if (new_size > capacity_)
+        {
+            change_capacity(grown_capacity(new_size));
+        }
+        for (; size_ < new_size; ++size_)
+        {
+            construct(data_ + size_);
+        }
+    }
+
+    void change_capacity(size_type new_capacity)
+    {
+        if (new_capacity == 0 && block_bytes_ == 0)
+        {
+            return;
+        }
+
+        if (relocatable)
+        {
+            resize_block(new_capacity * sizeof(T));
+        }
+        else
+        {
+            move_to_new_block(new_capacity);
+        }
+    }
+
+    // generic path: allocate, move the elements across one by one and release the old block
+    void move_to_new_block(size_type new_capacity)
+    {
+        T* destination = nullptr;
+        if (new_capacity > 0)
+        {
+            destination = static_cast<T*>(::operator new(new_capacity * sizeof(T), std::align_val_t(alignof(T))));
+        }
+
+        for (size_type i = 0; i < size_; ++i)
+        {
+            ::new (static_cast<void*>(destination + i)) T(std::move_if_noexcept(data_[i]));
+        }
+        destroy(data_, data_ + size_);
+
+        if (data_ != nullptr)
+        {
+            ::operator delete(data_, std::align_val_t(alignof(T)));
+        }
+
+        record_relocation(data_ != nullptr && destination != nullptr);
+
+        data_ = destination;
+        capacity_ = new_capacity;
+        block_bytes_ = new_capacity * sizeof(T);
+    }
+
+    // trivially copyable path: realloc keeps the elements, mremap moves them by remapping pages
+    void resize_block(std::size_t bytes)
+    {
+        void* const old_block = data_;
+        const std::size_t used = size_ * sizeof(T);
+        void* block = nullptr;
+
+#ifdef __linux__
+        if (bytes >= map_threshold)
+        {
+            bytes = growth_detail::round_up(bytes, static_cast<std::size_t>(sysconf(_SC_PAGESIZE)));
+
+            if (mapped_)
+            {
+                block = mremap(old_block, block_bytes_, bytes, MREMAP_MAYMOVE);
+                if (block == MAP_FAILED)
+                {
+                    throw std::bad_alloc();
+                }
+                record_remap(block == old_block);
+            }
+            else
+            {
+                block = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                if (block == MAP_FAILED)
+                {
+                    throw std::bad_alloc();
+                }
+                copy_and_release(block, old_block, used);
+            }
+
+            if (GrowthPolicy::huge_pages)
+            {
+                // only a hint, the kernel may not have transparent huge pages enabled
+                madvise(block, bytes, MADV_HUGEPAGE);
+            }
+
+            mapped_ = true;
+            adopt(block, bytes);
+            return;
+        }
+
+        if (mapped_)
+        {
+            // shrinking below the threshold, go back to the heap
+            block = bytes > 0 ? std::malloc(bytes) : nullptr;
+            if (bytes > 0 && block == nullptr)
+            {
+                throw std::bad_alloc();
+            }
+            copy_and_release(block, old_block, used);
+            mapped_ = false;
+            adopt(block, bytes);
+            return;
+        }
+#endif
+
+        if (bytes == 0)
+        {
+            std::free(old_block);
+            ++stats_.reallocations;
+            adopt(nullptr, 0);
+            return;
+        }
+
+        block = std::realloc(old_block, bytes);
+        if (block == nullptr)
+        {
+            throw std::bad_alloc();
+        }
+
+        if (old_block == nullptr)
+        {
+            ++stats_.reallocations;
+        }
+        else if (block == old_block)
+        {
+            record_remap(true);
+        }
+        else
+        {
+            // realloc does not say whether it copied or remapped, so assume the worst
+            record_relocation(used > 0);
+        }
+        adopt(block, bytes);
+    }
+
+    // moves used bytes from a heap block into a mapping or back, then frees the old block
+    void copy_and_release(void* block, void* old_block, std::size_t used)
+    {
+        if (used > 0 && block != nullptr)
+        {
+            std::memcpy(block, old_block, used);
+        }
+
+#ifdef __linux__
+        if (mapped_)
+        {
+            munmap(old_block, block_bytes_);
+        }
+        else
+#endif
+        {
+            std::free(old_block);
+        }
+
+        record_relocation(old_block != nullptr && block != nullptr);
+    }
+
+    void adopt(void* block, std::size_t bytes) noexcept
+    {
+        data_ = static_cast<T*>(block);
+        block_bytes_ = bytes;
+        capacity_ = bytes / sizeof(T);
+    }
+
+    void record_relocation(bool moved_elements) noexcept
+    {
+        ++stats_.reallocations;
+        if (moved_elements)
+        {
+            ++stats_.relocations;
+            stats_.relocated_bytes += size_ * sizeof(T);
+        }
+    }
+
+    void record_remap(bool same_address) noexcept
+    {
+        ++stats_.reallocations;
+        if (same_address)
+        {
+            ++stats_.in_place;
+        }
+        else
+        {
+            stats_.remapped_bytes += size_ * sizeof(T);
+        }
+    }
+
+    T* data_ = nullptr;
+    size_type size_ = 0;
+    size_type capacity_ = 0;
+    // bytes actually held by data_, at least capacity_ * sizeof(T)
+    std::size_t block_bytes_ = 0;
+    // true when data_ came from mmap rather than malloc
+    bool mapped_ = false;
+    growth_stats stats_;
+};
@@ -0,0 +1,241 @@
+// line_reader.cpp : Bounded, allocation free line reader.
+//
+
+#include "line_reader.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace
+{
+    std::ptrdiff_t read_descriptor(void* context, char* buffer, std::size_t size)
+    {
+        const int fd = *static_cast<int*>(context);
+        for (;;)
+        {
+#ifdef _WIN32
+            const int count = ::_read(fd, buffer, static_cast<unsigned int>(std::min<std::size_t>(size, 1u << 30)));
+#else
+            const ssize_t count = ::read(fd, buffer, size);
+#endif
+            if (count >= 0 || errno != EINTR)
+            {
+                return count;
+            }
+        }
+    }
+}
+
+line_reader::line_reader(int fd, std::size_t max_line_length, std::size_t chunk_size)
+    : line_reader(read_descriptor, nullptr, max_line_length, chunk_size)
+{
+    fd_ = fd;
+    context_ = &fd_;
+}
+
+line_reader::line_reader(read_function read, void* context, std::size_t max_line_length, std::size_t chunk_size)
+    : read_(read),
+      context_(context),
+      max_line_length_(max_line_length),
+      chunk_size_(std::max<std::size_t>(chunk_size, 1)),
+      // room for one full line plus its "\r\n" and a chunk behind it, so a line is never split
+      // by compaction and truncation can keep its prefix while skipping the rest
+      capacity_(max_line_length + 1 + std::max<std::size_t>(chunk_size, 1)),
+      buffer_(new char[capacity_])
+{
+}
+
+bool line_reader::fill()
+{
+    if (eof_ || failed_)
+    {
+        return false;
+    }
+
+    if (capacity_ - end_ < chunk_size_)
+    {
+        compact();
+    }
+
+    // never more than a chunk, so a small chunk_size bounds how far the reader reads ahead
+    const std::ptrdiff_t count = read_(context_, buffer_.get() + end_, std::min(chunk_size_, capacity_ - end_));
+    if (count < 0)
+    {
+        failed_ = true;
+        return false;
+    }
+    if (count == 0)
+    {
+        eof_ = true;
+        return false;
+    }
+
+    end_ += static_cast<std::size_t>(count);
+    return true;
+}
+
+void line_reader::compact()
+{
+    if (begin_ > 0)
+    {
+        std::memmove(buffer_.get(), buffer_.get() + begin_, end_ - begin_);
+        end_ -= begin_;
+        begin_ = 0;
+    }
+}
+
+bool line_reader::skip_rest_of_line(std::size_t& length)
+{
+    // the kept prefix occupies [0, max_line_length_) and the rest of the line is searched and
+    // discarded in the space behind it, so the prefix never moves
+    char previous = max_line_length_ > 0 ? buffer_[max_line_length_ - 1] : '\0';
+    begin_ = max_line_length_;
+
+    for (;;)
+    {
+        const char* start = buffer_.get() + begin_;
+        const char* newline = static_cast<const char*>(std::memchr(start, '\n', end_ - begin_));
+        if (newline != nullptr)
+        {
+            length += static_cast<std::size_t>(newline - start);
+            if ((newline > start ? newline[-1] : previous) == '\r')
+            {
+                --length;
+            }
+            begin_ += static_cast<std::size_t>(newline - start) + 1;
+            return true;
+        }
+
+        length += end_ - begin_;
+        if (end_ > begin_)
+        {
+            previous = buffer_[end_ - 1];
+        }
+
+        // drop what we searched; the free space behind the prefix is a full chunk, so fill()
+        // reads straight into it without compacting
+        begin_ = end_ = max_line_length_;
+        if (!fill())
+        {
+            return false;
+        }
+    }
+}
+
+bool line_reader::next(input_line& line)
+{
+    std::size_t scanned = 0;
+
+    for (;;)
+    {
+        char* start = buffer_.get() + begin_;
+        const std::size_t available = end_ - begin_;
+        // a line of exactly max_line_length_ bytes may end in "\r\n", its '\n' one further out
+        const bool return_at_limit = available > max_line_length_ && start[max_line_length_] == '\r';
+        const std::size_t limit = max_line_length_ + (return_at_limit ? 2 : 1);
+        const std::size_t window = std::min(available, limit);
+
+        // only look at bytes we have not searched yet, and never further than the line limit
+        const char* newline = static_cast<const char*>(std::memchr(start + scanned, '\n', window - scanned));
+        if (newline != nullptr)
+        {
+            const std::size_t length = static_cast<std::size_t>(newline - start);
+            begin_ += length + 1;
+            return hand_out(line, start, length);
+        }
+        scanned = window;
+
+        if (available >= limit)
+        {
+            // too long: keep the first max_line_length bytes at the front of the buffer
+            compact();
+
+            std::size_t length = max_line_length_;
+            skip_rest_of_line(length);
+
+            line.text = std::string_view(buffer_.get(), max_line_length_);
+            line.length = length;
+            line.truncated = true;
+            ++line_count_;
+            ++truncated_count_;
+            return true;
+        }
+
+        if (!fill())
+        {
+            // a last line without a newline still counts as a line
+            if (begin_ == end_)
+            {
+                return false;
+            }
+
+            const std::size_t length = end_ - begin_;
+            start = buffer_.get() + begin_;
+            begin_ = end_;
+            return hand_out(line, start, length);
+        }
+    }
+}
+
+bool line_reader::hand_out(input_line& line, const char* start, std::size_t length)
+{
+    if (length > 0 && start[length - 1] == '\r')
+    {
+        --length;
+    }
+
+    line.text = std::string_view(start, length);
+    line.length = length;
+    line.truncated = false;
+    ++line_count_;
+    return true;
+}
+
+field_check split_fields(std::string_view text, char delimiter, const std::size_t* max_lengths, std::string_view* fields, std::size_t field_count) noexcept
+{
+    field_check result;
+
+    for (std::size_t i = 0; i < field_count; ++i)
+    {
+        const std::size_t position = text.find(delimiter);
+        const bool last = i + 1 == field_count;
+
+        if (position == std::string_view::npos && !last)
+        {
+            fields[i] = text;
+            result.status = field_status::too_few_fields;
+            result.index = i + 1;
+            return result;
+        }
+
+        fields[i] = last ? text : text.substr(0, position);
+        if (last && position != std::string_view::npos)
+        {
+            fields[i] = text.substr(0, position);
+            result.status = field_status::too_many_fields;
+            result.index = field_count;
+            return result;
+        }
+
+        if (fields[i].size() > max_lengths[i])
+        {
+            result.status = field_status::field_too_long;
+            result.index = i;
+            return result;
+        }
+
+        if (!last)
+        {
+            text.remove_prefix(position + 1);
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,131 @@
+// line_reader.h : Bounded, allocation free line reader for stdin, file descriptors or any byte source.
+//
+// std::cin.getline(buffer, size) silently truncates long lines and leaves the stream in a fail state,
+// and std::getline allocates a std::string per line. line_reader reads the input in large chunks into
+// one buffer allocated up front and hands out std::string_view lines that point straight into it.
+// Lines longer than the limit are never stored in full: the reader keeps the first max_line_length
+// bytes, skips the rest and reports the line as truncated together with its real length.
+//
+// The reader reads ahead of the lines it hands out, at most chunk_size bytes at a time. Input it has
+// buffered is not seen by anything else reading the same descriptor; a chunk_size of 1 consumes
+// nothing past the end of the line returned, at the cost of a read per byte.
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string_view>
+
+/// <summary>
+/// One line handed out by line_reader. text stays valid until the next call to next().
+/// </summary>
+struct input_line
+{
+    // the line without its terminating "\n" or "\r\n", cut to max_line_length when truncated
+    std::string_view text;
+    // length of the line as it appeared in the input
+    std::size_t length = 0;
+    // true when text holds only the first max_line_length bytes of the line
+    bool truncated = false;
+};
+
+class line_reader
+{
+public:
+    // reads up to size bytes into buffer, returns the number read, 0 at end of input or -1 on error
+    using read_function = std::ptrdiff_t (*)(void* context, char* buffer, std::size_t size);
+
+    static constexpr std::size_t default_chunk_size = 64 * 1024;
+    static constexpr std::size_t default_max_line_length = 4096;
+
+    /// <summary>
+    /// Reads from a file descriptor, 0 for stdin.
+    /// </summary>
+    /// <param name="fd">descriptor to read</param>
+    /// <param name="max_line_length">longest line returned in full</param>
+    /// <param name="chunk_size">most bytes requested from the descriptor per read</param>
+    explicit line_reader(int fd, std::size_t max_line_length = default_max_line_length, std::size_t chunk_size = default_chunk_size);
+
+    /// <summary>
+    /// Reads from a caller supplied source, for input that does not come from a descriptor.
+    /// </summary>
+    line_reader(read_function read, void* context, std::size_t max_line_length = default_max_line_length, std::size_t chunk_size = default_chunk_size);
+
+    line_reader(const line_reader&) = delete;
+    line_reader& operator=(const line_reader&) = delete;
+
+    /// <summary>
+    /// Moves to the next line.
+    /// </summary>
+    /// <param name="line">receives the line</param>
+    /// <returns>false at end of input or on a read error, see failed()</returns>
+    bool next(input_line& line);
+
+    // true when the source reported an error rather than end of input
+    bool failed() const noexcept { return failed_; }
+
+    // number of lines returned so far, and how many of them were truncated
+    std::size_t line_count() const noexcept { return line_count_; }
+    std::size_t truncated_count() const noexcept { return truncated_count_; }
+
+    std::size_t max_line_length() const noexcept { return max_line_length_; }
+
+private:
+    // appends one chunk after end_, returns false at end of input or error
+    bool fill();
+    // makes room for a chunk by sliding the unread bytes to the front of the buffer
+    void compact();
+    // drops input up to and including the next newline, counting the dropped bytes into length
+    bool skip_rest_of_line(std::size_t& length);
+    // fills in line for a complete line of length bytes at start
+    bool hand_out(input_line& line, const char* start, std::size_t length);
+
+    read_function read_;
+    void* context_;
+    std::size_t max_line_length_;
+    std::size_t chunk_size_;
+    std::size_t capacity_;
+    std::unique_ptr<char[]> buffer_;
+    // unread bytes are [begin_, end_)
+    std::size_t begin_ = 0;
+    std::size_t end_ = 0;
+    bool eof_ = false;
+    bool failed_ = false;
+    std::size_t line_count_ = 0;
+    std::size_t truncated_count_ = 0;
+    // descriptor used by the default read function
+    int fd_ = -1;
+};
+
+/// <summary>
+/// Outcome of splitting a line into length limited fields.
+/// </summary>
+enum class field_status
+{
+    ok,
+    // a field is longer than its limit, field_check::index says which
+    field_too_long,
+    // the line has more delimiters than expected fields
+    too_many_fields,
+    // the line ended before every expected field was seen
+    too_few_fields
+};
+
+struct field_check
+{
+    field_status status = field_status::ok;
+    // index of the offending field, or the number of fields found for too_few_fields
+    std::size_t index = 0;
+};
+
+/// <summary>
+/// Splits text on delimiter into exactly field_count fields, checking field i against max_lengths[i].
+/// fields[i] points into text, nothing is copied.
+/// </summary>
+/// <param name="text">line to split</param>
+/// <param name="delimiter">field separator</param>
+/// <param name="max_lengths">longest allowed length per field</param>
+/// <param name="fields">receives field_count views</param>
+/// <param name="field_count">number of fields expected</param>
+/// <returns>ok, or the first problem found</returns>
+field_check split_fields(std::string_view text, char delimiter, const std::size_t* max_lengths, std::string_view* fields, std::size_t field_count) noexcept;
@@ -0,0 +1,237 @@
+// lz4_block.cpp : LZ4 block format compressor and bounds checked decompressor.
+//
+
+#include "lz4_block.h"
+
+#include <cstdint>
+#include <cstring>
+
+namespace
+{
+    constexpr std::size_t min_match = 4;
+    // the format ends every block with at least this many literals
+    constexpr std::size_t last_literals = 5;
+    // and no match may start closer than this to the end
+    constexpr std::size_t match_start_limit = 12;
+    constexpr std::size_t max_offset = 65535;
+    constexpr unsigned hash_bits = 12;
+
+    std::uint32_t read32(const char* p) noexcept
+    {
+        std::uint32_t value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    std::uint32_t hash(std::uint32_t sequence) noexcept
+    {
+        return (sequence * 2654435761u) >> (32 - hash_bits);
+    }
+
+    // writes the length extension bytes of a length whose 4 bit field is saturated
+    bool put_length(std::size_t length, char*& out, const char* end) noexcept
+    {
+        for (; length >= 255; length -= 255)
+        {
+            if (out == end)
+            {
+                return false;
+            }
+            *out++ = static_cast<char>(255);
+        }
+        if (out == end)
+        {
+            return false;
+        }
+        *out++ = static_cast<char>(length);
+        return true;
+    }
+
+    // one sequence: literals, then a match unless this is the last sequence (match_length 0)
+    bool put_sequence(const char* literals, std::size_t literal_length, std::size_t offset, std::size_t match_length, char*& out,
+        const char* end) noexcept
+    {
+        if (out == end)
+        {
+            return false;
+        }
+        char* token = out++;
+        const std::size_t match_field = match_length == 0 ? 0 : match_length - min_match;
+        *token = static_cast<char>((literal_length >= 15 ? 15 : literal_length) << 4 | (match_field >= 15 ? 15 : match_field));
+
+        if (literal_length >= 15 && !put_length(literal_length - 15, out, end))
+        {
+            return false;
+        }
+        if (static_cast<std::size_t>(end - out) < literal_length)
+        {
+            return false;
+        }
+        std::memcpy(out, literals, literal_length);
+        out += literal_length;
+
+        if (match_length == 0)
+        {
+            return true;
+        }
+        if (end - out < 2)
+        {
+            return false;
+        }
+        *out++ = static_cast<char>(offset & 0xff);
+        *out++ = static_cast<char>(offset >> 8);
+        return match_field < 15 || put_length(match_field - 15, out, end);
+    }
+
+    // reads the extension bytes of a saturated length field
+    bool get_length(std::size_t& length, const unsigned char*& in, const unsigned char* end) noexcept
+    {
+        unsigned char byte;
+        do
+        {
+            if (in == end)
+            {
+                return false;
+            }
+            byte = *in++;
+            length += byte;
+        } while (byte == 255);
+        return true;
+    }
+}
+
+std::size_t lz4_compress(const char* source, std::size_t size, char* output, std::size_t capacity) noexcept
+{
+    char* out = output;
+    const char* const end = output + capacity;
+    std::size_t anchor = 0;
+
+    if (size > match_start_limit)
+    {
+        // positions of the last 4 byte sequence seen with each hash
+        std::uint32_t table[1u << hash_bits] = {};
+        const std::size_t match_limit = size - last_literals;
+        const std::size_t start_limit = size - match_start_limit;
+
+        std::size_t position = 1;
+        table[hash(read32(source))] = 0;
+        while (position < start_limit)
+        {
+            const std::uint32_t sequence = read32(source + position);
+            const std::uint32_t h = hash(sequence);
+            std::size_t candidate = table[h];
+            table[h] = static_cast<std::uint32_t>(position);
+
+            if (candidate >= position || position - candidate > max_offset || read32(source + candidate) != sequence)
+            {
+                // the longer the run without a match, the larger the steps through it
+                position += 1 + ((position - anchor) >> 6);
+                continue;
+            }
+
+            // grow the match backwards into the pending literals, then forwards
+            while (position > anchor && candidate > 0 && source[position - 1] == source[candidate - 1])
+            {
+                --position;
+                --candidate;
+            }
+            std::size_t length = min_match;
+            while (position + length < match_limit && source[position + length] == source[candidate + length])
+            {
+                ++length;
+            }
+
+            if (!put_sequence(source + anchor, position - anchor, position - candidate, length, out, end))
+            {
+                return 0;
+            }
+            position += length;
+            anchor = position;
+
+            // the position just behind the match is a likely start for the next one
+            if (position - 2 < start_limit)
+            {
+                table[hash(read32(source + position - 2))] = static_cast<std::uint32_t>(position - 2);
+            }
+        }
+    }
+
+    if (!put_sequence(source + anchor, size - anchor, 0, 0, out, end))
+    {
+        return 0;
+    }
+    return static_cast<std::size_t>(out - output);
+}
+
+std::ptrdiff_t lz4_decompress(const char* source, std::size_t size, char* output, std::size_t capacity) noexcept
+{
+    const auto* in = reinterpret_cast<const unsigned char*>(source);
+    const unsigned char* const in_end = in + size;
+    std::size_t written = 0;
+
+    for (;;)
+    {
+        if (in == in_end)
+        {
+            return -1;
+        }
+        const unsigned token = *in++;
+
+        std::size_t literal_length = token >> 4;
+        if (literal_length == 15 && !get_length(literal_length, in, in_end))
+        {
+            return -1;
+        }
+        if (literal_length > static_cast<std::size_t>(in_end - in) || literal_length > capacity - written)
+        {
+            return -1;
+        }
+        std::memcpy(output + written, in, literal_length);
+        in += literal_length;
+        written += literal_length;
+
+        // the last sequence has literals only
+        if (in == in_end)
+        {
+            return static_cast<std::ptrdiff_t>(written);
+        }
+
+        if (in_end - in < 2)
+        {
+            return -1;
+        }
+        const std::size_t offset = static_cast<std::size_t>(in[0] | in[1] << 8);
+        in += 2;
+        if (offset == 0 || offset > written)
+        {
+            return -1;
+        }
+
+        std::size_t match_length = token & 15;
+        if (match_length == 15 && !get_length(match_length, in, in_end))
+        {
+            return -1;
+        }
+        match_length += min_match;
+        if (match_length > capacity - written)
+        {
+            return -1;
+        }
+
+        // a match may overlap the bytes it produces, a run of one repeated byte has offset 1
+        char* target = output + written;
+        const char* match = target - offset;
+        if (offset >= match_length)
+        {
+            std::memcpy(target, match, match_length);
+        }
+        else
+        {
+            for (std::size_t i = 0; i < match_length; ++i)
+            {
+                target[i] = match[i];
+            }
+        }
+        written += match_length;
+    }
+}
@@ -0,0 +1,34 @@
+// lz4_block.h : Small bundled compressor in the LZ4 block format.
+//
+// The payloads the programs encrypt are plain text and compress several times over, yet pulling in
+// a compression library for that would be the repository's first external dependency. This is a
+// single pass greedy LZ77 matcher writing the LZ4 block format (token, literals, 2 byte offset,
+// match length), so any LZ4 block decoder can read its output and the decoder here reads any LZ4
+// block. Speed comes from a 4096 entry hash table of 4 byte sequences and from skipping ahead faster
+// the longer no match is found.
+
+#pragma once
+
+#include <cstddef>
+
+/// <summary>
+/// Largest compressed size of size input bytes: incompressible input grows by at most this much.
+/// </summary>
+constexpr std::size_t lz4_bound(std::size_t size) noexcept
+{
+    return size + size / 255 + 16;
+}
+
+/// <summary>
+/// Compresses size bytes of source into output.
+/// </summary>
+/// <param name="capacity">bytes available at output, lz4_bound(size) is always enough</param>
+/// <returns>compressed size, or 0 when it does not fit in capacity</returns>
+std::size_t lz4_compress(const char* source, std::size_t size, char* output, std::size_t capacity) noexcept;
+
+/// <summary>
+/// Decompresses one block. Malformed input is reported, never read or written out of bounds.
+/// </summary>
+/// <param name="capacity">bytes available at output</param>
+/// <returns>decompressed size, or -1 when source is not a valid block or does not fit in capacity</returns>
+std::ptrdiff_t lz4_decompress(const char* source, std::size_t size, char* output, std::size_t capacity) noexcept;
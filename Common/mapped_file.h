@@ -0,0 +1,42 @@
+// mapped_file.h : Read only memory mapping of a whole file.
+//
+// Reading a file into a string copies every byte through the stream buffers before the first one is
+// looked at. A mapping makes the file's pages addressable directly: only the pages actually touched
+// are read from disk, and several threads can work on different parts of the file at once.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+class mapped_file
+{
+public:
+    mapped_file() noexcept = default;
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+    mapped_file(mapped_file&& other) noexcept;
+    mapped_file& operator=(mapped_file&& other) noexcept;
+    ~mapped_file();
+
+    /// <summary>
+    /// Maps filename, replacing any previous mapping.
+    /// </summary>
+    /// <returns>false when the file cannot be opened or mapped</returns>
+    bool open(const std::string& filename);
+
+    void close() noexcept;
+
+    bool is_open() const noexcept { return data_ != nullptr || open_empty_; }
+
+    // null for an empty file
+    const std::uint8_t* data() const noexcept { return data_; }
+    std::size_t size() const noexcept { return size_; }
+
+private:
+    const std::uint8_t* data_ = nullptr;
+    std::size_t size_ = 0;
+    // an empty file cannot be mapped, but opening it still succeeded
+    bool open_empty_ = false;
+};
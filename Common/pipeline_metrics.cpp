@@ -0,0 +1,333 @@
+// pipeline_metrics.cpp : Per thread counter slots, their snapshot and the Prometheus and JSON writers.
+//
+
+#include "pipeline_metrics.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <ostream>
+#include <string>
+#include <utility>
+
+namespace
+{
+    using pipeline_metrics::stage_count;
+
+    struct stage_counters
+    {
+        std::atomic<std::uint64_t> operations{ 0 };
+        std::atomic<std::uint64_t> bytes{ 0 };
+        std::atomic<std::uint64_t> nanoseconds{ 0 };
+        std::atomic<std::uint64_t> max_nanoseconds{ 0 };
+    };
+
+    // one cache line or more per thread, written by its owner only unless shared
+    struct alignas(64) thread_slot
+    {
+        stage_counters stages[stage_count];
+        std::atomic<std::uint64_t> queue_depth{ 0 };
+        std::atomic<std::uint64_t> max_queue_depth{ 0 };
+        // guarded by registry_lock
+        bool in_use = false;
+    };
+
+    std::mutex registry_lock;
+    thread_slot slots[pipeline_metrics::max_threads];
+    // for threads that found every slot taken, updated with atomic read-modify-write
+    thread_slot shared_slot;
+    // counts of threads that have exited, guarded by registry_lock
+    pipeline_metrics::totals retired;
+
+    void add(std::atomic<std::uint64_t>& counter, std::uint64_t value, bool shared) noexcept
+    {
+        if (shared)
+        {
+            counter.fetch_add(value, std::memory_order_relaxed);
+        }
+        else
+        {
+            // the only writer, so no locked instruction is needed
+            counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+        }
+    }
+
+    void raise(std::atomic<std::uint64_t>& counter, std::uint64_t value, bool shared) noexcept
+    {
+        std::uint64_t current = counter.load(std::memory_order_relaxed);
+        if (!shared)
+        {
+            if (value > current)
+            {
+                counter.store(value, std::memory_order_relaxed);
+            }
+            return;
+        }
+        while (value > current && !counter.compare_exchange_weak(current, value, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    // adds a slot into totals, queue depth included only for threads still running
+    void accumulate(const thread_slot& slot, pipeline_metrics::totals& values, bool running) noexcept
+    {
+        for (std::size_t i = 0; i < stage_count; ++i)
+        {
+            auto& into = values.stages[i];
+            const auto& from = slot.stages[i];
+            into.operations += from.operations.load(std::memory_order_relaxed);
+            into.bytes += from.bytes.load(std::memory_order_relaxed);
+            into.nanoseconds += from.nanoseconds.load(std::memory_order_relaxed);
+            into.max_nanoseconds = std::max(into.max_nanoseconds, from.max_nanoseconds.load(std::memory_order_relaxed));
+        }
+        if (running)
+        {
+            values.queue_depth += slot.queue_depth.load(std::memory_order_relaxed);
+        }
+        values.max_queue_depth = std::max(values.max_queue_depth, slot.max_queue_depth.load(std::memory_order_relaxed));
+    }
+
+    // caller holds registry_lock
+    void clear(thread_slot& slot) noexcept
+    {
+        for (auto& counters : slot.stages)
+        {
+            counters.operations.store(0, std::memory_order_relaxed);
+            counters.bytes.store(0, std::memory_order_relaxed);
+            counters.nanoseconds.store(0, std::memory_order_relaxed);
+            counters.max_nanoseconds.store(0, std::memory_order_relaxed);
+        }
+        slot.queue_depth.store(0, std::memory_order_relaxed);
+        slot.max_queue_depth.store(0, std::memory_order_relaxed);
+    }
+
+    // claims a slot on a thread's first record and folds it into retired when the thread exits
+    class slot_owner
+    {
+    public:
+        ~slot_owner()
+        {
+            if (slot_ == nullptr || slot_ == &shared_slot)
+            {
+                return;
+            }
+            std::lock_guard<std::mutex> lock(registry_lock);
+            accumulate(*slot_, retired, false);
+            clear(*slot_);
+            slot_->in_use = false;
+        }
+
+        thread_slot& slot() noexcept
+        {
+            if (slot_ == nullptr)
+            {
+                slot_ = &shared_slot;
+                std::lock_guard<std::mutex> lock(registry_lock);
+                for (auto& candidate : slots)
+                {
+                    if (!candidate.in_use)
+                    {
+                        candidate.in_use = true;
+                        slot_ = &candidate;
+                        break;
+                    }
+                }
+            }
+            return *slot_;
+        }
+
+        bool shared() const noexcept { return slot_ == &shared_slot; }
+
+    private:
+        thread_slot* slot_ = nullptr;
+    };
+
+    thread_local slot_owner owner;
+
+    // nanoseconds as seconds with all nine decimals, without touching the stream's format flags
+    std::string seconds(std::uint64_t nanoseconds)
+    {
+        char text[32];
+        std::snprintf(text, sizeof(text), "%llu.%09llu", static_cast<unsigned long long>(nanoseconds / 1000000000),
+            static_cast<unsigned long long>(nanoseconds % 1000000000));
+        return text;
+    }
+
+    void write_prometheus(std::ostream& stream, const pipeline_metrics::totals& values)
+    {
+        using pipeline_metrics::stage_totals;
+        struct stage_metric
+        {
+            const char* name;
+            const char* type;
+            const char* help;
+            std::string (*value)(const stage_totals&);
+        };
+        const stage_metric metrics[] = {
+            { "pipeline_operations_total", "counter", "Operations completed by each stage.",
+                [](const stage_totals& totals) { return std::to_string(totals.operations); } },
+            { "pipeline_bytes_total", "counter", "Bytes processed by each stage.",
+                [](const stage_totals& totals) { return std::to_string(totals.bytes); } },
+            { "pipeline_seconds_total", "counter", "Time spent in each stage.",
+                [](const stage_totals& totals) { return seconds(totals.nanoseconds); } },
+            { "pipeline_max_seconds", "gauge", "Longest single operation of each stage.",
+                [](const stage_totals& totals) { return seconds(totals.max_nanoseconds); } },
+        };
+
+        for (const auto& metric : metrics)
+        {
+            stream << "# HELP " << metric.name << " " << metric.help << "\n"
+                   << "# TYPE " << metric.name << " " << metric.type << "\n";
+            for (std::size_t i = 0; i < stage_count; ++i)
+            {
+                stream << metric.name << "{stage=\"" << pipeline_metrics::to_string(static_cast<pipeline_metrics::stage>(i)) << "\"} "
+                       << metric.value(values.stages[i]) << "\n";
+            }
+        }
+
+        stream << "# HELP pipeline_queue_depth Requests in flight.\n"
+               << "# TYPE pipeline_queue_depth gauge\n"
+               << "pipeline_queue_depth " << values.queue_depth << "\n"
+               << "# HELP pipeline_max_queue_depth Most requests one thread had in flight.\n"
+               << "# TYPE pipeline_max_queue_depth gauge\n"
+               << "pipeline_max_queue_depth " << values.max_queue_depth << "\n"
+               << "# HELP pipeline_threads Threads recording.\n"
+               << "# TYPE pipeline_threads gauge\n"
+               << "pipeline_threads " << values.threads << "\n";
+    }
+
+    void write_json(std::ostream& stream, const pipeline_metrics::totals& values)
+    {
+        stream << "{\"stages\":{";
+        for (std::size_t i = 0; i < stage_count; ++i)
+        {
+            const auto& totals = values.stages[i];
+            stream << (i == 0 ? "" : ",") << "\"" << pipeline_metrics::to_string(static_cast<pipeline_metrics::stage>(i)) << "\":{"
+                   << "\"operations\":" << totals.operations << ",\"bytes\":" << totals.bytes
+                   << ",\"seconds\":" << seconds(totals.nanoseconds) << ",\"max_seconds\":" << seconds(totals.max_nanoseconds) << "}";
+        }
+        stream << "},\"queue_depth\":" << values.queue_depth << ",\"max_queue_depth\":" << values.max_queue_depth
+               << ",\"threads\":" << values.threads << "}\n";
+    }
+}
+
+namespace pipeline_metrics
+{
+    const char* to_string(stage which) noexcept
+    {
+        switch (which)
+        {
+        case stage::read:
+            return "read";
+        case stage::transform:
+            return "transform";
+        case stage::write:
+            return "write";
+        }
+        return "unknown";
+    }
+
+    void record(stage which, std::uint64_t bytes, std::uint64_t nanoseconds) noexcept
+    {
+        thread_slot& slot = owner.slot();
+        const bool shared = owner.shared();
+        stage_counters& counters = slot.stages[static_cast<std::size_t>(which)];
+        add(counters.operations, 1, shared);
+        add(counters.bytes, bytes, shared);
+        add(counters.nanoseconds, nanoseconds, shared);
+        raise(counters.max_nanoseconds, nanoseconds, shared);
+    }
+
+    void set_queue_depth(std::uint64_t depth) noexcept
+    {
+        // threads on the shared slot overwrite one another's depth, they only happen past max_threads
+        thread_slot& slot = owner.slot();
+        slot.queue_depth.store(depth, std::memory_order_relaxed);
+        raise(slot.max_queue_depth, depth, owner.shared());
+    }
+
+    totals snapshot()
+    {
+        std::lock_guard<std::mutex> lock(registry_lock);
+        totals values = retired;
+        for (const auto& slot : slots)
+        {
+            if (slot.in_use)
+            {
+                accumulate(slot, values, true);
+                ++values.threads;
+            }
+        }
+        accumulate(shared_slot, values, true);
+        return values;
+    }
+
+    void reset()
+    {
+        std::lock_guard<std::mutex> lock(registry_lock);
+        for (auto& slot : slots)
+        {
+            clear(slot);
+        }
+        clear(shared_slot);
+        retired = totals();
+    }
+
+    void write(std::ostream& stream, const totals& values, format as)
+    {
+        if (as == format::json)
+        {
+            write_json(stream, values);
+        }
+        else
+        {
+            write_prometheus(stream, values);
+        }
+    }
+
+    bool write_file(const std::string& filename, format as)
+    {
+        const std::string temporary = filename + ".tmp";
+        {
+            std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+            write(file, snapshot(), as);
+            if (!file.flush())
+            {
+                file.close();
+                std::remove(temporary.c_str());
+                return false;
+            }
+        }
+#ifdef _WIN32
+        // rename does not replace an existing file there
+        std::remove(filename.c_str());
+#endif
+        return std::rename(temporary.c_str(), filename.c_str()) == 0;
+    }
+
+    periodic_export::periodic_export(std::string filename, std::chrono::milliseconds interval, format as)
+        : filename_(std::move(filename)),
+          interval_(interval),
+          format_(as)
+    {
+        thread_ = std::thread([this]() {
+            std::unique_lock<std::mutex> lock(mutex_);
+            while (!wake_.wait_for(lock, interval_, [this]() { return stopping_; }))
+            {
+                write_file(filename_, format_);
+            }
+        });
+    }
+
+    periodic_export::~periodic_export()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_one();
+        thread_.join();
+        write_file(filename_, format_);
+    }
+}
@@ -0,0 +1,163 @@
+// pipeline_metrics.h : Throughput, stage latency and queue depth counters for the encryption pipeline.
+//
+// Each thread that records gets a slot of its own the first time it records, and only that thread
+// ever writes to it, so recording is a few relaxed loads and stores without a lock or a locked
+// instruction. A snapshot adds the slots up. Slots are cache line aligned so threads do not share
+// lines. A thread's counts are folded into a retired total when it exits, which frees its slot;
+// only claiming and freeing a slot and taking a snapshot take a lock. Threads beyond max_threads
+// share one more slot and update it atomically.
+//
+// Snapshots are written as Prometheus text (for the node_exporter textfile collector) or JSON, to a
+// file that is replaced in one rename so a reader never sees half of one. periodic_export does that
+// on an interval, so a batch job can be watched without attaching a profiler.
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace pipeline_metrics
+{
+    constexpr std::size_t max_threads = 256;
+
+    enum class stage
+    {
+        read,
+        transform,
+        write
+    };
+
+    constexpr std::size_t stage_count = 3;
+
+    const char* to_string(stage which) noexcept;
+
+    enum class format
+    {
+        prometheus,
+        json
+    };
+
+    struct stage_totals
+    {
+        std::uint64_t operations = 0;
+        std::uint64_t bytes = 0;
+        std::uint64_t nanoseconds = 0;
+        // longest single operation
+        std::uint64_t max_nanoseconds = 0;
+    };
+
+    struct totals
+    {
+        std::array<stage_totals, stage_count> stages{};
+        // requests in flight now, over every thread, and the most any one thread had at once
+        std::uint64_t queue_depth = 0;
+        std::uint64_t max_queue_depth = 0;
+        // threads holding a slot now
+        std::uint32_t threads = 0;
+    };
+
+    /// <summary>
+    /// Counts one operation of a stage on the calling thread.
+    /// </summary>
+    /// <param name="which">stage the operation belongs to</param>
+    /// <param name="bytes">bytes it processed</param>
+    /// <param name="nanoseconds">how long it took</param>
+    void record(stage which, std::uint64_t bytes, std::uint64_t nanoseconds) noexcept;
+
+    /// <summary>
+    /// Sets the number of requests the calling thread has in flight.
+    /// </summary>
+    void set_queue_depth(std::uint64_t depth) noexcept;
+
+    /// <summary>
+    /// Sum of every slot and of the threads that have exited.
+    /// </summary>
+    totals snapshot();
+
+    /// <summary>
+    /// Clears every counter. Counts a thread records while this runs may be lost.
+    /// </summary>
+    void reset();
+
+    /// <summary>
+    /// Writes a snapshot in the given format.
+    /// </summary>
+    void write(std::ostream& stream, const totals& values, format as);
+
+    /// <summary>
+    /// Writes a snapshot to filename + ".tmp" and renames it over filename.
+    /// </summary>
+    /// <returns>false when the file could not be written</returns>
+    bool write_file(const std::string& filename, format as);
+
+    /// <summary>
+    /// Times a scope and records it as one operation of a stage when it ends.
+    /// </summary>
+    class stage_timer
+    {
+    public:
+        explicit stage_timer(stage which, std::uint64_t bytes = 0) noexcept
+            : stage_(which),
+              bytes_(bytes),
+              start_(std::chrono::steady_clock::now())
+        {
+        }
+
+        ~stage_timer()
+        {
+            const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_);
+            record(stage_, bytes_, static_cast<std::uint64_t>(elapsed.count()));
+        }
+
+        stage_timer(const stage_timer&) = delete;
+        stage_timer& operator=(const stage_timer&) = delete;
+
+        // for a scope that only learns its size as it goes
+        void add_bytes(std::uint64_t bytes) noexcept { bytes_ += bytes; }
+
+    private:
+        stage stage_;
+        std::uint64_t bytes_;
+        std::chrono::steady_clock::time_point start_;
+    };
+
+    /// <summary>
+    /// Runs work as one operation of a stage over bytes bytes and returns what it returns.
+    /// </summary>
+    template <typename Work>
+    auto timed(stage which, std::uint64_t bytes, Work work) -> decltype(work())
+    {
+        stage_timer timer(which, bytes);
+        return work();
+    }
+
+    /// <summary>
+    /// Writes write_file() at a fixed interval on a background thread until destroyed, and once more
+    /// on destruction so the last interval is not lost.
+    /// </summary>
+    class periodic_export
+    {
+    public:
+        periodic_export(std::string filename, std::chrono::milliseconds interval, format as);
+        ~periodic_export();
+
+        periodic_export(const periodic_export&) = delete;
+        periodic_export& operator=(const periodic_export&) = delete;
+
+    private:
+        std::string filename_;
+        std::chrono::milliseconds interval_;
+        format format_;
+        std::mutex mutex_;
+        std::condition_variable wake_;
+        bool stopping_ = false;
+        std::thread thread_;
+    };
+}
@@ -0,0 +1,153 @@
+// pool_allocator.h : Size class block pool and a standard allocator that draws from it.
+//
+// Freed blocks are kept on per size class free lists instead of being handed back to the heap,
+// so containers that are repeatedly built up and torn down stop allocating once the pool is warm.
+
+#pragma once
+
+#include <cstddef>
+#include <new>
+
+/// <summary>
+/// Single threaded pool of power of two sized blocks. Blocks still owned by containers must be
+/// returned before the pool is destroyed.
+/// </summary>
+class block_pool
+{
+public:
+    block_pool() = default;
+    block_pool(const block_pool&) = delete;
+    block_pool& operator=(const block_pool&) = delete;
+
+    ~block_pool()
+    {
+        release();
+    }
+
+    /// <summary>
+    /// Hands out a block of at least bytes bytes, reusing a cached block of the same size class when one exists.
+    /// </summary>
+    /// <param name="bytes">number of bytes requested</param>
+    /// <returns>pointer to the block</returns>
+    void* allocate(std::size_t bytes)
+    {
+        const std::size_t index = size_class(bytes);
+        free_block* block = free_lists_[index];
+        if (block != nullptr)
+        {
+            free_lists_[index] = block->next;
+            return block;
+        }
+        return ::operator new(block_size(index));
+    }
+
+    /// <summary>
+    /// Returns a block to the free list of its size class.
+    /// </summary>
+    /// <param name="block">block previously returned by allocate</param>
+    /// <param name="bytes">the size that was passed to allocate</param>
+    void deallocate(void* block, std::size_t bytes) noexcept
+    {
+        if (block == nullptr)
+        {
+            return;
+        }
+        const std::size_t index = size_class(bytes);
+        free_lists_[index] = ::new (block) free_block{ free_lists_[index] };
+    }
+
+    /// <summary>
+    /// Gives every cached block back to the heap.
+    /// </summary>
+    void release() noexcept
+    {
+        for (auto& head : free_lists_)
+        {
+            while (head != nullptr)
+            {
+                free_block* next = head->next;
+                ::operator delete(head);
+                head = next;
+            }
+        }
+    }
+
+private:
+    struct free_block
+    {
+        free_block* next;
+    };
+
+    static constexpr std::size_t minimum_block = 16;
+    static constexpr std::size_t class_count = sizeof(std::size_t) * 8;
+
+    static std::size_t block_size(std::size_t index) noexcept
+    {
+        return minimum_block << index;
+    }
+
+    // index of the smallest power of two block that holds bytes
+    static std::size_t size_class(std::size_t bytes) noexcept
+    {
+        std::size_t index = 0;
+        while (block_size(index) < bytes)
+        {
+            ++index;
+        }
+        return index;
+    }
+
+    free_block* free_lists_[class_count] = {};
+};
+
+/// <summary>
+/// Standard allocator that draws its storage from a block_pool.
+/// </summary>
+/// <typeparam name="T">type of the allocated elements</typeparam>
+template <typename T>
+class pool_allocator
+{
+public:
+    using value_type = T;
+
+    explicit pool_allocator(block_pool& pool) noexcept
+        : pool_(&pool)
+    {
+    }
+
+    template <typename U>
+    pool_allocator(const pool_allocator<U>& other) noexcept
+        : pool_(other.pool())
+    {
+    }
+
+    T* allocate(std::size_t count)
+    {
+        return static_cast<T*>(pool_->allocate(count * sizeof(T)));
+    }
+
+    void deallocate(T* block, std::size_t count) noexcept
+    {
+        pool_->deallocate(block, count * sizeof(T));
+    }
+
+    block_pool* pool() const noexcept
+    {
+        return pool_;
+    }
+
+    template <typename U>
+    bool operator==(const pool_allocator<U>& other) const noexcept
+    {
+        return pool_ == other.pool();
+    }
+
+    template <typename U>
+    bool operator!=(const pool_allocator<U>& other) const noexcept
+    {
+        return pool_ != other.pool();
+    }
+
+private:
+    block_pool* pool_;
+};
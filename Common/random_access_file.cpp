@@ -0,0 +1,123 @@
+// random_access_file.cpp : pread / ReadFile behind random_access_file.
+//
+
+#include "random_access_file.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+random_access_file::~random_access_file()
+{
+    close();
+}
+
+bool random_access_file::open(const std::string& filename)
+{
+    close();
+
+#ifdef _WIN32
+    const HANDLE file = ::CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+    LARGE_INTEGER size;
+    if (!::GetFileSizeEx(file, &size))
+    {
+        ::CloseHandle(file);
+        return false;
+    }
+    handle_ = file;
+    size_ = static_cast<std::uint64_t>(size.QuadPart);
+#else
+    const int fd = ::open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return false;
+    }
+    struct stat status;
+    if (::fstat(fd, &status) != 0 || !S_ISREG(status.st_mode))
+    {
+        ::close(fd);
+        return false;
+    }
+    fd_ = fd;
+    size_ = static_cast<std::uint64_t>(status.st_size);
+#endif
+    return true;
+}
+
+void random_access_file::close() noexcept
+{
+#ifdef _WIN32
+    if (handle_ != nullptr)
+    {
+        ::CloseHandle(handle_);
+        handle_ = nullptr;
+    }
+#else
+    if (fd_ >= 0)
+    {
+        ::close(fd_);
+        fd_ = -1;
+    }
+#endif
+    size_ = 0;
+}
+
+bool random_access_file::is_open() const noexcept
+{
+#ifdef _WIN32
+    return handle_ != nullptr;
+#else
+    return fd_ >= 0;
+#endif
+}
+
+std::ptrdiff_t random_access_file::read_at(std::uint64_t offset, void* buffer, std::size_t size) const noexcept
+{
+    auto* bytes = static_cast<char*>(buffer);
+    std::size_t total = 0;
+    while (total < size)
+    {
+#ifdef _WIN32
+        // an OVERLAPPED offset on a synchronous handle reads at that position
+        OVERLAPPED position{};
+        const std::uint64_t at = offset + total;
+        position.Offset = static_cast<DWORD>(at);
+        position.OffsetHigh = static_cast<DWORD>(at >> 32);
+        const DWORD request = static_cast<DWORD>(size - total < 0x40000000 ? size - total : 0x40000000);
+        DWORD count = 0;
+        if (!::ReadFile(handle_, bytes + total, request, &count, &position))
+        {
+            if (::GetLastError() == ERROR_HANDLE_EOF)
+            {
+                break;
+            }
+            return -1;
+        }
+#else
+        const ssize_t count = ::pread(fd_, bytes + total, size - total, static_cast<off_t>(offset + total));
+        if (count < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return -1;
+        }
+#endif
+        if (count == 0)
+        {
+            break;
+        }
+        total += static_cast<std::size_t>(count);
+    }
+    return static_cast<std::ptrdiff_t>(total);
+}
@@ -0,0 +1,47 @@
+// random_access_file.h : Read only file read at explicit offsets.
+//
+// pread (ReadFile with an offset on Windows) reads from any position without a seek, so there is no
+// shared file position: several threads can read one descriptor at once, and reading a few bytes
+// from the middle of a large file costs only those bytes.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+class random_access_file
+{
+public:
+    random_access_file() noexcept = default;
+    random_access_file(const random_access_file&) = delete;
+    random_access_file& operator=(const random_access_file&) = delete;
+    ~random_access_file();
+
+    /// <summary>
+    /// Opens filename for reading, closing any file already open.
+    /// </summary>
+    /// <returns>false when the file cannot be opened</returns>
+    bool open(const std::string& filename);
+
+    void close() noexcept;
+
+    bool is_open() const noexcept;
+
+    // size of the file when it was opened
+    std::uint64_t size() const noexcept { return size_; }
+
+    /// <summary>
+    /// Reads up to size bytes starting at offset, retrying short reads.
+    /// </summary>
+    /// <returns>bytes read, fewer than size only at end of file, or -1 on error</returns>
+    std::ptrdiff_t read_at(std::uint64_t offset, void* buffer, std::size_t size) const noexcept;
+
+private:
+#ifdef _WIN32
+    void* handle_ = nullptr;
+#else
+    int fd_ = -1;
+#endif
+    std::uint64_t size_ = 0;
+};
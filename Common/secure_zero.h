@@ -0,0 +1,20 @@
+// secure_zero.h : Clearing key material so it does not outlive its use.
+//
+// A memset on a buffer that is about to go out of scope or be freed is a dead store the optimizer
+// is allowed to remove. Writing through a volatile pointer forces every byte to be stored.
+
+#pragma once
+
+#include <cstddef>
+
+/// <summary>
+/// Sets size bytes at data to zero, even when data is never read again.
+/// </summary>
+inline void secure_zero(void* data, std::size_t size) noexcept
+{
+    volatile unsigned char* bytes = static_cast<volatile unsigned char*>(data);
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        bytes[i] = 0;
+    }
+}
@@ -0,0 +1,318 @@
+// small_vector.h : Vector with inline storage for the first N elements.
+//
+// Collections that usually stay small never touch the heap; once they outgrow the inline buffer
+// they behave like std::vector and grow geometrically on the heap.
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <limits>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+/// <summary>
+/// Sequence container that stores up to N elements inline before falling back to the heap.
+/// Supports the subset of the std::vector interface exercised by the collection tests.
+/// </summary>
+/// <typeparam name="T">element type</typeparam>
+/// <typeparam name="N">number of elements stored inline</typeparam>
+template <typename T, std::size_t N>
+class small_vector
+{
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using reference = T&;
+    using const_reference = const T&;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    small_vector() noexcept = default;
+
+    small_vector(std::initializer_list<T> values)
+    {
+        reserve(values.size());
+        for (const auto& value : values)
+        {
+            push_back(value);
+        }
+    }
+
+    small_vector(const small_vector& other)
+    {
+        reserve(other.size_);
+        std::uninitialized_copy(other.begin(), other.end(), data_);
+        size_ = other.size_;
+    }
+
+    small_vector(small_vector&& other) noexcept(std::is_nothrow_move_constructible<T>::value)
+    {
+        take(std::move(other));
+    }
+
+    ~small_vector()
+    {
+        clear();
+        release_heap();
+    }
+
+    small_vector& operator=(const small_vector& other)
+    {
+        if (this != &other)
+        {
+            small_vector copy(other);
+            clear();
+            release_heap();
+            take(std::move(copy));
+        }
+        return *this;
+    }
+
+    small_vector& operator=(small_vector&& other) noexcept(std::is_nothrow_move_constructible<T>::value)
+    {
+        if (this != &other)
+        {
+            clear();
+            release_heap();
+            take(std::move(other));
+        }
+        return *this;
+    }
+
+    iterator begin() noexcept { return data_; }
+    iterator end() noexcept { return data_ + size_; }
+    const_iterator begin() const noexcept { return data_; }
+    const_iterator end() const noexcept { return data_ + size_; }
+
+    T* data() noexcept { return data_; }
+    const T* data() const noexcept { return data_; }
+
+    size_type size() const noexcept { return size_; }
+    size_type capacity() const noexcept { return capacity_; }
+    bool empty() const noexcept { return size_ == 0; }
+    size_type max_size() const noexcept { return std::numeric_limits<size_type>::max() / sizeof(T); }
+
+    // true while the elements still live in the inline buffer
+    bool is_inline() const noexcept { return data_ == inline_data(); }
+
+    reference operator[](size_type index) noexcept { return data_[index]; }
+    const_reference operator[](size_type index) const noexcept { return data_[index]; }
+
+    reference at(size_type index)
+    {
+        if (index >= size_)
+        {
+            throw std::out_of_range("small_vector::at index out of range");
+        }
+        return data_[index];
+    }
+
+    const_reference at(size_type index) const
+    {
+        if (index >= size_)
+        {
+            throw std::out_of_range("small_vector::at index out of range");
+        }
+        return data_[index];
+    }
+
+    reference front() noexcept { return data_[0]; }
+    reference back() noexcept { return data_[size_ - 1]; }
+
+    void push_back(const T& value) { emplace_back(value); }
+    void push_back(T&& value) { emplace_back(std::move(value)); }
+
+    template <typename... Args>
+    reference emplace_back(Args&&... args)
+    {
+        if (size_ == capacity_)
+        {
+            // construct into a temporary first in case args refer to one of our own elements
+            T value(std::forward<Args>(args)...);
+            relocate(next_capacity(size_ + 1));
+            ::new (static_cast<void*>(data_ + size_)) T(std::move(value));
+        }
+        else
+        {
+            ::new (static_cast<void*>(data_ + size_)) T(std::forward<Args>(args)...);
+        }
+        return data_[size_++];
+    }
+
+    void pop_back() noexcept
+    {
+        --size_;
+        data_[size_].~T();
+    }
+
+    void reserve(size_type new_capacity)
+    {
+        if (new_capacity > capacity_)
+        {
+            relocate(new_capacity);
+        }
+    }
+
+    void resize(size_type new_size)
+    {
+        resize_with(new_size, [](T* slot) { ::new (static_cast<void*>(slot)) T(); });
+    }
+
+    void resize(size_type new_size, const T& value)
+    {
+        resize_with(new_size, [&value](T* slot) { ::new (static_cast<void*>(slot)) T(value); });
+    }
+
+    void clear() noexcept
+    {
+        destroy(data_, data_ + size_);
+        size_ = 0;
+    }
+
+    // moves the elements back into the inline buffer when they fit, otherwise into an exactly sized heap block
+    void shrink_to_fit()
+    {
+        if (is_inline() || size_ == capacity_)
+        {
+            return;
+        }
+        relocate(size_);
+    }
+
+    iterator erase(const_iterator position)
+    {
+        return erase(position, position + 1);
+    }
+
+    iterator erase(const_iterator first, const_iterator last)
+    {
+        iterator target = data_ + (first - data_);
+        iterator source = data_ + (last - data_);
+        if (target != source)
+        {
+            iterator new_end = std::move(source, end(), target);
+            destroy(new_end, end());
+            size_ -= static_cast<size_type>(source - target);
+        }
+        return target;
+    }
+
+private:
+    T* inline_data() noexcept { return reinterpret_cast<T*>(buffer_); }
+    const T* inline_data() const noexcept { return reinterpret_cast<const T*>(buffer_); }
+
+    size_type next_capacity(size_type required) const noexcept
+    {
+        return std::max(required, capacity_ * 2);
+    }
+
+    static void destroy(T* first, T* last) noexcept
+    {
+        for (; first != last; ++first)
+        {
+            first->~T();
+        }
+    }
+
+    template <typename Construct>
+    void resize_with(size_type new_size, Construct construct)
+    {
+        if (new_size < size_)
+        {
+            destroy(data_ + new_size, data_ + size_);
+            size_ = new_size;
+            return;
+        }
+
+        // grow like emplace_back, so growing one element at a time stays amortized constant
+        if (new_size > capacity_)
+        {
+            relocate(next_capacity(new_size));
+        }
+        for (; size_ < new_size; ++size_)
+        {
+            construct(data_ + size_);
+        }
+    }
+
+    // moves the elements into storage for new_capacity elements, the inline buffer when it is large
+    // enough. The new storage is filled completely before anything is given up: if a copy throws,
+    // the elements and storage are left as they were (a throwing move of a type that cannot be
+    // copied may have moved from some of them, as with std::vector)
+    void relocate(size_type new_capacity)
+    {
+        T* destination = new_capacity <= N
+            ? inline_data()
+            : static_cast<T*>(::operator new(new_capacity * sizeof(T), std::align_val_t(alignof(T))));
+
+        if (destination == data_)
+        {
+            return;
+        }
+
+        size_type built = 0;
+        try
+        {
+            for (; built < size_; ++built)
+            {
+                ::new (static_cast<void*>(destination + built)) T(std::move_if_noexcept(data_[built]));
+            }
+        }
+        catch (...)
+        {
+            destroy(destination, destination + built);
+            if (destination != inline_data())
+            {
+                ::operator delete(destination, std::align_val_t(alignof(T)));
+            }
+            throw;
+        }
+        destroy(data_, data_ + size_);
+        release_heap();
+
+        data_ = destination;
+        capacity_ = new_capacity <= N ? N : new_capacity;
+    }
+
+    void release_heap() noexcept
+    {
+        if (!is_inline())
+        {
+            ::operator delete(data_, std::align_val_t(alignof(T)));
+            data_ = inline_data();
+            capacity_ = N;
+        }
+    }
+
+    // steals the heap block of other, or moves its inline elements one by one
+    void take(small_vector&& other)
+    {
+        if (other.is_inline())
+        {
+            for (size_type i = 0; i < other.size_; ++i)
+            {
+                ::new (static_cast<void*>(inline_data() + i)) T(std::move(other.data_[i]));
+            }
+            size_ = other.size_;
+            other.clear();
+            return;
+        }
+
+        data_ = other.data_;
+        size_ = other.size_;
+        capacity_ = other.capacity_;
+        other.data_ = other.inline_data();
+        other.size_ = 0;
+        other.capacity_ = N;
+    }
+
+    alignas(T) unsigned char buffer_[N * sizeof(T)];
+    T* data_ = inline_data();
+    size_type size_ = 0;
+    size_type capacity_ = N;
+};
@@ -1,49 +1,25 @@
 // Encryption.cpp : This file contains the 'main' function. Program execution begins and ends there.
 //
 
+#include <algorithm>
 #include <cassert>
+#include <cstdlib>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <memory>
 #include <sstream>
-#include <ctime>
-
-/// <summary>
-/// encrypt or decrypt a source string using the provided key
-/// </summary>
-/// <param name="source">input string to process</param>
-/// <param name="key">key to use in encryption / decryption</param>
-/// <returns>transformed string</returns>
-std::string encrypt_decrypt(const std::string& source, const std::string& key)
-{
-    // get lengths now instead of calling the function every time.
-    // this would have most likely been inlined by the compiler, but design for perfomance.
-    const auto key_length = key.length();
-    const auto source_length = source.length();
-
-    // assert that our input data is good
-    assert(key_length > 0);
-    assert(source_length > 0);
-
-    std::string output = source;
-
-    // loop through the source string char by char
-    for (size_t i = 0; i < source_length; ++i)
-    { // TODO: student need to change the next line from output[i] = source[i]
-      // transform each character based on an xor of the key modded constrained to key length using a mod
-        output[i] = source[i] ^ key[i % key_length];
-    }
-
-    // our output length must equal our source length
-    assert(output.length() == source_length);
 
-    // return the transformed string
-    return output;
-}
+#include "cipher.h"
+#include "data_container.h"
+#include "date_stamp.h"
+#include "input_header.h"
+#include "pipeline_metrics.h"
 
 std::string read_file(const std::string& filename)
 {
     std::string file_text = "John Q. Smith\nThis is my test string";
+    pipeline_metrics::stage_timer timer(pipeline_metrics::stage::read);
 	
     // TODO: implement loading the file into a string
 
@@ -60,6 +36,7 @@ std::string read_file(const std::string& filename)
 
 		// Assign the contents of file_text to the string value of the input file.
         file_text = buffer.str();
+        timer.add_bytes(file_text.size());
 	}
 
     return file_text;
@@ -67,50 +44,43 @@ std::string read_file(const std::string& filename)
 
 std::string get_student_name(const std::string& string_data)
 {
-    std::string student_name;
-
-    // find the first newline
-    size_t pos = string_data.find('\n');
-    // did we find a newline
-    if (pos != std::string::npos)
-    { // we did, so copy that substring as the student name
-        student_name = string_data.substr(0, pos);
+    // only the header lines are looked at, however long the file
+    const auto header = parse_input_header(string_data.data(), string_data.size());
+    if (!header)
+    {
+        return std::string();
     }
 
-    return student_name;
+    return std::string(header->student_name);
 }
 
-void save_data_file(const std::string& filename, const std::string& student_name, const std::string& key, const std::string& data)
+void save_data_file(const std::string& filename, const std::string& student_name, const std::string& key_id, const std::string& cipher,
+    const std::string& data)
 {
     //  TODO: implement file saving
     //  file format
     //  Line 1: student name
     //  Line 2: timestamp (yyyy-mm-dd)
-    //  Line 3: key used
-    //  Line 4+: data
+    //  Line 3: id of the key used, never the key itself
+    //  Line 4: cipher and its parameters
+    //  Line 5+: data
     std::ofstream outputFile;
+    pipeline_metrics::stage_timer timer(pipeline_metrics::stage::write, data.size());
 
     outputFile.open(filename);
 	
     if (outputFile.is_open())
     {
-    	// Get localtime using localtime_s because localtime is deprecated and unsafe.
-        struct std::tm localTime;
-        time_t currentTime = time(nullptr);
-
-    	::localtime_s(&localTime, &currentTime);
-
-    	// Extract Year/Month/Day from localTime. Add 1900 to year because tm_year returned the number of years
-    	// since 1900. Add 1 to tm_mon because month returned is based on a 0 index.
-        int year = localTime.tm_year + 1900;
-        int day = localTime.tm_mday;
-        int month = localTime.tm_mon + 1;
-
+    	// Today's date as yyyy-mm-dd. The thread's cached date is reused until the day rolls over, so
+    	// writing many files does not convert the time to local time for every one of them.
+        char timestamp[date_stamp_length + 1];
+        date_stamp(timestamp, sizeof(timestamp));
 
     	// Format message
         outputFile << "Student Name: " << student_name << "\n"
-    		<< "Timestamp: " << year << "-" << month << "-" << day << "\n"
-            << "Key Used: " << key << "\n"
+    		<< "Timestamp: " << timestamp << "\n"
+            << "Key Id: " << key_id << "\n"
+            << "Cipher: " << cipher << "\n"
             << "Data: " << data;
 
     	// Close output file to dispose of stream.
@@ -118,10 +88,40 @@ void save_data_file(const std::string& filename, const std::string& student_name
     }   
 }
 
-int main()
+int main(int argc, char* argv[])
 {
     std::cout << "Encyption Decryption Test!" << std::endl;
 
+    // --metrics=FILE writes the read, transform and write counters to FILE every
+    // --metrics-interval=MS milliseconds (1000) and on exit, as JSON when FILE ends in .json and as
+    // Prometheus text otherwise
+    std::string metrics_file;
+    long metrics_interval = 1000;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string argument = argv[i];
+        if (argument.compare(0, 10, "--metrics=") == 0)
+        {
+            metrics_file = argument.substr(10);
+        }
+        else if (argument.compare(0, 19, "--metrics-interval=") == 0)
+        {
+            metrics_interval = std::max(1L, std::strtol(argument.c_str() + 19, nullptr, 10));
+        }
+        else
+        {
+            std::cerr << "usage: Encryption [--metrics=FILE] [--metrics-interval=MS]" << std::endl;
+            return 2;
+        }
+    }
+    std::unique_ptr<pipeline_metrics::periodic_export> metrics;
+    if (!metrics_file.empty())
+    {
+        const bool json = metrics_file.size() >= 5 && metrics_file.compare(metrics_file.size() - 5, 5, ".json") == 0;
+        metrics.reset(new pipeline_metrics::periodic_export(metrics_file, std::chrono::milliseconds(metrics_interval),
+            json ? pipeline_metrics::format::json : pipeline_metrics::format::prometheus));
+    }
+
     // input file format
     // Line 1: <students name>
     // Line 2: <Lorem Ipsum Generator website used> https://pirateipsum.me/ (could be https://www.lipsum.com/ or one of https://www.shopify.com/partners/blog/79940998-15-funny-lorem-ipsum-generators-to-shake-up-your-design-mockups)
@@ -133,27 +133,57 @@ int main()
     const std::string file_name = "inputdatafile.txt";
     const std::string encrypted_file_name = "encrypteddatafile.txt";
     const std::string decrypted_file_name = "decrytpteddatafile.txt";
+    const std::string container_file_name = "encrypteddatafile.scd";
     const std::string source_string = read_file(file_name);
-    const std::string key = "password";
+    const std::string password = "password";
 
     // get the student name from the data file
     const std::string student_name = get_student_name(source_string);
 
+    // derive the key once, under a fresh salt, for both directions
+    const cipher_key key(cipher_mode::chacha20_poly1305, password);
+
     // encrypt sourceString with key
-    const std::string encrypted_string = encrypt_decrypt(source_string, key);
+    cipher_header header;
+    const std::string encrypted_string = pipeline_metrics::timed(pipeline_metrics::stage::transform, source_string.size(), [&]() {
+        return encrypt(key, source_string, header);
+    });
 
     // save encrypted_string to file
-    save_data_file(encrypted_file_name, student_name, key, encrypted_string);
+    save_data_file(encrypted_file_name, student_name, key.id_string(), to_string(header), encrypted_string);
 
-    // decrypt encryptedString with key
-    const std::string decrypted_string = encrypt_decrypt(encrypted_string, key);
+    // decrypt encryptedString with key, which also checks it was not altered
+    std::string decrypted_string;
+    if (!pipeline_metrics::timed(pipeline_metrics::stage::transform, encrypted_string.size(), [&]() {
+            return decrypt(key, header, encrypted_string, decrypted_string);
+        }))
+    {
+        std::cout << "Decryption failed: the data does not match its authentication tag" << std::endl;
+        return 1;
+    }
 
     // save decrypted_string to file
-    save_data_file(decrypted_file_name, student_name, key, decrypted_string);
+    save_data_file(decrypted_file_name, student_name, key.id_string(), "none", decrypted_string);
+
+    // the same data in the binary container, read back through a mapping and decrypted chunk by chunk
+    container_file container;
+    auto stored = write_container(container_file_name, student_name, key, source_string);
+    if (stored)
+    {
+        stored = container.open(container_file_name);
+    }
+    const auto restored = stored ? container.view().decrypt_all(key) : expected<std::string, container_error>(unexpected(stored.error()));
+    if (!restored || *restored != source_string)
+    {
+        std::cout << "Container " << container_file_name << " failed: " << (restored ? "data differs" : to_string(restored.error())) << std::endl;
+        return 1;
+    }
 
-    std::cout << "Read File: " << file_name << " - Encrypted To: " << encrypted_file_name << " - Decrypted To: " << decrypted_file_name << std::endl;
+    std::cout << "Read File: " << file_name << " - Encrypted To: " << encrypted_file_name << " - Decrypted To: " << decrypted_file_name
+              << " - Container: " << container_file_name << std::endl;
 
     // students submit input file, encrypted file, decrypted file, source code file, and key used
+    return 0;
 }
 
 // Run program: Ctrl + F5 or Debug > Start Without Debugging menu
@@ -0,0 +1,576 @@
+// chacha20_poly1305.cpp : Scalar, SSE2 and AVX2 ChaCha20 kernels and Poly1305 behind the RFC 8439 AEAD.
+//
+
+#include "chacha20_poly1305.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "secure_zero.h"
+
+#if defined(__AVX2__)
+#define CHACHA20_WIDTH 8
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CHACHA20_WIDTH 4
+#else
+#define CHACHA20_WIDTH 1
+#endif
+
+#if CHACHA20_WIDTH > 1
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    // plaintext is encrypted and authenticated in slices of this size, so each slice is still in the
+    // cache when Poly1305 reads it back; a multiple of the 64 byte block
+    constexpr std::size_t slice_size = 16 * 1024;
+
+    std::uint32_t load32(const std::uint8_t* bytes) noexcept
+    {
+        return static_cast<std::uint32_t>(bytes[0]) | static_cast<std::uint32_t>(bytes[1]) << 8 |
+            static_cast<std::uint32_t>(bytes[2]) << 16 | static_cast<std::uint32_t>(bytes[3]) << 24;
+    }
+
+    void store32(std::uint8_t* bytes, std::uint32_t value) noexcept
+    {
+        bytes[0] = static_cast<std::uint8_t>(value);
+        bytes[1] = static_cast<std::uint8_t>(value >> 8);
+        bytes[2] = static_cast<std::uint8_t>(value >> 16);
+        bytes[3] = static_cast<std::uint8_t>(value >> 24);
+    }
+
+    void store64(std::uint8_t* bytes, std::uint64_t value) noexcept
+    {
+        store32(bytes, static_cast<std::uint32_t>(value));
+        store32(bytes + 4, static_cast<std::uint32_t>(value >> 32));
+    }
+
+    std::uint32_t rotate(std::uint32_t value, int count) noexcept
+    {
+        return value << count | value >> (32 - count);
+    }
+
+    // "expand 32-byte k", the key, the block counter and the nonce
+    void initial_state(const std::uint8_t* key, const std::uint8_t* nonce, std::uint32_t counter, std::uint32_t* state) noexcept
+    {
+        state[0] = 0x61707865;
+        state[1] = 0x3320646e;
+        state[2] = 0x79622d32;
+        state[3] = 0x6b206574;
+        for (int i = 0; i < 8; ++i)
+        {
+            state[4 + i] = load32(key + 4 * i);
+        }
+        state[12] = counter;
+        for (int i = 0; i < 3; ++i)
+        {
+            state[13 + i] = load32(nonce + 4 * i);
+        }
+    }
+
+#define CHACHA_QUARTER_ROUND(a, b, c, d) \
+    a += b; d = rotate(d ^ a, 16);       \
+    c += d; b = rotate(b ^ c, 12);       \
+    a += b; d = rotate(d ^ a, 8);        \
+    c += d; b = rotate(b ^ c, 7)
+
+    void block_scalar(const std::uint32_t* state, std::uint8_t* keystream) noexcept
+    {
+        std::uint32_t x[16];
+        std::memcpy(x, state, sizeof(x));
+        for (int round = 0; round < 10; ++round)
+        {
+            CHACHA_QUARTER_ROUND(x[0], x[4], x[8], x[12]);
+            CHACHA_QUARTER_ROUND(x[1], x[5], x[9], x[13]);
+            CHACHA_QUARTER_ROUND(x[2], x[6], x[10], x[14]);
+            CHACHA_QUARTER_ROUND(x[3], x[7], x[11], x[15]);
+            CHACHA_QUARTER_ROUND(x[0], x[5], x[10], x[15]);
+            CHACHA_QUARTER_ROUND(x[1], x[6], x[11], x[12]);
+            CHACHA_QUARTER_ROUND(x[2], x[7], x[8], x[13]);
+            CHACHA_QUARTER_ROUND(x[3], x[4], x[9], x[14]);
+        }
+        for (int i = 0; i < 16; ++i)
+        {
+            store32(keystream + 4 * i, x[i] + state[i]);
+        }
+        secure_zero(x, sizeof(x));
+    }
+
+#undef CHACHA_QUARTER_ROUND
+
+    // the vector kernels hold word i of several consecutive blocks in the lanes of register x[i], so a
+    // quarter round is the same 12 instructions as the scalar form, just on 4 or 8 blocks at once
+#define CHACHA_VECTOR_QUARTER_ROUND(a, b, c, d)                \
+    a = VECTOR_ADD(a, b); d = VECTOR_ROTATE16(VECTOR_XOR(d, a)); \
+    c = VECTOR_ADD(c, d); b = VECTOR_ROTATE12(VECTOR_XOR(b, c)); \
+    a = VECTOR_ADD(a, b); d = VECTOR_ROTATE8(VECTOR_XOR(d, a));  \
+    c = VECTOR_ADD(c, d); b = VECTOR_ROTATE7(VECTOR_XOR(b, c))
+
+#define CHACHA_VECTOR_ROUNDS()                                    \
+    for (int round = 0; round < 10; ++round)                      \
+    {                                                             \
+        CHACHA_VECTOR_QUARTER_ROUND(x[0], x[4], x[8], x[12]);     \
+        CHACHA_VECTOR_QUARTER_ROUND(x[1], x[5], x[9], x[13]);     \
+        CHACHA_VECTOR_QUARTER_ROUND(x[2], x[6], x[10], x[14]);    \
+        CHACHA_VECTOR_QUARTER_ROUND(x[3], x[7], x[11], x[15]);    \
+        CHACHA_VECTOR_QUARTER_ROUND(x[0], x[5], x[10], x[15]);    \
+        CHACHA_VECTOR_QUARTER_ROUND(x[1], x[6], x[11], x[12]);    \
+        CHACHA_VECTOR_QUARTER_ROUND(x[2], x[7], x[8], x[13]);     \
+        CHACHA_VECTOR_QUARTER_ROUND(x[3], x[4], x[9], x[14]);     \
+    }
+
+#if CHACHA20_WIDTH > 1
+    template <int count>
+    __m128i rotate_128(__m128i value) noexcept
+    {
+        return _mm_or_si128(_mm_slli_epi32(value, count), _mm_srli_epi32(value, 32 - count));
+    }
+
+    // 4 blocks, 256 bytes of input
+    void xor_blocks_sse2(const std::uint32_t* state, const std::uint8_t* input, std::uint8_t* output) noexcept
+    {
+        __m128i x[16];
+        __m128i initial[16];
+        for (int i = 0; i < 16; ++i)
+        {
+            initial[i] = _mm_set1_epi32(static_cast<int>(state[i]));
+        }
+        initial[12] = _mm_add_epi32(initial[12], _mm_set_epi32(3, 2, 1, 0));
+        std::memcpy(x, initial, sizeof(x));
+
+#define VECTOR_ADD _mm_add_epi32
+#define VECTOR_XOR _mm_xor_si128
+#define VECTOR_ROTATE16 rotate_128<16>
+#define VECTOR_ROTATE12 rotate_128<12>
+#define VECTOR_ROTATE8 rotate_128<8>
+#define VECTOR_ROTATE7 rotate_128<7>
+        CHACHA_VECTOR_ROUNDS()
+#undef VECTOR_ADD
+#undef VECTOR_XOR
+#undef VECTOR_ROTATE16
+#undef VECTOR_ROTATE12
+#undef VECTOR_ROTATE8
+#undef VECTOR_ROTATE7
+
+        // transpose each group of 4 words from one block per lane to one block per register
+        for (int group = 0; group < 4; ++group)
+        {
+            const __m128i a = _mm_add_epi32(x[4 * group], initial[4 * group]);
+            const __m128i b = _mm_add_epi32(x[4 * group + 1], initial[4 * group + 1]);
+            const __m128i c = _mm_add_epi32(x[4 * group + 2], initial[4 * group + 2]);
+            const __m128i d = _mm_add_epi32(x[4 * group + 3], initial[4 * group + 3]);
+            const __m128i ab_low = _mm_unpacklo_epi32(a, b);
+            const __m128i cd_low = _mm_unpacklo_epi32(c, d);
+            const __m128i ab_high = _mm_unpackhi_epi32(a, b);
+            const __m128i cd_high = _mm_unpackhi_epi32(c, d);
+            const __m128i blocks[4] = { _mm_unpacklo_epi64(ab_low, cd_low), _mm_unpackhi_epi64(ab_low, cd_low),
+                _mm_unpacklo_epi64(ab_high, cd_high), _mm_unpackhi_epi64(ab_high, cd_high) };
+            for (int block = 0; block < 4; ++block)
+            {
+                const std::size_t offset = 64 * block + 16 * group;
+                const __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + offset));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(output + offset), _mm_xor_si128(data, blocks[block]));
+            }
+        }
+    }
+#endif
+
+#if CHACHA20_WIDTH == 8
+    template <int count>
+    __m256i rotate_256(__m256i value) noexcept
+    {
+        return _mm256_or_si256(_mm256_slli_epi32(value, count), _mm256_srli_epi32(value, 32 - count));
+    }
+
+    // rotations by whole bytes are a single byte shuffle
+    __m256i rotate_256_16(__m256i value) noexcept
+    {
+        const __m256i order = _mm256_set_epi8(13, 12, 15, 14, 9, 8, 11, 10, 5, 4, 7, 6, 1, 0, 3, 2,
+            13, 12, 15, 14, 9, 8, 11, 10, 5, 4, 7, 6, 1, 0, 3, 2);
+        return _mm256_shuffle_epi8(value, order);
+    }
+
+    __m256i rotate_256_8(__m256i value) noexcept
+    {
+        const __m256i order = _mm256_set_epi8(14, 13, 12, 15, 10, 9, 8, 11, 6, 5, 4, 7, 2, 1, 0, 3,
+            14, 13, 12, 15, 10, 9, 8, 11, 6, 5, 4, 7, 2, 1, 0, 3);
+        return _mm256_shuffle_epi8(value, order);
+    }
+
+    // 8 blocks, 512 bytes of input
+    void xor_blocks_avx2(const std::uint32_t* state, const std::uint8_t* input, std::uint8_t* output) noexcept
+    {
+        __m256i x[16];
+        __m256i initial[16];
+        for (int i = 0; i < 16; ++i)
+        {
+            initial[i] = _mm256_set1_epi32(static_cast<int>(state[i]));
+        }
+        initial[12] = _mm256_add_epi32(initial[12], _mm256_set_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+        std::memcpy(x, initial, sizeof(x));
+
+#define VECTOR_ADD _mm256_add_epi32
+#define VECTOR_XOR _mm256_xor_si256
+#define VECTOR_ROTATE16 rotate_256_16
+#define VECTOR_ROTATE12 rotate_256<12>
+#define VECTOR_ROTATE8 rotate_256_8
+#define VECTOR_ROTATE7 rotate_256<7>
+        CHACHA_VECTOR_ROUNDS()
+#undef VECTOR_ADD
+#undef VECTOR_XOR
+#undef VECTOR_ROTATE16
+#undef VECTOR_ROTATE12
+#undef VECTOR_ROTATE8
+#undef VECTOR_ROTATE7
+
+        // the 4 x 4 transpose works within each 128 bit half, so blocks[group][b] holds words
+        // 4 * group .. 4 * group + 3 of block b in its low half and of block b + 4 in its high half
+        __m256i blocks[4][4];
+        for (int group = 0; group < 4; ++group)
+        {
+            const __m256i a = _mm256_add_epi32(x[4 * group], initial[4 * group]);
+            const __m256i b = _mm256_add_epi32(x[4 * group + 1], initial[4 * group + 1]);
+            const __m256i c = _mm256_add_epi32(x[4 * group + 2], initial[4 * group + 2]);
+            const __m256i d = _mm256_add_epi32(x[4 * group + 3], initial[4 * group + 3]);
+            const __m256i ab_low = _mm256_unpacklo_epi32(a, b);
+            const __m256i cd_low = _mm256_unpacklo_epi32(c, d);
+            const __m256i ab_high = _mm256_unpackhi_epi32(a, b);
+            const __m256i cd_high = _mm256_unpackhi_epi32(c, d);
+            blocks[group][0] = _mm256_unpacklo_epi64(ab_low, cd_low);
+            blocks[group][1] = _mm256_unpackhi_epi64(ab_low, cd_low);
+            blocks[group][2] = _mm256_unpacklo_epi64(ab_high, cd_high);
+            blocks[group][3] = _mm256_unpackhi_epi64(ab_high, cd_high);
+        }
+
+        // join the halves of neighbouring groups into the 32 byte runs of each block
+        for (int block = 0; block < 4; ++block)
+        {
+            for (int pair = 0; pair < 2; ++pair)
+            {
+                const __m256i first = blocks[2 * pair][block];
+                const __m256i second = blocks[2 * pair + 1][block];
+                const std::size_t low = 64 * block + 32 * pair;
+                const std::size_t high = 64 * (block + 4) + 32 * pair;
+                const __m256i low_data = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + low));
+                const __m256i high_data = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + high));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + low), _mm256_xor_si256(low_data, _mm256_permute2x128_si256(first, second, 0x20)));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + high), _mm256_xor_si256(high_data, _mm256_permute2x128_si256(first, second, 0x31)));
+            }
+        }
+    }
+#endif
+
+#undef CHACHA_VECTOR_ROUNDS
+#undef CHACHA_VECTOR_QUARTER_ROUND
+
+    // Poly1305 with the accumulator and r in five 26 bit limbs, so every product fits in 64 bits
+    struct poly1305_state
+    {
+        std::uint32_t r[5];
+        std::uint32_t h[5];
+        std::uint32_t pad[4];
+        std::uint8_t buffer[16];
+        std::size_t buffered;
+    };
+
+    void poly1305_init(poly1305_state& state, const std::uint8_t* key) noexcept
+    {
+        // r is clamped as the specification requires
+        state.r[0] = load32(key) & 0x3ffffff;
+        state.r[1] = (load32(key + 3) >> 2) & 0x3ffff03;
+        state.r[2] = (load32(key + 6) >> 4) & 0x3ffc0ff;
+        state.r[3] = (load32(key + 9) >> 6) & 0x3f03fff;
+        state.r[4] = (load32(key + 12) >> 8) & 0x00fffff;
+        for (int i = 0; i < 5; ++i)
+        {
+            state.h[i] = 0;
+        }
+        for (int i = 0; i < 4; ++i)
+        {
+            state.pad[i] = load32(key + 16 + 4 * i);
+        }
+        state.buffered = 0;
+    }
+
+    // h = (h + block) * r mod 2^130 - 5 for each 16 byte block; high_bit is 1 << 24 for full blocks
+    void poly1305_blocks(poly1305_state& state, const std::uint8_t* message, std::size_t size, std::uint32_t high_bit) noexcept
+    {
+        const std::uint32_t r0 = state.r[0], r1 = state.r[1], r2 = state.r[2], r3 = state.r[3], r4 = state.r[4];
+        const std::uint32_t s1 = r1 * 5, s2 = r2 * 5, s3 = r3 * 5, s4 = r4 * 5;
+        std::uint32_t h0 = state.h[0], h1 = state.h[1], h2 = state.h[2], h3 = state.h[3], h4 = state.h[4];
+
+        for (; size >= 16; message += 16, size -= 16)
+        {
+            h0 += load32(message) & 0x3ffffff;
+            h1 += (load32(message + 3) >> 2) & 0x3ffffff;
+            h2 += (load32(message + 6) >> 4) & 0x3ffffff;
+            h3 += (load32(message + 9) >> 6) & 0x3ffffff;
+            h4 += (load32(message + 12) >> 8) | high_bit;
+
+            const std::uint64_t d0 = std::uint64_t(h0) * r0 + std::uint64_t(h1) * s4 + std::uint64_t(h2) * s3 + std::uint64_t(h3) * s2 + std::uint64_t(h4) * s1;
+            std::uint64_t d1 = std::uint64_t(h0) * r1 + std::uint64_t(h1) * r0 + std::uint64_t(h2) * s4 + std::uint64_t(h3) * s3 + std::uint64_t(h4) * s2;
+            std::uint64_t d2 = std::uint64_t(h0) * r2 + std::uint64_t(h1) * r1 + std::uint64_t(h2) * r0 + std::uint64_t(h3) * s4 + std::uint64_t(h4) * s3;
+            std::uint64_t d3 = std::uint64_t(h0) * r3 + std::uint64_t(h1) * r2 + std::uint64_t(h2) * r1 + std::uint64_t(h3) * r0 + std::uint64_t(h4) * s4;
+            std::uint64_t d4 = std::uint64_t(h0) * r4 + std::uint64_t(h1) * r3 + std::uint64_t(h2) * r2 + std::uint64_t(h3) * r1 + std::uint64_t(h4) * r0;
+
+            // partial carry propagation, enough to keep every limb within 26 bits plus a little
+            std::uint32_t carry = static_cast<std::uint32_t>(d0 >> 26);
+            h0 = static_cast<std::uint32_t>(d0) & 0x3ffffff;
+            d1 += carry;
+            carry = static_cast<std::uint32_t>(d1 >> 26);
+            h1 = static_cast<std::uint32_t>(d1) & 0x3ffffff;
+            d2 += carry;
+            carry = static_cast<std::uint32_t>(d2 >> 26);
+            h2 = static_cast<std::uint32_t>(d2) & 0x3ffffff;
+            d3 += carry;
+            carry = static_cast<std::uint32_t>(d3 >> 26);
+            h3 = static_cast<std::uint32_t>(d3) & 0x3ffffff;
+            d4 += carry;
+            carry = static_cast<std::uint32_t>(d4 >> 26);
+            h4 = static_cast<std::uint32_t>(d4) & 0x3ffffff;
+            h0 += carry * 5;
+            carry = h0 >> 26;
+            h0 &= 0x3ffffff;
+            h1 += carry;
+        }
+
+        state.h[0] = h0;
+        state.h[1] = h1;
+        state.h[2] = h2;
+        state.h[3] = h3;
+        state.h[4] = h4;
+    }
+
+    void poly1305_update(poly1305_state& state, const std::uint8_t* message, std::size_t size) noexcept
+    {
+        if (state.buffered != 0)
+        {
+            const std::size_t count = std::min(size, 16 - state.buffered);
+            std::memcpy(state.buffer + state.buffered, message, count);
+            state.buffered += count;
+            message += count;
+            size -= count;
+            if (state.buffered < 16)
+            {
+                return;
+            }
+            poly1305_blocks(state, state.buffer, 16, 1u << 24);
+            state.buffered = 0;
+        }
+
+        const std::size_t whole = size & ~static_cast<std::size_t>(15);
+        poly1305_blocks(state, message, whole, 1u << 24);
+        std::memcpy(state.buffer, message + whole, size - whole);
+        state.buffered = size - whole;
+    }
+
+    void poly1305_finish(poly1305_state& state, std::uint8_t* tag) noexcept
+    {
+        // a final short block is followed by a 1 byte and zero padding instead of the high bit
+        if (state.buffered != 0)
+        {
+            state.buffer[state.buffered] = 1;
+            std::memset(state.buffer + state.buffered + 1, 0, 16 - state.buffered - 1);
+            poly1305_blocks(state, state.buffer, 16, 0);
+        }
+
+        std::uint32_t h0 = state.h[0], h1 = state.h[1], h2 = state.h[2], h3 = state.h[3], h4 = state.h[4];
+
+        // full carry propagation
+        std::uint32_t carry = h1 >> 26;
+        h1 &= 0x3ffffff;
+        h2 += carry;
+        carry = h2 >> 26;
+        h2 &= 0x3ffffff;
+        h3 += carry;
+        carry = h3 >> 26;
+        h3 &= 0x3ffffff;
+        h4 += carry;
+        carry = h4 >> 26;
+        h4 &= 0x3ffffff;
+        h0 += carry * 5;
+        carry = h0 >> 26;
+        h0 &= 0x3ffffff;
+        h1 += carry;
+
+        // g = h + 5 - 2^130, taken instead of h when it does not go negative, without a branch
+        std::uint32_t g0 = h0 + 5;
+        carry = g0 >> 26;
+        g0 &= 0x3ffffff;
+        std::uint32_t g1 = h1 + carry;
+        carry = g1 >> 26;
+        g1 &= 0x3ffffff;
+        std::uint32_t g2 = h2 + carry;
+        carry = g2 >> 26;
+        g2 &= 0x3ffffff;
+        std::uint32_t g3 = h3 + carry;
+        carry = g3 >> 26;
+        g3 &= 0x3ffffff;
+        const std::uint32_t g4 = h4 + carry - (1u << 26);
+
+        const std::uint32_t use_g = (g4 >> 31) - 1;
+        h0 = (h0 & ~use_g) | (g0 & use_g);
+        h1 = (h1 & ~use_g) | (g1 & use_g);
+        h2 = (h2 & ~use_g) | (g2 & use_g);
+        h3 = (h3 & ~use_g) | (g3 & use_g);
+        h4 = (h4 & ~use_g) | (g4 & use_g);
+
+        // back to four 32 bit words, then add the pad mod 2^128
+        const std::uint32_t words[4] = { h0 | h1 << 26, h1 >> 6 | h2 << 20, h2 >> 12 | h3 << 14, h3 >> 18 | h4 << 8 };
+        std::uint64_t sum = 0;
+        for (int i = 0; i < 4; ++i)
+        {
+            sum = static_cast<std::uint64_t>(words[i]) + state.pad[i] + (sum >> 32);
+            store32(tag + 4 * i, static_cast<std::uint32_t>(sum));
+        }
+
+        secure_zero(&state, sizeof(state));
+    }
+
+    void poly1305_pad16(poly1305_state& state, std::size_t size) noexcept
+    {
+        static const std::uint8_t zeros[16] = {};
+        if (size % 16 != 0)
+        {
+            poly1305_update(state, zeros, 16 - size % 16);
+        }
+    }
+
+    // the Poly1305 key is the first half of keystream block 0; the message starts at block 1
+    void aead_begin(poly1305_state& state, const std::uint8_t* key, const std::uint8_t* nonce, const std::uint8_t* aad, std::size_t aad_size) noexcept
+    {
+        std::uint8_t one_time_key[64] = {};
+        chacha20_xor(key, nonce, 0, one_time_key, one_time_key, sizeof(one_time_key));
+        poly1305_init(state, one_time_key);
+        secure_zero(one_time_key, sizeof(one_time_key));
+
+        if (aad_size != 0)
+        {
+            poly1305_update(state, aad, aad_size);
+        }
+        poly1305_pad16(state, aad_size);
+    }
+
+    void aead_end(poly1305_state& state, std::size_t aad_size, std::size_t size, std::uint8_t* tag) noexcept
+    {
+        poly1305_pad16(state, size);
+        std::uint8_t lengths[16];
+        store64(lengths, aad_size);
+        store64(lengths + 8, size);
+        poly1305_update(state, lengths, sizeof(lengths));
+        poly1305_finish(state, tag);
+    }
+
+    // compares every byte whatever the first difference, so the time taken reveals nothing
+    bool tags_equal(const std::uint8_t* left, const std::uint8_t* right) noexcept
+    {
+        std::uint8_t difference = 0;
+        for (std::size_t i = 0; i < poly1305_tag_size; ++i)
+        {
+            difference |= left[i] ^ right[i];
+        }
+        return difference == 0;
+    }
+}
+
+std::size_t chacha20_width() noexcept
+{
+    return CHACHA20_WIDTH;
+}
+
+void chacha20_xor(const std::uint8_t* key, const std::uint8_t* nonce, std::uint32_t counter, const std::uint8_t* input,
+    std::uint8_t* output, std::size_t size) noexcept
+{
+    std::uint32_t state[16];
+    initial_state(key, nonce, counter, state);
+
+    std::size_t offset = 0;
+#if CHACHA20_WIDTH == 8
+    for (; size - offset >= 512; offset += 512)
+    {
+        xor_blocks_avx2(state, input + offset, output + offset);
+        state[12] += 8;
+    }
+#endif
+#if CHACHA20_WIDTH > 1
+    // also takes the 256 byte remainder of the AVX2 loop
+    for (; size - offset >= 256; offset += 256)
+    {
+        xor_blocks_sse2(state, input + offset, output + offset);
+        state[12] += 4;
+    }
+#endif
+
+    std::uint8_t keystream[64];
+    for (; offset < size; offset += 64)
+    {
+        block_scalar(state, keystream);
+        ++state[12];
+        const std::size_t count = std::min<std::size_t>(64, size - offset);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            output[offset + i] = input[offset + i] ^ keystream[i];
+        }
+    }
+
+    secure_zero(keystream, sizeof(keystream));
+    secure_zero(state, sizeof(state));
+}
+
+void poly1305(const std::uint8_t* key, const std::uint8_t* message, std::size_t size, std::uint8_t* tag) noexcept
+{
+    poly1305_state state;
+    poly1305_init(state, key);
+    poly1305_update(state, message, size);
+    poly1305_finish(state, tag);
+}
+
+bool chacha20_poly1305_seal(const std::uint8_t* key, const std::uint8_t* nonce, const std::uint8_t* aad, std::size_t aad_size,
+    const std::uint8_t* input, std::uint8_t* output, std::size_t size, std::uint8_t* tag) noexcept
+{
+    if (static_cast<std::uint64_t>(size) > chacha20_poly1305_max_size)
+    {
+        return false;
+    }
+
+    poly1305_state state;
+    aead_begin(state, key, nonce, aad, aad_size);
+
+    for (std::size_t offset = 0; offset < size; offset += slice_size)
+    {
+        const std::size_t count = std::min(slice_size, size - offset);
+        chacha20_xor(key, nonce, static_cast<std::uint32_t>(1 + offset / 64), input + offset, output + offset, count);
+        poly1305_update(state, output + offset, count);
+    }
+
+    aead_end(state, aad_size, size, tag);
+    return true;
+}
+
+bool chacha20_poly1305_open(const std::uint8_t* key, const std::uint8_t* nonce, const std::uint8_t* aad, std::size_t aad_size,
+    const std::uint8_t* input, std::uint8_t* output, std::size_t size, const std::uint8_t* tag) noexcept
+{
+    if (static_cast<std::uint64_t>(size) > chacha20_poly1305_max_size)
+    {
+        return false;
+    }
+
+    // authenticate everything first, a forged message is never decrypted
+    poly1305_state state;
+    aead_begin(state, key, nonce, aad, aad_size);
+    if (size != 0)
+    {
+        poly1305_update(state, input, size);
+    }
+
+    std::uint8_t expected[poly1305_tag_size];
+    aead_end(state, aad_size, size, expected);
+    if (!tags_equal(expected, tag))
+    {
+        return false;
+    }
+
+    chacha20_xor(key, nonce, 1, input, output, size);
+    return true;
+}
@@ -0,0 +1,69 @@
+// chacha20_poly1305.h : The ChaCha20-Poly1305 AEAD construction of RFC 8439.
+//
+// ChaCha20 encrypts, Poly1305 authenticates the ciphertext and the associated data, so a changed
+// byte, a wrong key or a truncated file is detected before any plaintext is returned. The ChaCha20
+// keystream is produced 8 blocks at a time with AVX2, 4 with SSE2 or one block otherwise, whichever
+// the compiler targets. Poly1305 is the portable 26 bit limb form.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+constexpr std::size_t chacha20_key_size = 32;
+constexpr std::size_t chacha20_nonce_size = 12;
+constexpr std::size_t poly1305_key_size = 32;
+constexpr std::size_t poly1305_tag_size = 16;
+// the 32 bit block counter runs from 1 for the message, block 0 is the Poly1305 key; past this it
+// would wrap and reuse keystream (RFC 8439 section 2.8), about 256 GiB per nonce
+constexpr std::uint64_t chacha20_poly1305_max_size = 64 * ((std::uint64_t{ 1 } << 32) - 1);
+
+/// <summary>
+/// Number of 64 byte ChaCha20 blocks computed per pass in this build: 8 with AVX2, 4 with SSE2 and 1
+/// without either.
+/// </summary>
+std::size_t chacha20_width() noexcept;
+
+/// <summary>
+/// output = input XOR the ChaCha20 keystream that starts at block counter. output may alias input.
+/// </summary>
+/// <param name="key">chacha20_key_size bytes</param>
+/// <param name="nonce">chacha20_nonce_size bytes</param>
+/// <param name="counter">block number of the first byte</param>
+/// <param name="input">size bytes</param>
+/// <param name="output">receives size bytes</param>
+/// <param name="size">number of bytes, at most 64 * (2^32 - counter)</param>
+void chacha20_xor(const std::uint8_t* key, const std::uint8_t* nonce, std::uint32_t counter, const std::uint8_t* input,
+    std::uint8_t* output, std::size_t size) noexcept;
+
+/// <summary>
+/// Poly1305 one time authenticator of a whole message.
+/// </summary>
+/// <param name="key">poly1305_key_size bytes, never reused for a second message</param>
+/// <param name="message">size bytes</param>
+/// <param name="size">number of bytes</param>
+/// <param name="tag">receives poly1305_tag_size bytes</param>
+void poly1305(const std::uint8_t* key, const std::uint8_t* message, std::size_t size, std::uint8_t* tag) noexcept;
+
+/// <summary>
+/// Encrypts size bytes and computes the tag over aad and the ciphertext. output may alias input.
+/// </summary>
+/// <param name="key">chacha20_key_size bytes</param>
+/// <param name="nonce">chacha20_nonce_size bytes, never used twice with the same key</param>
+/// <param name="aad">associated data authenticated but not encrypted, may be null when aad_size is 0</param>
+/// <param name="aad_size">number of associated bytes</param>
+/// <param name="input">plaintext</param>
+/// <param name="output">receives the ciphertext</param>
+/// <param name="size">number of bytes, at most chacha20_poly1305_max_size</param>
+/// <param name="tag">receives poly1305_tag_size bytes</param>
+/// <returns>false, with nothing written, when size is over chacha20_poly1305_max_size</returns>
+bool chacha20_poly1305_seal(const std::uint8_t* key, const std::uint8_t* nonce, const std::uint8_t* aad, std::size_t aad_size,
+    const std::uint8_t* input, std::uint8_t* output, std::size_t size, std::uint8_t* tag) noexcept;
+
+/// <summary>
+/// Checks the tag and decrypts. output may alias input.
+/// </summary>
+/// <returns>false, with nothing written to output, when the tag does not match or size is over
+/// chacha20_poly1305_max_size</returns>
+bool chacha20_poly1305_open(const std::uint8_t* key, const std::uint8_t* nonce, const std::uint8_t* aad, std::size_t aad_size,
+    const std::uint8_t* input, std::uint8_t* output, std::size_t size, const std::uint8_t* tag) noexcept;
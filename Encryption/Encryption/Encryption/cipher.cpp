@@ -0,0 +1,226 @@
+// cipher.cpp : Key derivation, key ids and the per mode encrypt / decrypt behind cipher.h.
+//
+
+#include "cipher.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <bcrypt.h>
+#pragma comment(lib, "bcrypt.lib")
+#else
+#include <unistd.h>
+#ifdef __APPLE__
+#include <sys/random.h>
+#endif
+#endif
+
+#include "chacha20_poly1305.h"
+#include "encrypt_decrypt.h"
+#include "key_derivation.h"
+#include "secure_zero.h"
+
+namespace
+{
+    void append_hex(std::string& text, const std::uint8_t* bytes, std::size_t size)
+    {
+        static const char digits[] = "0123456789abcdef";
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            text += digits[bytes[i] >> 4];
+            text += digits[bytes[i] & 0xf];
+        }
+    }
+
+    const std::uint8_t* bytes_of(const std::string& text) noexcept
+    {
+        return reinterpret_cast<const std::uint8_t*>(text.data());
+    }
+
+    std::uint8_t* bytes_of(std::string& text) noexcept
+    {
+        return reinterpret_cast<std::uint8_t*>(&text[0]);
+    }
+
+    const std::uint8_t* bytes_of(std::string_view text) noexcept
+    {
+        return reinterpret_cast<const std::uint8_t*>(text.data());
+    }
+}
+
+void secure_random(void* data, std::size_t size)
+{
+#ifdef _WIN32
+    const NTSTATUS status = ::BCryptGenRandom(nullptr, static_cast<PUCHAR>(data), static_cast<ULONG>(size), BCRYPT_USE_SYSTEM_PREFERRED_RNG);
+    if (!BCRYPT_SUCCESS(status))
+    {
+        throw std::system_error(static_cast<int>(status), std::system_category(), "BCryptGenRandom");
+    }
+#else
+    // getentropy hands out at most 256 bytes per call
+    auto* bytes = static_cast<unsigned char*>(data);
+    while (size != 0)
+    {
+        const std::size_t count = size < 256 ? size : 256;
+        if (::getentropy(bytes, count) != 0)
+        {
+            throw std::system_error(errno, std::generic_category(), "getentropy");
+        }
+        bytes += count;
+        size -= count;
+    }
+#endif
+}
+
+cipher_key::cipher_key(cipher_mode mode, std::string_view password, const std::uint8_t* salt, std::uint32_t iterations)
+    : mode_(mode), iterations_(iterations)
+{
+    std::copy(salt, salt + cipher_salt_size, salt_.begin());
+    derive(password);
+}
+
+cipher_key::cipher_key(cipher_mode mode, std::string_view password, std::uint32_t iterations)
+    : mode_(mode), iterations_(iterations)
+{
+    secure_random(salt_.data(), salt_.size());
+    derive(password);
+}
+
+cipher_key::~cipher_key()
+{
+    secure_zero(bytes_.data(), bytes_.size());
+}
+
+void cipher_key::derive(std::string_view password)
+{
+    // legacy_xor derives too: its key id must not be computable from the password without the work
+    // of the KDF either
+    pbkdf2_sha256(password, salt_.data(), salt_.size(), iterations_, bytes_.data(), bytes_.size());
+
+    static const char id_label[] = "key id";
+    std::uint8_t mac[sha256_size];
+    hmac_sha256(bytes_.data(), bytes_.size(), id_label, sizeof(id_label) - 1, mac);
+    std::copy(mac, mac + cipher_key_id_size, id_.begin());
+    secure_zero(mac, sizeof(mac));
+
+    if (mode_ == cipher_mode::legacy_xor)
+    {
+        legacy_key_ = xor_key(password);
+    }
+}
+
+std::string cipher_key::id_string() const
+{
+    std::string text;
+    append_hex(text, id_.data(), id_.size());
+    return text;
+}
+
+std::string encrypt(const cipher_key& key, const std::string& plaintext, cipher_header& header, std::string_view associated)
+{
+    header.mode = key.mode();
+    header.salt = key.salt();
+    header.iterations = key.iterations();
+    header.key_id = key.id();
+    header.nonce.fill(0);
+    header.tag.fill(0);
+
+    if (plaintext.empty())
+    {
+        if (key.mode() == cipher_mode::chacha20_poly1305)
+        {
+            // an empty message still gets a tag, so its associated data is authenticated
+            secure_random(header.nonce.data(), header.nonce.size());
+            chacha20_poly1305_seal(key.bytes(), header.nonce.data(), bytes_of(associated), associated.size(), nullptr, nullptr, 0,
+                header.tag.data());
+        }
+        return std::string();
+    }
+
+    switch (key.mode())
+    {
+    case cipher_mode::legacy_xor:
+        return encrypt_decrypt(plaintext, key.legacy_key());
+
+    case cipher_mode::chacha20_poly1305:
+    {
+        secure_random(header.nonce.data(), header.nonce.size());
+        std::string ciphertext(plaintext.size(), '\0');
+        if (!chacha20_poly1305_seal(key.bytes(), header.nonce.data(), bytes_of(associated), associated.size(), bytes_of(plaintext),
+                bytes_of(ciphertext), plaintext.size(), header.tag.data()))
+        {
+            throw std::length_error("encrypt: plaintext is longer than one ChaCha20 nonce can cover");
+        }
+        return ciphertext;
+    }
+    }
+    return std::string();
+}
+
+bool decrypt(const cipher_key& key, const cipher_header& header, const std::string& ciphertext, std::string& plaintext,
+    std::string_view associated)
+{
+    plaintext.clear();
+    if (header.mode != key.mode() || header.key_id != key.id())
+    {
+        return false;
+    }
+
+    switch (key.mode())
+    {
+    case cipher_mode::legacy_xor:
+        if (!ciphertext.empty())
+        {
+            plaintext = encrypt_decrypt(ciphertext, key.legacy_key());
+        }
+        return true;
+
+    case cipher_mode::chacha20_poly1305:
+    {
+        std::string output(ciphertext.size(), '\0');
+        if (!chacha20_poly1305_open(key.bytes(), header.nonce.data(), bytes_of(associated), associated.size(),
+                ciphertext.empty() ? nullptr : bytes_of(ciphertext), output.empty() ? nullptr : bytes_of(output), ciphertext.size(),
+                header.tag.data()))
+        {
+            return false;
+        }
+        plaintext = std::move(output);
+        return true;
+    }
+    }
+    return false;
+}
+
+const char* to_string(cipher_mode mode) noexcept
+{
+    switch (mode)
+    {
+    case cipher_mode::legacy_xor:
+        return "xor";
+    case cipher_mode::chacha20_poly1305:
+        return "chacha20-poly1305";
+    }
+    return "unknown";
+}
+
+std::string to_string(const cipher_header& header)
+{
+    std::string text = to_string(header.mode);
+    text += " salt=";
+    append_hex(text, header.salt.data(), header.salt.size());
+    text += " iterations=";
+    text += std::to_string(header.iterations);
+    if (header.mode == cipher_mode::chacha20_poly1305)
+    {
+        text += " nonce=";
+        append_hex(text, header.nonce.data(), header.nonce.size());
+        text += " tag=";
+        append_hex(text, header.tag.data(), header.tag.size());
+    }
+    return text;
+}
@@ -0,0 +1,132 @@
+// cipher.h : The ciphers the Encryption program can write a data file with.
+//
+// legacy_xor is the original repeating key XOR of encrypt_decrypt, kept so existing files can still
+// be read; it hides nothing from anyone holding a few known bytes. chacha20_poly1305 encrypts with a
+// key stretched from the password by PBKDF2 and a fresh random nonce per file, and authenticates the
+// result, so tampering and wrong passwords are detected. Either way the file records only a key id
+// derived from the key, never the password.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "encrypt_decrypt.h"
+
+enum class cipher_mode
+{
+    legacy_xor,
+    chacha20_poly1305
+};
+
+constexpr std::size_t cipher_salt_size = 16;
+constexpr std::size_t cipher_key_id_size = 8;
+constexpr std::uint32_t default_kdf_iterations = 100000;
+
+/// <summary>
+/// Fills size bytes from the operating system's cryptographically secure generator.
+/// </summary>
+/// <exception cref="std::system_error">the generator is unavailable</exception>
+void secure_random(void* data, std::size_t size);
+
+/// <summary>
+/// A key derived from a password. The derived bytes are cleared when the object is destroyed.
+/// </summary>
+class cipher_key
+{
+public:
+    /// <summary>
+    /// Derives the key for an existing file from the salt and iteration count stored in it.
+    /// </summary>
+    /// <param name="mode">cipher the key is for</param>
+    /// <param name="password">secret to derive from</param>
+    /// <param name="salt">cipher_salt_size bytes</param>
+    /// <param name="iterations">PBKDF2 iterations</param>
+    cipher_key(cipher_mode mode, std::string_view password, const std::uint8_t* salt, std::uint32_t iterations = default_kdf_iterations);
+
+    /// <summary>
+    /// Derives a key for a new file under a fresh random salt.
+    /// </summary>
+    cipher_key(cipher_mode mode, std::string_view password, std::uint32_t iterations = default_kdf_iterations);
+
+    cipher_key(const cipher_key&) = delete;
+    cipher_key& operator=(const cipher_key&) = delete;
+    ~cipher_key();
+
+    cipher_mode mode() const noexcept { return mode_; }
+    const std::array<std::uint8_t, cipher_salt_size>& salt() const noexcept { return salt_; }
+    std::uint32_t iterations() const noexcept { return iterations_; }
+
+    // identifies the key without revealing it: the first bytes of HMAC(key, "key id")
+    const std::array<std::uint8_t, cipher_key_id_size>& id() const noexcept { return id_; }
+
+    /// <summary>
+    /// The key id as lowercase hex, for the data file header.
+    /// </summary>
+    std::string id_string() const;
+
+    // the 32 derived key bytes
+    const std::uint8_t* bytes() const noexcept { return bytes_.data(); }
+    // the XOR key of legacy_xor, prepared once for every message; empty for the other modes
+    const xor_key& legacy_key() const noexcept { return legacy_key_; }
+
+private:
+    void derive(std::string_view password);
+
+    cipher_mode mode_;
+    std::array<std::uint8_t, cipher_salt_size> salt_{};
+    std::uint32_t iterations_;
+    std::array<std::uint8_t, 32> bytes_{};
+    std::array<std::uint8_t, cipher_key_id_size> id_{};
+    // legacy_xor keys with the password itself, as encrypt_decrypt always has
+    xor_key legacy_key_;
+};
+
+/// <summary>
+/// Everything besides the key that decrypting a message needs. None of it is secret.
+/// </summary>
+struct cipher_header
+{
+    cipher_mode mode = cipher_mode::chacha20_poly1305;
+    std::array<std::uint8_t, cipher_salt_size> salt{};
+    std::uint32_t iterations = default_kdf_iterations;
+    std::array<std::uint8_t, cipher_key_id_size> key_id{};
+    std::array<std::uint8_t, 12> nonce{};
+    std::array<std::uint8_t, 16> tag{};
+};
+
+/// <summary>
+/// Encrypts plaintext with key and fills in header. A new random nonce is drawn for each call.
+/// </summary>
+/// <param name="key">key to encrypt with</param>
+/// <param name="plaintext">data to encrypt</param>
+/// <param name="header">receives the parameters decrypt needs</param>
+/// <param name="associated">data authenticated with the message but not encrypted; ignored by legacy_xor</param>
+/// <returns>ciphertext of the same length as plaintext</returns>
+/// <exception cref="std::length_error">plaintext is over chacha20_poly1305_max_size for chacha20_poly1305</exception>
+std::string encrypt(const cipher_key& key, const std::string& plaintext, cipher_header& header, std::string_view associated = {});
+
+/// <summary>
+/// Decrypts what encrypt produced.
+/// </summary>
+/// <param name="key">key derived with the salt and iterations of header</param>
+/// <param name="header">parameters written by encrypt</param>
+/// <param name="ciphertext">data to decrypt</param>
+/// <param name="plaintext">receives the plaintext, left empty on failure</param>
+/// <param name="associated">the associated data given to encrypt</param>
+/// <returns>false when the key id does not match or authentication fails</returns>
+bool decrypt(const cipher_key& key, const cipher_header& header, const std::string& ciphertext, std::string& plaintext,
+    std::string_view associated = {});
+
+/// <summary>
+/// "xor" or "chacha20-poly1305".
+/// </summary>
+const char* to_string(cipher_mode mode) noexcept;
+
+/// <summary>
+/// One line description of header for the data file, the mode followed by its hex encoded parameters.
+/// </summary>
+std::string to_string(const cipher_header& header);
@@ -0,0 +1,718 @@
+// data_container.cpp : Writing, parsing and chunk decryption of the container format.
+//
+
+#include "data_container.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+#include "chacha20_poly1305.h"
+#include "date_stamp.h"
+#include "encrypt_decrypt.h"
+#include "lz4_block.h"
+#include "secure_zero.h"
+
+namespace
+{
+    const char magic[8] = { 'S', 'C', 'D', 'A', 'T', 'A', '\r', '\n' };
+
+    // field offsets within the header, see the layout in data_container.h
+    constexpr std::size_t version_offset = 8;
+    constexpr std::size_t header_size_offset = 10;
+    constexpr std::size_t mode_offset = 12;
+    constexpr std::size_t flags_offset = 13;
+    constexpr std::size_t chunk_size_offset = 16;
+    constexpr std::size_t chunk_count_offset = 20;
+    constexpr std::size_t payload_length_offset = 24;
+    constexpr std::size_t iterations_offset = 32;
+    constexpr std::size_t key_id_offset = 36;
+    constexpr std::size_t salt_offset = 44;
+    constexpr std::size_t nonce_offset = 60;
+    constexpr std::size_t timestamp_offset = 72;
+    constexpr std::size_t name_length_offset = 82;
+    constexpr std::size_t name_offset = 83;
+
+    constexpr std::uint8_t lz4_flag = 1;
+
+    void put16(std::uint8_t* out, std::uint16_t value) noexcept
+    {
+        out[0] = static_cast<std::uint8_t>(value);
+        out[1] = static_cast<std::uint8_t>(value >> 8);
+    }
+
+    void put32(std::uint8_t* out, std::uint32_t value) noexcept
+    {
+        for (int i = 0; i < 4; ++i)
+        {
+            out[i] = static_cast<std::uint8_t>(value >> (8 * i));
+        }
+    }
+
+    void put64(std::uint8_t* out, std::uint64_t value) noexcept
+    {
+        for (int i = 0; i < 8; ++i)
+        {
+            out[i] = static_cast<std::uint8_t>(value >> (8 * i));
+        }
+    }
+
+    std::uint16_t get16(const std::uint8_t* in) noexcept
+    {
+        return static_cast<std::uint16_t>(in[0] | in[1] << 8);
+    }
+
+    std::uint32_t get32(const std::uint8_t* in) noexcept
+    {
+        std::uint32_t value = 0;
+        for (int i = 3; i >= 0; --i)
+        {
+            value = value << 8 | in[i];
+        }
+        return value;
+    }
+
+    std::uint64_t get64(const std::uint8_t* in) noexcept
+    {
+        std::uint64_t value = 0;
+        for (int i = 7; i >= 0; --i)
+        {
+            value = value << 8 | in[i];
+        }
+        return value;
+    }
+
+    void write_header(const container_header& header, std::uint8_t* out) noexcept
+    {
+        std::memset(out, 0, container_header_size);
+        std::memcpy(out, magic, sizeof(magic));
+        put16(out + version_offset, header.version);
+        put16(out + header_size_offset, static_cast<std::uint16_t>(container_header_size));
+        out[mode_offset] = static_cast<std::uint8_t>(header.mode);
+        out[flags_offset] = header.compression == container_compression::lz4 ? lz4_flag : 0;
+        put32(out + chunk_size_offset, header.chunk_size);
+        put32(out + chunk_count_offset, header.chunk_count);
+        put64(out + payload_length_offset, header.payload_length);
+        put32(out + iterations_offset, header.iterations);
+        std::memcpy(out + key_id_offset, header.key_id.data(), header.key_id.size());
+        std::memcpy(out + salt_offset, header.salt.data(), header.salt.size());
+        std::memcpy(out + nonce_offset, header.nonce.data(), header.nonce.size());
+        std::memcpy(out + timestamp_offset, header.timestamp.data(), header.timestamp.size());
+        out[name_length_offset] = static_cast<std::uint8_t>(header.student_name.size());
+        std::memcpy(out + name_offset, header.student_name.data(), header.student_name.size());
+    }
+
+    void write_entry(const chunk_entry& entry, std::uint8_t* out) noexcept
+    {
+        put64(out, entry.offset);
+        put32(out + 8, entry.stored_size);
+        put32(out + 12, entry.plain_size);
+        std::memcpy(out + 16, entry.tag.data(), entry.tag.size());
+    }
+
+    chunk_entry read_entry(const std::uint8_t* in) noexcept
+    {
+        chunk_entry entry;
+        entry.offset = get64(in);
+        entry.stored_size = get32(in + 8);
+        entry.plain_size = get32(in + 12);
+        std::memcpy(entry.tag.data(), in + 16, entry.tag.size());
+        return entry;
+    }
+
+    // parses and checks the fixed header, size is what is available of the whole container
+    expected<void, container_error> read_header(const std::uint8_t* data, std::uint64_t size, container_header& header) noexcept
+    {
+        if (size < container_header_size)
+        {
+            return unexpected(size >= sizeof(magic) && std::memcmp(data, magic, sizeof(magic)) != 0 ? container_error::bad_magic
+                                                                                                 : container_error::truncated);
+        }
+        if (std::memcmp(data, magic, sizeof(magic)) != 0)
+        {
+            return unexpected(container_error::bad_magic);
+        }
+
+        header.version = get16(data + version_offset);
+        if (header.version != container_version || get16(data + header_size_offset) != container_header_size)
+        {
+            return unexpected(container_error::unsupported_version);
+        }
+
+        const std::uint8_t mode = data[mode_offset];
+        if (mode > static_cast<std::uint8_t>(cipher_mode::chacha20_poly1305))
+        {
+            return unexpected(container_error::unsupported_version);
+        }
+        header.mode = static_cast<cipher_mode>(mode);
+
+        // a flag this version does not know changes how chunks are read
+        const std::uint8_t flags = data[flags_offset];
+        if ((flags & ~lz4_flag) != 0)
+        {
+            return unexpected(container_error::unsupported_version);
+        }
+        header.compression = (flags & lz4_flag) != 0 ? container_compression::lz4 : container_compression::none;
+        header.chunk_size = get32(data + chunk_size_offset);
+        header.chunk_count = get32(data + chunk_count_offset);
+        header.payload_length = get64(data + payload_length_offset);
+        header.iterations = get32(data + iterations_offset);
+        std::memcpy(header.key_id.data(), data + key_id_offset, header.key_id.size());
+        std::memcpy(header.salt.data(), data + salt_offset, header.salt.size());
+        std::memcpy(header.nonce.data(), data + nonce_offset, header.nonce.size());
+        header.timestamp.assign(std::string_view(reinterpret_cast<const char*>(data + timestamp_offset), 10));
+        if (!header.student_name.assign(std::string_view(reinterpret_cast<const char*>(data + name_offset), data[name_length_offset])))
+        {
+            return unexpected(container_error::corrupt_index);
+        }
+
+        // the chunk count must be exactly what the payload length and chunk size give, rounded up without
+        // an add that wraps for a payload length near 2^64
+        if (header.chunk_size == 0
+            || header.chunk_count != header.payload_length / header.chunk_size + (header.payload_length % header.chunk_size != 0 ? 1 : 0)
+            || header.payload_length > static_cast<std::uint64_t>(header.chunk_count) * header.chunk_size)
+        {
+            return unexpected(container_error::corrupt_index);
+        }
+        return {};
+    }
+
+    // whether a whole container of size bytes can hold the header's payload: stored as is, or at LZ4's
+    // best ratio of 255 to 1. Only for a whole image, the reader opens files cut short on purpose.
+    bool payload_fits(const container_header& header, std::uint64_t size) noexcept
+    {
+        const std::uint64_t stored = size - container_header_size;
+        if (header.compression == container_compression::none)
+        {
+            return header.payload_length <= stored;
+        }
+        return stored > UINT64_MAX / 255 || header.payload_length <= stored * 255;
+    }
+
+    // checks index entry i against the header and the size of the whole container
+    expected<void, container_error> check_entry(const container_header& header, std::size_t index, const chunk_entry& entry,
+        std::uint64_t size) noexcept
+    {
+        const std::uint64_t position = static_cast<std::uint64_t>(index) * header.chunk_size;
+        const std::uint64_t expected_plain = std::min<std::uint64_t>(header.chunk_size, header.payload_length - position);
+        const bool stored_fits = header.compression == container_compression::none ? entry.stored_size == entry.plain_size
+                                                                                   : entry.stored_size <= entry.plain_size;
+        if (entry.plain_size != expected_plain || !stored_fits || entry.offset < container_header_size)
+        {
+            return unexpected(container_error::corrupt_index);
+        }
+        if (entry.offset > size || size - entry.offset < entry.stored_size)
+        {
+            return unexpected(container_error::truncated);
+        }
+        return {};
+    }
+
+    // decompresses the decrypted stored bytes of a compressed chunk into output
+    expected<void, container_error> unpack_chunk(const chunk_entry& entry, const std::uint8_t* stored, char* output) noexcept
+    {
+        const std::ptrdiff_t size = lz4_decompress(reinterpret_cast<const char*>(stored), entry.stored_size, output, entry.plain_size);
+        if (size != static_cast<std::ptrdiff_t>(entry.plain_size))
+        {
+            return unexpected(container_error::corrupt_chunk);
+        }
+        return {};
+    }
+
+    // a distinct nonce for every chunk of the container
+    std::array<std::uint8_t, 12> chunk_nonce(const std::array<std::uint8_t, 12>& base, std::size_t index) noexcept
+    {
+        std::array<std::uint8_t, 12> nonce = base;
+        put32(nonce.data(), get32(nonce.data()) + static_cast<std::uint32_t>(index));
+        return nonce;
+    }
+
+    // runs work(i) for every i in [0, count) on up to threads threads, the calling thread included
+    template <typename Work>
+    void for_each_chunk(std::size_t count, unsigned threads, Work work)
+    {
+        if (threads == 0)
+        {
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        threads = static_cast<unsigned>(std::min<std::size_t>(threads, std::max<std::size_t>(count, 1)));
+
+        std::atomic<std::size_t> next{ 0 };
+        auto worker = [&]() {
+            for (std::size_t i = next.fetch_add(1); i < count; i = next.fetch_add(1))
+            {
+                work(i);
+            }
+        };
+
+        std::vector<std::thread> workers;
+        for (unsigned i = 1; i < threads; ++i)
+        {
+            workers.emplace_back(worker);
+        }
+        worker();
+        for (auto& w : workers)
+        {
+            w.join();
+        }
+    }
+}
+
+const char* to_string(container_error error) noexcept
+{
+    switch (error)
+    {
+    case container_error::io_error:
+        return "the file could not be read or written";
+    case container_error::truncated:
+        return "the file is shorter than its header and index say";
+    case container_error::bad_magic:
+        return "not a data container";
+    case container_error::unsupported_version:
+        return "unsupported container version";
+    case container_error::corrupt_index:
+        return "the chunk index is inconsistent";
+    case container_error::name_too_long:
+        return "the student name does not fit in the header";
+    case container_error::wrong_key:
+        return "the key is not the one the container was written with";
+    case container_error::authentication_failed:
+        return "the data does not match its authentication tag";
+    case container_error::corrupt_chunk:
+        return "a chunk does not decompress to its recorded size";
+    case container_error::chunk_out_of_range:
+        return "the container has no chunk with that index";
+    }
+    return "unknown container error";
+}
+
+expected<std::string, container_error> seal_container(std::string_view student_name, const cipher_key& key, std::string_view data,
+    std::uint32_t chunk_size, unsigned threads, container_compression compression)
+{
+    container_header header;
+    if (!header.student_name.assign(student_name))
+    {
+        return unexpected(container_error::name_too_long);
+    }
+    char today[date_stamp_length + 1];
+    header.timestamp.assign(std::string_view(today, date_stamp(today, sizeof(today))));
+
+    header.mode = key.mode();
+    header.compression = compression;
+    header.chunk_size = std::max<std::uint32_t>(chunk_size, 1);
+    // the header stores the count in 32 bits
+    const std::uint64_t chunk_count = data.size() / header.chunk_size + (data.size() % header.chunk_size != 0 ? 1 : 0);
+    if (chunk_count > UINT32_MAX)
+    {
+        throw std::length_error("seal_container: data needs more chunks than a container can index");
+    }
+    header.chunk_count = static_cast<std::uint32_t>(chunk_count);
+    header.payload_length = data.size();
+    header.iterations = key.iterations();
+    header.key_id = key.id();
+    header.salt = key.salt();
+    if (key.mode() == cipher_mode::chacha20_poly1305)
+    {
+        secure_random(header.nonce.data(), header.nonce.size());
+    }
+
+    const std::size_t payload_offset = container_header_size + container_entry_size * header.chunk_count;
+    std::uint8_t header_bytes[container_header_size];
+    write_header(header, header_bytes);
+
+    // encrypts the stored bytes of chunk i in place and records its tag
+    auto encrypt_chunk = [&](std::size_t i, const char* source, std::uint8_t* target, chunk_entry& entry) {
+        if (header.mode == cipher_mode::chacha20_poly1305)
+        {
+            const auto nonce = chunk_nonce(header.nonce, i);
+            chacha20_poly1305_seal(key.bytes(), nonce.data(), header_bytes, container_header_size,
+                reinterpret_cast<const std::uint8_t*>(source), target, entry.stored_size, entry.tag.data());
+        }
+        else
+        {
+            encrypt_decrypt(source, reinterpret_cast<char*>(target), entry.stored_size, key.legacy_key(),
+                static_cast<std::uint64_t>(i) * header.chunk_size);
+        }
+    };
+
+    if (compression == container_compression::none)
+    {
+        std::string image(payload_offset + data.size(), '\0');
+        auto* bytes = reinterpret_cast<std::uint8_t*>(&image[0]);
+        std::memcpy(bytes, header_bytes, container_header_size);
+
+        // chunks are independent, so they are encrypted in parallel straight into their final place
+        for_each_chunk(header.chunk_count, threads, [&](std::size_t i) {
+            chunk_entry entry;
+            const std::uint64_t position = static_cast<std::uint64_t>(i) * header.chunk_size;
+            entry.offset = payload_offset + position;
+            entry.plain_size = static_cast<std::uint32_t>(std::min<std::uint64_t>(header.chunk_size, data.size() - position));
+            entry.stored_size = entry.plain_size;
+            encrypt_chunk(i, data.data() + position, bytes + entry.offset, entry);
+            write_entry(entry, bytes + container_header_size + container_entry_size * i);
+        });
+        return image;
+    }
+
+    // a compressed chunk's place depends on the size of every chunk before it, so each is compressed
+    // and encrypted into a slot of its own first, then the slots are packed into the image
+    const std::size_t slot_size = lz4_bound(std::min<std::uint64_t>(header.chunk_size, data.size()));
+    std::unique_ptr<std::uint8_t[]> slots(new std::uint8_t[slot_size * header.chunk_count]);
+    std::vector<chunk_entry> entries(header.chunk_count);
+    for_each_chunk(header.chunk_count, threads, [&](std::size_t i) {
+        chunk_entry& entry = entries[i];
+        const std::uint64_t position = static_cast<std::uint64_t>(i) * header.chunk_size;
+        entry.plain_size = static_cast<std::uint32_t>(std::min<std::uint64_t>(header.chunk_size, data.size() - position));
+
+        const char* source = data.data() + position;
+        std::uint8_t* slot = slots.get() + slot_size * i;
+        const std::size_t packed = lz4_compress(source, entry.plain_size, reinterpret_cast<char*>(slot), slot_size);
+        if (packed != 0 && packed < entry.plain_size)
+        {
+            // compressed plaintext is encrypted where it lies
+            entry.stored_size = static_cast<std::uint32_t>(packed);
+            source = reinterpret_cast<const char*>(slot);
+        }
+        else
+        {
+            entry.stored_size = entry.plain_size;
+        }
+        encrypt_chunk(i, source, slot, entry);
+    });
+
+    std::uint64_t offset = payload_offset;
+    for (auto& entry : entries)
+    {
+        entry.offset = offset;
+        offset += entry.stored_size;
+    }
+
+    std::string image(static_cast<std::size_t>(offset), '\0');
+    auto* bytes = reinterpret_cast<std::uint8_t*>(&image[0]);
+    std::memcpy(bytes, header_bytes, container_header_size);
+    for_each_chunk(header.chunk_count, threads, [&](std::size_t i) {
+        std::memcpy(bytes + entries[i].offset, slots.get() + slot_size * i, entries[i].stored_size);
+        write_entry(entries[i], bytes + container_header_size + container_entry_size * i);
+    });
+    return image;
+}
+
+expected<void, container_error> write_container(const std::string& filename, std::string_view student_name, const cipher_key& key,
+    std::string_view data, std::uint32_t chunk_size, unsigned threads, container_compression compression)
+{
+    const auto image = seal_container(student_name, key, data, chunk_size, threads, compression);
+    if (!image)
+    {
+        return unexpected(image.error());
+    }
+
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    if (!file.write(image->data(), static_cast<std::streamsize>(image->size())))
+    {
+        return unexpected(container_error::io_error);
+    }
+    return {};
+}
+
+expected<container_view, container_error> container_view::parse(const std::uint8_t* data, std::size_t size)
+{
+    container_view view;
+    view.data_ = data;
+    const auto header = read_header(data, size, view.header_);
+    if (!header)
+    {
+        return unexpected(header.error());
+    }
+    if ((size - container_header_size) / container_entry_size < view.header_.chunk_count || !payload_fits(view.header_, size))
+    {
+        return unexpected(container_error::truncated);
+    }
+
+    view.entries_.reserve(view.header_.chunk_count);
+    for (std::size_t i = 0; i < view.header_.chunk_count; ++i)
+    {
+        const chunk_entry entry = read_entry(data + container_header_size + container_entry_size * i);
+        const auto checked = check_entry(view.header_, i, entry, size);
+        if (!checked)
+        {
+            return unexpected(checked.error());
+        }
+        view.entries_.push_back(entry);
+    }
+    return view;
+}
+
+expected<void, container_error> container_view::decrypt_chunk(const cipher_key& key, std::size_t index, char* output) const
+{
+    if (index >= entries_.size())
+    {
+        return unexpected(container_error::chunk_out_of_range);
+    }
+    if (key.mode() != header_.mode || key.id() != header_.key_id)
+    {
+        return unexpected(container_error::wrong_key);
+    }
+
+    const chunk_entry& entry = entries_[index];
+    const std::uint8_t* stored = data_ + entry.offset;
+
+    // compressed bytes are decrypted into a buffer kept per thread and decompressed from there
+    thread_local std::vector<std::uint8_t> scratch;
+    const bool packed = entry.stored_size != entry.plain_size;
+    std::uint8_t* target = reinterpret_cast<std::uint8_t*>(output);
+    if (packed)
+    {
+        if (scratch.size() < entry.stored_size)
+        {
+            scratch.resize(entry.stored_size);
+        }
+        target = scratch.data();
+    }
+
+    if (header_.mode == cipher_mode::chacha20_poly1305)
+    {
+        const auto nonce = chunk_nonce(header_.nonce, index);
+        if (!chacha20_poly1305_open(key.bytes(), nonce.data(), data_, container_header_size, stored, target, entry.stored_size,
+                entry.tag.data()))
+        {
+            return unexpected(container_error::authentication_failed);
+        }
+    }
+    else
+    {
+        encrypt_decrypt(reinterpret_cast<const char*>(stored), reinterpret_cast<char*>(target), entry.stored_size, key.legacy_key(),
+            chunk_position(index));
+    }
+
+    if (!packed)
+    {
+        return {};
+    }
+    const auto unpacked = unpack_chunk(entry, target, output);
+    secure_zero(target, entry.stored_size);
+    return unpacked;
+}
+
+expected<std::string, container_error> container_view::decrypt_all(const cipher_key& key, unsigned threads) const
+{
+    if (key.mode() != header_.mode || key.id() != header_.key_id)
+    {
+        return unexpected(container_error::wrong_key);
+    }
+
+    std::string plaintext(static_cast<std::size_t>(header_.payload_length), '\0');
+
+    // every worker records a failure, the first one recorded is reported
+    std::atomic<bool> failed{ false };
+    container_error error = container_error::authentication_failed;
+    for_each_chunk(entries_.size(), threads, [&](std::size_t i) {
+        if (failed.load(std::memory_order_relaxed))
+        {
+            return;
+        }
+        const auto result = decrypt_chunk(key, i, &plaintext[static_cast<std::size_t>(chunk_position(i))]);
+        if (!result && !failed.exchange(true))
+        {
+            error = result.error();
+        }
+    });
+
+    if (failed)
+    {
+        return unexpected(error);
+    }
+    return plaintext;
+}
+
+expected<void, container_error> container_file::open(const std::string& filename)
+{
+    if (!file_.open(filename))
+    {
+        return unexpected(container_error::io_error);
+    }
+    auto parsed = container_view::parse(file_.data(), file_.size());
+    if (!parsed)
+    {
+        return unexpected(parsed.error());
+    }
+    view_ = std::move(*parsed);
+    return {};
+}
+
+expected<void, container_error> container_reader::open(const std::string& filename)
+{
+    bytes_read_.store(0, std::memory_order_relaxed);
+    if (!file_.open(filename))
+    {
+        return unexpected(container_error::io_error);
+    }
+
+    const std::size_t available = static_cast<std::size_t>(std::min<std::uint64_t>(file_.size(), container_header_size));
+    const auto read = read_exactly(0, raw_header_.data(), available);
+    if (!read)
+    {
+        return read;
+    }
+    const auto header = read_header(raw_header_.data(), file_.size(), header_);
+    if (!header)
+    {
+        return header;
+    }
+    if ((file_.size() - container_header_size) / container_entry_size < header_.chunk_count)
+    {
+        return unexpected(container_error::truncated);
+    }
+    return {};
+}
+
+expected<std::size_t, container_error> container_reader::decrypt_range(const cipher_key& key, std::uint64_t offset, char* output,
+    std::size_t length) const
+{
+    if (key.mode() != header_.mode || key.id() != header_.key_id)
+    {
+        return unexpected(container_error::wrong_key);
+    }
+    if (offset >= header_.payload_length || length == 0)
+    {
+        return std::size_t{ 0 };
+    }
+    length = static_cast<std::size_t>(std::min<std::uint64_t>(length, header_.payload_length - offset));
+
+    const std::size_t first = static_cast<std::size_t>(offset / header_.chunk_size);
+    const std::size_t last = static_cast<std::size_t>((offset + length - 1) / header_.chunk_size);
+
+    // index entries are read a batch at a time, chunks that are only partly wanted go through scratch,
+    // compressed ones through a second half of it that receives the plain bytes
+    constexpr std::size_t batch = 32;
+    std::uint8_t entries[batch * container_entry_size];
+    const std::size_t scratch_size = static_cast<std::size_t>(std::min<std::uint64_t>(header_.chunk_size, header_.payload_length));
+    std::unique_ptr<std::uint8_t[]> scratch;
+
+    std::size_t written = 0;
+    for (std::size_t i = first; i <= last; ++i)
+    {
+        if ((i - first) % batch == 0)
+        {
+            const std::size_t count = std::min(batch, last - i + 1);
+            const auto read = read_exactly(container_header_size + container_entry_size * static_cast<std::uint64_t>(i), entries,
+                count * container_entry_size);
+            if (!read)
+            {
+                return unexpected(read.error());
+            }
+        }
+        const chunk_entry entry = read_entry(entries + (i - first) % batch * container_entry_size);
+        const auto checked = check_entry(header_, i, entry, file_.size());
+        if (!checked)
+        {
+            return unexpected(checked.error());
+        }
+
+        // the part of this chunk inside the range
+        const std::uint64_t position = static_cast<std::uint64_t>(i) * header_.chunk_size;
+        const std::size_t begin = static_cast<std::size_t>(std::max(offset, position) - position);
+        const std::size_t end = static_cast<std::size_t>(std::min<std::uint64_t>(offset + length - position, entry.plain_size));
+        char* target = output + written;
+
+        if (header_.mode == cipher_mode::legacy_xor && header_.compression == container_compression::none)
+        {
+            const auto read = read_exactly(entry.offset + begin, target, end - begin);
+            if (!read)
+            {
+                return unexpected(read.error());
+            }
+            encrypt_decrypt(target, target, end - begin, key.legacy_key(), position + begin);
+        }
+        else
+        {
+            // the tag and the compression cover the whole chunk: a whole uncompressed chunk is
+            // decrypted in place, anything else needs scratch
+            const bool whole = begin == 0 && end == entry.plain_size;
+            const bool packed = entry.stored_size != entry.plain_size;
+            std::uint8_t* stored = reinterpret_cast<std::uint8_t*>(target);
+            if (!whole || packed)
+            {
+                if (!scratch)
+                {
+                    scratch.reset(new std::uint8_t[header_.compression == container_compression::none ? scratch_size : 2 * scratch_size]);
+                }
+                stored = scratch.get();
+            }
+            const auto read = read_exactly(entry.offset, stored, entry.stored_size);
+            if (!read)
+            {
+                return unexpected(read.error());
+            }
+            if (header_.mode == cipher_mode::chacha20_poly1305)
+            {
+                const auto nonce = chunk_nonce(header_.nonce, i);
+                if (!chacha20_poly1305_open(key.bytes(), nonce.data(), raw_header_.data(), container_header_size, stored, stored,
+                        entry.stored_size, entry.tag.data()))
+                {
+                    return unexpected(container_error::authentication_failed);
+                }
+            }
+            else
+            {
+                encrypt_decrypt(reinterpret_cast<char*>(stored), reinterpret_cast<char*>(stored), entry.stored_size, key.legacy_key(), position);
+            }
+
+            std::uint8_t* plain = stored;
+            if (packed)
+            {
+                plain = whole ? reinterpret_cast<std::uint8_t*>(target) : scratch.get() + scratch_size;
+                const auto unpacked = unpack_chunk(entry, stored, reinterpret_cast<char*>(plain));
+                secure_zero(stored, entry.stored_size);
+                if (!unpacked)
+                {
+                    secure_zero(plain, entry.plain_size);
+                    return unexpected(unpacked.error());
+                }
+            }
+            if (!whole)
+            {
+                std::memcpy(target, plain + begin, end - begin);
+                secure_zero(plain, entry.plain_size);
+            }
+        }
+        written += end - begin;
+    }
+    return written;
+}
+
+expected<void, container_error> container_reader::read_exactly(std::uint64_t offset, void* buffer, std::size_t size) const noexcept
+{
+    const std::ptrdiff_t count = file_.read_at(offset, buffer, size);
+    if (count < 0)
+    {
+        return unexpected(container_error::io_error);
+    }
+    bytes_read_.fetch_add(static_cast<std::uint64_t>(count), std::memory_order_relaxed);
+    if (static_cast<std::size_t>(count) != size)
+    {
+        return unexpected(container_error::truncated);
+    }
+    return {};
+}
+
+expected<std::size_t, container_error> decrypt_range(const std::string& path, const cipher_key& key, std::uint64_t offset, char* output,
+    std::size_t length)
+{
+    container_reader reader;
+    const auto opened = reader.open(path);
+    if (!opened)
+    {
+        return unexpected(opened.error());
+    }
+    return reader.decrypt_range(key, offset, output, length);
+}
+
+cipher_key derive_container_key(const container_header& header, std::string_view password)
+{
+    return cipher_key(header.mode, password, header.salt.data(), header.iterations);
+}
@@ -0,0 +1,235 @@
+// data_container.h : Versioned binary file format for encrypted data.
+//
+// The text file save_data_file writes has to be scanned line by line to find where the data starts,
+// and the data itself may contain newlines. A container is a fixed 256 byte header, an index with one
+// 32 byte entry per chunk and the chunks themselves. Any chunk can be found with one lookup and
+// decrypted on its own, so readers map the file and decrypt only the chunks they need, on as many
+// threads as they like. container_reader goes further and reads only the bytes a range needs.
+// Chunks may be LZ4 compressed before they are encrypted: the text the programs store shrinks to a
+// fraction of its size, and a chunk is still compressed, decompressed and found on its own.
+//
+// Layout, all integers little endian:
+//   0   magic "SCDATA\r\n"         8
+//   8   version                    2   container_version
+//   10  header size                2   container_header_size
+//   12  cipher mode                1   0 legacy_xor, 1 chacha20_poly1305
+//   13  flags                      1   bit 0 chunks LZ4 compressed, others reserved, 0
+//   14  reserved                   2
+//   16  chunk size                 4   plaintext bytes per chunk, the last one may be shorter
+//   20  chunk count                4
+//   24  payload length             8   plaintext bytes in all chunks
+//   32  KDF iterations             4
+//   36  key id                     8
+//   44  KDF salt                   16
+//   60  base nonce                 12  chunk i uses it with i added to its first 4 bytes
+//   72  timestamp                  10  yyyy-mm-dd
+//   82  name length                1
+//   83  student name               128
+//   211 reserved                   45  zero
+//   256 chunk index                32 per chunk: offset 8, stored size 4, plain size 4, tag 16
+// A compressed chunk whose stored size equals its plain size did not shrink and is stored as is.
+// ChaCha20-Poly1305 chunks authenticate the whole 256 byte header as associated data, so a changed
+// header field fails every chunk. legacy_xor chunks carry no tag and are XORed at their position in
+// the payload.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "cipher.h"
+#include "expected.h"
+#include "fixed_string.h"
+#include "mapped_file.h"
+#include "random_access_file.h"
+
+constexpr std::uint16_t container_version = 1;
+constexpr std::size_t container_header_size = 256;
+constexpr std::size_t container_entry_size = 32;
+constexpr std::uint32_t default_chunk_size = 64 * 1024;
+
+enum class container_error
+{
+    io_error,
+    truncated,
+    bad_magic,
+    unsupported_version,
+    corrupt_index,
+    name_too_long,
+    wrong_key,
+    authentication_failed,
+    corrupt_chunk,
+    chunk_out_of_range
+};
+
+const char* to_string(container_error error) noexcept;
+
+enum class container_compression
+{
+    none,
+    // lz4_block.h, each chunk on its own before it is encrypted
+    lz4
+};
+
+struct container_header
+{
+    std::uint16_t version = container_version;
+    cipher_mode mode = cipher_mode::chacha20_poly1305;
+    container_compression compression = container_compression::none;
+    std::uint32_t chunk_size = default_chunk_size;
+    std::uint32_t chunk_count = 0;
+    std::uint64_t payload_length = 0;
+    std::uint32_t iterations = default_kdf_iterations;
+    std::array<std::uint8_t, cipher_key_id_size> key_id{};
+    std::array<std::uint8_t, cipher_salt_size> salt{};
+    std::array<std::uint8_t, 12> nonce{};
+    fixed_string<10> timestamp;
+    fixed_string<128> student_name;
+};
+
+struct chunk_entry
+{
+    // from the start of the container
+    std::uint64_t offset = 0;
+    // smaller than plain_size only when the chunk is compressed
+    std::uint32_t stored_size = 0;
+    std::uint32_t plain_size = 0;
+    std::array<std::uint8_t, 16> tag{};
+};
+
+/// <summary>
+/// Encrypts data into a complete container image, chunk_size bytes per chunk, chunks spread over
+/// threads workers. Compressed chunks are compressed on the same workers, each into its own buffer,
+/// and then packed behind one another.
+/// </summary>
+/// <param name="student_name">recorded in the header, at most 128 bytes</param>
+/// <param name="key">key to encrypt with</param>
+/// <param name="data">plaintext</param>
+/// <param name="chunk_size">plaintext bytes per chunk, not 0</param>
+/// <param name="threads">worker count, 0 for one per hardware thread</param>
+/// <param name="compression">whether chunks are compressed before they are encrypted</param>
+/// <returns>the container bytes, or name_too_long</returns>
+/// <exception cref="std::length_error">data needs more than 2^32 - 1 chunks of chunk_size</exception>
+expected<std::string, container_error> seal_container(std::string_view student_name, const cipher_key& key, std::string_view data,
+    std::uint32_t chunk_size = default_chunk_size, unsigned threads = 0, container_compression compression = container_compression::none);
+
+/// <summary>
+/// seal_container written to filename.
+/// </summary>
+expected<void, container_error> write_container(const std::string& filename, std::string_view student_name, const cipher_key& key,
+    std::string_view data, std::uint32_t chunk_size = default_chunk_size, unsigned threads = 0,
+    container_compression compression = container_compression::none);
+
+/// <summary>
+/// A parsed container over bytes it does not own: an image in memory or a mapped file.
+/// </summary>
+class container_view
+{
+public:
+    /// <summary>
+    /// Checks the header and the index against size. Chunk contents are only checked when decrypted.
+    /// </summary>
+    static expected<container_view, container_error> parse(const std::uint8_t* data, std::size_t size);
+
+    const container_header& header() const noexcept { return header_; }
+    std::size_t chunk_count() const noexcept { return entries_.size(); }
+    const chunk_entry& chunk(std::size_t index) const noexcept { return entries_[index]; }
+
+    // position of chunk index within the plaintext
+    std::uint64_t chunk_position(std::size_t index) const noexcept { return static_cast<std::uint64_t>(index) * header_.chunk_size; }
+
+    /// <summary>
+    /// Decrypts one chunk into output, which must hold chunk(index).plain_size bytes, and decompresses
+    /// it when it is compressed.
+    /// </summary>
+    /// <returns>chunk_out_of_range when index is not below chunk_count(), wrong_key when key is not
+    /// the one the container was written with, authentication_failed when the chunk or the header was
+    /// altered, corrupt_chunk when a compressed chunk does not decompress to its plain size</returns>
+    expected<void, container_error> decrypt_chunk(const cipher_key& key, std::size_t index, char* output) const;
+
+    /// <summary>
+    /// Decrypts every chunk, spread over threads workers.
+    /// </summary>
+    expected<std::string, container_error> decrypt_all(const cipher_key& key, unsigned threads = 0) const;
+
+private:
+    const std::uint8_t* data_ = nullptr;
+    container_header header_;
+    std::vector<chunk_entry> entries_;
+};
+
+/// <summary>
+/// A container file mapped into memory.
+/// </summary>
+class container_file
+{
+public:
+    /// <summary>
+    /// Maps filename and parses it.
+    /// </summary>
+    expected<void, container_error> open(const std::string& filename);
+
+    const container_view& view() const noexcept { return view_; }
+
+private:
+    mapped_file file_;
+    container_view view_;
+};
+
+/// <summary>
+/// A container file read with positioned reads rather than mapped. Decrypting a range reads the
+/// index entries and chunk bytes that range covers and nothing else, so its cost follows the range
+/// length rather than the file size.
+/// </summary>
+class container_reader
+{
+public:
+    /// <summary>
+    /// Opens filename and reads its header. The index is read entry by entry as ranges need it.
+    /// </summary>
+    expected<void, container_error> open(const std::string& filename);
+
+    const container_header& header() const noexcept { return header_; }
+
+    /// <summary>
+    /// Decrypts payload bytes [offset, offset + length) into output. A legacy_xor range is read and
+    /// XORed byte for byte at its position in the key. A ChaCha20-Poly1305 range is read whole chunk
+    /// by chunk, since a tag covers a whole chunk, so it costs at most one extra chunk at either end;
+    /// so is any range of a compressed container. Safe to call from several threads at once.
+    /// </summary>
+    /// <param name="key">key the container was written with</param>
+    /// <param name="offset">position in the plaintext</param>
+    /// <param name="output">receives up to length bytes; unspecified when an error is returned</param>
+    /// <param name="length">bytes wanted</param>
+    /// <returns>bytes decrypted, fewer than length only where the payload ends, or the error</returns>
+    expected<std::size_t, container_error> decrypt_range(const cipher_key& key, std::uint64_t offset, char* output,
+        std::size_t length) const;
+
+    // bytes read from the file since open, header included
+    std::uint64_t bytes_read() const noexcept { return bytes_read_.load(std::memory_order_relaxed); }
+
+private:
+    expected<void, container_error> read_exactly(std::uint64_t offset, void* buffer, std::size_t size) const noexcept;
+
+    random_access_file file_;
+    std::array<std::uint8_t, container_header_size> raw_header_{};
+    container_header header_;
+    mutable std::atomic<std::uint64_t> bytes_read_{ 0 };
+};
+
+/// <summary>
+/// Opens the container at path and decrypts payload bytes [offset, offset + length) into output.
+/// See container_reader::decrypt_range; keep a container_reader open for repeated ranges.
+/// </summary>
+expected<std::size_t, container_error> decrypt_range(const std::string& path, const cipher_key& key, std::uint64_t offset, char* output,
+    std::size_t length);
+
+/// <summary>
+/// Reads the KDF parameters of a container back into a key for password.
+/// </summary>
+cipher_key derive_container_key(const container_header& header, std::string_view password);
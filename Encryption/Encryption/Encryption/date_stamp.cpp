@@ -0,0 +1,123 @@
+// date_stamp.cpp : Per thread cache behind date_stamp.
+//
+
+#include "date_stamp.h"
+
+#include <cstring>
+
+namespace
+{
+    struct cached_day
+    {
+        // the text is valid for first <= now < last
+        std::time_t first = 0;
+        std::time_t last = 0;
+        char text[date_stamp_length + 1] = {};
+        std::size_t refreshes = 0;
+    };
+
+    thread_local cached_day cache;
+
+    bool to_local(std::time_t when, std::tm& local) noexcept
+    {
+#ifdef _WIN32
+        return ::localtime_s(&local, &when) == 0;
+#else
+        return ::localtime_r(&when, &local) != nullptr;
+#endif
+    }
+
+    void put_digits(char* out, int value, int digits) noexcept
+    {
+        for (int i = digits - 1; i >= 0; --i)
+        {
+            out[i] = static_cast<char>('0' + value % 10);
+            value /= 10;
+        }
+    }
+
+    bool refresh(std::time_t now) noexcept
+    {
+        std::tm local{};
+        if (!to_local(now, local))
+        {
+            return false;
+        }
+
+        const int year = local.tm_year + 1900;
+        if (year < 0 || year > 9999)
+        {
+            return false;
+        }
+
+        // zero padded, so January 5th is 2026-01-05 rather than 2026-1-5
+        put_digits(cache.text, year, 4);
+        cache.text[4] = '-';
+        put_digits(cache.text + 5, local.tm_mon + 1, 2);
+        cache.text[7] = '-';
+        put_digits(cache.text + 8, local.tm_mday, 2);
+        cache.text[date_stamp_length] = '\0';
+
+        // mktime finds local midnight at both ends of the day, daylight saving changes included
+        std::tm midnight = local;
+        midnight.tm_hour = 0;
+        midnight.tm_min = 0;
+        midnight.tm_sec = 0;
+        midnight.tm_isdst = -1;
+        const std::time_t first = std::mktime(&midnight);
+
+        midnight = local;
+        midnight.tm_mday += 1;
+        midnight.tm_hour = 0;
+        midnight.tm_min = 0;
+        midnight.tm_sec = 0;
+        midnight.tm_isdst = -1;
+        const std::time_t last = std::mktime(&midnight);
+
+        if (first == static_cast<std::time_t>(-1) || last == static_cast<std::time_t>(-1) || !(first <= now && now < last))
+        {
+            // no usable day boundaries, cover just this second so the next call converts again
+            cache.first = now;
+            cache.last = now + 1;
+        }
+        else
+        {
+            cache.first = first;
+            cache.last = last;
+        }
+        ++cache.refreshes;
+        return true;
+    }
+}
+
+std::size_t date_stamp(std::time_t now, char* buffer, std::size_t size) noexcept
+{
+    if (size < date_stamp_length + 1)
+    {
+        if (size != 0)
+        {
+            buffer[0] = '\0';
+        }
+        return 0;
+    }
+
+    // an empty range (first == last) means nothing is cached yet
+    if (!(cache.first <= now && now < cache.last) && !refresh(now))
+    {
+        buffer[0] = '\0';
+        return 0;
+    }
+
+    std::memcpy(buffer, cache.text, date_stamp_length + 1);
+    return date_stamp_length;
+}
+
+std::size_t date_stamp(char* buffer, std::size_t size) noexcept
+{
+    return date_stamp(std::time(nullptr), buffer, size);
+}
+
+std::size_t date_stamp_refreshes() noexcept
+{
+    return cache.refreshes;
+}
@@ -0,0 +1,35 @@
+// date_stamp.h : ISO yyyy-mm-dd date for the timestamp line of save_data_file.
+//
+// Converting the current time to local time takes the time zone lock and walks the zone rules, and
+// formatting it through an ostream is slower still, yet the date only changes once a day. Each thread
+// keeps the formatted date together with the range of times it covers, so writing a stamp is a clock
+// read, a compare and a 10 byte copy until the day rolls over. Nothing allocates.
+
+#pragma once
+
+#include <cstddef>
+#include <ctime>
+
+// "yyyy-mm-dd" without the terminating null
+constexpr std::size_t date_stamp_length = 10;
+
+/// <summary>
+/// Writes the local date of now as a null terminated "yyyy-mm-dd". Uses the calling thread's cached
+/// date when now falls on the same day as the previous call on that thread.
+/// </summary>
+/// <param name="now">time to format</param>
+/// <param name="buffer">receives the date</param>
+/// <param name="size">size of buffer, at least date_stamp_length + 1</param>
+/// <returns>date_stamp_length, or 0 when buffer is too small or the year is outside 0 - 9999</returns>
+std::size_t date_stamp(std::time_t now, char* buffer, std::size_t size) noexcept;
+
+/// <summary>
+/// date_stamp for the current time.
+/// </summary>
+std::size_t date_stamp(char* buffer, std::size_t size) noexcept;
+
+/// <summary>
+/// Number of times the calling thread converted a time to local time because its cached day did not
+/// cover it. Lets tests and benchmarks confirm the cache is hit.
+/// </summary>
+std::size_t date_stamp_refreshes() noexcept;
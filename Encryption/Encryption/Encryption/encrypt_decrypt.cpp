@@ -0,0 +1,221 @@
+// encrypt_decrypt.cpp : Repeating key XOR transform used by the Encryption program.
+//
+
+#include "encrypt_decrypt.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <stdexcept>
+
+#include "secure_zero.h"
+
+#if defined(__AVX2__)
+#define XOR_KEY_WIDTH 32
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define XOR_KEY_WIDTH 16
+#else
+#define XOR_KEY_WIDTH 8
+#endif
+
+#if XOR_KEY_WIDTH > 8
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    // keys whose least common multiple with the width is longer than this repeat at their own length
+    constexpr std::size_t max_period = 4096;
+
+    std::size_t greatest_common_divisor(std::size_t a, std::size_t b) noexcept
+    {
+        while (b != 0)
+        {
+            const std::size_t r = a % b;
+            a = b;
+            b = r;
+        }
+        return a;
+    }
+}
+
+/// <summary>
+/// encrypt or decrypt a source string using the provided key
+/// </summary>
+/// <param name="source">input string to process</param>
+/// <param name="key">key to use in encryption / decryption</param>
+/// <returns>transformed string</returns>
+std::string encrypt_decrypt(const std::string& source, const std::string& key)
+{
+    // get lengths now instead of calling the function every time.
+    // this would have most likely been inlined by the compiler, but design for perfomance.
+    const auto key_length = key.length();
+    const auto source_length = source.length();
+
+    // assert that our input data is good
+    assert(key_length > 0);
+    assert(source_length > 0);
+
+    std::string output = source;
+
+    // loop through the source string char by char
+    for (size_t i = 0; i < source_length; ++i)
+    { // TODO: student need to change the next line from output[i] = source[i]
+      // transform each character based on an xor of the key modded constrained to key length using a mod
+        output[i] = source[i] ^ key[i % key_length];
+    }
+
+    // our output length must equal our source length
+    assert(output.length() == source_length);
+
+    // return the transformed string
+    return output;
+}
+
+void encrypt_decrypt(const char* source, char* output, std::size_t length, std::string_view key, std::uint64_t position) noexcept
+{
+    const std::size_t key_length = key.length();
+    assert(key_length > 0);
+
+    // walk the key with a wrapping index rather than taking a modulo for every byte
+    std::size_t k = static_cast<std::size_t>(position % key_length);
+    for (std::size_t i = 0; i < length; ++i)
+    {
+        output[i] = source[i] ^ key[k];
+        if (++k == key_length)
+        {
+            k = 0;
+        }
+    }
+}
+
+std::size_t xor_key::width() noexcept
+{
+    return XOR_KEY_WIDTH;
+}
+
+xor_key::xor_key(std::string_view key)
+    : length_(key.length())
+{
+    assert(length_ > 0);
+    if (length_ == 0)
+    {
+        return;
+    }
+
+    period_ = length_ / greatest_common_divisor(length_, XOR_KEY_WIDTH) * XOR_KEY_WIDTH;
+    if (period_ > max_period)
+    {
+        period_ = length_;
+    }
+
+    // period_ bytes of key, then one more vector so a load at any index below period_ stays inside
+    const std::size_t size = period_ + XOR_KEY_WIDTH;
+    block_.reset(new char[size]);
+    for (std::size_t i = 0; i < size; i += length_)
+    {
+        std::memcpy(&block_[i], key.data(), std::min(length_, size - i));
+    }
+}
+
+xor_key::xor_key(xor_key&& other) noexcept
+    : block_(std::move(other.block_)), length_(other.length_), period_(other.period_)
+{
+    other.length_ = 0;
+    other.period_ = 0;
+}
+
+xor_key& xor_key::operator=(xor_key&& other) noexcept
+{
+    if (this != &other)
+    {
+        clear();
+        block_ = std::move(other.block_);
+        length_ = other.length_;
+        period_ = other.period_;
+        other.length_ = 0;
+        other.period_ = 0;
+    }
+    return *this;
+}
+
+xor_key::~xor_key()
+{
+    clear();
+}
+
+void xor_key::clear() noexcept
+{
+    if (block_)
+    {
+        secure_zero(block_.get(), period_ + XOR_KEY_WIDTH);
+        block_.reset();
+    }
+    length_ = 0;
+    period_ = 0;
+}
+
+void xor_key::apply(const char* source, char* output, std::size_t length, std::uint64_t position) const
+{
+    // period_ is 0 without a key, and the modulo below would divide by it
+    if (empty())
+    {
+        throw std::invalid_argument("xor_key::apply: the key is empty");
+    }
+
+    // period_ is a multiple of the key length, so the keystream at position starts at this index
+    const char* block = block_.get();
+    std::size_t k = static_cast<std::size_t>(position % period_);
+    std::size_t i = 0;
+
+    // one vector of source XOR one unaligned vector of key per step; k stays below period_, so the
+    // load at block + k never passes the extra vector at the end
+    for (; i + XOR_KEY_WIDTH <= length; i += XOR_KEY_WIDTH)
+    {
+#if XOR_KEY_WIDTH == 32
+        const __m256i data = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i));
+        const __m256i stream = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + k));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + i), _mm256_xor_si256(data, stream));
+#elif XOR_KEY_WIDTH == 16
+        const __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+        const __m128i stream = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + k));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i), _mm_xor_si128(data, stream));
+#else
+        std::uint64_t data;
+        std::uint64_t stream;
+        std::memcpy(&data, source + i, sizeof(data));
+        std::memcpy(&stream, block + k, sizeof(stream));
+        data ^= stream;
+        std::memcpy(output + i, &data, sizeof(data));
+#endif
+        k += XOR_KEY_WIDTH;
+        if (k >= period_)
+        {
+            k -= period_;
+        }
+    }
+
+    for (; i < length; ++i)
+    {
+        output[i] = source[i] ^ block[k];
+        if (++k == period_)
+        {
+            k = 0;
+        }
+    }
+}
+
+std::string encrypt_decrypt(std::string_view source, const xor_key& key)
+{
+    std::string output(source.size(), '\0');
+    if (!output.empty())
+    {
+        key.apply(source.data(), &output[0], source.size(), 0);
+    }
+    return output;
+}
+
+void encrypt_decrypt(const char* source, char* output, std::size_t length, const xor_key& key, std::uint64_t position)
+{
+    key.apply(source, output, length, position);
+}
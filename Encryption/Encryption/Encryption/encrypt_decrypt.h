@@ -0,0 +1,89 @@
+// encrypt_decrypt.h : Repeating key XOR transform used by the Encryption program.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+/// <summary>
+/// encrypt or decrypt a source string using the provided key
+/// </summary>
+/// <param name="source">input string to process</param>
+/// <param name="key">key to use in encryption / decryption</param>
+/// <returns>transformed string</returns>
+std::string encrypt_decrypt(const std::string& source, const std::string& key);
+
+/// <summary>
+/// The same transform on a slice of a longer message: byte i of source is combined with the key byte
+/// for message position position + i, so any range can be processed on its own. output may alias
+/// source.
+/// </summary>
+/// <param name="source">length bytes to process</param>
+/// <param name="output">receives length bytes</param>
+/// <param name="length">number of bytes</param>
+/// <param name="key">key to use, not empty</param>
+/// <param name="position">offset of source[0] within the whole message</param>
+void encrypt_decrypt(const char* source, char* output, std::size_t length, std::string_view key, std::uint64_t position) noexcept;
+
+/// <summary>
+/// A repeating XOR key prepared once for many calls. The key is laid out repeated to the least common
+/// multiple of its length and the vector width, plus one vector, so any message position reads a
+/// whole vector of key bytes with one unaligned load and the key index only has to wrap once per
+/// vector instead of once per byte. The prepared bytes are cleared with secure_zero when the key is
+/// destroyed or assigned over.
+/// </summary>
+class xor_key
+{
+public:
+    // bytes the kernel processes per step: 32 with AVX2, 16 with SSE2, 8 otherwise
+    static std::size_t width() noexcept;
+
+    // an empty key, which must be assigned before use
+    xor_key() noexcept = default;
+
+    /// <summary>
+    /// Prepares key, which must not be empty.
+    /// </summary>
+    explicit xor_key(std::string_view key);
+
+    xor_key(const xor_key&) = delete;
+    xor_key& operator=(const xor_key&) = delete;
+    xor_key(xor_key&& other) noexcept;
+    xor_key& operator=(xor_key&& other) noexcept;
+    ~xor_key();
+
+    bool empty() const noexcept { return length_ == 0; }
+
+    // length of the key itself
+    std::size_t length() const noexcept { return length_; }
+
+    // key bytes repeated: period() bytes, a multiple of length(), then width() more
+    std::size_t period() const noexcept { return period_; }
+
+    /// <summary>
+    /// The same transform as the string_view overload of encrypt_decrypt. output may alias source.
+    /// </summary>
+    /// <exception cref="std::invalid_argument">the key is empty, default constructed or moved from</exception>
+    void apply(const char* source, char* output, std::size_t length, std::uint64_t position) const;
+
+private:
+    void clear() noexcept;
+
+    std::unique_ptr<char[]> block_;
+    std::size_t length_ = 0;
+    std::size_t period_ = 0;
+};
+
+/// <summary>
+/// encrypt or decrypt source with a prepared key
+/// </summary>
+std::string encrypt_decrypt(std::string_view source, const xor_key& key);
+
+/// <summary>
+/// encrypt or decrypt a slice of a longer message with a prepared key, see xor_key::apply
+/// </summary>
+void encrypt_decrypt(const char* source, char* output, std::size_t length, const xor_key& key, std::uint64_t position);
@@ -0,0 +1,200 @@
+// input_header.cpp : Bounded header line search and field validation.
+//
+
+#include "input_header.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#include "random_access_file.h"
+
+namespace
+{
+    // what a line search found
+    enum class line_end
+    {
+        found,
+        end_of_input,
+        too_long
+    };
+
+    // Finds the end of the line at data[start]. Only max_length + 2 bytes ("\r\n") are searched,
+    // so an overlong line is rejected without reading the rest of it.
+    line_end find_line(const char* data, std::size_t size, bool complete, std::size_t start, std::size_t max_length,
+        std::size_t& length, std::size_t& next) noexcept
+    {
+        const std::size_t window = std::min(size - start, max_length + 2);
+        const auto* newline = static_cast<const char*>(std::memchr(data + start, '\n', window));
+        if (newline == nullptr)
+        {
+            // the line runs to the end of the input, or past what can be seen of it
+            if (!complete || window == max_length + 2 || size - start > max_length)
+            {
+                return line_end::too_long;
+            }
+            length = size - start;
+            next = size;
+            if (length > 0 && data[start + length - 1] == '\r')
+            {
+                --length;
+            }
+            return line_end::end_of_input;
+        }
+
+        length = static_cast<std::size_t>(newline - (data + start));
+        next = start + length + 1;
+        if (length > 0 && data[start + length - 1] == '\r')
+        {
+            --length;
+        }
+        return length > max_length ? line_end::too_long : line_end::found;
+    }
+
+    // UTF-8 as RFC 3629 allows it, and no control characters other than tab
+    bool valid_text(std::string_view text) noexcept
+    {
+        const auto* bytes = reinterpret_cast<const std::uint8_t*>(text.data());
+        const std::size_t size = text.size();
+        std::size_t i = 0;
+        while (i < size)
+        {
+            const std::uint8_t lead = bytes[i];
+            if (lead < 0x80)
+            {
+                if ((lead < 0x20 && lead != '\t') || lead == 0x7f)
+                {
+                    return false;
+                }
+                ++i;
+                continue;
+            }
+
+            // sequence length and the range of its second byte, which rules out overlong forms,
+            // surrogates and code points past U+10FFFF
+            std::size_t count = 0;
+            std::uint8_t low = 0x80;
+            std::uint8_t high = 0xbf;
+            if (lead >= 0xc2 && lead <= 0xdf)
+            {
+                count = 2;
+            }
+            else if (lead >= 0xe0 && lead <= 0xef)
+            {
+                count = 3;
+                low = lead == 0xe0 ? 0xa0 : 0x80;
+                high = lead == 0xed ? 0x9f : 0xbf;
+            }
+            else if (lead >= 0xf0 && lead <= 0xf4)
+            {
+                count = 4;
+                low = lead == 0xf0 ? 0x90 : 0x80;
+                high = lead == 0xf4 ? 0x8f : 0xbf;
+            }
+            else
+            {
+                return false;
+            }
+
+            if (size - i < count || bytes[i + 1] < low || bytes[i + 1] > high)
+            {
+                return false;
+            }
+            for (std::size_t k = 2; k < count; ++k)
+            {
+                if ((bytes[i + k] & 0xc0) != 0x80)
+                {
+                    return false;
+                }
+            }
+            // C1 control characters, U+0080 to U+009F
+            if (lead == 0xc2 && bytes[i + 1] < 0xa0)
+            {
+                return false;
+            }
+            i += count;
+        }
+        return true;
+    }
+}
+
+const char* to_string(input_header_error error) noexcept
+{
+    switch (error)
+    {
+    case input_header_error::io_error:
+        return "the file could not be read";
+    case input_header_error::missing_name:
+        return "the file does not start with a student name";
+    case input_header_error::name_too_long:
+        return "the student name is too long";
+    case input_header_error::missing_source:
+        return "the file has no source line after the student name";
+    case input_header_error::source_too_long:
+        return "the source line is too long";
+    case input_header_error::invalid_encoding:
+        return "the header is not valid UTF-8 text";
+    }
+    return "unknown input header error";
+}
+
+expected<input_header, input_header_error> parse_input_header(const char* data, std::size_t size, bool complete) noexcept
+{
+    // nothing past the limit is looked at, whatever the caller passes
+    if (size > input_header_limit)
+    {
+        size = input_header_limit;
+        complete = false;
+    }
+
+    input_header header;
+    std::size_t length = 0;
+    std::size_t next = 0;
+    const line_end name = find_line(data, size, complete, 0, max_student_name_length, length, next);
+    if (name == line_end::too_long)
+    {
+        return unexpected(input_header_error::name_too_long);
+    }
+    if (length == 0)
+    {
+        return unexpected(input_header_error::missing_name);
+    }
+    header.student_name = std::string_view(data, length);
+    if (name == line_end::end_of_input)
+    {
+        return unexpected(input_header_error::missing_source);
+    }
+
+    const std::size_t source_start = next;
+    if (find_line(data, size, complete, source_start, max_source_url_length, length, next) == line_end::too_long)
+    {
+        return unexpected(input_header_error::source_too_long);
+    }
+    if (length == 0)
+    {
+        return unexpected(input_header_error::missing_source);
+    }
+    header.source_url = std::string_view(data + source_start, length);
+    header.payload_offset = next;
+
+    if (!valid_text(header.student_name) || !valid_text(header.source_url))
+    {
+        return unexpected(input_header_error::invalid_encoding);
+    }
+    return header;
+}
+
+expected<input_header, input_header_error> read_input_header(const std::string& filename, char* buffer, std::size_t size)
+{
+    random_access_file file;
+    if (!file.open(filename))
+    {
+        return unexpected(input_header_error::io_error);
+    }
+    const std::ptrdiff_t count = file.read_at(0, buffer, std::min(size, input_header_limit));
+    if (count < 0)
+    {
+        return unexpected(input_header_error::io_error);
+    }
+    return parse_input_header(buffer, static_cast<std::size_t>(count), file.size() <= static_cast<std::uint64_t>(count));
+}
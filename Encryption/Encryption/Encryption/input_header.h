@@ -0,0 +1,65 @@
+// input_header.h : The two header lines of an Encryption input file, read without loading the file.
+//
+// An input file is the student name on line 1, the lorem ipsum generator used on line 2 and the
+// generated text from line 3 on. get_student_name used to need the whole file in memory and copied
+// the name out of it. parse_input_header looks at no more than input_header_limit bytes, finds the
+// line ends with memchr (vectorised in every mainstream C library), checks both fields and hands
+// them back as views, so reading the metadata of a file costs the same however large it is.
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+#include "expected.h"
+
+// the header is always found in this many bytes, or it is rejected
+constexpr std::size_t input_header_limit = 4096;
+// the name has to fit in a data container header
+constexpr std::size_t max_student_name_length = 128;
+constexpr std::size_t max_source_url_length = 2048;
+
+enum class input_header_error
+{
+    io_error,
+    missing_name,
+    name_too_long,
+    missing_source,
+    source_too_long,
+    invalid_encoding
+};
+
+const char* to_string(input_header_error error) noexcept;
+
+// The fields are views into the caller's buffer, not copies: they are valid only as long as the
+// data given to parse_input_header (or the buffer given to read_input_header) is.
+struct input_header
+{
+    // line 1 without its line end
+    std::string_view student_name;
+    // line 2 without its line end
+    std::string_view source_url;
+    // where line 3, the payload, starts
+    std::size_t payload_offset = 0;
+};
+
+/// <summary>
+/// Finds and checks the header lines at the start of data. Both lines end in "\n" or "\r\n"; the
+/// second may instead end the input. Fields must be valid UTF-8 without control characters, neither
+/// may be empty, the name is at most max_student_name_length bytes and the source at most
+/// max_source_url_length.
+/// </summary>
+/// <param name="data">start of the file</param>
+/// <param name="size">bytes available at data</param>
+/// <param name="complete">true when data holds the whole file, so its end is the end of the input</param>
+/// <returns>views into data, which must outlive them</returns>
+expected<input_header, input_header_error> parse_input_header(const char* data, std::size_t size, bool complete = true) noexcept;
+
+/// <summary>
+/// Reads the first bytes of filename into buffer, at most size and no more than the header can
+/// need, and parses them.
+/// </summary>
+/// <param name="buffer">receives the start of the file, input_header_limit bytes is always enough</param>
+/// <returns>views into buffer, which must outlive them</returns>
+expected<input_header, input_header_error> read_input_header(const std::string& filename, char* buffer, std::size_t size);
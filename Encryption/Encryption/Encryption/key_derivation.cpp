@@ -0,0 +1,255 @@
+// key_derivation.cpp : Portable SHA-256 compression function and the HMAC / PBKDF2 constructions on it.
+//
+
+#include "key_derivation.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "secure_zero.h"
+
+namespace
+{
+    const std::uint32_t round_constants[64] = {
+        0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+        0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+        0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+        0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+        0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+        0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+        0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+        0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+    };
+
+    const std::uint32_t initial_hash[8] = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+    };
+
+    std::uint32_t rotate_right(std::uint32_t value, int count) noexcept
+    {
+        return value >> count | value << (32 - count);
+    }
+
+    std::uint32_t load_big_endian(const std::uint8_t* bytes) noexcept
+    {
+        return static_cast<std::uint32_t>(bytes[0]) << 24 | static_cast<std::uint32_t>(bytes[1]) << 16 |
+            static_cast<std::uint32_t>(bytes[2]) << 8 | static_cast<std::uint32_t>(bytes[3]);
+    }
+
+    void store_big_endian(std::uint8_t* bytes, std::uint32_t value) noexcept
+    {
+        bytes[0] = static_cast<std::uint8_t>(value >> 24);
+        bytes[1] = static_cast<std::uint8_t>(value >> 16);
+        bytes[2] = static_cast<std::uint8_t>(value >> 8);
+        bytes[3] = static_cast<std::uint8_t>(value);
+    }
+
+    void compress(std::uint32_t* state, const std::uint8_t* block) noexcept
+    {
+        std::uint32_t w[64];
+        for (int i = 0; i < 16; ++i)
+        {
+            w[i] = load_big_endian(block + 4 * i);
+        }
+        for (int i = 16; i < 64; ++i)
+        {
+            const std::uint32_t s0 = rotate_right(w[i - 15], 7) ^ rotate_right(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            const std::uint32_t s1 = rotate_right(w[i - 2], 17) ^ rotate_right(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+
+        std::uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+        std::uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+        for (int i = 0; i < 64; ++i)
+        {
+            const std::uint32_t s1 = rotate_right(e, 6) ^ rotate_right(e, 11) ^ rotate_right(e, 25);
+            const std::uint32_t choose = (e & f) ^ (~e & g);
+            const std::uint32_t t1 = h + s1 + choose + round_constants[i] + w[i];
+            const std::uint32_t s0 = rotate_right(a, 2) ^ rotate_right(a, 13) ^ rotate_right(a, 22);
+            const std::uint32_t majority = (a & b) ^ (a & c) ^ (b & c);
+            const std::uint32_t t2 = s0 + majority;
+            h = g;
+            g = f;
+            f = e;
+            e = d + t1;
+            d = c;
+            c = b;
+            b = a;
+            a = t1 + t2;
+        }
+
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+        state[4] += e;
+        state[5] += f;
+        state[6] += g;
+        state[7] += h;
+        secure_zero(w, sizeof(w));
+    }
+
+    // the inner and outer hashes of HMAC with the key already absorbed, so PBKDF2 pays for the key
+    // block once rather than on each of its iterations
+    struct hmac_key
+    {
+        sha256 inner;
+        sha256 outer;
+
+        hmac_key(const void* key, std::size_t key_size) noexcept
+        {
+            std::uint8_t block[64] = {};
+            if (key_size > sizeof(block))
+            {
+                sha256 hash;
+                hash.update(key, key_size);
+                hash.finish(block);
+            }
+            else
+            {
+                std::memcpy(block, key, key_size);
+            }
+
+            std::uint8_t pad[64];
+            for (std::size_t i = 0; i < sizeof(pad); ++i)
+            {
+                pad[i] = block[i] ^ 0x36;
+            }
+            inner.update(pad, sizeof(pad));
+            for (std::size_t i = 0; i < sizeof(pad); ++i)
+            {
+                pad[i] = block[i] ^ 0x5c;
+            }
+            outer.update(pad, sizeof(pad));
+
+            secure_zero(block, sizeof(block));
+            secure_zero(pad, sizeof(pad));
+        }
+
+        void mac(const void* message, std::size_t size, std::uint8_t* out) const noexcept
+        {
+            sha256 first = inner;
+            first.update(message, size);
+            std::uint8_t digest[sha256_size];
+            first.finish(digest);
+
+            sha256 second = outer;
+            second.update(digest, sizeof(digest));
+            second.finish(out);
+            secure_zero(digest, sizeof(digest));
+        }
+    };
+}
+
+sha256::sha256() noexcept
+{
+    std::memcpy(state_, initial_hash, sizeof(state_));
+}
+
+sha256::~sha256()
+{
+    secure_zero(state_, sizeof(state_));
+    secure_zero(buffer_, sizeof(buffer_));
+}
+
+void sha256::update(const void* data, std::size_t size) noexcept
+{
+    const std::uint8_t* bytes = static_cast<const std::uint8_t*>(data);
+    length_ += size;
+
+    if (buffered_ != 0)
+    {
+        const std::size_t count = std::min(size, sizeof(buffer_) - buffered_);
+        std::memcpy(buffer_ + buffered_, bytes, count);
+        buffered_ += count;
+        bytes += count;
+        size -= count;
+        if (buffered_ < sizeof(buffer_))
+        {
+            return;
+        }
+        compress(state_, buffer_);
+        buffered_ = 0;
+    }
+
+    for (; size >= 64; bytes += 64, size -= 64)
+    {
+        compress(state_, bytes);
+    }
+    if (size != 0)
+    {
+        std::memcpy(buffer_, bytes, size);
+    }
+    buffered_ = size;
+}
+
+void sha256::finish(std::uint8_t* digest) noexcept
+{
+    // a 1 bit, zeros up to 56 bytes into the last block, then the length in bits
+    const std::uint64_t bits = length_ * 8;
+    buffer_[buffered_++] = 0x80;
+    if (buffered_ > 56)
+    {
+        std::memset(buffer_ + buffered_, 0, sizeof(buffer_) - buffered_);
+        compress(state_, buffer_);
+        buffered_ = 0;
+    }
+    std::memset(buffer_ + buffered_, 0, 56 - buffered_);
+    store_big_endian(buffer_ + 56, static_cast<std::uint32_t>(bits >> 32));
+    store_big_endian(buffer_ + 60, static_cast<std::uint32_t>(bits));
+    compress(state_, buffer_);
+
+    for (int i = 0; i < 8; ++i)
+    {
+        store_big_endian(digest + 4 * i, state_[i]);
+    }
+}
+
+void hmac_sha256(const void* key, std::size_t key_size, const void* message, std::size_t message_size, std::uint8_t* mac) noexcept
+{
+    const hmac_key prepared(key, key_size);
+    prepared.mac(message, message_size, mac);
+}
+
+void pbkdf2_sha256(std::string_view password, const std::uint8_t* salt, std::size_t salt_size, std::uint32_t iterations,
+    std::uint8_t* output, std::size_t output_size) noexcept
+{
+    const hmac_key prepared(password.data(), password.size());
+
+    // block i is U1 ^ U2 ^ ... ^ Uc with U1 = HMAC(salt || i) and Uj = HMAC(Uj-1)
+    for (std::uint32_t index = 1; output_size != 0; ++index)
+    {
+        sha256 first = prepared.inner;
+        first.update(salt, salt_size);
+        std::uint8_t counter[4];
+        store_big_endian(counter, index);
+        first.update(counter, sizeof(counter));
+        std::uint8_t digest[sha256_size];
+        first.finish(digest);
+        sha256 second = prepared.outer;
+        second.update(digest, sizeof(digest));
+
+        std::uint8_t u[sha256_size];
+        second.finish(u);
+        std::uint8_t block[sha256_size];
+        std::memcpy(block, u, sizeof(block));
+
+        for (std::uint32_t i = 1; i < iterations; ++i)
+        {
+            prepared.mac(u, sizeof(u), u);
+            for (std::size_t j = 0; j < sizeof(block); ++j)
+            {
+                block[j] ^= u[j];
+            }
+        }
+
+        const std::size_t count = std::min(output_size, sizeof(block));
+        std::memcpy(output, block, count);
+        output += count;
+        output_size -= count;
+
+        secure_zero(digest, sizeof(digest));
+        secure_zero(u, sizeof(u));
+        secure_zero(block, sizeof(block));
+    }
+}
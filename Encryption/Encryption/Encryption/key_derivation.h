@@ -0,0 +1,55 @@
+// key_derivation.h : SHA-256, HMAC-SHA-256 and PBKDF2-HMAC-SHA-256.
+//
+// A password is not a key: it is short, guessable and the wrong length. PBKDF2 stretches it with a
+// salt and many HMAC iterations into key material, so every guess an attacker makes costs as much as
+// the derivation itself and the same password gives a different key under a different salt.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+constexpr std::size_t sha256_size = 32;
+
+/// <summary>
+/// Incremental SHA-256.
+/// </summary>
+class sha256
+{
+public:
+    sha256() noexcept;
+    ~sha256();
+
+    void update(const void* data, std::size_t size) noexcept;
+
+    /// <summary>
+    /// Writes the digest. The object must not be updated afterwards.
+    /// </summary>
+    /// <param name="digest">receives sha256_size bytes</param>
+    void finish(std::uint8_t* digest) noexcept;
+
+private:
+    std::uint32_t state_[8];
+    std::uint64_t length_ = 0;
+    std::uint8_t buffer_[64];
+    std::size_t buffered_ = 0;
+};
+
+/// <summary>
+/// HMAC-SHA-256 of message under key.
+/// </summary>
+/// <param name="mac">receives sha256_size bytes</param>
+void hmac_sha256(const void* key, std::size_t key_size, const void* message, std::size_t message_size, std::uint8_t* mac) noexcept;
+
+/// <summary>
+/// PBKDF2 with HMAC-SHA-256 as the pseudorandom function, RFC 8018.
+/// </summary>
+/// <param name="password">secret to stretch</param>
+/// <param name="salt">salt bytes, stored next to whatever the key protects</param>
+/// <param name="salt_size">number of salt bytes</param>
+/// <param name="iterations">HMAC iterations per output block, at least 1</param>
+/// <param name="output">receives output_size bytes of key material</param>
+/// <param name="output_size">number of bytes to derive</param>
+void pbkdf2_sha256(std::string_view password, const std::uint8_t* salt, std::size_t salt_size, std::uint32_t iterations,
+    std::uint8_t* output, std::size_t output_size) noexcept;
@@ -2,66 +2,47 @@
 //
 
 #include <iostream>
+#include <limits>
+
+#include "application_logic.h"
+#include "exception_stats.h"
 
 bool do_even_more_custom_application_logic()
 {
 	// TODO: Throw any standard exception
-	std::cout << "Running Even More Custom Application Logic." << std::endl;
-
-	// Throw a standard exception which will be caught as part of the try/catch
-	// block in do_custom_application_logic
-	throw std::exception("An Exception has occurred");
-
-	return true;
+	// The logic lives in try_even_more_custom_application_logic, which returns its error. Turn it back
+	// into the standard exception callers of this function expect.
+	return value_or_throw(try_even_more_custom_application_logic());
 }
 void do_custom_application_logic()
 {
 	// TODO: Wrap the call to do_even_more_custom_application_logic()
 	//  with an exception handler that catches std::exception, displays
 	//  a message and the exception.what(), then continues processing
-	std::cout << "Running Custom Application Logic." << std::endl;
-
-	// Wrap call to do_even_more_custom_application_logic in try/catch block,
-	// catching a standard exception if it gets thrown.
-	try
-	{
-		if (do_even_more_custom_application_logic())
-		{
-			std::cout << "Even More Custom Application Logic Succeeded." << std::endl;
-		}
-	}
-	catch (std::exception& exception)
-	{
-		std::cout << exception.what() << std::endl;
-	}
 
 	// TODO: Throw a custom exception derived from std::exception
 	//  and catch it explictly in main
 
-	std::cout << "Leaving Custom Application Logic." << std::endl;
-
-	// Throw logic_error that with message stating this is being thrown.
-	throw std::logic_error("A Logic Error has occurred");
-
+	// try_custom_application_logic handles the failure of the even more custom logic without an
+	// exception, then returns the logic error, which is thrown here for main to catch.
+	value_or_throw(try_custom_application_logic());
 }
 
 float divide(float num, float den)
 {
 	// TODO: Throw an exception to deal with divide by zero errors using
 	//  a standard C++ defined exception
-	try
-	{
-		if (den == 0)
-			// Throw runtime_error exception with message that states a Divide by 0
-			// error is about to occur.
-			throw std::runtime_error("Denominator cannot be 0");
 
-		return (num / den);
-	}
-	catch (std::runtime_error& runtime_error)
+	// A zero denominator is reported without throwing and catching a std::runtime_error, and the
+	// result is NaN rather than an undefined value from falling off the end of the function.
+	const auto result = try_divide(num, den);
+	if (!result)
 	{
-		std::cout << "Runtime Error: " << runtime_error.what() << std::endl;
+		std::cout << "Runtime Error: " << result.error().message << std::endl;
+		return std::numeric_limits<float>::quiet_NaN();
 	}
+
+	return *result;
 }
 
 void do_division() noexcept
@@ -80,29 +61,40 @@ int main()
 {
 	std::cout << "Exceptions Tests!" << std::endl;
 
+	// Count every throw by type and call site and time its unwind. The report is written every
+	// 10 seconds while the program runs and once more when main returns. A stack trace is kept
+	// for every throw here; a busy program would sample far fewer.
+	exception_stats::set_sample_interval(1);
+	exception_stats::periodic_report exception_report(std::cout, std::chrono::seconds(10));
+
 	// TODO: Create exception handlers that catch (in this order):
 	//  your custom exception
 	//  std::exception
 	//  uncaught exception 
 	//  that wraps the whole main function, and displays a message to the console.
 
-	// Wrap main method logic in try/catch block, with catching a Logic error, standard exception, and general
-	// catch all exception at the end on the block.
+	// Wrap main method logic in try/catch block, catching the custom exceptions from application_exceptions.h
+	// first, then a standard exception, and a general catch all exception at the end on the block.
 	try
 	{
 		do_division();
 		do_custom_application_logic();
 	}
-	catch (std::logic_error& logic_error)
+	catch (application_logic_error& logic_error)
 	{
 		std::cout << "Logic Error: " << logic_error.what() << std::endl;
 	}
+	catch (application_exception& exception)
+	{
+		std::cout << "Application Exception (" << to_string(exception.code()) << "): " << exception.what() << std::endl;
+	}
 	catch (std::exception& exception)
 	{
 		std::cout << "Exception: " << exception.what() << std::endl;
 	}
 	catch (...)
 	{
+		std::cout << "Unknown exception caught." << std::endl;
 	}
 }
 
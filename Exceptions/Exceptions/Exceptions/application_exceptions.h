@@ -0,0 +1,90 @@
+// application_exceptions.h : Exception hierarchy for the Exceptions program.
+//
+// std::runtime_error and std::logic_error copy their message into a heap allocated string every time
+// one is constructed, so throwing one allocates, which is the wrong moment to need memory. These
+// exceptions hold a pointer to a static message and an error_code instead, so constructing, copying
+// and throwing them never calls operator new.
+
+#pragma once
+
+#include <exception>
+
+/// <summary>
+/// What went wrong, independent of the message text.
+/// </summary>
+enum class error_code
+{
+    unknown,
+    divide_by_zero,
+    custom_logic_failed,
+    even_more_custom_logic_failed
+};
+
+/// <summary>
+/// Name of an error code, for messages.
+/// </summary>
+constexpr const char* to_string(error_code code) noexcept
+{
+    switch (code)
+    {
+    case error_code::divide_by_zero:
+        return "divide_by_zero";
+    case error_code::custom_logic_failed:
+        return "custom_logic_failed";
+    case error_code::even_more_custom_logic_failed:
+        return "even_more_custom_logic_failed";
+    case error_code::unknown:
+    default:
+        return "unknown";
+    }
+}
+
+/// <summary>
+/// Base of every exception the program throws. message must outlive the exception, use a string literal.
+/// </summary>
+class application_exception : public std::exception
+{
+public:
+    application_exception(error_code code, const char* message) noexcept
+        : code_(code),
+          message_(message)
+    {
+    }
+
+    const char* what() const noexcept override { return message_; }
+    error_code code() const noexcept { return code_; }
+
+private:
+    error_code code_;
+    const char* message_;
+};
+
+/// <summary>
+/// Failure detected while running, the counterpart of std::runtime_error.
+/// </summary>
+class application_runtime_error : public application_exception
+{
+public:
+    using application_exception::application_exception;
+};
+
+/// <summary>
+/// Division with a zero denominator.
+/// </summary>
+class divide_by_zero_error : public application_runtime_error
+{
+public:
+    divide_by_zero_error() noexcept
+        : application_runtime_error(error_code::divide_by_zero, "Denominator cannot be 0")
+    {
+    }
+};
+
+/// <summary>
+/// Broken assumption in the program logic, the counterpart of std::logic_error.
+/// </summary>
+class application_logic_error : public application_exception
+{
+public:
+    using application_exception::application_exception;
+};
@@ -0,0 +1,60 @@
+// application_logic.cpp : expected based versions of the operations in Exceptions.cpp.
+//
+
+#include "application_logic.h"
+
+#include <iostream>
+
+void throw_exception(const application_error& error)
+{
+    switch (error.kind)
+    {
+    case error_kind::runtime:
+        if (error.code == error_code::divide_by_zero)
+        {
+            throw divide_by_zero_error();
+        }
+        throw application_runtime_error(error.code, error.message);
+    case error_kind::logic:
+        throw application_logic_error(error.code, error.message);
+    case error_kind::general:
+    default:
+        throw application_exception(error.code, error.message);
+    }
+}
+
+expected<float, application_error> try_divide(float num, float den) noexcept
+{
+    if (den == 0)
+    {
+        return unexpected(application_error{ error_kind::runtime, error_code::divide_by_zero, "Denominator cannot be 0" });
+    }
+    return num / den;
+}
+
+expected<bool, application_error> try_even_more_custom_application_logic()
+{
+    std::cout << "Running Even More Custom Application Logic." << std::endl;
+
+    return unexpected(application_error{ error_kind::general, error_code::even_more_custom_logic_failed, "An Exception has occurred" });
+}
+
+expected<void, application_error> try_custom_application_logic()
+{
+    std::cout << "Running Custom Application Logic." << std::endl;
+
+    // same as the catch of std::exception in do_custom_application_logic: show the message and carry on
+    const auto result = try_even_more_custom_application_logic();
+    if (!result)
+    {
+        std::cout << result.error().message << std::endl;
+    }
+    else if (*result)
+    {
+        std::cout << "Even More Custom Application Logic Succeeded." << std::endl;
+    }
+
+    std::cout << "Leaving Custom Application Logic." << std::endl;
+
+    return unexpected(application_error{ error_kind::logic, error_code::custom_logic_failed, "A Logic Error has occurred" });
+}
@@ -0,0 +1,52 @@
+// application_logic.h : expected based versions of the operations in Exceptions.cpp.
+//
+// The functions here report failure by returning an application_error instead of throwing, so a
+// caller that sees many failures pays for a branch rather than an unwind. Exceptions.cpp keeps its
+// exception based interface by converting the errors with value_or_throw() at its edges.
+
+#pragma once
+
+#include "application_exceptions.h"
+#include "expected.h"
+
+/// <summary>
+/// Which exception the error turns into when it reaches code that still uses exceptions.
+/// </summary>
+enum class error_kind
+{
+    // application_runtime_error, or divide_by_zero_error for error_code::divide_by_zero
+    runtime,
+    // application_logic_error
+    logic,
+    // application_exception
+    general
+};
+
+struct application_error
+{
+    error_kind kind = error_kind::general;
+    error_code code = error_code::unknown;
+    // static text, so creating and copying an error never allocates
+    const char* message = "";
+};
+
+/// <summary>
+/// Throws the exception that matches error.kind. Used by value_or_throw().
+/// </summary>
+[[noreturn]] void throw_exception(const application_error& error);
+
+/// <summary>
+/// num / den, or a runtime error when den is 0.
+/// </summary>
+expected<float, application_error> try_divide(float num, float den) noexcept;
+
+/// <summary>
+/// Runs the even more custom application logic, which always fails with a general error.
+/// </summary>
+expected<bool, application_error> try_even_more_custom_application_logic();
+
+/// <summary>
+/// Runs the custom application logic: reports the failure of the even more custom logic and carries
+/// on, then fails with a logic error.
+/// </summary>
+expected<void, application_error> try_custom_application_logic();
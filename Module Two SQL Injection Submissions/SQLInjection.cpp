@@ -8,6 +8,7 @@
 #include <vector>
 #include <sstream>
 #include "sqlite3.h"
+#include "fast_random.h"
 
 // DO NOT CHANGE
 typedef std::tuple<std::string, std::string, std::string> user_record;
@@ -171,7 +172,7 @@ bool run_query_injection(sqlite3* db, const std::string& sql, std::vector< user_
             injectedSQL.pop_back();
         }
 
-        switch (rand() % 4)
+        switch (fast_random::uniform(4))
         {
         case 1:
             injectedSQL.append(" or 2=2;");
@@ -235,7 +236,7 @@ void run_queries(sqlite3* db)
 int main()
 {
     // initialize random seed:
-    srand(time(nullptr));
+    fast_random::seed(time(nullptr));
 
     int return_code = 0;
     std::cout << "SQL Injection Example" << std::endl;
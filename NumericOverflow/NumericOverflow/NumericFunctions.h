@@ -0,0 +1,389 @@
+// NumericFunctions.h : Overflow / underflow checked add_numbers and subtract_numbers templates.
+//
+// The 64 bit limits checks go through float, which is close enough for the demonstration in main.
+// __int128 / unsigned __int128 and wide_int<Bits> / wide_uint<Bits> are checked exactly with the
+// carry-chain kernels of wide_int.h, as is any integer type typeid does not name here.
+
+#pragma once
+
+#include <cfloat>       // FLT_MAX, DBL_MAX, LDBL_MAX
+#include <climits>      // CHAR_MAX, INT_MAX, ...
+#include <cstring>      // std::strcmp
+#include <cwchar>       // WCHAR_MAX, WCHAR_MIN
+#include <limits>       // std::numeric_limits
+#include <typeinfo>     // typeid
+
+#include "wide_int.h"
+
+/// <summary>
+/// Custom Enum values used to perform switch case logic to determine current type.
+/// </summary>
+enum class string_type_values
+{
+	eChar,
+	eWChar_T,
+	eShortInt,
+	eInt,
+	eLong,
+	eInt64,
+	eInt128,
+	eUnsignedChar,
+	eUnsignedShortInt,
+	eUnsignedInt,
+	eUnsignedLong,
+	eUnsignedInt64,
+	eUnsignedInt128,
+	eFloat,
+	eDouble,
+	eLongDouble,
+	eUnknown
+};
+
+/// <summary>
+/// Accepts the string value of the current type and
+/// converts into a custom string_type_values enum. Understands the names MSVC reports
+/// ("unsigned __int64") and the Itanium ABI codes gcc and clang report ("y", "o" for unsigned __int128).
+/// </summary>
+/// <param name="type_value">name reported by typeid</param>
+/// <returns>matching string_type_values entry</returns>
+inline string_type_values convert_to_enum(const char* type_value)
+{
+	if (std::strcmp(type_value, "char") == 0 || std::strcmp(type_value, "c") == 0)
+	{
+        return string_type_values::eChar;
+	}
+    else if(std::strcmp(type_value, "wchar_t") == 0 || std::strcmp(type_value, "w") == 0)
+    {
+        return string_type_values::eWChar_T;
+    }
+    else if (std::strcmp(type_value, "short") == 0 || std::strcmp(type_value, "s") == 0)
+    {
+        return string_type_values::eShortInt;
+    }
+    else if (std::strcmp(type_value, "int") == 0 || std::strcmp(type_value, "i") == 0)
+    {
+        return string_type_values::eInt;
+    }
+    else if (std::strcmp(type_value, "long") == 0 || std::strcmp(type_value, "l") == 0)
+    {
+        return string_type_values::eLong;
+    }
+    else if (std::strcmp(type_value, "__int64") == 0 || std::strcmp(type_value, "x") == 0)
+    {
+        return string_type_values::eInt64;
+    }
+    else if (std::strcmp(type_value, "__int128") == 0 || std::strcmp(type_value, "n") == 0)
+    {
+        return string_type_values::eInt128;
+    }
+    else if (std::strcmp(type_value, "unsigned char") == 0 || std::strcmp(type_value, "h") == 0)
+    {
+        return string_type_values::eUnsignedChar;
+    }
+    else if (std::strcmp(type_value, "unsigned short") == 0 || std::strcmp(type_value, "t") == 0)
+    {
+        return string_type_values::eUnsignedShortInt;
+    }
+    else if (std::strcmp(type_value, "unsigned int") == 0 || std::strcmp(type_value, "j") == 0)
+    {
+        return string_type_values::eUnsignedInt;
+    }
+    else if (std::strcmp(type_value, "unsigned long") == 0 || std::strcmp(type_value, "m") == 0)
+    {
+        return string_type_values::eUnsignedLong;
+    }
+    else if (std::strcmp(type_value, "unsigned __int64") == 0 || std::strcmp(type_value, "y") == 0)
+    {
+        return string_type_values::eUnsignedInt64;
+    }
+    else if (std::strcmp(type_value, "unsigned __int128") == 0 || std::strcmp(type_value, "o") == 0)
+    {
+        return string_type_values::eUnsignedInt128;
+    }
+    else if (std::strcmp(type_value, "float") == 0 || std::strcmp(type_value, "f") == 0)
+    {
+        return string_type_values::eFloat;
+    }
+    else if (std::strcmp(type_value, "double") == 0 || std::strcmp(type_value, "d") == 0)
+    {
+        return string_type_values::eDouble;
+    }
+    else if (std::strcmp(type_value, "long double") == 0 || std::strcmp(type_value, "e") == 0)
+    {
+        return string_type_values::eLongDouble;
+    }
+
+    return string_type_values::eUnknown;
+}
+
+/// <summary>
+/// Responsible for preventing overflows by determining if the current result value is greater than 0, and
+/// if the result is greater than the maximum value allotted minus the desired increment
+/// for the current type.
+/// </summary>
+/// <typeparam name="T"></typeparam>
+/// <param name="result"></param>
+/// <param name="max"></param>
+/// <param name="increment"></param>
+/// <returns></returns>
+template <typename T>
+bool is_valid_maximum_value(T result, float max, T const& increment)
+{
+    return (result > 0) && (result > max - increment);
+}
+
+/// <summary>
+/// Responsible for preventing underflows by determining if the current result value is equal to 0 and
+/// if the result is less than the minimum value allotted plus the desired decrement for the current type. 
+/// </summary>
+/// <typeparam name="T"></typeparam>
+/// <param name="result"></param>
+/// <param name="min"></param>
+/// <param name="decrement"></param>
+/// <returns></returns>
+template <typename T>
+bool is_valid_minimum_value(T result, float min, T const& decrement)
+{
+    return (result == 0) && (result < min + decrement);
+}
+
+/// <summary>
+/// Exact overflow check for integer types: true when result + increment does not fit in T.
+/// Other types never overflow here; they are checked against their limits by is_overflow.
+/// </summary>
+/// <typeparam name="T">Generic type T</typeparam>
+/// <param name="result">Result value used to validate against</param>
+/// <param name="increment">How much would be added</param>
+/// <returns>True if result + increment would overflow.</returns>
+template <typename T>
+bool is_exact_overflow(T result, T const& increment)
+{
+    if constexpr (is_checked_integer<T>::value)
+    {
+        T sum;
+        return add_overflows(result, increment, sum);
+    }
+    else
+    {
+        return false;
+    }
+}
+
+/// <summary>
+/// Exact underflow check for integer types: true when result - decrement does not fit in T.
+/// </summary>
+/// <typeparam name="T">Generic type T</typeparam>
+/// <param name="result">Result value used to validate against</param>
+/// <param name="decrement">How much would be subtracted</param>
+/// <returns>True if result - decrement would underflow.</returns>
+template <typename T>
+bool is_exact_underflow(T result, T const& decrement)
+{
+    if constexpr (is_checked_integer<T>::value)
+    {
+        T difference;
+        return subtract_overflows(result, decrement, difference);
+    }
+    else
+    {
+        return false;
+    }
+}
+
+/// <summary>
+/// Responsible for checking the type of the given result and validating that the result
+/// value will remain under the specified type's maximum value. 
+/// </summary>
+/// <typeparam name="T">Generic type T</typeparam>
+/// <param name="result">Result value used to validate against</param>
+/// <param name="increment">Constant increment value passed in from Main.</param>
+/// <returns>True if result will overflow. False if result will not overflow.</returns>
+template <typename T>
+bool is_overflow(T result, T const& increment)
+{
+    // the type never changes for a given T, so the string comparisons run once rather than on every
+    // step of add_numbers / subtract_numbers
+    static const string_type_values type_value = convert_to_enum(typeid(T).name());
+
+	switch (type_value)
+	{
+		case string_type_values::eChar:
+            return is_valid_maximum_value(result, CHAR_MAX, increment);
+        case string_type_values::eWChar_T:
+            return is_valid_maximum_value(result, WCHAR_MAX, increment);
+        case string_type_values::eShortInt:
+            return is_valid_maximum_value(result, SHRT_MAX, increment);
+        case string_type_values::eInt:
+            return is_valid_maximum_value(result, INT_MAX, increment);
+        case string_type_values::eLong:
+            return is_valid_maximum_value(result, LONG_MAX, increment);
+        case string_type_values::eInt64:
+            return is_valid_maximum_value(result, LLONG_MAX, increment);
+        case string_type_values::eInt128:
+            return is_exact_overflow(result, increment);
+        case string_type_values::eUnsignedChar:
+            return is_valid_maximum_value(result, UCHAR_MAX, increment);
+        case string_type_values::eUnsignedShortInt:
+            return is_valid_maximum_value(result, USHRT_MAX, increment);
+        case string_type_values::eUnsignedInt:
+            return is_valid_maximum_value(result, UINT_MAX, increment);
+        case string_type_values::eUnsignedLong:
+            return is_valid_maximum_value(result, ULONG_MAX, increment);
+        case string_type_values::eUnsignedInt64:
+            return is_valid_maximum_value(result, ULLONG_MAX, increment);
+        case string_type_values::eUnsignedInt128:
+            return is_exact_overflow(result, increment);
+        case string_type_values::eFloat:
+            return is_valid_maximum_value(result, FLT_MAX, increment);
+        case string_type_values::eDouble:
+            return is_valid_maximum_value(result, DBL_MAX, increment);
+        case string_type_values::eLongDouble:
+            return is_valid_maximum_value(result, LDBL_MAX, increment);
+	    default:
+	        break;
+	}
+
+    // a type typeid does not name here (signed char, char32_t, ...): exact when it is an integer,
+    // against its own limits when the standard library describes it
+    if constexpr (!is_checked_integer<T>::value && std::numeric_limits<T>::is_specialized)
+    {
+        return result > 0 && result > std::numeric_limits<T>::max() - increment;
+    }
+    return is_exact_overflow(result, increment);
+}
+
+/// <summary>
+/// is_overflow for wide_int and wide_uint, exact through the carry chain.
+/// </summary>
+template <std::size_t Bits, bool Signed>
+bool is_overflow(wide_integer<Bits, Signed> result, wide_integer<Bits, Signed> const& increment)
+{
+    wide_integer<Bits, Signed> sum;
+    return add_overflows(result, increment, sum);
+}
+
+/// <summary>
+/// Responsible for checking the type of the given result and validating that the result
+/// value will remain above the specified type's minimum value. 
+/// </summary>
+/// <typeparam name="T">Generic type T</typeparam>
+/// <param name="result">Result value used to validate against</param>
+/// <param name="decrement">Constant decrement value passed in from Main.</param>
+/// <returns>True if result will underflow. False if  will not underflow.</returns>
+template <typename T>
+bool is_underflow(T result, T const& decrement)
+{
+    // the type never changes for a given T, so the string comparisons run once rather than on every
+    // step of add_numbers / subtract_numbers
+    static const string_type_values type_value = convert_to_enum(typeid(T).name());
+
+    switch (type_value)
+    {
+    case string_type_values::eChar:
+        return is_valid_minimum_value(result, CHAR_MIN, decrement);
+    case string_type_values::eWChar_T:
+        return is_valid_minimum_value(result, WCHAR_MIN, decrement);
+    case string_type_values::eShortInt:
+        return is_valid_minimum_value(result, SHRT_MIN, decrement);
+    case string_type_values::eInt:
+        return is_valid_minimum_value(result, INT_MIN, decrement);
+    case string_type_values::eLong:
+        return is_valid_minimum_value(result, LONG_MIN, decrement);
+    case string_type_values::eInt64:
+        return is_valid_minimum_value(result, LLONG_MIN, decrement);
+    case string_type_values::eInt128:
+        return is_exact_underflow(result, decrement);
+    case string_type_values::eUnsignedChar:
+        return is_valid_minimum_value(result, 0, decrement);
+    case string_type_values::eUnsignedShortInt:
+        return is_valid_minimum_value(result, 0, decrement);
+    case string_type_values::eUnsignedInt:
+        return is_valid_minimum_value(result, 0, decrement);
+    case string_type_values::eUnsignedLong:
+        return is_valid_minimum_value(result, 0, decrement);
+    case string_type_values::eUnsignedInt64:
+        return is_valid_minimum_value(result, 0, decrement);
+    case string_type_values::eUnsignedInt128:
+        return is_exact_underflow(result, decrement);
+    case string_type_values::eFloat:
+        return is_valid_minimum_value(result, FLT_MIN, decrement);
+    case string_type_values::eDouble:
+        return is_valid_minimum_value(result, DBL_MIN, decrement);
+    case string_type_values::eLongDouble:
+        return is_valid_minimum_value(result, LDBL_MIN, decrement);
+    default:
+        break;
+    }
+
+    return is_exact_underflow(result, decrement);
+}
+
+/// <summary>
+/// is_underflow for wide_int and wide_uint, exact through the borrow chain.
+/// </summary>
+template <std::size_t Bits, bool Signed>
+bool is_underflow(wide_integer<Bits, Signed> result, wide_integer<Bits, Signed> const& decrement)
+{
+    wide_integer<Bits, Signed> difference;
+    return subtract_overflows(result, decrement, difference);
+}
+
+
+/// <summary>
+/// Template function to abstract away the logic of:
+///   start + (increment * steps)
+/// </summary>
+/// <typeparam name="T">A type that with basic math functions</typeparam>
+/// <param name="start">The number to start with</param>
+/// <param name="increment">How much to add each step</param>
+/// <param name="steps">The number of steps to iterate</param>
+/// <returns>start + (increment * steps)</returns>
+template <typename T>
+T add_numbers(T const& start, T const& increment, unsigned long int const& steps)
+{
+    T result = start;
+
+    for (unsigned long int i = 0; i < steps; ++i)
+    {
+        if (is_overflow(result, increment))
+        {
+            return false;
+        }
+        else
+        {
+            result += increment;
+        }
+    }
+
+    return result;
+}
+
+/// <summary>
+/// Template function to abstract away the logic of:
+///   start - (increment * steps)
+/// </summary>
+/// <typeparam name="T">A type that with basic math functions</typeparam>
+/// <param name="start">The number to start with</param>
+/// <param name="decrement">How much to subtract each step</param>
+/// <param name="steps">The number of steps to iterate</param>
+/// <returns>start - (increment * steps)</returns>
+
+template <typename T>
+T subtract_numbers(T const& start, T const& decrement, unsigned long int const& steps)
+{
+    T result = start;
+
+    for (unsigned long int i = 0; i < steps; ++i)
+    {
+    	if (is_underflow(result, decrement))
+    	{
+            return false;
+    	}
+        else
+        {
+            result -= decrement;
+        }
+    }
+
+    return result;
+}
@@ -3,281 +3,11 @@
 
 #include <iostream>     // std::cout
 #include <limits>       // std::numeric_limits
+#include <type_traits>  // std::is_same
+#include <vector>       // std::vector
 
-/// <summary>
-/// Custom Enum values used to perform switch case logic to determine current type.
-/// </summary>
-enum class string_type_values
-{
-	eChar,
-	eWChar_T,
-	eShortInt,
-	eInt,
-	eLong,
-	eInt64,
-	eUnsignedChar,
-	eUnsignedShortInt,
-	eUnsignedInt,
-	eUnsignedLong,
-	eUnsignedInt64,
-	eFloat,
-	eDouble,
-	eLongDouble
-};
-
-/// <summary>
-/// Accepts the string value of the current type and
-/// converts into a custom string_type_values enum.
-/// </summary>
-/// <param name="type_value"></param>
-/// <returns></returns>
-string_type_values convert_to_enum(std::string type_value)
-{
-	if (type_value == "char")
-	{
-        return string_type_values::eChar;
-	}
-    else if(type_value == "wchar_t")
-    {
-        return string_type_values::eWChar_T;
-    }
-    else if (type_value == "short")
-    {
-        return string_type_values::eShortInt;
-    }
-    else if (type_value == "int")
-    {
-        return string_type_values::eInt;
-    }
-    else if (type_value == "long")
-    {
-        return string_type_values::eLong;
-    }
-    else if (type_value == "__int64")
-    {
-        return string_type_values::eInt64;
-    }
-    else if (type_value == "unsigned char")
-    {
-        return string_type_values::eUnsignedChar;
-    }
-    else if (type_value == "unsigned short")
-    {
-        return string_type_values::eUnsignedShortInt;
-    }
-    else if (type_value == "unsigned int")
-    {
-        return string_type_values::eUnsignedInt;
-    }
-    else if (type_value == "unsigned long")
-    {
-        return string_type_values::eUnsignedLong;
-    }
-    else if (type_value == "unsigned __int64")
-    {
-        return string_type_values::eUnsignedInt64;
-    }
-    else if (type_value == "float")
-    {
-        return string_type_values::eFloat;
-    }
-    else if (type_value == "double")
-    {
-        return string_type_values::eDouble;
-    }
-    else if (type_value == "long double")
-    {
-        return string_type_values::eLongDouble;
-    }
-}
-
-/// <summary>
-/// Responsible for preventing overflows by determining if the current result value is greater than 0, and
-/// if the result is greater than the maximum value allotted minus the desired increment
-/// for the current type.
-/// </summary>
-/// <typeparam name="T"></typeparam>
-/// <param name="result"></param>
-/// <param name="max"></param>
-/// <param name="increment"></param>
-/// <returns></returns>
-template <typename T>
-bool is_valid_maximum_value(T result, float max, T const& increment)
-{
-    return (result > 0) && (result > max - increment);
-}
-
-/// <summary>
-/// Responsible for preventing underflows by determining if the current result value is equal to 0 and
-/// if the result is less than the minimum value allotted plus the desired decrement for the current type. 
-/// </summary>
-/// <typeparam name="T"></typeparam>
-/// <param name="result"></param>
-/// <param name="min"></param>
-/// <param name="decrement"></param>
-/// <returns></returns>
-template <typename T>
-bool is_valid_minimum_value(T result, float min, T const& decrement)
-{
-    return (result == 0) && (result < min + decrement);
-}
-
-/// <summary>
-/// Responsible for checking the type of the given result and validating that the result
-/// value will remain under the specified type's maximum value. 
-/// </summary>
-/// <typeparam name="T">Generic type T</typeparam>
-/// <param name="result">Result value used to validate against</param>
-/// <param name="increment">Constant increment value passed in from Main.</param>
-/// <returns>True if result will overflow. False if result will not overflow.</returns>
-template <typename T>
-bool is_overflow(T result, T const& increment)
-{
-    string_type_values type_value = convert_to_enum(std::string(typeid(result).name()));
-
-	switch (type_value)
-	{
-		case string_type_values::eChar:
-            return is_valid_maximum_value(result, CHAR_MAX, increment);
-        case string_type_values::eWChar_T:
-            return is_valid_maximum_value(result, WCHAR_MAX, increment);
-        case string_type_values::eShortInt:
-            return is_valid_maximum_value(result, SHRT_MAX, increment);
-        case string_type_values::eInt:
-            return is_valid_maximum_value(result, INT_MAX, increment);
-        case string_type_values::eLong:
-            return is_valid_maximum_value(result, LONG_MAX, increment);
-        case string_type_values::eInt64:
-            return is_valid_maximum_value(result, LLONG_MAX, increment);
-        case string_type_values::eUnsignedChar:
-            return is_valid_maximum_value(result, UCHAR_MAX, increment);
-        case string_type_values::eUnsignedShortInt:
-            return is_valid_maximum_value(result, USHRT_MAX, increment);
-        case string_type_values::eUnsignedInt:
-            return is_valid_maximum_value(result, UINT_MAX, increment);
-        case string_type_values::eUnsignedLong:
-            return is_valid_maximum_value(result, ULONG_MAX, increment);
-        case string_type_values::eUnsignedInt64:
-            return is_valid_maximum_value(result, ULLONG_MAX, increment);
-        case string_type_values::eFloat:
-            return is_valid_maximum_value(result, FLT_MAX, increment);
-        case string_type_values::eDouble:
-            return is_valid_maximum_value(result, DBL_MAX, increment);
-        case string_type_values::eLongDouble:
-            return is_valid_maximum_value(result, LDBL_MAX, increment);
-	    default:
-	        break;
-	}
-}
-
-/// <summary>
-/// Responsible for checking the type of the given result and validating that the result
-/// value will remain above the specified type's minimum value. 
-/// </summary>
-/// <typeparam name="T">Generic type T</typeparam>
-/// <param name="result">Result value used to validate against</param>
-/// <param name="decrement">Constant decrement value passed in from Main.</param>
-/// <returns>True if result will underflow. False if  will not underflow.</returns>
-template <typename T>
-bool is_underflow(T result, T const& decrement)
-{
-    string_type_values type_value = convert_to_enum(std::string(typeid(result).name()));
-
-    switch (type_value)
-    {
-    case string_type_values::eChar:
-        return is_valid_minimum_value(result, CHAR_MIN, decrement);
-    case string_type_values::eWChar_T:
-        return is_valid_minimum_value(result, WCHAR_MIN, decrement);
-    case string_type_values::eShortInt:
-        return is_valid_minimum_value(result, SHRT_MIN, decrement);
-    case string_type_values::eInt:
-        return is_valid_minimum_value(result, INT_MIN, decrement);
-    case string_type_values::eLong:
-        return is_valid_minimum_value(result, LONG_MIN, decrement);
-    case string_type_values::eInt64:
-        return is_valid_minimum_value(result, LLONG_MIN, decrement);
-    case string_type_values::eUnsignedChar:
-        return is_valid_minimum_value(result, 0, decrement);
-    case string_type_values::eUnsignedShortInt:
-        return is_valid_minimum_value(result, 0, decrement);
-    case string_type_values::eUnsignedInt:
-        return is_valid_minimum_value(result, 0, decrement);
-    case string_type_values::eUnsignedLong:
-        return is_valid_minimum_value(result, 0, decrement);
-    case string_type_values::eUnsignedInt64:
-        return is_valid_minimum_value(result, 0, decrement);
-    case string_type_values::eFloat:
-        return is_valid_minimum_value(result, FLT_MIN, decrement);
-    case string_type_values::eDouble:
-        return is_valid_minimum_value(result, DBL_MIN, decrement);
-    case string_type_values::eLongDouble:
-        return is_valid_minimum_value(result, LDBL_MIN, decrement);
-    default:
-        break;
-    }
-}
-
-
-/// <summary>
-/// Template function to abstract away the logic of:
-///   start + (increment * steps)
-/// </summary>
-/// <typeparam name="T">A type that with basic math functions</typeparam>
-/// <param name="start">The number to start with</param>
-/// <param name="increment">How much to add each step</param>
-/// <param name="steps">The number of steps to iterate</param>
-/// <returns>start + (increment * steps)</returns>
-template <typename T>
-T add_numbers(T const& start, T const& increment, unsigned long int const& steps)
-{
-    T result = start;
-
-    for (unsigned long int i = 0; i < steps; ++i)
-    {
-        if (is_overflow(result, increment))
-        {
-            return false;
-        }
-        else
-        {
-            result += increment;
-        }
-    }
-
-    return result;
-}
-
-/// <summary>
-/// Template function to abstract away the logic of:
-///   start - (increment * steps)
-/// </summary>
-/// <typeparam name="T">A type that with basic math functions</typeparam>
-/// <param name="start">The number to start with</param>
-/// <param name="decrement">How much to subtract each step</param>
-/// <param name="steps">The number of steps to iterate</param>
-/// <returns>start - (increment * steps)</returns>
-
-template <typename T>
-T subtract_numbers(T const& start, T const& decrement, unsigned long int const& steps)
-{
-    T result = start;
-
-    for (unsigned long int i = 0; i < steps; ++i)
-    {
-    	if (is_underflow(result, decrement))
-    	{
-            return false;
-    	}
-        else
-        {
-            result -= decrement;
-        }
-    }
-
-    return result;
-}
-
+#include "NumericFunctions.h"
+#include "parallel_reduce.h"
 
 //  NOTE:
 //    You will see the unary ('+') operator used in front of the variables in the test_XXX methods.
@@ -379,6 +109,43 @@ void test_underflow()
     }
 }
 
+/// <summary>
+/// The same sums as test_overflow, as one checked_sum over an array of increments rather than a loop
+/// of add_numbers. On overflow the widened sum shows the exact value that did not fit.
+/// </summary>
+template <typename T>
+void test_parallel_sum()
+{
+    const unsigned long int steps = 5;
+    const T increment = std::numeric_limits<T>::max() / steps;
+
+    std::cout << "Parallel Sum Test of Type = " << typeid(T).name() << std::endl;
+
+    const std::vector<T> fits(steps, increment);
+    const reduction<T> sum = checked_sum(fits.data(), fits.size());
+    std::cout << "\tSumming Numbers Without Overflow (" << +increment << " x " << steps << ") = " << +sum.value << std::endl;
+
+    const std::vector<T> overflows(steps + 1, increment);
+    const reduction<T> overflowed = checked_sum(overflows.data(), overflows.size());
+    std::cout << "\tSumming Numbers With Overflow (" << +increment << " x " << (steps + 1) << ") = ";
+    if (overflowed.overflow)
+    {
+        // double and long double have nothing wider to sum in, their widened sum overflows too
+        if constexpr (std::is_same<widened_sum_t<T>, T>::value)
+        {
+            std::cout << "Overflow detected" << std::endl;
+        }
+        else
+        {
+            std::cout << "Overflow detected, widened sum = " << widened_sum(overflows.data(), overflows.size()) << std::endl;
+        }
+    }
+    else
+    {
+        std::cout << +overflowed.value << std::endl;
+    }
+}
+
 void do_overflow_tests(const std::string& star_line)
 {
     std::cout << std::endl << star_line << std::endl;
@@ -405,6 +172,22 @@ void do_overflow_tests(const std::string& star_line)
     test_overflow<float>();
     test_overflow<double>();
     test_overflow<long double>();
+
+    // the same sums as parallel reductions over arrays
+    test_parallel_sum<char>();
+    test_parallel_sum<wchar_t>();
+    test_parallel_sum<short int>();
+    test_parallel_sum<int>();
+    test_parallel_sum<long>();
+    test_parallel_sum<long long>();
+    test_parallel_sum<unsigned char>();
+    test_parallel_sum<unsigned short int>();
+    test_parallel_sum<unsigned int>();
+    test_parallel_sum<unsigned long>();
+    test_parallel_sum<unsigned long long>();
+    test_parallel_sum<float>();
+    test_parallel_sum<double>();
+    test_parallel_sum<long double>();
 }
 
 void do_underflow_tests(const std::string& star_line)
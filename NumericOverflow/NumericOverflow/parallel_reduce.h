@@ -0,0 +1,450 @@
+// parallel_reduce.h : Overflow checked sums and products of whole arrays, spread over threads.
+//
+// add_numbers checks one step at a time, so summing an array through it is a serial chain of checks.
+// Here the array is cut into fixed blocks that threads take in turn, each block is reduced into a
+// partial that cannot overflow, and the partials are combined in block order at the end:
+//
+//   - integer sums widen: a block of 32 bit values sums in 64 bits and a block of 64 bit values in
+//     128. Every partial and the total are a wide_integer of 128 bits for types up to 64 bits, 256
+//     for __int128 and Bits + 64 for a wide_integer<Bits>, at least 64 bits more than T, which holds
+//     the sum of any 2^64 values exactly. checked_sum then reports whether that exact sum fits in T.
+//   - integer products multiply magnitudes with multiply_overflows and track the sign and any zero
+//     apart, so overflow is exact whatever order the blocks finish in.
+//   - floating point sums run in double (float) or T, plain, compensated (Kahan-Babuska) or pairwise.
+//
+// The blocks depend only on the element count, so a floating point result is the same for any
+// number of threads.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "wide_int.h"
+
+/// <summary>
+/// How floating point sums are accumulated.
+/// </summary>
+enum class float_summation
+{
+    // one running sum per block, error grows with the element count
+    plain,
+    // a running sum and the low bits it lost (Kahan-Babuska / Neumaier)
+    kahan,
+    // halves summed recursively, error grows with log2 of the element count
+    pairwise
+};
+
+/// <summary>
+/// A reduction's result in T and whether the exact result fitted.
+/// </summary>
+template <typename T>
+struct reduction
+{
+    // the result, wrapped as T arithmetic wraps (or infinite for floating point) when overflow is set
+    T value;
+    // the exact result does not fit in T
+    bool overflow;
+};
+
+/// <summary>
+/// The type widened_sum returns for T: a 128 bit wide_integer for integers up to 64 bits, 256 bits for
+/// __int128, Bits + 64 for wide_integer<Bits>, double for float and T itself for wider floating point.
+/// </summary>
+template <typename T, typename Enable = void>
+struct widened_sum_type;
+
+template <typename T>
+struct widened_sum_type<T, std::enable_if_t<is_checked_integer<T>::value>>
+{
+    using type = wide_integer<(sizeof(T) > sizeof(std::uint64_t) ? 256 : 128), (static_cast<T>(-1) < static_cast<T>(0))>;
+};
+
+template <std::size_t Bits, bool Signed>
+struct widened_sum_type<wide_integer<Bits, Signed>>
+{
+    using type = wide_integer<Bits + 64, Signed>;
+};
+
+template <typename T>
+struct widened_sum_type<T, std::enable_if_t<std::is_floating_point<T>::value>>
+{
+    using type = std::conditional_t<(sizeof(T) < sizeof(double)), double, T>;
+};
+
+template <typename T>
+using widened_sum_t = typename widened_sum_type<T>::type;
+
+namespace parallel_reduce_detail
+{
+    // elements per block: enough that taking one is noise, few enough that threads stay balanced
+    constexpr std::size_t block_size = std::size_t{ 1 } << 16;
+    // elements a pairwise sum adds up directly
+    constexpr std::size_t pairwise_base = 128;
+
+    // partials[b] = reduce_block(first, last) for every block b on up to threads threads, the calling
+    // thread included
+    template <typename Partial, typename ReduceBlock>
+    std::vector<Partial> reduce_blocks(std::size_t count, unsigned threads, ReduceBlock reduce_block)
+    {
+        const std::size_t blocks = (count + block_size - 1) / block_size;
+        std::vector<Partial> partials(blocks);
+
+        if (threads == 0)
+        {
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        threads = static_cast<unsigned>(std::min<std::size_t>(threads, std::max<std::size_t>(blocks, 1)));
+
+        std::atomic<std::size_t> next{ 0 };
+        auto worker = [&]() {
+            for (std::size_t b = next.fetch_add(1); b < blocks; b = next.fetch_add(1))
+            {
+                const std::size_t first = b * block_size;
+                partials[b] = reduce_block(first, std::min(first + block_size, count));
+            }
+        };
+
+        std::vector<std::thread> workers;
+        for (unsigned i = 1; i < threads; ++i)
+        {
+            workers.emplace_back(worker);
+        }
+        worker();
+        for (auto& w : workers)
+        {
+            w.join();
+        }
+        return partials;
+    }
+
+    // what one block of an integer T sums into before it is widened: a type twice as wide as T or
+    // more, which the compiler adds in registers
+    template <typename T, typename Enable = void>
+    struct block_sum_type
+    {
+        using type = widened_sum_t<T>;
+    };
+
+    template <typename T>
+    struct block_sum_type<T, std::enable_if_t<is_checked_integer<T>::value && sizeof(T) <= sizeof(std::uint32_t)>>
+    {
+        using type = std::conditional_t<(static_cast<T>(-1) < static_cast<T>(0)), std::int64_t, std::uint64_t>;
+    };
+
+#if defined(__SIZEOF_INT128__)
+    template <typename T>
+    struct block_sum_type<T, std::enable_if_t<is_checked_integer<T>::value && sizeof(T) == sizeof(std::uint64_t)>>
+    {
+        using type = std::conditional_t<(static_cast<T>(-1) < static_cast<T>(0)), __int128, unsigned __int128>;
+    };
+#endif
+
+    // the unsigned type of the same width, which std::make_unsigned does not give for __int128
+    template <typename T>
+    struct unsigned_of
+    {
+        using type = std::make_unsigned_t<T>;
+    };
+
+#if defined(__SIZEOF_INT128__)
+    template <>
+    struct unsigned_of<__int128>
+    {
+        using type = unsigned __int128;
+    };
+
+    template <>
+    struct unsigned_of<unsigned __int128>
+    {
+        using type = unsigned __int128;
+    };
+#endif
+
+    // a floating point sum and the low bits it lost
+    template <typename F>
+    struct compensated
+    {
+        F sum = 0;
+        F compensation = 0;
+
+        void add(F value) noexcept
+        {
+            const F total = sum + value;
+            if (std::fabs(sum) >= std::fabs(value))
+            {
+                compensation += (sum - total) + value;
+            }
+            else
+            {
+                compensation += (value - total) + sum;
+            }
+            sum = total;
+        }
+    };
+
+    // the sum of count values as F, halving down to pairwise_base elements added in eight lanes
+    template <typename F, typename T>
+    F pairwise_sum(const T* values, std::size_t count) noexcept
+    {
+        if (count > pairwise_base)
+        {
+            const std::size_t half = count / 2;
+            return pairwise_sum<F>(values, half) + pairwise_sum<F>(values + half, count - half);
+        }
+
+        F lanes[8] = {};
+        std::size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            for (std::size_t lane = 0; lane < 8; ++lane)
+            {
+                lanes[lane] += static_cast<F>(values[i + lane]);
+            }
+        }
+        for (; i < count; ++i)
+        {
+            lanes[i % 8] += static_cast<F>(values[i]);
+        }
+        return ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) + ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+    }
+
+    template <typename T>
+    widened_sum_t<T> integer_sum(const T* values, std::size_t count, unsigned threads)
+    {
+        using total_type = widened_sum_t<T>;
+        using block_type = typename block_sum_type<T>::type;
+
+        const auto partials = reduce_blocks<total_type>(count, threads, [values](std::size_t first, std::size_t last) {
+            block_type sum{};
+            for (std::size_t i = first; i < last; ++i)
+            {
+                sum += static_cast<block_type>(values[i]);
+            }
+            return static_cast<total_type>(sum);
+        });
+
+        total_type total{};
+        for (const auto& partial : partials)
+        {
+            total += partial;
+        }
+        return total;
+    }
+
+    template <typename T>
+    widened_sum_t<T> float_sum(const T* values, std::size_t count, unsigned threads, float_summation method)
+    {
+        using F = widened_sum_t<T>;
+
+        const auto partials = reduce_blocks<compensated<F>>(count, threads, [values, method](std::size_t first, std::size_t last) {
+            compensated<F> partial;
+            switch (method)
+            {
+            case float_summation::plain:
+                for (std::size_t i = first; i < last; ++i)
+                {
+                    partial.sum += static_cast<F>(values[i]);
+                }
+                break;
+            case float_summation::kahan:
+                for (std::size_t i = first; i < last; ++i)
+                {
+                    partial.add(static_cast<F>(values[i]));
+                }
+                break;
+            case float_summation::pairwise:
+                partial.sum = pairwise_sum<F>(values + first, last - first);
+                break;
+            }
+            return partial;
+        });
+
+        // the partials are combined the way their elements were
+        if (method == float_summation::pairwise)
+        {
+            std::vector<F> sums(partials.size());
+            std::transform(partials.begin(), partials.end(), sums.begin(), [](const compensated<F>& partial) { return partial.sum; });
+            return pairwise_sum<F>(sums.data(), sums.size());
+        }
+        compensated<F> total;
+        for (const auto& partial : partials)
+        {
+            if (method == float_summation::kahan)
+            {
+                total.add(partial.sum);
+                total.compensation += partial.compensation;
+            }
+            else
+            {
+                total.sum += partial.sum;
+            }
+        }
+        return total.sum + total.compensation;
+    }
+
+    // a floating point total as T, overflowing when it is beyond T's largest finite value
+    template <typename T, typename F>
+    reduction<T> narrow(F total) noexcept
+    {
+        if (std::isnan(total))
+        {
+            return { std::numeric_limits<T>::quiet_NaN(), true };
+        }
+        if (std::fabs(total) > std::numeric_limits<T>::max())
+        {
+            return { total < 0 ? -std::numeric_limits<T>::infinity() : std::numeric_limits<T>::infinity(), true };
+        }
+        return { static_cast<T>(total), false };
+    }
+
+    // a product kept as a magnitude and a sign, so its overflow does not depend on the order
+    template <typename T>
+    struct signed_product
+    {
+        typename unsigned_of<T>::type magnitude = 1;
+        bool negative = false;
+        bool zero = false;
+        bool overflow = false;
+
+        void multiply(typename unsigned_of<T>::type factor, bool factor_negative) noexcept
+        {
+            overflow |= multiply_overflows(magnitude, factor, magnitude);
+            negative ^= factor_negative;
+        }
+    };
+}
+
+/// <summary>
+/// Sum of count values in widened_sum_t&lt;T&gt;, computed on up to threads threads (0 for one per
+/// hardware thread). Exact for integers, whatever count is.
+/// </summary>
+/// <param name="values">count values</param>
+/// <param name="count">number of values</param>
+/// <param name="threads">threads to use, the calling thread included; 0 for one per hardware thread</param>
+/// <param name="method">how floating point values are accumulated, unused for integers</param>
+/// <returns>the sum</returns>
+template <typename T>
+widened_sum_t<T> widened_sum(const T* values, std::size_t count, unsigned threads = 0,
+    float_summation method = float_summation::pairwise)
+{
+    if constexpr (std::is_floating_point<T>::value)
+    {
+        return parallel_reduce_detail::float_sum(values, count, threads, method);
+    }
+    else
+    {
+        return parallel_reduce_detail::integer_sum(values, count, threads);
+    }
+}
+
+/// <summary>
+/// Sum of count values in T, with overflow set when the exact sum does not fit. For floating point
+/// that is a sum beyond T's largest finite value, including any that reaches infinity or NaN.
+/// </summary>
+/// <param name="values">count values</param>
+/// <param name="count">number of values</param>
+/// <param name="threads">threads to use, the calling thread included; 0 for one per hardware thread</param>
+/// <param name="method">how floating point values are accumulated, unused for integers</param>
+/// <returns>the sum and whether it overflowed</returns>
+template <typename T>
+reduction<T> checked_sum(const T* values, std::size_t count, unsigned threads = 0,
+    float_summation method = float_summation::pairwise)
+{
+    const auto total = widened_sum(values, count, threads, method);
+
+    if constexpr (std::is_floating_point<T>::value)
+    {
+        return parallel_reduce_detail::narrow<T>(total);
+    }
+    else
+    {
+        // it fits exactly when narrowing and widening again gives the same value
+        const auto value = static_cast<T>(total);
+        return { value, static_cast<widened_sum_t<T>>(value) != total };
+    }
+}
+
+/// <summary>
+/// Product of count values in T, with overflow set when the exact product does not fit. Takes the
+/// built-in integers and floating point types; the product of no values is 1.
+/// </summary>
+/// <param name="values">count values</param>
+/// <param name="count">number of values</param>
+/// <param name="threads">threads to use, the calling thread included; 0 for one per hardware thread</param>
+/// <returns>the product and whether it overflowed</returns>
+template <typename T>
+reduction<T> checked_product(const T* values, std::size_t count, unsigned threads = 0)
+{
+    using parallel_reduce_detail::reduce_blocks;
+
+    if constexpr (std::is_floating_point<T>::value)
+    {
+        using F = widened_sum_t<T>;
+        const auto partials = reduce_blocks<F>(count, threads, [values](std::size_t first, std::size_t last) {
+            F product = 1;
+            for (std::size_t i = first; i < last; ++i)
+            {
+                product *= static_cast<F>(values[i]);
+            }
+            return product;
+        });
+
+        F total = 1;
+        for (const F partial : partials)
+        {
+            total *= partial;
+        }
+        return parallel_reduce_detail::narrow<T>(total);
+    }
+    else
+    {
+        static_assert(is_checked_integer<T>::value && !std::is_same<T, bool>::value,
+            "checked_product takes the built-in integer and floating point types");
+        using product = parallel_reduce_detail::signed_product<T>;
+        using magnitude_type = typename parallel_reduce_detail::unsigned_of<T>::type;
+        constexpr bool is_signed = static_cast<T>(-1) < static_cast<T>(0);
+
+        const auto partials = reduce_blocks<product>(count, threads, [values](std::size_t first, std::size_t last) {
+            product partial;
+            for (std::size_t i = first; i < last; ++i)
+            {
+                const T value = values[i];
+                if (value == 0)
+                {
+                    // nothing else in the block matters
+                    partial.zero = true;
+                    break;
+                }
+                const bool negative = is_signed && value < 0;
+                partial.multiply(negative ? static_cast<magnitude_type>(magnitude_type(0) - static_cast<magnitude_type>(value))
+                                          : static_cast<magnitude_type>(value), negative);
+            }
+            return partial;
+        });
+
+        product total;
+        for (const auto& partial : partials)
+        {
+            if (partial.zero)
+            {
+                return { 0, false };
+            }
+            total.multiply(partial.magnitude, partial.negative);
+            total.overflow |= partial.overflow;
+        }
+
+        // a negative product may reach one past max
+        const magnitude_type limit = is_signed ? static_cast<magnitude_type>(~magnitude_type(0) >> 1) : ~magnitude_type(0);
+        const bool overflow = total.overflow || total.magnitude > limit + (total.negative ? 1 : 0);
+        const T value = static_cast<T>(total.negative ? static_cast<magnitude_type>(magnitude_type(0) - total.magnitude) : total.magnitude);
+        return { value, overflow };
+    }
+}
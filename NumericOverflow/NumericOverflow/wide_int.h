@@ -0,0 +1,445 @@
+// wide_int.h : Checked add and subtract for the built-in integers, 128 bit ones included, and a fixed
+// width multi-limb integer for counters that outgrow them.
+//
+// add_overflows, subtract_overflows and multiply_overflows compute a + b, a - b or a * b, wrapped,
+// and report whether the true result fitted. For the built-in types gcc and clang do it with the overflow flag of one add; the
+// portable fallback compares against the limits first. wide_integer<Bits, Signed> is Bits / 64
+// little endian 64 bit limbs in two's complement, added and subtracted as one carry chain (add with
+// carry on x64), so a 256 bit counter costs four adds rather than a detour through double that
+// loses every digit past the 53rd.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <ostream>
+#include <string>
+#include <type_traits>
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+#if defined(__SIZEOF_INT128__)
+// with extensions off the standard library does not describe __int128, so its limits are spelled out
+constexpr unsigned __int128 uint128_max = ~static_cast<unsigned __int128>(0);
+constexpr __int128 int128_max = static_cast<__int128>(uint128_max >> 1);
+constexpr __int128 int128_min = -int128_max - 1;
+#endif
+
+/// <summary>
+/// True for the built-in integer types add_overflows and subtract_overflows take, 128 bit ones included.
+/// </summary>
+template <typename T>
+struct is_checked_integer : std::is_integral<T>
+{
+};
+
+#if defined(__SIZEOF_INT128__)
+template <>
+struct is_checked_integer<__int128> : std::true_type
+{
+};
+
+template <>
+struct is_checked_integer<unsigned __int128> : std::true_type
+{
+};
+#endif
+
+/// <summary>
+/// Computes a + b into result, wrapping on overflow.
+/// </summary>
+/// <returns>true when a + b does not fit in T</returns>
+template <typename T, typename = std::enable_if_t<is_checked_integer<T>::value>>
+bool add_overflows(T a, T b, T& result) noexcept
+{
+#if defined(__GNUC__)
+    return __builtin_add_overflow(a, b, &result);
+#else
+    if constexpr (std::is_unsigned<T>::value)
+    {
+        result = static_cast<T>(a + b);
+        return result < a;
+    }
+    else
+    {
+        const bool overflow = b > 0 ? a > std::numeric_limits<T>::max() - b : a < std::numeric_limits<T>::min() - b;
+        result = static_cast<T>(static_cast<std::make_unsigned_t<T>>(a) + static_cast<std::make_unsigned_t<T>>(b));
+        return overflow;
+    }
+#endif
+}
+
+/// <summary>
+/// Computes a - b into result, wrapping on overflow.
+/// </summary>
+/// <returns>true when a - b does not fit in T</returns>
+template <typename T, typename = std::enable_if_t<is_checked_integer<T>::value>>
+bool subtract_overflows(T a, T b, T& result) noexcept
+{
+#if defined(__GNUC__)
+    return __builtin_sub_overflow(a, b, &result);
+#else
+    if constexpr (std::is_unsigned<T>::value)
+    {
+        result = static_cast<T>(a - b);
+        return a < b;
+    }
+    else
+    {
+        const bool overflow = b > 0 ? a < std::numeric_limits<T>::min() + b : a > std::numeric_limits<T>::max() + b;
+        result = static_cast<T>(static_cast<std::make_unsigned_t<T>>(a) - static_cast<std::make_unsigned_t<T>>(b));
+        return overflow;
+    }
+#endif
+}
+
+/// <summary>
+/// Computes a * b into result, wrapping on overflow.
+/// </summary>
+/// <returns>true when a * b does not fit in T</returns>
+template <typename T, typename = std::enable_if_t<is_checked_integer<T>::value>>
+bool multiply_overflows(T a, T b, T& result) noexcept
+{
+#if defined(__GNUC__)
+    return __builtin_mul_overflow(a, b, &result);
+#else
+    // multiplied as magnitudes in a type wide enough that small types are not promoted to int
+    using magnitude_type = std::make_unsigned_t<T>;
+    const bool negative = (a < 0) != (b < 0);
+    const auto magnitude = [](T value) {
+        return value < 0 ? static_cast<magnitude_type>(magnitude_type(0) - static_cast<magnitude_type>(value))
+                         : static_cast<magnitude_type>(value);
+    };
+    const magnitude_type left = magnitude(a);
+    const magnitude_type right = magnitude(b);
+    const auto product = static_cast<magnitude_type>(static_cast<std::uintmax_t>(left) * right);
+    const bool wrapped = left != 0 && product / left != right;
+    result = static_cast<T>(negative ? static_cast<magnitude_type>(magnitude_type(0) - product) : product);
+
+    // a negative product may reach one past max
+    const auto limit = static_cast<magnitude_type>(std::numeric_limits<T>::max());
+    return wrapped || product > (negative ? limit + 1 : limit);
+#endif
+}
+
+namespace wide_int_detail
+{
+    // a + b + carry, the carry out replaces carry
+    inline std::uint64_t add_carry(std::uint64_t a, std::uint64_t b, unsigned char& carry) noexcept
+    {
+#if defined(_MSC_VER) && defined(_M_X64)
+        unsigned long long sum;
+        carry = _addcarry_u64(carry, a, b, &sum);
+        return sum;
+#elif defined(__SIZEOF_INT128__)
+        const unsigned __int128 sum = static_cast<unsigned __int128>(a) + b + carry;
+        carry = static_cast<unsigned char>(sum >> 64);
+        return static_cast<std::uint64_t>(sum);
+#else
+        const std::uint64_t partial = a + b;
+        const std::uint64_t sum = partial + carry;
+        carry = static_cast<unsigned char>((partial < a) | (sum < partial));
+        return sum;
+#endif
+    }
+
+    // a - b - borrow, the borrow out replaces borrow
+    inline std::uint64_t subtract_borrow(std::uint64_t a, std::uint64_t b, unsigned char& borrow) noexcept
+    {
+#if defined(_MSC_VER) && defined(_M_X64)
+        unsigned long long difference;
+        borrow = _subborrow_u64(borrow, a, b, &difference);
+        return difference;
+#elif defined(__SIZEOF_INT128__)
+        const unsigned __int128 difference = static_cast<unsigned __int128>(a) - b - borrow;
+        borrow = static_cast<unsigned char>(difference >> 127);
+        return static_cast<std::uint64_t>(difference);
+#else
+        const std::uint64_t partial = a - b;
+        const std::uint64_t difference = partial - borrow;
+        borrow = static_cast<unsigned char>((a < b) | (partial < borrow));
+        return difference;
+#endif
+    }
+}
+
+/// <summary>
+/// Fixed width integer of Bits / 64 limbs. Arithmetic wraps like the built-in unsigned types;
+/// add_overflows and subtract_overflows report when the true result does not fit.
+/// </summary>
+/// <typeparam name="Bits">width, a multiple of 64 from 128 up</typeparam>
+/// <typeparam name="Signed">two's complement when true</typeparam>
+template <std::size_t Bits, bool Signed>
+class wide_integer
+{
+    static_assert(Bits >= 128 && Bits % 64 == 0, "wide_integer is whole 64 bit limbs, 128 bits or more");
+
+public:
+    static constexpr std::size_t limb_count = Bits / 64;
+
+    constexpr wide_integer() noexcept
+        : limbs_{}
+    {
+    }
+
+    /// <summary>
+    /// Widens a built-in integer, sign extending signed ones.
+    /// </summary>
+    template <typename Integer, typename = std::enable_if_t<is_checked_integer<Integer>::value>>
+    constexpr wide_integer(Integer value) noexcept
+        : limbs_{}
+    {
+        // std::is_signed does not know __int128 with extensions off
+        bool negative = false;
+        if constexpr (static_cast<Integer>(-1) < static_cast<Integer>(0))
+        {
+            negative = value < 0;
+        }
+
+        // the value's own limbs, then copies of its sign
+        std::size_t filled = 1;
+        limbs_[0] = static_cast<std::uint64_t>(value);
+#if defined(__SIZEOF_INT128__)
+        if constexpr (sizeof(Integer) > sizeof(std::uint64_t))
+        {
+            limbs_[1] = static_cast<std::uint64_t>(static_cast<unsigned __int128>(value) >> 64);
+            filled = 2;
+        }
+#endif
+        for (std::size_t i = filled; i < limb_count; ++i)
+        {
+            limbs_[i] = negative ? ~std::uint64_t{ 0 } : 0;
+        }
+    }
+
+    /// <summary>
+    /// Converts from another width or signedness the way static_cast converts between the built-in
+    /// integers: a wider value is truncated, a narrower signed one is sign extended.
+    /// </summary>
+    template <std::size_t OtherBits, bool OtherSigned>
+    explicit constexpr wide_integer(const wide_integer<OtherBits, OtherSigned>& other) noexcept
+        : limbs_{}
+    {
+        const std::uint64_t fill = other.negative() ? ~std::uint64_t{ 0 } : 0;
+        for (std::size_t i = 0; i < limb_count; ++i)
+        {
+            limbs_[i] = i < other.limb_count ? other.limb(i) : fill;
+        }
+    }
+
+    static constexpr wide_integer max() noexcept
+    {
+        wide_integer value;
+        for (auto& limb : value.limbs_)
+        {
+            limb = ~std::uint64_t{ 0 };
+        }
+        if (Signed)
+        {
+            value.limbs_[limb_count - 1] >>= 1;
+        }
+        return value;
+    }
+
+    static constexpr wide_integer min() noexcept
+    {
+        wide_integer value;
+        if (Signed)
+        {
+            value.limbs_[limb_count - 1] = std::uint64_t{ 1 } << 63;
+        }
+        return value;
+    }
+
+    // limb i, least significant first
+    constexpr std::uint64_t limb(std::size_t index) const noexcept { return limbs_[index]; }
+
+    constexpr bool negative() const noexcept { return Signed && (limbs_[limb_count - 1] >> 63) != 0; }
+
+    wide_integer& operator+=(const wide_integer& other) noexcept
+    {
+        unsigned char carry = 0;
+        for (std::size_t i = 0; i < limb_count; ++i)
+        {
+            limbs_[i] = wide_int_detail::add_carry(limbs_[i], other.limbs_[i], carry);
+        }
+        return *this;
+    }
+
+    wide_integer& operator-=(const wide_integer& other) noexcept
+    {
+        unsigned char borrow = 0;
+        for (std::size_t i = 0; i < limb_count; ++i)
+        {
+            limbs_[i] = wide_int_detail::subtract_borrow(limbs_[i], other.limbs_[i], borrow);
+        }
+        return *this;
+    }
+
+    friend wide_integer operator+(wide_integer left, const wide_integer& right) noexcept { return left += right; }
+    friend wide_integer operator-(wide_integer left, const wide_integer& right) noexcept { return left -= right; }
+    friend wide_integer operator-(const wide_integer& value) noexcept { return wide_integer() - value; }
+
+    friend bool operator==(const wide_integer& left, const wide_integer& right) noexcept
+    {
+        for (std::size_t i = 0; i < limb_count; ++i)
+        {
+            if (left.limbs_[i] != right.limbs_[i])
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    friend bool operator!=(const wide_integer& left, const wide_integer& right) noexcept { return !(left == right); }
+
+    friend bool operator<(const wide_integer& left, const wide_integer& right) noexcept
+    {
+        // the sign decides first, then the limbs from the top compare as unsigned
+        if (left.negative() != right.negative())
+        {
+            return left.negative();
+        }
+        for (std::size_t i = limb_count; i-- > 0;)
+        {
+            if (left.limbs_[i] != right.limbs_[i])
+            {
+                return left.limbs_[i] < right.limbs_[i];
+            }
+        }
+        return false;
+    }
+
+    friend bool operator>(const wide_integer& left, const wide_integer& right) noexcept { return right < left; }
+    friend bool operator<=(const wide_integer& left, const wide_integer& right) noexcept { return !(right < left); }
+    friend bool operator>=(const wide_integer& left, const wide_integer& right) noexcept { return !(left < right); }
+
+    /// <summary>
+    /// Computes a + b into result, which may be a or b, wrapping on overflow.
+    /// </summary>
+    /// <returns>true when a + b does not fit</returns>
+    friend bool add_overflows(const wide_integer& a, const wide_integer& b, wide_integer& result) noexcept
+    {
+        const bool a_negative = a.negative();
+        const bool b_negative = b.negative();
+        unsigned char carry = 0;
+        for (std::size_t i = 0; i < limb_count; ++i)
+        {
+            result.limbs_[i] = wide_int_detail::add_carry(a.limbs_[i], b.limbs_[i], carry);
+        }
+        if (!Signed)
+        {
+            return carry != 0;
+        }
+        // operands of one sign whose sum has the other
+        return a_negative == b_negative && result.negative() != a_negative;
+    }
+
+    /// <summary>
+    /// Computes a - b into result, which may be a or b, wrapping on overflow.
+    /// </summary>
+    /// <returns>true when a - b does not fit</returns>
+    friend bool subtract_overflows(const wide_integer& a, const wide_integer& b, wide_integer& result) noexcept
+    {
+        const bool a_negative = a.negative();
+        const bool b_negative = b.negative();
+        unsigned char borrow = 0;
+        for (std::size_t i = 0; i < limb_count; ++i)
+        {
+            result.limbs_[i] = wide_int_detail::subtract_borrow(a.limbs_[i], b.limbs_[i], borrow);
+        }
+        if (!Signed)
+        {
+            return borrow != 0;
+        }
+        // operands of different signs whose difference does not have the sign of a
+        return a_negative != b_negative && result.negative() != a_negative;
+    }
+
+    /// <summary>
+    /// The low bits as a built-in integer, truncated as static_cast does.
+    /// </summary>
+    template <typename Integer,
+        typename = std::enable_if_t<is_checked_integer<Integer>::value && !std::is_same<Integer, bool>::value>>
+    explicit constexpr operator Integer() const noexcept
+    {
+#if defined(__SIZEOF_INT128__)
+        if constexpr (sizeof(Integer) > sizeof(std::uint64_t))
+        {
+            return static_cast<Integer>(static_cast<unsigned __int128>(limbs_[1]) << 64 | limbs_[0]);
+        }
+#endif
+        return static_cast<Integer>(limbs_[0]);
+    }
+
+    /// <summary>
+    /// Closest long double, for display and for mixing with floating point results.
+    /// </summary>
+    explicit operator long double() const noexcept
+    {
+        const wide_integer magnitude = negative() ? -*this : *this;
+        long double value = 0;
+        for (std::size_t i = limb_count; i-- > 0;)
+        {
+            value = value * 18446744073709551616.0L + static_cast<long double>(magnitude.limbs_[i]);
+        }
+        return negative() ? -value : value;
+    }
+
+    /// <summary>
+    /// Decimal digits, with a leading '-' when negative.
+    /// </summary>
+    std::string to_string() const
+    {
+        // the magnitude is divided by 10^9 limb by limb in 32 bit halves, nine digits at a time
+        wide_integer magnitude = negative() ? -*this : *this;
+        std::string digits;
+        bool zero = false;
+        while (!zero)
+        {
+            std::uint64_t remainder = 0;
+            zero = true;
+            for (std::size_t i = limb_count; i-- > 0;)
+            {
+                const std::uint64_t high = (remainder << 32) | (magnitude.limbs_[i] >> 32);
+                const std::uint64_t low = ((high % 1000000000) << 32) | (magnitude.limbs_[i] & 0xffffffffu);
+                magnitude.limbs_[i] = (high / 1000000000) << 32 | (low / 1000000000);
+                remainder = low % 1000000000;
+                zero = zero && magnitude.limbs_[i] == 0;
+            }
+            for (int d = 0; d < 9 && (!zero || remainder != 0); ++d)
+            {
+                digits += static_cast<char>('0' + remainder % 10);
+                remainder /= 10;
+            }
+        }
+        if (digits.empty())
+        {
+            digits = "0";
+        }
+        if (negative())
+        {
+            digits += '-';
+        }
+        return std::string(digits.rbegin(), digits.rend());
+    }
+
+private:
+    std::uint64_t limbs_[limb_count];
+};
+
+template <std::size_t Bits, bool Signed>
+std::ostream& operator<<(std::ostream& stream, const wide_integer<Bits, Signed>& value)
+{
+    return stream << value.to_string();
+}
+
+template <std::size_t Bits>
+using wide_int = wide_integer<Bits, true>;
+
+template <std::size_t Bits>
+using wide_uint = wide_integer<Bits, false>;
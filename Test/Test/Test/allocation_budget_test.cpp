@@ -0,0 +1,75 @@
+#include "pch.h"
+
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "allocation_tracking.h"
+#include "encrypt_decrypt.h"
+#include "NumericFunctions.h"
+
+// the tracking itself: two vectors that are never alive at the same time
+TEST(AllocationTrackingTest, ScopeCountsAllocationsBytesAndPeak)
+{
+    allocation_scope scope;
+    {
+        std::vector<int> first(100);
+    }
+    {
+        std::vector<int> second(50);
+    }
+
+    EXPECT_EQ(scope.allocations(), 2);
+    EXPECT_EQ(scope.bytes(), 150 * sizeof(int));
+    EXPECT_EQ(scope.peak_bytes(), 100 * sizeof(int));
+}
+
+// the test window also holds fixture construction and gtest bookkeeping, restart() leaves it behind
+TEST(AllocationTrackingTest, RestartExcludesEarlierAllocations)
+{
+    std::vector<int> values(100);
+
+    allocation_tracking::restart();
+    values[0] = 1;
+
+    EXPECT_NO_ALLOCS();
+}
+
+// encrypt_decrypt copies the source once for its output and must not allocate per character
+TEST(AllocationBudgetTest, EncryptDecryptAllocatesOnlyItsOutput)
+{
+    const std::string source(64 * 1024, 'x');
+    const std::string key = "password";
+
+    allocation_tracking::restart();
+    const std::string encrypted = encrypt_decrypt(source, key);
+
+    EXPECT_ALLOCS_LE(1);
+    EXPECT_ALLOC_BYTES_LE(source.size() + 1);
+    ASSERT_EQ(encrypted.size(), source.size());
+}
+
+// the overflow checks run on every step, so they must not build strings to find the type
+TEST(AllocationBudgetTest, AddNumbersDoesNotAllocate)
+{
+    const unsigned long long increment = std::numeric_limits<unsigned long long>::max() / 5;
+
+    allocation_tracking::restart();
+    const auto result = add_numbers<unsigned long long>(0, increment, 5);
+    const auto overflowed = add_numbers<unsigned long long>(0, increment, 6);
+
+    EXPECT_NO_ALLOCS();
+    EXPECT_EQ(result, increment * 5);
+    EXPECT_EQ(overflowed, 0);
+}
+
+TEST(AllocationBudgetTest, SubtractNumbersDoesNotAllocate)
+{
+    const int decrement = std::numeric_limits<int>::max() / 5;
+
+    allocation_tracking::restart();
+    const auto result = subtract_numbers<int>(std::numeric_limits<int>::max(), decrement, 5);
+
+    EXPECT_NO_ALLOCS();
+    EXPECT_EQ(result, std::numeric_limits<int>::max() - decrement * 5);
+}
@@ -0,0 +1,58 @@
+//
+// allocation_tracking.cpp
+//
+
+#include "pch.h"
+
+#include "allocation_tracking.h"
+
+namespace
+{
+    allocation_counter::snapshot window_start;
+
+    // prints the allocation totals of every test next to the usual gtest output
+    class allocation_listener : public ::testing::EmptyTestEventListener
+    {
+    public:
+        void OnTestStart(const ::testing::TestInfo&) override
+        {
+            allocation_tracking::restart();
+        }
+
+        void OnTestEnd(const ::testing::TestInfo& test_info) override
+        {
+            const auto activity = allocation_tracking::window();
+            std::cout << "[ ALLOCS   ] " << test_info.test_case_name() << "." << test_info.name()
+                << ": " << activity.allocations << " allocations, "
+                << activity.bytes_allocated << " bytes, peak " << activity.peak_live_bytes << " bytes" << std::endl;
+        }
+    };
+
+    // the global test environment that installs the listener before the first test runs
+    class AllocationEnvironment : public ::testing::Environment
+    {
+    public:
+        void SetUp() override
+        {
+            // gtest takes ownership of the listener
+            ::testing::UnitTest::GetInstance()->listeners().Append(new allocation_listener);
+        }
+    };
+
+    ::testing::Environment* const allocation_environment =
+        ::testing::AddGlobalTestEnvironment(new AllocationEnvironment);
+}
+
+namespace allocation_tracking
+{
+    void restart() noexcept
+    {
+        window_start = allocation_counter::current();
+        allocation_counter::reset_peak();
+    }
+
+    allocation_counter::snapshot window() noexcept
+    {
+        return allocation_counter::difference(window_start, allocation_counter::current());
+    }
+}
@@ -0,0 +1,64 @@
+//
+// allocation_tracking.h
+//
+// Per test heap allocation tracking on top of the replacement operator new / delete in
+// Common/allocation_counter.cpp. A global test environment starts a new measurement window
+// as each test starts and prints the totals when it ends, and the EXPECT_ALLOCS_LE family of
+// macros checks the current window against an allocation budget.
+//
+
+#pragma once
+
+#include "allocation_counter.h"
+
+namespace allocation_tracking
+{
+    /// <summary>
+    /// Starts a new measurement window. Called automatically as every test starts, so the window also
+    /// holds gtest's own bookkeeping, fixture construction and SetUp. Call it again inside a test right
+    /// before the code under test when checking a tight budget.
+    /// </summary>
+    void restart() noexcept;
+
+    /// <summary>
+    /// Allocation activity since the current window started.
+    /// </summary>
+    /// <returns>allocations, bytes and peak live bytes of the window</returns>
+    allocation_counter::snapshot window() noexcept;
+}
+
+/// <summary>
+/// Measures the allocation activity of the enclosing block, independent of the test window.
+/// </summary>
+class allocation_scope
+{
+public:
+    allocation_scope() noexcept
+        : start_(allocation_counter::current())
+    {
+        allocation_counter::reset_peak();
+    }
+
+    std::size_t allocations() const noexcept { return activity().allocations; }
+    std::size_t bytes() const noexcept { return activity().bytes_allocated; }
+    std::size_t peak_bytes() const noexcept { return activity().peak_live_bytes; }
+
+private:
+    allocation_counter::snapshot activity() const noexcept
+    {
+        return allocation_counter::difference(start_, allocation_counter::current());
+    }
+
+    allocation_counter::snapshot start_;
+};
+
+// budget checks against the current window, in the style of the gtest EXPECT_xxx / ASSERT_xxx macros
+#define EXPECT_ALLOCS_LE(count) \
+    EXPECT_LE(allocation_tracking::window().allocations, static_cast<std::size_t>(count)) << "heap allocations over budget"
+#define ASSERT_ALLOCS_LE(count) \
+    ASSERT_LE(allocation_tracking::window().allocations, static_cast<std::size_t>(count)) << "heap allocations over budget"
+#define EXPECT_ALLOC_BYTES_LE(bytes) \
+    EXPECT_LE(allocation_tracking::window().bytes_allocated, static_cast<std::size_t>(bytes)) << "heap bytes over budget"
+#define EXPECT_PEAK_BYTES_LE(bytes) \
+    EXPECT_LE(allocation_tracking::window().peak_live_bytes, static_cast<std::size_t>(bytes)) << "peak live heap bytes over budget"
+#define EXPECT_NO_ALLOCS() EXPECT_ALLOCS_LE(0)
@@ -0,0 +1,123 @@
+#include "pch.h"
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "analysis_cache.h"
+#include "checks.h"
+
+namespace
+{
+    std::vector<std::string> rules_found(const char* source)
+    {
+        std::vector<std::string> rules;
+        for (const auto& f : analyze_source(source, "test.cpp"))
+        {
+            rules.push_back(f.rule);
+        }
+        return rules;
+    }
+
+    const std::vector<std::string> none;
+}
+
+// each pattern as QuestionableCode.cpp writes it
+TEST(AnalyzerTest, FindsEachQuestionablePattern)
+{
+    ASSERT_EQ(rules_found("bool is_type(int type) const { if (known(type)) return true; return is_type(type); }"),
+        std::vector<std::string>{ "endlessRecursion" });
+    ASSERT_EQ(rules_found("void DontThrow() noexcept { throw \"Ha!\"; }"),
+        std::vector<std::string>{ "throwInNoexcept" });
+    ASSERT_EQ(rules_found("void foo(int** a) { int b = 1; *a = &b; }"),
+        std::vector<std::string>{ "danglingPointer" });
+    ASSERT_EQ(rules_found("void f(int count) { int buf[10]; if (count == 1000) buf[count] = 0; }"),
+        std::vector<std::string>{ "arrayIndexOutOfBounds" });
+    ASSERT_EQ(rules_found("void f() { std::vector<int> items; for (auto iter = items.begin(); iter != items.end(); ++iter) { if (*iter == 1) { items.erase(iter); } } }"),
+        std::vector<std::string>{ "invalidIterator" });
+    ASSERT_EQ(rules_found("int a; bool my_function() { a = 1 + 2; return true; } void f() { int z = 1; assert(z = 2); assert(my_function()); }"),
+        (std::vector<std::string>{ "assertWithSideEffect", "assertWithSideEffect" }));
+}
+
+// the corrected form of each pattern is left alone
+TEST(AnalyzerTest, AcceptsCorrectedPatterns)
+{
+    ASSERT_EQ(rules_found("int depth(int n) { if (n == 0) return 0; return depth(n - 1); }"), none);
+    ASSERT_EQ(rules_found("void DontThrow() noexcept { try { throw 1; } catch (...) { } }"), none);
+    ASSERT_EQ(rules_found("void f() noexcept(false) { throw 1; }"), none);
+    ASSERT_EQ(rules_found("void foo(int** a) { static int b = 1; *a = &b; }"), none);
+    ASSERT_EQ(rules_found("void f(int count) { int buf[10]; if (count == 9) buf[count] = 0; for (int i = 0; i < 10; ++i) buf[i] = i; }"), none);
+    ASSERT_EQ(rules_found("void f(std::vector<int>& items) { for (auto iter = items.begin(); iter != items.end();) { iter = items.erase(iter); } }"), none);
+    ASSERT_EQ(rules_found("void f(std::vector<int>& items) { for (auto iter = items.begin(); iter != items.end();) { iter = remove(*iter) ? items.erase(iter) : iter + 1; } }"), none);
+    ASSERT_EQ(rules_found("void f(std::vector<int>& items) { for (auto iter = items.begin(); iter != items.end();) { iter = (*iter == 1 ? items.erase(iter) : std::next(iter)); } }"), none);
+    ASSERT_EQ(rules_found("void f(int z) { assert(z == 2); assert(z != 3 && z >= 0); }"), none);
+}
+
+TEST(AnalyzerTest, FindsLoopsPastTheEnd)
+{
+    ASSERT_EQ(rules_found("void f() { int buf[10]; for (int i = 0; i <= 10; ++i) buf[i] = i; buf[12] = 0; }"),
+        (std::vector<std::string>{ "arrayIndexOutOfBounds", "arrayIndexOutOfBounds" }));
+    ASSERT_EQ(rules_found("void f(std::vector<int>& v) { for (int x : v) { v.push_back(x); } }"),
+        std::vector<std::string>{ "invalidIterator" });
+    // the result goes to another variable, iter itself is still invalid
+    ASSERT_EQ(rules_found("void f(std::vector<int>& items) { for (auto iter = items.begin(); iter != items.end(); ++iter) { auto next = *iter ? items.erase(iter) : iter; } }"),
+        std::vector<std::string>{ "invalidIterator" });
+}
+
+// positions are 1 based and comments and strings never produce findings
+TEST(AnalyzerTest, ReportsPositionsAndIgnoresCommentsAndStrings)
+{
+    const auto findings = analyze_source("// throw\nvoid g() noexcept\n{\n    const char* s = \"throw\";\n    throw 1;\n}\n", "g.cpp");
+    ASSERT_EQ(findings.size(), 1u);
+    ASSERT_EQ(findings[0].file, "g.cpp");
+    ASSERT_EQ(findings[0].line, 5);
+    ASSERT_EQ(findings[0].column, 5);
+    ASSERT_EQ(findings[0].severity, severity::error);
+}
+
+// findings survive a save and load without their file names, and a cache written by another
+// analyzer version is ignored
+TEST(AnalyzerTest, CacheRoundTripsFindingsByContent)
+{
+    const char* source = "void DontThrow() noexcept { throw \"Ha!\"; }";
+    const std::uint64_t key = analysis_cache::hash(source);
+    ASSERT_NE(key, analysis_cache::hash("void DontThrow() noexcept { throw \"Ho!\"; }"));
+
+    const std::string path = "analyzer_test.cache";
+    analysis_cache written;
+    written.insert(key, analyze_source(source, "a.cpp"));
+    written.insert(analysis_cache::hash(""), {});
+    ASSERT_TRUE(written.save(path));
+    std::string header;
+    {
+        std::ifstream saved(path);
+        std::getline(saved, header);
+    }
+
+    analysis_cache read;
+    ASSERT_TRUE(read.load(path));
+    ASSERT_EQ(read.size(), 2u);
+    const auto* findings = read.find(key);
+    ASSERT_NE(findings, nullptr);
+    ASSERT_EQ(findings->size(), 1u);
+    ASSERT_EQ((*findings)[0].rule, "throwInNoexcept");
+    ASSERT_EQ((*findings)[0].message, analyze_source(source, "a.cpp")[0].message);
+    ASSERT_TRUE((*findings)[0].file.empty());
+
+    {
+        std::ofstream stale(path, std::ios::trunc);
+        stale << "analyzer-cache 1 0.0.0\n" << std::hex << key << std::dec << " 0\n";
+    }
+    ASSERT_FALSE(read.load(path));
+    ASSERT_EQ(read.find(key), nullptr);
+
+    // a damaged count is not trusted to size anything
+    {
+        std::ofstream damaged(path, std::ios::trunc);
+        damaged << header << '\n' << std::hex << key << std::dec << " 18446744073709551615\n1 1 error throwInNoexcept m\n";
+    }
+    ASSERT_FALSE(read.load(path));
+    ASSERT_EQ(read.size(), 0u);
+    std::remove(path.c_str());
+}
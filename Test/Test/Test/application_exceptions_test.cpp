@@ -0,0 +1,62 @@
+#include "pch.h"
+
+#include "allocation_tracking.h"
+#include "application_logic.h"
+
+// the whole point of the hierarchy: throwing and catching never reaches operator new
+TEST(ApplicationExceptionsTest, ThrowingDoesNotAllocate)
+{
+    allocation_tracking::restart();
+    for (int i = 0; i < 100; ++i)
+    {
+        try
+        {
+            throw divide_by_zero_error();
+        }
+        catch (const application_runtime_error& error)
+        {
+            ASSERT_EQ(error.code(), error_code::divide_by_zero);
+        }
+
+        try
+        {
+            throw application_logic_error(error_code::custom_logic_failed, "logic");
+        }
+        catch (const application_exception& error)
+        {
+            ASSERT_EQ(error.code(), error_code::custom_logic_failed);
+        }
+    }
+
+    EXPECT_NO_ALLOCS();
+}
+
+// errors coming back from the expected based functions turn into the matching exception type
+TEST(ApplicationExceptionsTest, ThrowExceptionPicksTypeAndCode)
+{
+    allocation_tracking::restart();
+    try
+    {
+        value_or_throw(try_divide(1.0f, 0.0f));
+        FAIL() << "expected divide_by_zero_error";
+    }
+    catch (const divide_by_zero_error& error)
+    {
+        ASSERT_STREQ(error.what(), "Denominator cannot be 0");
+    }
+    EXPECT_NO_ALLOCS();
+
+    try
+    {
+        throw_exception(application_error{ error_kind::general, error_code::even_more_custom_logic_failed, "general" });
+    }
+    catch (const application_logic_error&)
+    {
+        FAIL() << "a general error is not a logic error";
+    }
+    catch (const application_exception& error)
+    {
+        ASSERT_EQ(error.code(), error_code::even_more_custom_logic_failed);
+        ASSERT_STREQ(to_string(error.code()), "even_more_custom_logic_failed");
+    }
+}
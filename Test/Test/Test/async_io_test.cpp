@@ -0,0 +1,219 @@
+#include "pch.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "async_io.h"
+
+namespace
+{
+    // file names of the running test, ctest runs each test as its own process in one directory
+    std::string test_file(const char* extension)
+    {
+        return std::string("async_io_test.") + ::testing::UnitTest::GetInstance()->current_test_info()->name() + extension;
+    }
+
+    void write_text(const std::string& filename, const std::string& text)
+    {
+        std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+        file.write(text.data(), static_cast<std::streamsize>(text.size()));
+    }
+
+    std::string read_text(const std::string& filename)
+    {
+        std::ifstream file(filename, std::ios::binary);
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+        return buffer.str();
+    }
+
+    // the next completion, false when nothing is in flight; a failed wait fails the test
+    bool next_completion(async_io& io, io_completion& completion)
+    {
+        const auto waited = io.wait(completion);
+        EXPECT_TRUE(waited);
+        return waited && *waited;
+    }
+
+    std::string sample(std::size_t size)
+    {
+        std::string text(size, '\0');
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            text[i] = static_cast<char>('a' + i * 7 % 26);
+        }
+        return text;
+    }
+
+    // a position dependent transform, so a block written to the wrong place shows up
+    void add_position(std::uint8_t* data, std::size_t size, std::uint64_t position)
+    {
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            data[i] = static_cast<std::uint8_t>(data[i] + (position + i) % 251);
+        }
+    }
+
+    std::string add_position(std::string text)
+    {
+        add_position(reinterpret_cast<std::uint8_t*>(&text[0]), text.size(), 0);
+        return text;
+    }
+}
+
+TEST(AsyncIoTest, TransformsFilesOnEitherBackend)
+{
+    const std::string input_name = test_file(".in");
+    const std::string output_name = test_file(".out");
+    for (const auto backend : { io_backend::io_uring, io_backend::thread_pool })
+    {
+        auto io = async_io::create(4, 4096, backend);
+        ASSERT_TRUE(io);
+        if (backend == io_backend::thread_pool)
+        {
+            ASSERT_EQ((*io)->backend(), io_backend::thread_pool);
+        }
+
+        // empty, less than a block, exactly the buffers, and many times the buffers with a short tail
+        for (const std::size_t size : { 0u, 100u, 4u * 4096u, 100u * 4096u + 123u })
+        {
+            const std::string data = sample(size);
+            write_text(input_name, data);
+            const auto written = transform_file(**io, input_name, output_name, [](std::uint8_t* block, std::size_t count, std::uint64_t position) {
+                add_position(block, count, position);
+            });
+            ASSERT_TRUE(written) << to_string((*io)->backend());
+            ASSERT_EQ(*written, size);
+            ASSERT_EQ(read_text(output_name), add_position(data)) << to_string((*io)->backend());
+        }
+    }
+    std::remove(input_name.c_str());
+    std::remove(output_name.c_str());
+}
+
+TEST(AsyncIoTest, RoundsBuffersToPages)
+{
+    auto io = async_io::create(3, 1000);
+    ASSERT_TRUE(io);
+    ASSERT_EQ((*io)->buffer_count(), 3u);
+    ASSERT_EQ((*io)->buffer_size(), 4096u);
+    for (unsigned i = 0; i < 3; ++i)
+    {
+        ASSERT_EQ(reinterpret_cast<std::uintptr_t>((*io)->buffer(i)) % 4096, 0u);
+    }
+
+    ASSERT_EQ(async_io::create(0, 4096).error(), io_error::setup_failed);
+    ASSERT_EQ(async_io::create(4, 0).error(), io_error::setup_failed);
+}
+
+TEST(AsyncIoTest, QueuesReadsAndWritesDirectly)
+{
+    const std::string input_name = test_file(".in");
+    const std::string data = sample(10000);
+    write_text(input_name, data);
+    for (const auto backend : { io_backend::io_uring, io_backend::thread_pool })
+    {
+        auto io = async_io::create(2, 8192, backend);
+        ASSERT_TRUE(io);
+        io_file file;
+        ASSERT_TRUE(file.open_read(input_name));
+        ASSERT_EQ(file.size(), data.size());
+
+        // nothing in flight
+        io_completion completion;
+        const auto idle = (*io)->wait(completion);
+        ASSERT_TRUE(idle);
+        ASSERT_FALSE(*idle);
+
+        (*io)->read(file, 8000, 0, 0, 8192, 10);
+        (*io)->read(file, 100, 1, 50, 20, 11);
+        unsigned seen = 0;
+        while (next_completion(**io, completion))
+        {
+            if (completion.tag == 10)
+            {
+                ASSERT_EQ(completion.result, 2000);
+                ASSERT_EQ(std::string(reinterpret_cast<char*>((*io)->buffer(0)), 2000), data.substr(8000));
+            }
+            else
+            {
+                ASSERT_EQ(completion.tag, 11u);
+                ASSERT_EQ(completion.result, 20);
+                ASSERT_EQ(std::string(reinterpret_cast<char*>((*io)->buffer(1)) + 50, 20), data.substr(100, 20));
+            }
+            ++seen;
+        }
+        ASSERT_EQ(seen, 2u);
+    }
+    std::remove(input_name.c_str());
+}
+
+TEST(AsyncIoTest, ReportsOpenFailures)
+{
+    const std::string input_name = test_file(".in");
+    const std::string output_name = test_file(".out");
+    auto io = async_io::create(2, 4096);
+    ASSERT_TRUE(io);
+    std::remove(input_name.c_str());
+    const auto written = transform_file(**io, input_name, output_name, [](std::uint8_t*, std::size_t, std::uint64_t) {});
+    ASSERT_EQ(written.error(), io_error::open_failed);
+}
+
+// more requests than the submission queue holds are submitted in turns, none overwrites another
+TEST(AsyncIoTest, QueuesMoreRequestsThanBuffers)
+{
+    const std::string input_name = test_file(".in");
+    const std::string data = sample(2000);
+    write_text(input_name, data);
+    for (const auto backend : { io_backend::io_uring, io_backend::thread_pool })
+    {
+        auto io = async_io::create(2, 4096, backend);
+        ASSERT_TRUE(io);
+        io_file file;
+        ASSERT_TRUE(file.open_read(input_name));
+
+        for (unsigned i = 0; i < 16; ++i)
+        {
+            (*io)->read(file, i * 100, 0, i * 100, 100, i);
+        }
+        unsigned seen = 0;
+        io_completion completion;
+        while (next_completion(**io, completion))
+        {
+            ASSERT_EQ(completion.result, 100) << to_string((*io)->backend());
+            ++seen;
+        }
+        ASSERT_EQ(seen, 16u);
+        ASSERT_EQ(std::string(reinterpret_cast<char*>((*io)->buffer(0)), 1600), data.substr(0, 1600));
+    }
+    std::remove(input_name.c_str());
+}
+
+// a throwing transform leaves nothing in flight behind it
+TEST(AsyncIoTest, DrainsRequestsWhenTheTransformThrows)
+{
+    const std::string input_name = test_file(".in");
+    const std::string output_name = test_file(".out");
+    write_text(input_name, sample(20 * 4096));
+    for (const auto backend : { io_backend::io_uring, io_backend::thread_pool })
+    {
+        auto io = async_io::create(4, 4096, backend);
+        ASSERT_TRUE(io);
+        ASSERT_THROW(transform_file(**io, input_name, output_name, [](std::uint8_t*, std::size_t, std::uint64_t position) {
+            if (position == 4096)
+            {
+                throw std::runtime_error("transform failed");
+            }
+        }), std::runtime_error);
+
+        io_completion completion;
+        const auto idle = (*io)->wait(completion);
+        ASSERT_TRUE(idle);
+        ASSERT_FALSE(*idle);
+    }
+    std::remove(input_name.c_str());
+    std::remove(output_name.c_str());
+}
@@ -0,0 +1,90 @@
+#include "pch.h"
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "batch_divide.h"
+
+namespace
+{
+    bool bit_set(const std::vector<std::uint64_t>& mask, std::size_t index)
+    {
+        return (mask[index / 64] >> (index % 64)) & 1u;
+    }
+}
+
+// lengths that are not a multiple of any register width exercise the scalar tail as well
+TEST(BatchDivideTest, MasksZeroDenominatorsInEveryLane)
+{
+    for (const std::size_t count : { 0u, 1u, 7u, 16u, 67u, 130u })
+    {
+        std::vector<float> numerators(count);
+        std::vector<float> denominators(count);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            numerators[i] = static_cast<float>(i + 1);
+            denominators[i] = i % 5 == 0 ? 0.0f : static_cast<float>(i % 7 + 1);
+        }
+
+        std::vector<float> results(count);
+        std::vector<std::uint64_t> mask(batch_divide_mask_words(count), ~0ull);
+        batch_divide_options options;
+        options.sentinel = -1.0f;
+
+        const std::size_t bad = divide_batch(numerators.data(), denominators.data(), results.data(), count, mask.data(), options);
+
+        ASSERT_EQ(bad, (count + 4) / 5) << "count " << count;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            if (i % 5 == 0)
+            {
+                ASSERT_TRUE(bit_set(mask, i)) << "lane " << i;
+                ASSERT_EQ(results[i], -1.0f);
+            }
+            else
+            {
+                ASSERT_FALSE(bit_set(mask, i)) << "lane " << i;
+                ASSERT_FLOAT_EQ(results[i], numerators[i] / denominators[i]);
+            }
+        }
+    }
+}
+
+TEST(BatchDivideTest, SubnormalAndNanDenominators)
+{
+    const float subnormal = std::numeric_limits<float>::denorm_min();
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    std::vector<float> numerators(20, 1.0f);
+    std::vector<float> denominators(20, 2.0f);
+    denominators[3] = subnormal;
+    denominators[9] = -0.0f;
+    denominators[17] = nan;
+
+    std::vector<float> results(20);
+    std::vector<std::uint64_t> mask(1);
+    ASSERT_EQ(divide_batch(numerators.data(), denominators.data(), results.data(), 20, mask.data()), 3u);
+    ASSERT_EQ(mask[0], (1ull << 3) | (1ull << 9) | (1ull << 17));
+
+    // with subnormals accepted only zero and NaN are rejected, and results may overwrite the input
+    batch_divide_options options;
+    options.reject_subnormal = false;
+    ASSERT_EQ(divide_batch(numerators.data(), denominators.data(), numerators.data(), 20, nullptr, options), 2u);
+    ASSERT_TRUE(std::isinf(numerators[3]));
+    ASSERT_EQ(numerators[9], 0.0f);
+    ASSERT_EQ(numerators[0], 0.5f);
+}
+
+// the x86-64-v3 and x86-64-v4 presets exist to test these kernels, make sure they are the ones built
+TEST(BatchDivideTest, WidthFollowsTheTargetInstructionSet)
+{
+#if defined(__AVX512F__)
+    ASSERT_EQ(batch_divide_width(), 16u);
+#elif defined(__AVX__)
+    ASSERT_EQ(batch_divide_width(), 8u);
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    ASSERT_EQ(batch_divide_width(), 4u);
+#else
+    ASSERT_EQ(batch_divide_width(), 1u);
+#endif
+}
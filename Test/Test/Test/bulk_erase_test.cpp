@@ -0,0 +1,121 @@
+#include "pch.h"
+
+#include <cstdint>
+#include <list>
+#include <string>
+#include <vector>
+
+#include "bulk_erase.h"
+
+namespace
+{
+    // vector_test() from QuestionableCode.cpp with the iterator invalidation fixed: erase returns
+    // the next valid iterator. Correct, but quadratic, so it is only the reference here.
+    template <typename T, typename Predicate>
+    std::vector<T> erase_one_at_a_time(std::vector<T> items, Predicate remove)
+    {
+        for (auto iter = items.begin(); iter != items.end();)
+        {
+            if (remove(*iter))
+            {
+                iter = items.erase(iter);
+            }
+            else
+            {
+                ++iter;
+            }
+        }
+        return items;
+    }
+
+    template <typename T>
+    std::vector<T> sequence(std::size_t count)
+    {
+        std::vector<T> items(count);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            items[i] = static_cast<T>(i * 7 % 101);
+        }
+        return items;
+    }
+}
+
+template <typename T>
+class BulkEraseTest : public ::testing::Test
+{
+};
+
+using bulk_erase_types = ::testing::Types<std::int32_t, float, std::uint64_t, double, std::int16_t>;
+TYPED_TEST_CASE(BulkEraseTest, bulk_erase_types);
+
+// lengths around the block and register sizes, removal ratios from none to all
+TYPED_TEST(BulkEraseTest, MatchesEraseOneAtATime)
+{
+    for (const std::size_t count : { 0u, 1u, 3u, 8u, 17u, 511u, 512u, 513u, 2000u })
+    {
+        for (const int modulus : { 1, 2, 3, 10, 1000 })
+        {
+            const auto remove = [modulus](TypeParam value) { return static_cast<long long>(value) % modulus == 0; };
+            const std::vector<TypeParam> original = sequence<TypeParam>(count);
+            const std::vector<TypeParam> expected = erase_one_at_a_time(original, remove);
+
+            std::vector<TypeParam> bulk = original;
+            ASSERT_EQ(bulk_erase_if(bulk, remove), count - expected.size());
+            ASSERT_EQ(bulk, expected);
+
+            std::vector<TypeParam> remove_idiom = original;
+            ASSERT_EQ(erase_remove_if(remove_idiom, remove), count - expected.size());
+            ASSERT_EQ(remove_idiom, expected);
+
+            std::vector<TypeParam> compacted = original;
+            compacted.erase(compact_if(compacted.begin(), compacted.end(), remove), compacted.end());
+            ASSERT_EQ(compacted, expected);
+        }
+    }
+}
+
+// the exact vector_test() data: 1, 2, 3 with the 2 removed
+TEST(BulkEraseTest, RemovesTheVectorTestElement)
+{
+    std::vector<int> items = { 1, 2, 3 };
+    ASSERT_EQ(bulk_erase_if(items, [](int value) { return value == 2; }), 1u);
+    ASSERT_EQ(items, (std::vector<int>{ 1, 3 }));
+
+    // adjacent matches are what the invalidated loop skips over
+    std::vector<int> adjacent = { 2, 2, 1, 2, 2 };
+    ASSERT_EQ(bulk_erase_if(adjacent, [](int value) { return value == 2; }), 4u);
+    ASSERT_EQ(adjacent, std::vector<int>{ 1 });
+}
+
+// elements that are not trivially copyable are moved, and other containers take the generic path
+TEST(BulkEraseTest, MovesNonTrivialElements)
+{
+    std::vector<std::string> words = { "keep", "drop", "keep too", "drop", "drop", "last" };
+    ASSERT_EQ(bulk_erase_if(words, [](const std::string& word) { return word == "drop"; }), 3u);
+    ASSERT_EQ(words, (std::vector<std::string>{ "keep", "keep too", "last" }));
+
+    std::list<int> numbers = { 1, 2, 3, 4, 5, 6 };
+    ASSERT_EQ(erase_remove_if(numbers, [](int value) { return value % 2 == 0; }), 3u);
+    ASSERT_EQ(numbers, (std::list<int>{ 1, 3, 5 }));
+}
+
+// the predicate sees every original element exactly once, in order
+TEST(BulkEraseTest, CallsThePredicateOncePerElementInOrder)
+{
+    std::vector<std::uint32_t> items(1500);
+    for (std::size_t i = 0; i < items.size(); ++i)
+    {
+        items[i] = static_cast<std::uint32_t>(i);
+    }
+
+    std::uint32_t expected_next = 0;
+    bool in_order = true;
+    bulk_erase_if(items, [&](std::uint32_t value) {
+        in_order = in_order && value == expected_next++;
+        return value % 3 != 0;
+    });
+    ASSERT_TRUE(in_order);
+    ASSERT_EQ(expected_next, 1500u);
+    ASSERT_EQ(items.size(), 500u);
+    ASSERT_EQ(items.back(), 1497u);
+}
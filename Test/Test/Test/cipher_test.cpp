@@ -0,0 +1,231 @@
+#include "pch.h"
+
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "chacha20_poly1305.h"
+#include "cipher.h"
+#include "key_derivation.h"
+
+namespace
+{
+    std::vector<std::uint8_t> from_hex(const std::string& hex)
+    {
+        std::vector<std::uint8_t> bytes;
+        for (std::size_t i = 0; i + 1 < hex.size(); i += 2)
+        {
+            bytes.push_back(static_cast<std::uint8_t>(std::stoi(hex.substr(i, 2), nullptr, 16)));
+        }
+        return bytes;
+    }
+
+    std::string to_hex(const std::uint8_t* bytes, std::size_t size)
+    {
+        static const char digits[] = "0123456789abcdef";
+        std::string hex;
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            hex += digits[bytes[i] >> 4];
+            hex += digits[bytes[i] & 0xf];
+        }
+        return hex;
+    }
+
+    std::string sha256_hex(const std::uint8_t* data, std::size_t size)
+    {
+        sha256 hash;
+        hash.update(data, size);
+        std::uint8_t digest[sha256_size];
+        hash.finish(digest);
+        return to_hex(digest, sizeof(digest));
+    }
+
+    std::vector<std::uint8_t> sequence(std::size_t size)
+    {
+        std::vector<std::uint8_t> bytes(size);
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            bytes[i] = static_cast<std::uint8_t>(i * 7 % 251);
+        }
+        return bytes;
+    }
+
+    // few iterations so the tests stay fast; the iteration count does not change the code paths
+    constexpr std::uint32_t test_iterations = 16;
+}
+
+TEST(CipherTest, Sha256KnownAnswers)
+{
+    const std::string abc = "abc";
+    ASSERT_EQ(sha256_hex(reinterpret_cast<const std::uint8_t*>(abc.data()), abc.size()),
+        "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+
+    // fed in uneven pieces to cross the 64 byte block boundary mid update
+    const std::string a(1000, 'a');
+    sha256 hash;
+    for (std::size_t offset = 0; offset < a.size(); offset += 37)
+    {
+        hash.update(a.data() + offset, std::min<std::size_t>(37, a.size() - offset));
+    }
+    std::uint8_t digest[sha256_size];
+    hash.finish(digest);
+    ASSERT_EQ(to_hex(digest, sizeof(digest)), "41edece42d63e8d9bf515a9ba6932e1c20cbc9f5a5d134645adb5db1b9737ea3");
+}
+
+// RFC 4231 test case 2 and the PBKDF2-HMAC-SHA-256 vectors of RFC 7914
+TEST(CipherTest, HmacAndPbkdf2KnownAnswers)
+{
+    const std::string key = "Jefe";
+    const std::string message = "what do ya want for nothing?";
+    std::uint8_t mac[sha256_size];
+    hmac_sha256(key.data(), key.size(), message.data(), message.size(), mac);
+    ASSERT_EQ(to_hex(mac, sizeof(mac)), "5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843");
+
+    const std::uint8_t salt[] = { 's', 'a', 'l', 't' };
+    std::uint8_t derived[64];
+    pbkdf2_sha256("passwd", salt, sizeof(salt), 1, derived, sizeof(derived));
+    ASSERT_EQ(to_hex(derived, sizeof(derived)),
+        "55ac046e56e3089fec1691c22544b605f94185216dde0465e68b9d57c20dacbc"
+        "49ca9cccf179b645991664b39d77ef317c71b845b1e30bd509112041d3a19783");
+
+    pbkdf2_sha256("password", salt, sizeof(salt), 4096, derived, 32);
+    ASSERT_EQ(to_hex(derived, 32), "c5e478d59288c841aa530db6845c4c8d962893a001ce4e11a4963873aa98134a");
+}
+
+// RFC 8439 section 2.5.2
+TEST(CipherTest, Poly1305KnownAnswer)
+{
+    const auto key = from_hex("85d6be7857556d337f4452fe42d506a80103808afb0db2fd4abff6af4149f51b");
+    const std::string message = "Cryptographic Forum Research Group";
+    std::uint8_t tag[poly1305_tag_size];
+    poly1305(key.data(), reinterpret_cast<const std::uint8_t*>(message.data()), message.size(), tag);
+    ASSERT_EQ(to_hex(tag, sizeof(tag)), "a8061dc1305136c6c22b8baf0c0127a9");
+}
+
+// RFC 8439 section 2.8.2
+TEST(CipherTest, AeadKnownAnswer)
+{
+    const auto key = from_hex("808182838485868788898a8b8c8d8e8f909192939495969798999a9b9c9d9e9f");
+    const auto nonce = from_hex("070000004041424344454647");
+    const auto aad = from_hex("50515253c0c1c2c3c4c5c6c7");
+    const std::string plaintext = "Ladies and Gentlemen of the class of '99: If I could offer you only one tip for the future, sunscreen would be it.";
+
+    std::vector<std::uint8_t> ciphertext(plaintext.size());
+    std::uint8_t tag[poly1305_tag_size];
+    ASSERT_TRUE(chacha20_poly1305_seal(key.data(), nonce.data(), aad.data(), aad.size(), reinterpret_cast<const std::uint8_t*>(plaintext.data()),
+        ciphertext.data(), plaintext.size(), tag));
+
+    ASSERT_EQ(to_hex(ciphertext.data(), ciphertext.size()),
+        "d31a8d34648e60db7b86afbc53ef7ec2a4aded51296e08fea9e2b5a736ee62d63dbea45e8ca9671282fafb69da92728b"
+        "1a71de0a9e060b2905d6a5b67ecd3b3692ddbd7f2d778b8c9803aee328091b58fab324e4fad675945585808b4831d7bc"
+        "3ff4def08e4b7a9de576d26586cec64b6116");
+    ASSERT_EQ(to_hex(tag, sizeof(tag)), "1ae10b594f09e26a7e902ecbd0600691");
+
+    std::vector<std::uint8_t> decrypted(ciphertext.size());
+    ASSERT_TRUE(chacha20_poly1305_open(key.data(), nonce.data(), aad.data(), aad.size(), ciphertext.data(), decrypted.data(),
+        ciphertext.size(), tag));
+    ASSERT_EQ(std::string(decrypted.begin(), decrypted.end()), plaintext);
+
+    // past 2^32 - 1 blocks the counter would wrap; refused before any byte is touched
+    if (chacha20_poly1305_max_size < std::numeric_limits<std::size_t>::max())
+    {
+        const auto too_long = static_cast<std::size_t>(chacha20_poly1305_max_size + 1);
+        ASSERT_FALSE(chacha20_poly1305_seal(key.data(), nonce.data(), aad.data(), aad.size(), nullptr, nullptr, too_long, tag));
+        ASSERT_FALSE(chacha20_poly1305_open(key.data(), nonce.data(), aad.data(), aad.size(), nullptr, nullptr, too_long, tag));
+    }
+}
+
+// long enough for the 8 and 4 block kernels and a partial block, checked against a reference
+// implementation of RFC 8439
+TEST(CipherTest, VectorKernelsMatchReference)
+{
+    std::vector<std::uint8_t> key(32), nonce(12);
+    for (std::size_t i = 0; i < key.size(); ++i)
+    {
+        key[i] = static_cast<std::uint8_t>(i);
+    }
+    for (std::size_t i = 0; i < nonce.size(); ++i)
+    {
+        nonce[i] = static_cast<std::uint8_t>(i);
+    }
+    const std::string aad = "Student Name: John Q. Smith";
+    const auto plaintext = sequence(4099);
+
+    std::vector<std::uint8_t> ciphertext(plaintext.size());
+    std::uint8_t tag[poly1305_tag_size];
+    chacha20_poly1305_seal(key.data(), nonce.data(), reinterpret_cast<const std::uint8_t*>(aad.data()), aad.size(), plaintext.data(),
+        ciphertext.data(), plaintext.size(), tag);
+    ASSERT_EQ(sha256_hex(ciphertext.data(), ciphertext.size()), "313870f09b0c884a3bde7c8f7bd65e9e7f26f0fc1fde9df0266cff70c9be6def");
+    ASSERT_EQ(to_hex(tag, sizeof(tag)), "a73d95a0feac9d9865082f498b5ffdd5");
+
+    // one block at a time only ever runs the scalar kernel
+    std::vector<std::uint8_t> blockwise(plaintext.size());
+    for (std::size_t offset = 0; offset < plaintext.size(); offset += 64)
+    {
+        chacha20_xor(key.data(), nonce.data(), static_cast<std::uint32_t>(1 + offset / 64), plaintext.data() + offset,
+            blockwise.data() + offset, std::min<std::size_t>(64, plaintext.size() - offset));
+    }
+    ASSERT_EQ(blockwise, ciphertext);
+}
+
+TEST(CipherTest, TamperingIsDetected)
+{
+    const cipher_key key(cipher_mode::chacha20_poly1305, "password", test_iterations);
+    const std::string plaintext = "John Q. Smith\nThis is my test string";
+
+    cipher_header header;
+    std::string ciphertext = encrypt(key, plaintext, header, "header");
+    ASSERT_EQ(ciphertext.size(), plaintext.size());
+    ASSERT_NE(ciphertext, plaintext);
+
+    std::string decrypted;
+    ASSERT_TRUE(decrypt(key, header, ciphertext, decrypted, "header"));
+    ASSERT_EQ(decrypted, plaintext);
+
+    ASSERT_FALSE(decrypt(key, header, ciphertext, decrypted, "other header"));
+    ASSERT_TRUE(decrypted.empty());
+
+    ciphertext[3] ^= 1;
+    ASSERT_FALSE(decrypt(key, header, ciphertext, decrypted, "header"));
+    ASSERT_TRUE(decrypted.empty());
+}
+
+TEST(CipherTest, KeyIdIdentifiesTheKey)
+{
+    const cipher_key key(cipher_mode::chacha20_poly1305, "password", test_iterations);
+    const cipher_key same(cipher_mode::chacha20_poly1305, "password", key.salt().data(), test_iterations);
+    const cipher_key wrong(cipher_mode::chacha20_poly1305, "Password", key.salt().data(), test_iterations);
+
+    ASSERT_EQ(key.id(), same.id());
+    ASSERT_NE(key.id(), wrong.id());
+    ASSERT_EQ(key.id_string().size(), 2 * cipher_key_id_size);
+    ASSERT_EQ(key.id_string().find("password"), std::string::npos);
+
+    cipher_header header;
+    const std::string ciphertext = encrypt(key, "secret", header);
+    std::string decrypted;
+    ASSERT_TRUE(decrypt(same, header, ciphertext, decrypted));
+    ASSERT_EQ(decrypted, "secret");
+    ASSERT_FALSE(decrypt(wrong, header, ciphertext, decrypted));
+
+    // every message gets its own nonce
+    cipher_header second;
+    encrypt(key, "secret", second);
+    ASSERT_NE(header.nonce, second.nonce);
+}
+
+TEST(CipherTest, LegacyXorMatchesEncryptDecrypt)
+{
+    const cipher_key key(cipher_mode::legacy_xor, "password", test_iterations);
+    const std::string plaintext = "John Q. Smith\nThis is my test string";
+
+    cipher_header header;
+    const std::string ciphertext = encrypt(key, plaintext, header);
+    ASSERT_EQ(ciphertext[0], static_cast<char>('J' ^ 'p'));
+
+    std::string decrypted;
+    ASSERT_TRUE(decrypt(key, header, ciphertext, decrypted));
+    ASSERT_EQ(decrypted, plaintext);
+    ASSERT_EQ(to_string(header).rfind("xor salt=", 0), 0u);
+}
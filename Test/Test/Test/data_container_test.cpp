@@ -0,0 +1,324 @@
+#include "pch.h"
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <utility>
+
+#include "data_container.h"
+
+namespace
+{
+    constexpr std::uint32_t test_iterations = 16;
+
+    std::string sample(std::size_t size)
+    {
+        std::string text(size, '\0');
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            // newlines included, the text format could not hold these safely
+            text[i] = static_cast<char>(i % 13 == 0 ? '\n' : 'a' + i % 26);
+        }
+        return text;
+    }
+
+    const std::uint8_t* bytes_of(const std::string& image)
+    {
+        return reinterpret_cast<const std::uint8_t*>(image.data());
+    }
+
+    // writes a little endian field of a container header, as the container does
+    void put_le(std::string& image, std::size_t offset, std::uint64_t value, std::size_t bytes)
+    {
+        for (std::size_t i = 0; i < bytes; ++i)
+        {
+            image[offset + i] = static_cast<char>(value >> (8 * i));
+        }
+    }
+}
+
+TEST(DataContainerTest, RoundTripsInChunks)
+{
+    const cipher_key key(cipher_mode::chacha20_poly1305, "password", test_iterations);
+    const std::string data = sample(10000);
+
+    const auto image = seal_container("John Q. Smith", key, data, 1024, 4);
+    ASSERT_TRUE(image);
+    ASSERT_EQ(image->size(), container_header_size + 10 * container_entry_size + data.size());
+
+    const auto view = container_view::parse(bytes_of(*image), image->size());
+    ASSERT_TRUE(view);
+    ASSERT_EQ(view->header().student_name, "John Q. Smith");
+    ASSERT_EQ(view->header().timestamp.size(), 10u);
+    ASSERT_EQ(view->header().payload_length, data.size());
+    ASSERT_EQ(view->chunk_count(), 10u);
+    ASSERT_EQ(view->chunk(9).plain_size, 10000u - 9 * 1024);
+
+    const auto restored = view->decrypt_all(key, 3);
+    ASSERT_TRUE(restored);
+    ASSERT_EQ(*restored, data);
+}
+
+TEST(DataContainerTest, DecryptsAnyChunkOnItsOwn)
+{
+    for (const auto mode : { cipher_mode::chacha20_poly1305, cipher_mode::legacy_xor })
+    {
+        const cipher_key key(mode, "password", test_iterations);
+        const std::string data = sample(5000);
+        const auto image = seal_container("name", key, data, 700, 1);
+        const auto view = container_view::parse(bytes_of(*image), image->size());
+        ASSERT_TRUE(view);
+
+        // the last chunk first, without touching any other
+        for (std::size_t i = view->chunk_count(); i-- > 0;)
+        {
+            std::string chunk(view->chunk(i).plain_size, '\0');
+            ASSERT_TRUE(view->decrypt_chunk(key, i, &chunk[0]));
+            ASSERT_EQ(chunk, data.substr(static_cast<std::size_t>(view->chunk_position(i)), chunk.size()));
+        }
+    }
+}
+
+TEST(DataContainerTest, DetectsTamperingAndWrongKeys)
+{
+    const cipher_key key(cipher_mode::chacha20_poly1305, "password", test_iterations);
+    const std::string data = sample(3000);
+    const auto image = seal_container("John Q. Smith", key, data, 1000);
+
+    // the header is authenticated with every chunk
+    std::string renamed = *image;
+    renamed[83] = 'X';
+    auto view = container_view::parse(bytes_of(renamed), renamed.size());
+    ASSERT_TRUE(view);
+    ASSERT_EQ(view->decrypt_all(key).error(), container_error::authentication_failed);
+
+    std::string flipped = *image;
+    flipped[flipped.size() - 1] ^= 1;
+    view = container_view::parse(bytes_of(flipped), flipped.size());
+    ASSERT_TRUE(view);
+    std::string chunk(1000, '\0');
+    ASSERT_TRUE(view->decrypt_chunk(key, 0, &chunk[0]));
+    ASSERT_EQ(view->decrypt_chunk(key, 2, &chunk[0]).error(), container_error::authentication_failed);
+    ASSERT_EQ(view->decrypt_chunk(key, 3, &chunk[0]).error(), container_error::chunk_out_of_range);
+
+    const cipher_key other(cipher_mode::chacha20_poly1305, "Password", key.salt().data(), test_iterations);
+    view = container_view::parse(bytes_of(*image), image->size());
+    ASSERT_EQ(view->decrypt_all(other).error(), container_error::wrong_key);
+
+    // the key for a container comes from its own header
+    const cipher_key derived = derive_container_key(view->header(), "password");
+    ASSERT_TRUE(view->decrypt_all(derived));
+}
+
+TEST(DataContainerTest, RejectsMalformedInput)
+{
+    const cipher_key key(cipher_mode::chacha20_poly1305, "password", test_iterations);
+    const auto image = seal_container("name", key, sample(3000), 1000);
+
+    ASSERT_EQ(container_view::parse(bytes_of(*image), 100).error(), container_error::truncated);
+    ASSERT_EQ(container_view::parse(bytes_of(*image), image->size() - 1).error(), container_error::truncated);
+
+    const std::string text = "Student Name: John Q. Smith\nTimestamp: 2026-10-19\n" + std::string(300, 'x');
+    ASSERT_EQ(container_view::parse(bytes_of(text), text.size()).error(), container_error::bad_magic);
+
+    std::string version = *image;
+    version[8] = 2;
+    ASSERT_EQ(container_view::parse(bytes_of(version), version.size()).error(), container_error::unsupported_version);
+
+    std::string count = *image;
+    count[20] = 7;
+    ASSERT_EQ(container_view::parse(bytes_of(count), count.size()).error(), container_error::corrupt_index);
+
+    ASSERT_EQ(seal_container(std::string(129, 'n'), key, "data").error(), container_error::name_too_long);
+}
+
+// header sizes chosen so that rounding the chunk count up wraps, or that claim more than the file holds
+TEST(DataContainerTest, RejectsPayloadLengthsTheHeaderCannotHold)
+{
+    const cipher_key key(cipher_mode::chacha20_poly1305, "password", test_iterations);
+    const auto image = seal_container("name", key, sample(3000), 1000);
+
+    std::string wrapping = *image;
+    put_le(wrapping, 16, 2, 4);
+    put_le(wrapping, 20, 0, 4);
+    put_le(wrapping, 24, ~std::uint64_t{ 0 }, 8);
+    ASSERT_EQ(container_view::parse(bytes_of(wrapping), wrapping.size()).error(), container_error::corrupt_index);
+
+    // three chunks of 2^31 bytes agree with the chunk count, but not with a file of a few KB
+    std::string oversized = *image;
+    put_le(oversized, 16, std::uint64_t{ 1 } << 31, 4);
+    put_le(oversized, 24, (std::uint64_t{ 1 } << 32) + 5, 8);
+    ASSERT_EQ(container_view::parse(bytes_of(oversized), oversized.size()).error(), container_error::truncated);
+}
+
+TEST(DataContainerTest, MapsWrittenFile)
+{
+    const cipher_key key(cipher_mode::chacha20_poly1305, "password", test_iterations);
+    const std::string data = sample(200000);
+    const std::string filename = "data_container_test.scd";
+
+    ASSERT_TRUE(write_container(filename, "John Q. Smith", key, data));
+    container_file file;
+    ASSERT_TRUE(file.open(filename));
+    ASSERT_EQ(file.view().chunk_count(), 4u);
+    const auto restored = file.view().decrypt_all(key);
+    ASSERT_TRUE(restored);
+    ASSERT_EQ(*restored, data);
+
+    std::remove(filename.c_str());
+    ASSERT_EQ(container_file().open(filename).error(), container_error::io_error);
+}
+
+TEST(DataContainerTest, EmptyPayload)
+{
+    const cipher_key key(cipher_mode::chacha20_poly1305, "password", test_iterations);
+    const auto image = seal_container("name", key, "");
+    ASSERT_EQ(image->size(), container_header_size);
+    const auto view = container_view::parse(bytes_of(*image), image->size());
+    ASSERT_TRUE(view);
+    ASSERT_EQ(view->chunk_count(), 0u);
+    ASSERT_EQ(*view->decrypt_all(key), "");
+}
+
+TEST(DataContainerTest, CompressesChunksBeforeEncrypting)
+{
+    for (const auto mode : { cipher_mode::chacha20_poly1305, cipher_mode::legacy_xor })
+    {
+        const cipher_key key(mode, "password", test_iterations);
+
+        // repetitive text followed by bytes that do not compress, which are stored as they are
+        std::string data = sample(20000);
+        std::uint32_t state = 1;
+        for (int i = 0; i < 3000; ++i)
+        {
+            state = state * 1664525u + 1013904223u;
+            data += static_cast<char>(state >> 24);
+        }
+
+        const auto image = seal_container("name", key, data, 1000, 3, container_compression::lz4);
+        ASSERT_TRUE(image);
+        ASSERT_LT(image->size(), data.size() / 2);
+
+        const auto view = container_view::parse(bytes_of(*image), image->size());
+        ASSERT_TRUE(view);
+        ASSERT_EQ(view->header().compression, container_compression::lz4);
+        ASSERT_LT(view->chunk(0).stored_size, view->chunk(0).plain_size);
+        ASSERT_EQ(view->chunk(22).stored_size, view->chunk(22).plain_size);
+        ASSERT_EQ(*view->decrypt_all(key, 2), data);
+
+        std::string chunk(view->chunk(5).plain_size, '\0');
+        ASSERT_TRUE(view->decrypt_chunk(key, 5, &chunk[0]));
+        ASSERT_EQ(chunk, data.substr(5000, 1000));
+
+        // a flag this version does not know
+        std::string flagged = *image;
+        flagged[13] |= 2;
+        ASSERT_EQ(container_view::parse(bytes_of(flagged), flagged.size()).error(), container_error::unsupported_version);
+    }
+
+    // legacy_xor has no tag, so a damaged compressed chunk is caught when it fails to decompress
+    const cipher_key legacy(cipher_mode::legacy_xor, "password", test_iterations);
+    std::string image = *seal_container("name", legacy, sample(3000), 1000, 1, container_compression::lz4);
+    image[container_header_size + 8] = static_cast<char>(image[container_header_size + 8] - 1);
+    const auto view = container_view::parse(bytes_of(image), image.size());
+    ASSERT_TRUE(view);
+    std::string chunk(1000, '\0');
+    ASSERT_EQ(view->decrypt_chunk(legacy, 0, &chunk[0]).error(), container_error::corrupt_chunk);
+    ASSERT_EQ(view->decrypt_all(legacy).error(), container_error::corrupt_chunk);
+}
+
+TEST(DataContainerTest, DecryptsRangesWithPositionedReads)
+{
+    for (const auto compression : { container_compression::none, container_compression::lz4 })
+    {
+        for (const auto mode : { cipher_mode::chacha20_poly1305, cipher_mode::legacy_xor })
+        {
+            const cipher_key key(mode, "password", test_iterations);
+            const std::string data = sample(5000);
+            const std::string filename = "data_container_ranges_test.scd";
+            ASSERT_TRUE(write_container(filename, "name", key, data, 700, 0, compression));
+
+            container_reader reader;
+            ASSERT_TRUE(reader.open(filename));
+            ASSERT_EQ(reader.header().payload_length, data.size());
+
+            // inside one chunk, across chunk boundaries, whole chunks, the whole payload and past its end
+            const std::pair<std::uint64_t, std::size_t> ranges[] = { { 10, 20 }, { 690, 20 }, { 699, 1402 }, { 700, 700 }, { 0, 5000 },
+                { 4990, 100 }, { 5000, 10 }, { 123, 0 } };
+            for (const auto& range : ranges)
+            {
+                std::string out(range.second, '\0');
+                const auto count = reader.decrypt_range(key, range.first, &out[0], out.size());
+                ASSERT_TRUE(count);
+                const std::string wanted = range.first < data.size() ? data.substr(static_cast<std::size_t>(range.first), range.second) : "";
+                ASSERT_EQ(*count, wanted.size());
+                ASSERT_EQ(out.substr(0, *count), wanted);
+            }
+
+            std::string out(100, '\0');
+            ASSERT_EQ(*decrypt_range(filename, key, 4950, &out[0], out.size()), 50u);
+            ASSERT_EQ(out.substr(0, 50), data.substr(4950));
+
+            std::remove(filename.c_str());
+            ASSERT_EQ(decrypt_range(filename, key, 0, &out[0], out.size()).error(), container_error::io_error);
+        }
+    }
+}
+
+TEST(DataContainerTest, RangeReadsOnlyTheBytesItNeeds)
+{
+    const std::string data = sample(1000000);
+    const std::string filename = "data_container_range_bytes_test.scd";
+
+    // legacy_xor reads the header, one index entry and exactly the bytes asked for
+    const cipher_key legacy(cipher_mode::legacy_xor, "password", test_iterations);
+    ASSERT_TRUE(write_container(filename, "name", legacy, data, 4096));
+    container_reader reader;
+    ASSERT_TRUE(reader.open(filename));
+    std::string out(10, '\0');
+    ASSERT_TRUE(reader.decrypt_range(legacy, 777777, &out[0], out.size()));
+    ASSERT_EQ(out, data.substr(777777, 10));
+    ASSERT_EQ(reader.bytes_read(), container_header_size + container_entry_size + 10);
+
+    // ChaCha20-Poly1305 has to authenticate the one whole chunk the bytes are in
+    const cipher_key key(cipher_mode::chacha20_poly1305, "password", test_iterations);
+    ASSERT_TRUE(write_container(filename, "name", key, data, 4096));
+    ASSERT_TRUE(reader.open(filename));
+    ASSERT_TRUE(reader.decrypt_range(key, 777777, &out[0], out.size()));
+    ASSERT_EQ(out, data.substr(777777, 10));
+    ASSERT_EQ(reader.bytes_read(), container_header_size + container_entry_size + 4096);
+
+    std::remove(filename.c_str());
+}
+
+TEST(DataContainerTest, RangeDetectsTamperingAndWrongKeys)
+{
+    const cipher_key key(cipher_mode::chacha20_poly1305, "password", test_iterations);
+    const std::string filename = "data_container_range_tamper_test.scd";
+    std::string image = *seal_container("name", key, sample(3000), 1000);
+    image[image.size() - 1] ^= 1;
+    {
+        std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+        file.write(image.data(), static_cast<std::streamsize>(image.size()));
+    }
+
+    container_reader reader;
+    ASSERT_TRUE(reader.open(filename));
+    std::string out(1000, '\0');
+    ASSERT_TRUE(reader.decrypt_range(key, 0, &out[0], out.size()));
+    ASSERT_EQ(reader.decrypt_range(key, 2500, &out[0], 10).error(), container_error::authentication_failed);
+
+    const cipher_key other(cipher_mode::chacha20_poly1305, "Password", key.salt().data(), test_iterations);
+    ASSERT_EQ(reader.decrypt_range(other, 0, &out[0], 10).error(), container_error::wrong_key);
+
+    // a file cut short inside a chunk the range needs
+    {
+        std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+        file.write(image.data(), static_cast<std::streamsize>(image.size() - 500));
+    }
+    ASSERT_TRUE(reader.open(filename));
+    ASSERT_TRUE(reader.decrypt_range(key, 0, &out[0], 10));
+    ASSERT_EQ(reader.decrypt_range(key, 2900, &out[0], 10).error(), container_error::truncated);
+
+    std::remove(filename.c_str());
+}
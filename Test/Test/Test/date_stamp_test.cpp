@@ -0,0 +1,98 @@
+#include "pch.h"
+
+#include <string>
+#include <thread>
+
+#include "allocation_tracking.h"
+#include "date_stamp.h"
+
+namespace
+{
+    std::time_t local_time(int year, int month, int day, int hour, int minute, int second)
+    {
+        std::tm local{};
+        local.tm_year = year - 1900;
+        local.tm_mon = month - 1;
+        local.tm_mday = day;
+        local.tm_hour = hour;
+        local.tm_min = minute;
+        local.tm_sec = second;
+        local.tm_isdst = -1;
+        return std::mktime(&local);
+    }
+
+    std::string stamp(std::time_t when)
+    {
+        char buffer[date_stamp_length + 1];
+        const std::size_t length = date_stamp(when, buffer, sizeof(buffer));
+        return std::string(buffer, length);
+    }
+}
+
+// the old save_data_file wrote 2026-1-5
+TEST(DateStampTest, ZeroPadsMonthAndDay)
+{
+    ASSERT_EQ(stamp(local_time(2026, 1, 5, 12, 0, 0)), "2026-01-05");
+    ASSERT_EQ(stamp(local_time(2026, 12, 31, 12, 0, 0)), "2026-12-31");
+    ASSERT_EQ(stamp(local_time(999, 3, 9, 12, 0, 0)), "0999-03-09");
+}
+
+TEST(DateStampTest, ReusesTheDayUntilMidnight)
+{
+    ASSERT_EQ(stamp(local_time(2026, 10, 19, 0, 0, 0)), "2026-10-19");
+    const std::size_t refreshes = date_stamp_refreshes();
+
+    ASSERT_EQ(stamp(local_time(2026, 10, 19, 9, 30, 0)), "2026-10-19");
+    ASSERT_EQ(stamp(local_time(2026, 10, 19, 23, 59, 59)), "2026-10-19");
+    ASSERT_EQ(date_stamp_refreshes(), refreshes);
+
+    ASSERT_EQ(stamp(local_time(2026, 10, 20, 0, 0, 0)), "2026-10-20");
+    ASSERT_EQ(date_stamp_refreshes(), refreshes + 1);
+
+    // a clock that steps back is converted again rather than given the later day
+    ASSERT_EQ(stamp(local_time(2026, 10, 19, 23, 59, 59)), "2026-10-19");
+    ASSERT_EQ(date_stamp_refreshes(), refreshes + 2);
+}
+
+TEST(DateStampTest, RejectsShortBuffer)
+{
+    char buffer[date_stamp_length] = { 'x' };
+    ASSERT_EQ(date_stamp(buffer, sizeof(buffer)), 0u);
+    ASSERT_EQ(buffer[0], '\0');
+
+    char exact[date_stamp_length + 1];
+    ASSERT_EQ(date_stamp(exact, sizeof(exact)), date_stamp_length);
+    ASSERT_EQ(exact[date_stamp_length], '\0');
+}
+
+TEST(DateStampTest, DoesNotAllocate)
+{
+    // the first conversion may load the time zone database
+    char buffer[date_stamp_length + 1];
+    date_stamp(buffer, sizeof(buffer));
+
+    allocation_tracking::restart();
+    for (int i = 0; i < 1000; ++i)
+    {
+        date_stamp(buffer, sizeof(buffer));
+    }
+    EXPECT_NO_ALLOCS();
+}
+
+TEST(DateStampTest, EachThreadHasItsOwnCache)
+{
+    const std::time_t noon = local_time(2026, 10, 19, 12, 0, 0);
+    ASSERT_EQ(stamp(noon), "2026-10-19");
+
+    std::size_t other_refreshes = 0;
+    std::string other_stamp;
+    std::thread other([&]() {
+        other_stamp = stamp(noon);
+        other_stamp += stamp(noon + 60);
+        other_refreshes = date_stamp_refreshes();
+    });
+    other.join();
+
+    ASSERT_EQ(other_stamp, "2026-10-192026-10-19");
+    ASSERT_EQ(other_refreshes, 1u);
+}
@@ -0,0 +1,89 @@
+#include "pch.h"
+
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "allocation_tracking.h"
+#include "encrypt_decrypt.h"
+
+namespace
+{
+    std::string sample(std::size_t size)
+    {
+        std::string text(size, '\0');
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            text[i] = static_cast<char>(i * 31 + 7);
+        }
+        return text;
+    }
+}
+
+TEST(EncryptDecryptTest, PreparedKeyMatchesByteByByte)
+{
+    const std::string source = sample(1000);
+
+    // lengths around the vector width, and long enough to repeat at their own length
+    for (const std::size_t key_length : { 1u, 3u, 7u, 8u, 16u, 24u, 31u, 32u, 33u, 100u, 4097u, 5000u })
+    {
+        const std::string text = sample(key_length * 3 + 5).substr(key_length);
+        const std::string key = text.substr(0, key_length);
+        const xor_key prepared(key);
+        ASSERT_EQ(prepared.length(), key_length);
+        ASSERT_EQ(prepared.period() % key_length, 0u);
+
+        // every start position within two periods, a few lengths on each side of a vector
+        for (std::uint64_t position = 0; position < 2 * prepared.period() + 3; position += 1 + position / 50)
+        {
+            for (const std::size_t length : { 0u, 1u, 15u, 16u, 17u, 63u, 64u, 65u, 1000u })
+            {
+                std::string expected(length, '\0');
+                std::string actual(length, '\0');
+                encrypt_decrypt(source.data(), &expected[0], length, key, position);
+                encrypt_decrypt(source.data(), &actual[0], length, prepared, position);
+                ASSERT_EQ(actual, expected) << "key " << key_length << " position " << position << " length " << length;
+            }
+        }
+    }
+}
+
+TEST(EncryptDecryptTest, PreparedKeyRoundTripsInPlace)
+{
+    const std::string source = sample(10000);
+    const xor_key key("password");
+
+    const std::string encrypted = encrypt_decrypt(source, key);
+    ASSERT_EQ(encrypted, encrypt_decrypt(source, std::string("password")));
+
+    std::string buffer = encrypted;
+    encrypt_decrypt(buffer.data(), &buffer[0], buffer.size(), key, 0);
+    ASSERT_EQ(buffer, source);
+
+    // empty messages, which the std::string overload asserts on
+    ASSERT_EQ(encrypt_decrypt(std::string(), key), "");
+}
+
+TEST(EncryptDecryptTest, PreparedKeyMovesAndDoesNotAllocatePerCall)
+{
+    xor_key key("password");
+    const std::size_t period = key.period();
+    ASSERT_EQ(period % xor_key::width(), 0u);
+
+    xor_key moved(std::move(key));
+    ASSERT_TRUE(key.empty());
+    ASSERT_EQ(moved.period(), period);
+    // an empty key has no period to wrap at
+    char byte = 'x';
+    ASSERT_THROW(key.apply(&byte, &byte, 1, 0), std::invalid_argument);
+    ASSERT_THROW(encrypt_decrypt(&byte, &byte, 1, xor_key(), 0), std::invalid_argument);
+
+    key = xor_key("other key");
+    moved = std::move(key);
+    ASSERT_EQ(moved.length(), 9u);
+
+    std::string buffer = sample(4096);
+    allocation_tracking::restart();
+    encrypt_decrypt(buffer.data(), &buffer[0], buffer.size(), moved, 12345);
+    EXPECT_NO_ALLOCS();
+}
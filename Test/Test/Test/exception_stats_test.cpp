@@ -0,0 +1,55 @@
+#include "pch.h"
+
+#include <sstream>
+#include <stdexcept>
+
+#include "exception_stats.h"
+
+namespace
+{
+    void throw_runtime_error()
+    {
+        throw std::runtime_error("counted");
+    }
+}
+
+// every throw is counted against its type and call site, and every catch adds to the unwind time
+TEST(ExceptionStatsTest, CountsThrowsPerTypeAndSite)
+{
+    exception_stats::reset();
+    exception_stats::set_sample_interval(2);
+
+    for (int i = 0; i < 4; ++i)
+    {
+        try
+        {
+            throw_runtime_error();
+        }
+        catch (const std::runtime_error&)
+        {
+        }
+    }
+    if (!exception_stats::hooked())
+    {
+        exception_stats::record_throw(typeid(std::runtime_error), nullptr);
+    }
+
+    const auto sites = exception_stats::snapshot();
+    ASSERT_EQ(sites.size(), 1u);
+    ASSERT_EQ(*sites[0].type, typeid(std::runtime_error));
+
+    if (exception_stats::hooked())
+    {
+        ASSERT_EQ(sites[0].throws, 4u);
+        ASSERT_EQ(sites[0].catches, 4u);
+        ASSERT_GT(sites[0].stack_depth, 0u);
+    }
+
+    std::ostringstream report;
+    exception_stats::report(report);
+    ASSERT_NE(report.str().find("runtime_error"), std::string::npos);
+
+    exception_stats::set_sample_interval(64);
+    exception_stats::reset();
+    ASSERT_EQ(exception_stats::total_throws(), 0u);
+}
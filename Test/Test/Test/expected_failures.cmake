@@ -0,0 +1,2 @@
+# Included by ctest after the googletest discovery output, see CMakeLists.txt.
+set_tests_properties(CollectionTest.AlwaysFail PROPERTIES WILL_FAIL TRUE)
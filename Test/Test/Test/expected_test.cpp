@@ -0,0 +1,68 @@
+#include "pch.h"
+
+#include <stdexcept>
+#include <string>
+
+#include "application_logic.h"
+#include "expected.h"
+
+TEST(ExpectedTest, HoldsValueOrError)
+{
+    const expected<int, std::string> value = 42;
+    ASSERT_TRUE(value.has_value());
+    ASSERT_EQ(*value, 42);
+    ASSERT_EQ(value.value_or(0), 42);
+
+    const expected<int, std::string> error = unexpected(std::string("failed"));
+    ASSERT_FALSE(error);
+    ASSERT_EQ(error.error(), "failed");
+    ASSERT_EQ(error.value_or(7), 7);
+    ASSERT_THROW(error.value(), bad_expected_access<std::string>);
+}
+
+TEST(ExpectedTest, MapAndThenPassErrorsThrough)
+{
+    const auto half = [](int number) -> expected<int, std::string> {
+        if (number % 2 != 0)
+        {
+            return unexpected(std::string("odd"));
+        }
+        return number / 2;
+    };
+
+    const expected<int, std::string> eight = 8;
+    ASSERT_EQ(*eight.and_then(half).and_then(half), 2);
+    ASSERT_EQ(eight.and_then(half).and_then(half).and_then(half).and_then(half).error(), "odd");
+    ASSERT_EQ(*eight.map([](int number) { return number + 1; }), 9);
+
+    const expected<int, std::string> error = unexpected(std::string("failed"));
+    ASSERT_EQ(error.map([](int number) { return number + 1; }).error(), "failed");
+}
+
+// same outcomes as the exception based divide in Exceptions.cpp
+TEST(ExpectedTest, TryDivideReportsZeroDenominator)
+{
+    ASSERT_FLOAT_EQ(*try_divide(10.0f, 4.0f), 2.5f);
+
+    const auto result = try_divide(10.0f, 0.0f);
+    ASSERT_FALSE(result);
+    ASSERT_EQ(result.error().kind, error_kind::runtime);
+}
+
+// the adapter at the edges throws the exception type the error names
+TEST(ExpectedTest, ValueOrThrowConvertsToExceptions)
+{
+    ASSERT_FLOAT_EQ(value_or_throw(try_divide(1.0f, 2.0f)), 0.5f);
+    ASSERT_THROW(value_or_throw(try_divide(1.0f, 0.0f)), divide_by_zero_error);
+    ASSERT_THROW(value_or_throw(try_custom_application_logic()), application_logic_error);
+
+    try
+    {
+        value_or_throw(try_even_more_custom_application_logic());
+        FAIL() << "expected an exception";
+    }
+    catch (const std::exception& exception)
+    {
+        ASSERT_STREQ(exception.what(), "An Exception has occurred");
+    }
+}
@@ -0,0 +1,49 @@
+#include "pch.h"
+
+#include <thread>
+#include <vector>
+
+#include "fast_random.h"
+
+// the same seed must give the same numbers, that is what makes a failing run reproducible
+TEST(FastRandomTest, SameSeedReproducesSequence)
+{
+    fast_random::seed(1234);
+    std::vector<int> first(100);
+    fast_random::fill(first.data(), first.size(), 100);
+
+    fast_random::seed(1234);
+    std::vector<int> second(100);
+    fast_random::fill(second.data(), second.size(), 100);
+
+    ASSERT_EQ(first, second);
+}
+
+TEST(FastRandomTest, ValuesStayBelowBound)
+{
+    std::vector<int> values(1001);
+    fast_random::fill(values.data(), values.size(), 7);
+
+    for (const int value : values)
+    {
+        ASSERT_GE(value, 0);
+        ASSERT_LT(value, 7);
+    }
+    ASSERT_LT(fast_random::uniform(3), 3);
+}
+
+// each thread draws from its own stream rather than sharing one like rand()
+TEST(FastRandomTest, ThreadsGetDistinctStreams)
+{
+    fast_random::seed(99);
+    std::vector<std::uint64_t> main_values{ fast_random::thread_generator()(), fast_random::thread_generator()() };
+    std::vector<std::uint64_t> thread_values;
+
+    std::thread worker([&thread_values]() {
+        thread_values.push_back(fast_random::thread_generator()());
+        thread_values.push_back(fast_random::thread_generator()());
+    });
+    worker.join();
+
+    ASSERT_NE(main_values, thread_values);
+}
@@ -0,0 +1,69 @@
+#include "pch.h"
+
+#include <sstream>
+#include <string>
+
+#include "fixed_string.h"
+
+namespace
+{
+    // the layout from BufferOverflow.cpp: the account number sits directly before the input field
+    struct account_form
+    {
+        fixed_string<19> account_number = "CharlieBrown42";
+        fixed_string<19> user_input;
+    };
+}
+
+// usable in constant expressions, so identifiers can be compile time constants
+static_assert(fixed_string<8>("abc").size() == 3, "constexpr construction");
+static_assert(fixed_string<8>("abc") == std::string_view("abc"), "constexpr comparison");
+static_assert(sizeof(fixed_string<15>) == 17, "inline storage with a one byte length");
+
+// the overflow from BufferOverflow.cpp: input longer than the field must not reach its neighbour
+TEST(FixedStringTest, OverlongInputDoesNotOverwriteNeighbour)
+{
+    account_form form;
+    const std::string input(64, 'A');
+
+    ASSERT_FALSE(form.user_input.assign(input));
+    ASSERT_EQ(form.user_input.size(), 19u);
+    ASSERT_EQ(form.user_input, std::string(19, 'A'));
+    ASSERT_EQ(form.account_number, "CharlieBrown42");
+
+    ASSERT_FALSE(form.user_input.append("more"));
+    ASSERT_FALSE(form.user_input.push_back('!'));
+    ASSERT_EQ(form.account_number, "CharlieBrown42");
+    ASSERT_EQ(std::string(form.user_input.c_str()).size(), 19u);
+}
+
+TEST(FixedStringTest, CheckedFormsThrow)
+{
+    fixed_string<4> text("ab");
+
+    ASSERT_THROW(text.assign_checked("abcde"), std::length_error);
+    ASSERT_EQ(text, "ab");
+    ASSERT_THROW(text += "cde", std::length_error);
+    ASSERT_EQ(text, "ab");
+    ASSERT_THROW(fixed_string<4>(std::string_view("abcde")), std::length_error);
+    ASSERT_THROW(text.at(2), std::out_of_range);
+
+    text += "cd";
+    ASSERT_EQ(text, "abcd");
+    ASSERT_TRUE(text.full());
+}
+
+TEST(FixedStringTest, ComparesAndPrints)
+{
+    const fixed_string<8> alice = "alice";
+    const fixed_string<16> bob = "bob";
+
+    ASSERT_TRUE(alice < bob);
+    ASSERT_TRUE(alice != bob);
+    ASSERT_TRUE(alice == fixed_string<16>("alice"));
+    ASSERT_TRUE("alice" == alice);
+
+    std::ostringstream stream;
+    stream << alice << ':' << bob;
+    ASSERT_EQ(stream.str(), "alice:bob");
+}
@@ -0,0 +1,212 @@
+#include "pch.h"
+
+#include <string>
+
+#include "growable_vector.h"
+
+// the CollectionTest suite, run against growable_vector once per growth policy
+template <typename Collection>
+class GrowableCollectionTest : public ::testing::Test
+{
+protected:
+    // create a smart point to hold our collection
+    std::unique_ptr<Collection> collection;
+
+    void SetUp() override
+    { // create a new collection to be used in the test
+        collection.reset(new Collection);
+    }
+
+    void TearDown() override
+    { //  erase all elements in the collection, if any remain
+        collection->clear();
+        // free the pointer
+        collection.reset(nullptr);
+    }
+};
+
+using GrowthPolicies = ::testing::Types<
+    growable_vector<int, growth_1_5x>,
+    growable_vector<int, growth_2x>,
+    growable_vector<int, chunked_growth<>>,
+    growable_vector<int, huge_page_growth>,
+    growable_vector<std::string, growth_2x>>;
+
+TYPED_TEST_CASE(GrowableCollectionTest, GrowthPolicies);
+
+TYPED_TEST(GrowableCollectionTest, IsEmptyOnCreate)
+{
+    ASSERT_TRUE(this->collection->empty());
+    ASSERT_EQ(this->collection->size(), 0);
+    ASSERT_EQ(this->collection->capacity(), 0);
+}
+
+TYPED_TEST(GrowableCollectionTest, CanAddToEmptyVector)
+{
+    ASSERT_EQ(this->collection->size(), 0);
+
+    this->collection->push_back({});
+    ASSERT_EQ(this->collection->size(), 1);
+}
+
+TYPED_TEST(GrowableCollectionTest, CanAddFiveValuesToVector)
+{
+    for (int i = 0; i < 5; ++i)
+        this->collection->push_back({});
+
+    ASSERT_EQ(this->collection->size(), 5);
+}
+
+TYPED_TEST(GrowableCollectionTest, VerifyMaxSizeIsGreaterThanOrEqualToEntrySize)
+{
+    for (int count : { 1, 5, 10 })
+    {
+        this->collection->resize(count);
+        ASSERT_GE(this->collection->max_size(), this->collection->size());
+    }
+}
+
+TYPED_TEST(GrowableCollectionTest, VerifyCapacityIsGreaterThanOrEqualToEntrySize)
+{
+    for (int count : { 1, 5, 10 })
+    {
+        this->collection->push_back({});
+        this->collection->resize(count);
+        ASSERT_GE(this->collection->capacity(), this->collection->size());
+    }
+}
+
+TYPED_TEST(GrowableCollectionTest, VerifyResizeIncreasesCollection)
+{
+    this->collection->resize(5);
+    ASSERT_EQ(this->collection->size(), 5);
+}
+
+TYPED_TEST(GrowableCollectionTest, VerifyResizeDecreasesCollectionToZero)
+{
+    this->collection->resize(10);
+    this->collection->resize(3);
+    EXPECT_EQ(this->collection->size(), 3);
+
+    this->collection->resize(0);
+    EXPECT_EQ(this->collection->size(), 0);
+}
+
+TYPED_TEST(GrowableCollectionTest, VerifyEraseErasesCollectionUsingBeginEnd)
+{
+    this->collection->resize(5);
+    this->collection->erase(this->collection->begin(), this->collection->end());
+    ASSERT_EQ(this->collection->size(), 0);
+}
+
+// reserve is exact for every policy, unlike std::vector which only promises "at least"
+TYPED_TEST(GrowableCollectionTest, VerifyReserveIncreasesCapacacityNotSize)
+{
+    this->collection->resize(2);
+    this->collection->shrink_to_fit();
+    ASSERT_EQ(this->collection->capacity(), 2);
+
+    this->collection->reserve(4);
+
+    ASSERT_EQ(this->collection->size(), 2);
+    ASSERT_EQ(this->collection->capacity(), 4);
+}
+
+TYPED_TEST(GrowableCollectionTest, VerifyAtThrowsOutOfRangeExceptionOnIndex)
+{
+    ASSERT_EQ(this->collection->size(), 0);
+    ASSERT_THROW(this->collection->at(1), std::out_of_range);
+}
+
+TYPED_TEST(GrowableCollectionTest, VerifyShrinkToFitUpdatesCapactityToSize)
+{
+    this->collection->resize(5);
+    this->collection->shrink_to_fit();
+    this->collection->reserve(10);
+    ASSERT_EQ(this->collection->capacity(), 10);
+
+    this->collection->shrink_to_fit();
+
+    ASSERT_EQ(this->collection->size(), 5);
+    ASSERT_EQ(this->collection->capacity(), 5);
+}
+
+TYPED_TEST(GrowableCollectionTest, ReallocationsAreCounted)
+{
+    for (int i = 0; i < 1000; ++i)
+        this->collection->push_back({});
+    this->collection->shrink_to_fit();
+
+    ASSERT_EQ(this->collection->size(), 1000);
+    EXPECT_GT(this->collection->stats().reallocations, 0);
+}
+
+// the capacity sequence push_back produces is fixed by the policy, not the standard library
+TEST(GrowthPolicyTest, GeometricPoliciesGrowByTheirFactor)
+{
+    growable_vector<int, growth_2x> doubling;
+    growable_vector<int, growth_1_5x> one_and_a_half;
+    std::vector<std::size_t> doubling_capacities;
+    std::vector<std::size_t> one_and_a_half_capacities;
+
+    for (int i = 0; i < 10; ++i)
+    {
+        doubling.push_back(i);
+        one_and_a_half.push_back(i);
+        doubling_capacities.push_back(doubling.capacity());
+        one_and_a_half_capacities.push_back(one_and_a_half.capacity());
+    }
+
+    EXPECT_EQ(doubling_capacities, (std::vector<std::size_t>{ 1, 2, 4, 4, 8, 8, 8, 8, 16, 16 }));
+    EXPECT_EQ(one_and_a_half_capacities, (std::vector<std::size_t>{ 1, 2, 3, 4, 6, 6, 9, 9, 9, 13 }));
+}
+
+TEST(GrowthPolicyTest, ChunkedPolicyGrowsInWholeChunks)
+{
+    growable_vector<int, chunked_growth<4096>> collection;
+
+    collection.push_back(1);
+    EXPECT_EQ(collection.capacity(), 4096 / sizeof(int));
+
+    collection.resize(4096 / sizeof(int) + 1);
+    EXPECT_EQ(collection.capacity(), 2 * 4096 / sizeof(int));
+}
+
+TEST(GrowthPolicyTest, HugePagePolicyRoundsLargeBlocksToHugePages)
+{
+    const std::size_t huge_page_ints = growth_detail::huge_page_bytes / sizeof(int);
+    growable_vector<int, huge_page_growth> collection;
+
+    collection.resize(huge_page_ints + 1);
+
+    EXPECT_EQ(collection.capacity() % huge_page_ints, 0);
+    EXPECT_GE(collection.capacity(), huge_page_ints + 1);
+}
+
+TEST(GrowthPolicyTest, StatsCountRelocatedBytesForNonTrivialElements)
+{
+    growable_vector<std::string, growth_2x> collection;
+
+    // capacity goes 1, 2, 4 - moving 1 then 2 elements on the way
+    for (int i = 0; i < 3; ++i)
+        collection.push_back("entry");
+
+    EXPECT_EQ(collection.stats().reallocations, 3);
+    EXPECT_EQ(collection.stats().relocations, 2);
+    EXPECT_EQ(collection.stats().relocated_bytes, 3 * sizeof(std::string));
+}
+
+TEST(GrowthPolicyTest, LargeTriviallyCopyableGrowthAvoidsCopies)
+{
+    growable_vector<int, chunked_growth<>> collection;
+
+    for (int i = 0; i < 4 * 1024 * 1024; ++i)
+        collection.push_back(i);
+
+    ASSERT_EQ(collection.size(), 4u * 1024 * 1024);
+    EXPECT_EQ(collection[123456], 123456);
+
+    // realloc / mremap keep most growth steps from copying the live elements
+    const auto& stats = collection.stats();
+    EXPECT_LT(stats.relocations, stats.reallocations);
+}
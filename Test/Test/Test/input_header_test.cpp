@@ -0,0 +1,127 @@
+#include "pch.h"
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include "input_header.h"
+
+namespace
+{
+    // the header views into text, so text has to outlive it and a temporary never does
+    expected<input_header, input_header_error> parse(const std::string& text, bool complete = true)
+    {
+        return parse_input_header(text.data(), text.size(), complete);
+    }
+
+    expected<input_header, input_header_error> parse(std::string&& text, bool complete = true) = delete;
+
+    // only whether text is accepted, which holds no views and so takes temporaries too
+    expected<std::size_t, input_header_error> payload_offset(const std::string& text, bool complete = true)
+    {
+        const auto header = parse(text, complete);
+        if (!header)
+        {
+            return unexpected(header.error());
+        }
+        return header->payload_offset;
+    }
+}
+
+TEST(InputHeaderTest, FindsNameSourceAndPayload)
+{
+    const std::string text = "Sam Student\nhttps://pirateipsum.me/\nProw scuttle parrel\nprovost Sail ho";
+    const auto header = parse(text);
+    ASSERT_TRUE(header);
+    ASSERT_EQ(header->student_name, "Sam Student");
+    ASSERT_EQ(header->source_url, "https://pirateipsum.me/");
+    ASSERT_EQ(text.substr(header->payload_offset), "Prow scuttle parrel\nprovost Sail ho");
+
+    // views into the input, nothing copied
+    ASSERT_EQ(header->student_name.data(), text.data());
+
+    const std::string windows_text = "Sam Student\r\nhttps://pirateipsum.me/\r\nProw";
+    const auto windows = parse(windows_text);
+    ASSERT_TRUE(windows);
+    ASSERT_EQ(windows->student_name, "Sam Student");
+    ASSERT_EQ(windows->source_url, "https://pirateipsum.me/");
+    ASSERT_EQ(windows->payload_offset, 38u);
+
+    // the default text read_file falls back to has no payload line
+    const std::string fallback_text = "John Q. Smith\nThis is my test string";
+    const auto fallback = parse(fallback_text);
+    ASSERT_TRUE(fallback);
+    ASSERT_EQ(fallback->source_url, "This is my test string");
+    ASSERT_EQ(fallback->payload_offset, 36u);
+}
+
+TEST(InputHeaderTest, ChecksFieldLengths)
+{
+    ASSERT_EQ(payload_offset("").error(), input_header_error::missing_name);
+    ASSERT_EQ(payload_offset("\nhttps://x/\n").error(), input_header_error::missing_name);
+    ASSERT_EQ(payload_offset("Sam").error(), input_header_error::missing_source);
+    ASSERT_EQ(payload_offset("Sam\n").error(), input_header_error::missing_source);
+    ASSERT_EQ(payload_offset("Sam\n\npayload").error(), input_header_error::missing_source);
+
+    const std::string longest(max_student_name_length, 'n');
+    ASSERT_TRUE(payload_offset(longest + "\r\nsource\n"));
+    ASSERT_EQ(payload_offset(longest + "n\nsource\n").error(), input_header_error::name_too_long);
+    ASSERT_EQ(payload_offset(std::string(100000, 'n')).error(), input_header_error::name_too_long);
+
+    const std::string source(max_source_url_length, 's');
+    ASSERT_TRUE(payload_offset("Sam\n" + source + "\n"));
+    ASSERT_TRUE(payload_offset("Sam\n" + source));
+    ASSERT_EQ(payload_offset("Sam\n" + source + "s\n").error(), input_header_error::source_too_long);
+    ASSERT_EQ(payload_offset("Sam\n" + source + "s").error(), input_header_error::source_too_long);
+
+    // an unterminated line that may go on past the bytes given cannot be trusted
+    ASSERT_EQ(payload_offset("Sam\nhttps://x/", false).error(), input_header_error::source_too_long);
+}
+
+TEST(InputHeaderTest, ChecksEncoding)
+{
+    ASSERT_TRUE(payload_offset("Zo\xc3\xab S\xc3\xa6ther \xe2\x9c\x93 \xf0\x9f\x8f\xb4\xe2\x80\x8d\xe2\x98\xa0\nhttps://x/\n"));
+    ASSERT_TRUE(payload_offset("Sam\tStudent\nhttps://x/\n"));
+
+    const char* invalid[] = {
+        "Sam\x01\nhttps://x/\n",              // control character
+        "Sam\x7f\nhttps://x/\n",              // delete
+        "Sam\xc2\x85\nhttps://x/\n",          // C1 control character
+        "Sam\xc3\nhttps://x/\n",              // sequence cut short
+        "Sam\xc0\xaf\nhttps://x/\n",          // overlong form
+        "Sam\xe0\x80\xaf\nhttps://x/\n",      // overlong form
+        "Sam\xed\xa0\x80\nhttps://x/\n",      // surrogate
+        "Sam\xf4\x90\x80\x80\nhttps://x/\n",  // past U+10FFFF
+        "Sam\xff\nhttps://x/\n",              // never valid
+        "Sam\nhttps://x/\xe2\x82\n",          // in the source line
+    };
+    for (const char* text : invalid)
+    {
+        ASSERT_EQ(payload_offset(text).error(), input_header_error::invalid_encoding) << text;
+    }
+}
+
+TEST(InputHeaderTest, ReadsOnlyTheStartOfAFile)
+{
+    const std::string filename = "input_header_test.txt";
+    {
+        std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+        file << "Sam Student\nhttps://pirateipsum.me/\n" << std::string(1000000, 'x');
+    }
+
+    char buffer[input_header_limit];
+    const auto header = read_input_header(filename, buffer, sizeof(buffer));
+    ASSERT_TRUE(header);
+    ASSERT_EQ(header->student_name, "Sam Student");
+    ASSERT_EQ(header->source_url, "https://pirateipsum.me/");
+    ASSERT_EQ(header->payload_offset, 36u);
+
+    {
+        std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+        file << "Sam Student\nhttps://pirateipsum.me/";
+    }
+    ASSERT_TRUE(read_input_header(filename, buffer, sizeof(buffer)));
+
+    std::remove(filename.c_str());
+    ASSERT_EQ(read_input_header(filename, buffer, sizeof(buffer)).error(), input_header_error::io_error);
+}
@@ -0,0 +1,126 @@
+#include "pch.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "line_reader.h"
+
+namespace
+{
+    // hands out text a few bytes per read, so lines straddle chunk boundaries
+    struct memory_source
+    {
+        std::string text;
+        std::size_t position = 0;
+        std::size_t bytes_per_read = 3;
+
+        static std::ptrdiff_t read(void* context, char* buffer, std::size_t size)
+        {
+            auto& source = *static_cast<memory_source*>(context);
+            const std::size_t count = std::min({ size, source.bytes_per_read, source.text.size() - source.position });
+            source.text.copy(buffer, count, source.position);
+            source.position += count;
+            return static_cast<std::ptrdiff_t>(count);
+        }
+    };
+
+    std::vector<input_line> read_all(line_reader& reader, std::vector<std::string>& texts)
+    {
+        std::vector<input_line> lines;
+        input_line line;
+        while (reader.next(line))
+        {
+            // text is only valid until the next call, keep a copy
+            texts.emplace_back(line.text);
+            lines.push_back(line);
+        }
+        return lines;
+    }
+}
+
+TEST(LineReaderTest, SplitsLinesAcrossChunks)
+{
+    memory_source source{ "first\r\nsecond\n\nlast without newline" };
+    line_reader reader(memory_source::read, &source, 32, 4);
+
+    std::vector<std::string> texts;
+    const auto lines = read_all(reader, texts);
+
+    ASSERT_EQ(texts, (std::vector<std::string>{ "first", "second", "", "last without newline" }));
+    ASSERT_EQ(reader.line_count(), 4u);
+    ASSERT_EQ(reader.truncated_count(), 0u);
+    ASSERT_FALSE(reader.failed());
+}
+
+// a line over the limit keeps its prefix, reports its real length and does not disturb the next line
+TEST(LineReaderTest, ReportsTruncatedLines)
+{
+    memory_source source{ "short\n" + std::string(50, 'x') + "\r\nnext\n" + std::string(12, 'y') };
+    line_reader reader(memory_source::read, &source, 8, 5);
+
+    std::vector<std::string> texts;
+    const auto lines = read_all(reader, texts);
+
+    ASSERT_EQ(texts, (std::vector<std::string>{ "short", "xxxxxxxx", "next", "yyyyyyyy" }));
+    ASSERT_TRUE(lines[1].truncated);
+    ASSERT_EQ(lines[1].length, 50u);
+    ASSERT_FALSE(lines[2].truncated);
+    ASSERT_TRUE(lines[3].truncated);
+    ASSERT_EQ(lines[3].length, 12u);
+    ASSERT_EQ(reader.truncated_count(), 2u);
+}
+
+TEST(LineReaderTest, LineAtTheLimitIsNotTruncated)
+{
+    memory_source source{ "12345678\n123456789\n" };
+    line_reader reader(memory_source::read, &source, 8, 64);
+
+    std::vector<std::string> texts;
+    const auto lines = read_all(reader, texts);
+
+    ASSERT_EQ(lines.size(), 2u);
+    ASSERT_FALSE(lines[0].truncated);
+    ASSERT_TRUE(lines[1].truncated);
+    ASSERT_EQ(lines[1].length, 9u);
+}
+
+// the '\r' of a line at the limit sits where a too long line would continue
+TEST(LineReaderTest, LineAtTheLimitWithCrLfIsNotTruncated)
+{
+    memory_source source{ "12345678\r\n123456789\r\n" };
+    line_reader reader(memory_source::read, &source, 8, 64);
+
+    std::vector<std::string> texts;
+    const auto lines = read_all(reader, texts);
+
+    ASSERT_EQ(lines.size(), 2u);
+    ASSERT_FALSE(lines[0].truncated);
+    ASSERT_EQ(texts[0], "12345678");
+    ASSERT_EQ(lines[0].length, 8u);
+    ASSERT_TRUE(lines[1].truncated);
+    ASSERT_EQ(lines[1].length, 9u);
+}
+
+TEST(LineReaderTest, SplitFieldsChecksLimits)
+{
+    const std::size_t limits[] = { 5, 3, 10 };
+    std::string_view fields[3];
+
+    auto result = split_fields("alice,42,admin", ',', limits, fields, 3);
+    ASSERT_EQ(result.status, field_status::ok);
+    ASSERT_EQ(fields[0], "alice");
+    ASSERT_EQ(fields[1], "42");
+    ASSERT_EQ(fields[2], "admin");
+
+    result = split_fields("alice,4242,admin", ',', limits, fields, 3);
+    ASSERT_EQ(result.status, field_status::field_too_long);
+    ASSERT_EQ(result.index, 1u);
+
+    result = split_fields("alice,42", ',', limits, fields, 3);
+    ASSERT_EQ(result.status, field_status::too_few_fields);
+    ASSERT_EQ(result.index, 2u);
+
+    result = split_fields("alice,42,admin,extra", ',', limits, fields, 3);
+    ASSERT_EQ(result.status, field_status::too_many_fields);
+}
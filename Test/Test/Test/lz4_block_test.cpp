@@ -0,0 +1,87 @@
+#include "pch.h"
+
+#include <string>
+
+#include "lz4_block.h"
+
+namespace
+{
+    std::string round_trip(const std::string& source)
+    {
+        std::string packed(lz4_bound(source.size()), '\0');
+        const std::size_t size = lz4_compress(source.data(), source.size(), &packed[0], packed.size());
+        EXPECT_NE(size, 0u);
+        packed.resize(size);
+
+        std::string restored(source.size(), '\0');
+        const std::ptrdiff_t restored_size = lz4_decompress(packed.data(), packed.size(), &restored[0], restored.size());
+        EXPECT_EQ(restored_size, static_cast<std::ptrdiff_t>(source.size()));
+        return restored;
+    }
+
+    std::string noise(std::size_t size)
+    {
+        std::string text(size, '\0');
+        std::uint32_t state = 7;
+        for (auto& c : text)
+        {
+            state = state * 1664525u + 1013904223u;
+            c = static_cast<char>(state >> 24);
+        }
+        return text;
+    }
+}
+
+TEST(Lz4BlockTest, RoundTrips)
+{
+    std::string text;
+    while (text.size() < 100000)
+    {
+        text += "Prow scuttle parrel provost Sail ho shrouds spirits boom mizzenmast yardarm.\n";
+    }
+
+    // sizes around the end of block limits, a long run of one byte, text and noise
+    for (const std::size_t size : { 0u, 1u, 5u, 12u, 13u, 17u, 100u, 70000u })
+    {
+        const std::string part = text.substr(0, size);
+        ASSERT_EQ(round_trip(part), part) << size;
+    }
+    ASSERT_EQ(round_trip(std::string(100000, 'x')), std::string(100000, 'x'));
+    ASSERT_EQ(round_trip(noise(100000)), noise(100000));
+    const std::string mixed = text.substr(0, 50000) + noise(20000) + text.substr(0, 50000);
+    ASSERT_EQ(round_trip(mixed), mixed);
+
+    std::string packed(lz4_bound(text.size()), '\0');
+    ASSERT_LT(lz4_compress(text.data(), text.size(), &packed[0], packed.size()), text.size() / 10);
+}
+
+TEST(Lz4BlockTest, ReadsBlocksOfTheStandardFormat)
+{
+    // a literal "abc", then a match of 9 bytes one back (overlapping), then the last literals
+    const char block[] = { 0x35, 'a', 'b', 'c', 0x01, 0x00, 0x50, 'v', 'w', 'x', 'y', 'z' };
+    char out[32];
+    ASSERT_EQ(lz4_decompress(block, sizeof(block), out, sizeof(out)), 17);
+    ASSERT_EQ(std::string(out, 17), "abccccccccccvwxyz");
+}
+
+TEST(Lz4BlockTest, RejectsWhatDoesNotFit)
+{
+    const std::string text(1000, 'x');
+    char small[8];
+    ASSERT_EQ(lz4_compress(text.data(), text.size(), small, sizeof(small)), 0u);
+
+    std::string packed(lz4_bound(text.size()), '\0');
+    packed.resize(lz4_compress(text.data(), text.size(), &packed[0], packed.size()));
+    char out[1000];
+    ASSERT_EQ(lz4_decompress(packed.data(), packed.size(), out, 999), -1);
+
+    // cut short anywhere, offsets before the start of the output, nothing at all
+    for (std::size_t size = 0; size < packed.size(); ++size)
+    {
+        ASSERT_LT(lz4_decompress(packed.data(), size, out, sizeof(out)), 1000) << size;
+    }
+    const char before_start[] = { 0x10, 'a', 0x02, 0x00, 0x00 };
+    ASSERT_EQ(lz4_decompress(before_start, sizeof(before_start), out, sizeof(out)), -1);
+    const char zero_offset[] = { 0x10, 'a', 0x00, 0x00, 0x00 };
+    ASSERT_EQ(lz4_decompress(zero_offset, sizeof(zero_offset), out, sizeof(out)), -1);
+}
@@ -0,0 +1,113 @@
+#include "pch.h"
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "parallel_reduce.h"
+
+// enough values for several blocks, so more than one thread has work
+constexpr std::size_t many = 300000;
+
+TEST(ParallelReduceTest, IntegerSumIsExactPastTheType)
+{
+    const std::vector<std::int64_t> values(many, std::numeric_limits<std::int64_t>::max());
+
+    const auto sum = widened_sum(values.data(), values.size(), 4);
+    wide_int<128> expected;
+    for (std::size_t i = 0; i < many; ++i)
+    {
+        expected += std::numeric_limits<std::int64_t>::max();
+    }
+    ASSERT_EQ(expected, sum);
+    ASSERT_EQ(sum, widened_sum(values.data(), values.size(), 1));
+    ASSERT_TRUE(checked_sum(values.data(), values.size(), 4).overflow);
+}
+
+// overflow is judged on the exact sum, not on the running total of one order
+TEST(ParallelReduceTest, OverflowIsExact)
+{
+    std::vector<unsigned> values(many, 0u);
+    values[0] = std::numeric_limits<unsigned>::max() - 1;
+    values[many - 1] = 1;
+    auto sum = checked_sum(values.data(), values.size(), 3);
+    ASSERT_FALSE(sum.overflow);
+    ASSERT_EQ(std::numeric_limits<unsigned>::max(), sum.value);
+
+    values[many / 2] = 1;
+    sum = checked_sum(values.data(), values.size(), 3);
+    ASSERT_TRUE(sum.overflow);
+    ASSERT_EQ(0u, sum.value);
+
+    // a running total would overflow at the second value, the sum does not
+    const std::vector<int> cancelling{ std::numeric_limits<int>::max(), 1, -1 };
+    const auto cancelled = checked_sum(cancelling.data(), cancelling.size());
+    ASSERT_FALSE(cancelled.overflow);
+    ASSERT_EQ(std::numeric_limits<int>::max(), cancelled.value);
+}
+
+TEST(ParallelReduceTest, ProductTracksSignAndZero)
+{
+    const std::int64_t half = std::int64_t{ 1 } << 62;
+
+    const std::vector<std::int64_t> to_min{ -half, 2 };
+    const auto min_product = checked_product(to_min.data(), to_min.size());
+    ASSERT_FALSE(min_product.overflow);
+    ASSERT_EQ(std::numeric_limits<std::int64_t>::min(), min_product.value);
+
+    const std::vector<std::int64_t> past_max{ -half, 2, -1 };
+    ASSERT_TRUE(checked_product(past_max.data(), past_max.size()).overflow);
+
+    // a zero anywhere makes the product 0, however large the rest
+    std::vector<std::uint32_t> with_zero(many, 3u);
+    with_zero[many - 1] = 0;
+    const auto zero = checked_product(with_zero.data(), with_zero.size(), 4);
+    ASSERT_FALSE(zero.overflow);
+    ASSERT_EQ(0u, zero.value);
+
+    with_zero[many - 1] = 1;
+    ASSERT_TRUE(checked_product(with_zero.data(), with_zero.size(), 4).overflow);
+    ASSERT_EQ(1u, checked_product(with_zero.data(), 0).value);
+}
+
+TEST(ParallelReduceTest, CompensatedFloatSums)
+{
+    // one large value and many too small to move it on their own
+    std::vector<double> values(many, 1e-16);
+    values[0] = 1.0;
+    const double exact = 1.0 + (many - 1) * 1e-16;
+
+    const double kahan = widened_sum(values.data(), values.size(), 4, float_summation::kahan);
+    const double pairwise = widened_sum(values.data(), values.size(), 4, float_summation::pairwise);
+    const double plain = widened_sum(values.data(), values.size(), 4, float_summation::plain);
+    // pairwise still loses the few that share a lane with the large value
+    ASSERT_NEAR(exact, kahan, 1e-15);
+    ASSERT_NEAR(exact, pairwise, 1e-14);
+    ASSERT_GT(std::fabs(exact - plain), 1e-12);
+
+    // the blocks do not depend on the thread count, so neither does the result
+    ASSERT_EQ(pairwise, widened_sum(values.data(), values.size(), 1, float_summation::pairwise));
+    ASSERT_EQ(kahan, widened_sum(values.data(), values.size(), 3, float_summation::kahan));
+}
+
+TEST(ParallelReduceTest, FloatOverflowIsReported)
+{
+    const std::vector<float> values{ std::numeric_limits<float>::max(), std::numeric_limits<float>::max() };
+    const auto sum = checked_sum(values.data(), values.size());
+    ASSERT_TRUE(sum.overflow);
+    ASSERT_EQ(std::numeric_limits<float>::infinity(), sum.value);
+    // float sums in double, which holds it
+    ASSERT_DOUBLE_EQ(2.0 * std::numeric_limits<float>::max(), widened_sum(values.data(), values.size()));
+
+    const std::vector<float> halves{ std::numeric_limits<float>::max(), -std::numeric_limits<float>::max() / 2 };
+    ASSERT_FALSE(checked_sum(halves.data(), halves.size()).overflow);
+}
+
+TEST(ParallelReduceTest, WideIntegersSumIntoWiderOnes)
+{
+    const std::vector<wide_uint<128>> values(many, wide_uint<128>::max());
+    const auto sum = checked_sum(values.data(), values.size(), 4);
+    ASSERT_TRUE(sum.overflow);
+    ASSERT_EQ(wide_uint<128>() - wide_uint<128>(many), sum.value);
+    ASSERT_EQ(static_cast<std::uint64_t>(many - 1), widened_sum(values.data(), values.size()).limb(2));
+}
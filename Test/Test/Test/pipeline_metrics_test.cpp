@@ -0,0 +1,132 @@
+#include "pch.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "async_io.h"
+#include "pipeline_metrics.h"
+
+namespace
+{
+    std::string read_text(const std::string& filename)
+    {
+        std::ifstream file(filename, std::ios::binary);
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+        return buffer.str();
+    }
+}
+
+TEST(PipelineMetricsTest, MergesThreadCounters)
+{
+    pipeline_metrics::reset();
+
+    // threads that have exited still count
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t)
+    {
+        threads.emplace_back([]() {
+            for (int i = 0; i < 1000; ++i)
+            {
+                pipeline_metrics::record(pipeline_metrics::stage::transform, 10, 5);
+            }
+            pipeline_metrics::record(pipeline_metrics::stage::transform, 0, 700);
+            pipeline_metrics::set_queue_depth(3);
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    pipeline_metrics::record(pipeline_metrics::stage::read, 100, 20);
+    pipeline_metrics::set_queue_depth(2);
+
+    const auto totals = pipeline_metrics::snapshot();
+    const auto& transform = totals.stages[static_cast<std::size_t>(pipeline_metrics::stage::transform)];
+    ASSERT_EQ(transform.operations, 8u * 1001);
+    ASSERT_EQ(transform.bytes, 8u * 10000);
+    ASSERT_EQ(transform.nanoseconds, 8u * 5700);
+    ASSERT_EQ(transform.max_nanoseconds, 700u);
+
+    const auto& read = totals.stages[static_cast<std::size_t>(pipeline_metrics::stage::read)];
+    ASSERT_EQ(read.operations, 1u);
+    ASSERT_EQ(read.bytes, 100u);
+
+    // only this thread is still running and holding requests
+    ASSERT_EQ(totals.queue_depth, 2u);
+    ASSERT_EQ(totals.max_queue_depth, 3u);
+    ASSERT_GE(totals.threads, 1u);
+
+    pipeline_metrics::reset();
+    ASSERT_EQ(pipeline_metrics::snapshot().stages[0].operations, 0u);
+}
+
+TEST(PipelineMetricsTest, WritesPrometheusAndJson)
+{
+    pipeline_metrics::totals values;
+    values.stages[0] = { 2, 2048, 1500000000, 1000000001 };
+    values.queue_depth = 4;
+    values.max_queue_depth = 8;
+    values.threads = 1;
+
+    std::ostringstream prometheus;
+    pipeline_metrics::write(prometheus, values, pipeline_metrics::format::prometheus);
+    const std::string text = prometheus.str();
+    ASSERT_NE(text.find("# TYPE pipeline_bytes_total counter\n"), std::string::npos);
+    ASSERT_NE(text.find("pipeline_bytes_total{stage=\"read\"} 2048\n"), std::string::npos);
+    ASSERT_NE(text.find("pipeline_seconds_total{stage=\"read\"} 1.500000000\n"), std::string::npos);
+    ASSERT_NE(text.find("pipeline_max_seconds{stage=\"read\"} 1.000000001\n"), std::string::npos);
+    ASSERT_NE(text.find("pipeline_operations_total{stage=\"write\"} 0\n"), std::string::npos);
+    ASSERT_NE(text.find("pipeline_queue_depth 4\n"), std::string::npos);
+
+    std::ostringstream json;
+    pipeline_metrics::write(json, values, pipeline_metrics::format::json);
+    ASSERT_EQ(json.str(),
+        "{\"stages\":{\"read\":{\"operations\":2,\"bytes\":2048,\"seconds\":1.500000000,\"max_seconds\":1.000000001},"
+        "\"transform\":{\"operations\":0,\"bytes\":0,\"seconds\":0.000000000,\"max_seconds\":0.000000000},"
+        "\"write\":{\"operations\":0,\"bytes\":0,\"seconds\":0.000000000,\"max_seconds\":0.000000000}},"
+        "\"queue_depth\":4,\"max_queue_depth\":8,\"threads\":1}\n");
+}
+
+TEST(PipelineMetricsTest, ExportsTransformFileStages)
+{
+    pipeline_metrics::reset();
+    const std::string input_name = "pipeline_metrics_test.in";
+    const std::string output_name = "pipeline_metrics_test.out";
+    const std::string metrics_name = "pipeline_metrics_test.json";
+    {
+        std::ofstream file(input_name, std::ios::binary | std::ios::trunc);
+        file << std::string(100000, 'x');
+    }
+
+    {
+        pipeline_metrics::periodic_export exporter(metrics_name, std::chrono::milliseconds(10), pipeline_metrics::format::json);
+        auto io = async_io::create(4, 4096, io_backend::thread_pool);
+        ASSERT_TRUE(io);
+        ASSERT_EQ(*transform_file(**io, input_name, output_name, [](std::uint8_t*, std::size_t, std::uint64_t) {}), 100000u);
+    }
+
+    // 25 blocks of 4 KB through each stage, the last one 1696 bytes, and nothing left in flight
+    const auto totals = pipeline_metrics::snapshot();
+    for (const auto& stage : totals.stages)
+    {
+        ASSERT_EQ(stage.operations, 25u);
+        ASSERT_EQ(stage.bytes, 100000u);
+    }
+    ASSERT_EQ(totals.queue_depth, 0u);
+    ASSERT_GE(totals.max_queue_depth, 1u);
+    ASSERT_LE(totals.max_queue_depth, 4u);
+
+    // the exporter wrote once more as it stopped
+    const std::string exported = read_text(metrics_name);
+    ASSERT_NE(exported.find("\"write\":{\"operations\":25,\"bytes\":100000,"), std::string::npos);
+
+    std::remove(input_name.c_str());
+    std::remove(output_name.c_str());
+    std::remove(metrics_name.c_str());
+}
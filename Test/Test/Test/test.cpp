@@ -2,6 +2,9 @@
 #include "pch.h"
 // uncomment the next line if you do not use precompiled headers
 //#include "gtest/gtest.h"
+
+#include "fast_random.h"
+
 //
 // the global test environment setup and tear down
 // you should not need to change anything here
@@ -13,14 +16,21 @@ public:
     // Override this to define how to set up the environment.
     void SetUp() override
     {
-        //  initialize random seed
-        srand(time(nullptr));
+        //  initialize random seed, taking --gtest_random_seed when one is given so a failing
+        //  run can be reproduced, and print it either way
+        const auto seed_flag = ::testing::GTEST_FLAG(random_seed);
+        const auto seed = seed_flag != 0 ? static_cast<std::uint64_t>(seed_flag) : static_cast<std::uint64_t>(time(nullptr));
+        std::cout << "Random seed: " << seed << std::endl;
+        fast_random::seed(seed);
     }
 
     // Override this to define how to tear down the environment.
     void TearDown() override {}
 };
 
+// register the environment so SetUp runs before the first test
+::testing::Environment* const environment = ::testing::AddGlobalTestEnvironment(new Environment);
+
 // create our test class to house shared data between tests
 // you should not need to change anything here
 class CollectionTest : public ::testing::Test
@@ -46,7 +56,7 @@ protected:
     {
         assert(count > 0);
         for (auto i = 0; i < count; ++i)
-            collection->push_back(rand() % 100);
+            collection->push_back(fast_random::uniform(100));
     }
 };
 
@@ -294,8 +304,8 @@ TEST_F(CollectionTest, VerifyShrinkToFitUpdatesCapactityToSize)
     collection->shrink_to_fit();
 
     // It is expected that collection's size and capacity are both equal to 5.
-    ASSERT_TRUE(collection->size(), 5);
-    ASSERT_TRUE(collection->capacity(), 5);
+    ASSERT_EQ(collection->size(), 5);
+    ASSERT_EQ(collection->capacity(), 5);
 }
 
 TEST_F(CollectionTest, AssignEntries_SetupCollection_ThrowAfterAccessIndex)
@@ -0,0 +1,89 @@
+#include "pch.h"
+
+#include <cstdint>
+
+#include "NumericFunctions.h"
+#include "wide_int.h"
+
+// a carry out of one limb must reach the next, all the way up
+TEST(WideIntTest, CarriesAcrossLimbs)
+{
+    wide_uint<256> value = ~std::uint64_t{ 0 };
+    value += 1u;
+    ASSERT_EQ(0u, value.limb(0));
+    ASSERT_EQ(1u, value.limb(1));
+
+    wide_uint<256> below = wide_uint<256>::max();
+    wide_uint<256> wrapped;
+    ASSERT_TRUE(add_overflows(below, wide_uint<256>(1), wrapped));
+    ASSERT_EQ(wide_uint<256>(), wrapped);
+
+    ASSERT_TRUE(subtract_overflows(wide_uint<256>(), wide_uint<256>(1), wrapped));
+    ASSERT_EQ(wide_uint<256>::max(), wrapped);
+}
+
+TEST(WideIntTest, SignedOverflowFollowsSigns)
+{
+    using int256 = wide_int<256>;
+    int256 result;
+
+    ASSERT_TRUE(add_overflows(int256::max(), int256(1), result));
+    ASSERT_EQ(int256::min(), result);
+    ASSERT_FALSE(add_overflows(int256::max(), int256(-1), result));
+    ASSERT_TRUE(subtract_overflows(int256::min(), int256(1), result));
+    ASSERT_FALSE(subtract_overflows(int256(-5), int256(7), result));
+    ASSERT_EQ(int256(-12), result);
+
+    ASSERT_LT(int256(-1), int256(0));
+    ASSERT_LT(int256::min(), int256::max());
+    ASSERT_EQ("-12", result.to_string());
+}
+
+TEST(WideIntTest, PrintsDecimal)
+{
+    ASSERT_EQ("0", wide_uint<128>().to_string());
+    ASSERT_EQ("18446744073709551616", (wide_uint<128>(~std::uint64_t{ 0 }) + 1u).to_string());
+    ASSERT_EQ("115792089237316195423570985008687907853269984665640564039457584007913129639935",
+        wide_uint<256>::max().to_string());
+    ASSERT_EQ("-57896044618658097711785492504343953926634992332820282019728792003956564819968",
+        wide_int<256>::min().to_string());
+}
+
+// add_numbers and subtract_numbers report overflow exactly where the 64 bit types only approximate it
+TEST(WideIntTest, AddNumbersStopsAtExactLimit)
+{
+    const wide_uint<128> step = ~std::uint64_t{ 0 };
+    const auto sum = add_numbers(wide_uint<128>(), step, 3);
+    ASSERT_EQ(2u, sum.limb(1));
+    ASSERT_EQ(~std::uint64_t{ 0 } - 2, sum.limb(0));
+
+    ASSERT_EQ(wide_uint<128>(), add_numbers(wide_uint<128>::max() - 1u, wide_uint<128>(1), 2));
+    ASSERT_EQ(wide_int<256>(-30), subtract_numbers(wide_int<256>(), wide_int<256>(10), 3));
+    ASSERT_TRUE(is_underflow(wide_int<256>::min(), wide_int<256>(1)));
+}
+
+// a type typeid does not name no longer falls through to "never overflows"
+TEST(WideIntTest, UnnamedIntegerTypesAreChecked)
+{
+    ASSERT_TRUE(is_overflow<signed char>(120, 10));
+    ASSERT_FALSE(is_overflow<signed char>(100, 10));
+    ASSERT_TRUE(is_underflow<char16_t>(0, 1));
+}
+
+#if defined(__SIZEOF_INT128__)
+TEST(WideIntTest, Int128IsCheckedExactly)
+{
+    ASSERT_TRUE(is_overflow<unsigned __int128>(uint128_max, 1));
+    ASSERT_FALSE(is_overflow<unsigned __int128>(uint128_max - 1, 1));
+    ASSERT_TRUE(is_overflow<__int128>(int128_max, 1));
+    ASSERT_TRUE(is_underflow<__int128>(int128_min, 1));
+    ASSERT_FALSE(is_underflow<__int128>(int128_min + 1, 1));
+
+    const unsigned __int128 sum = add_numbers<unsigned __int128>(0, std::uint64_t{ 1 } << 63, 4);
+    ASSERT_EQ(static_cast<unsigned __int128>(2) << 64, sum);
+
+    // the same value through the 256 bit type, which also sign extends __int128
+    ASSERT_EQ(wide_int<256>(-1), wide_int<256>(static_cast<__int128>(-1)));
+    ASSERT_EQ(1u, wide_uint<256>(static_cast<unsigned __int128>(1) << 64).limb(1));
+}
+#endif
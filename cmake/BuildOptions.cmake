@@ -0,0 +1,82 @@
+# BuildOptions.cmake : Warnings, link time optimization, sanitizers and profile guided optimization
+# applied to every target in the tree.
+#
+#   SECURE_CODING_LTO         ON to link with -flto (the release presets turn it on)
+#   SECURE_CODING_SANITIZERS  list passed to -fsanitize=, e.g. "address;undefined" or "thread"
+#   SECURE_CODING_PGO         OFF, GENERATE to build instrumented binaries, USE to rebuild with the
+#                             profile the pgo-train target collected
+#   SECURE_CODING_PGO_DIR     where the profile is written and read
+#   SECURE_CODING_ARCH        passed to -march=, e.g. x86-64-v3 (AVX2) or x86-64-v4 (AVX-512), so the
+#                             wider kernels the default SSE2 build skips are compiled and tested
+
+include_guard(GLOBAL)
+
+option(SECURE_CODING_LTO "Link time optimization" OFF)
+set(SECURE_CODING_SANITIZERS "" CACHE STRING "Sanitizers to build with, e.g. address;undefined or thread")
+set(SECURE_CODING_PGO "OFF" CACHE STRING "Profile guided optimization phase: OFF, GENERATE or USE")
+set_property(CACHE SECURE_CODING_PGO PROPERTY STRINGS OFF GENERATE USE)
+set(SECURE_CODING_PGO_DIR "${CMAKE_BINARY_DIR}/pgo-profile" CACHE PATH "Profile directory for profile guided optimization")
+set(SECURE_CODING_ARCH "" CACHE STRING "Target instruction set passed to -march=, e.g. x86-64-v3 or x86-64-v4")
+
+if(MSVC)
+    add_compile_options(/W3 /permissive-)
+else()
+    add_compile_options(-Wall)
+endif()
+
+if(SECURE_CODING_ARCH)
+    if(MSVC)
+        message(FATAL_ERROR "SECURE_CODING_ARCH needs gcc or clang, use /arch in the Visual Studio projects")
+    endif()
+    add_compile_options(-march=${SECURE_CODING_ARCH})
+endif()
+
+if(SECURE_CODING_LTO)
+    include(CheckIPOSupported)
+    check_ipo_supported(RESULT lto_supported OUTPUT lto_error LANGUAGES CXX)
+    if(lto_supported)
+        set(CMAKE_INTERPROCEDURAL_OPTIMIZATION ON)
+    else()
+        message(WARNING "link time optimization is not supported: ${lto_error}")
+    endif()
+endif()
+
+if(SECURE_CODING_SANITIZERS)
+    if(MSVC)
+        message(FATAL_ERROR "SECURE_CODING_SANITIZERS needs gcc or clang")
+    endif()
+    list(JOIN SECURE_CODING_SANITIZERS "," sanitizer_list)
+    add_compile_options(-fsanitize=${sanitizer_list} -fno-omit-frame-pointer -fno-sanitize-recover=all)
+    add_link_options(-fsanitize=${sanitizer_list})
+endif()
+
+# gcc names each .gcda file after its object file, so GENERATE and USE must share one binary
+# directory; the presets do. clang writes raw profiles that llvm-profdata merges into one file.
+if(SECURE_CODING_PGO STREQUAL "GENERATE")
+    if(CMAKE_CXX_COMPILER_ID MATCHES "Clang")
+        add_compile_options(-fprofile-instr-generate=${SECURE_CODING_PGO_DIR}/%p-%m.profraw)
+        add_link_options(-fprofile-instr-generate=${SECURE_CODING_PGO_DIR}/%p-%m.profraw)
+    elseif(CMAKE_CXX_COMPILER_ID STREQUAL "GNU")
+        add_compile_options(-fprofile-generate=${SECURE_CODING_PGO_DIR} -fprofile-update=atomic)
+        add_link_options(-fprofile-generate=${SECURE_CODING_PGO_DIR})
+    else()
+        message(FATAL_ERROR "SECURE_CODING_PGO needs gcc or clang")
+    endif()
+elseif(SECURE_CODING_PGO STREQUAL "USE")
+    if(CMAKE_CXX_COMPILER_ID MATCHES "Clang")
+        if(NOT EXISTS "${SECURE_CODING_PGO_DIR}/merged.profdata")
+            message(FATAL_ERROR "no profile in ${SECURE_CODING_PGO_DIR}, build the pgo-train target of a GENERATE build first")
+        endif()
+        add_compile_options(-fprofile-instr-use=${SECURE_CODING_PGO_DIR}/merged.profdata -Wno-profile-instr-unprofiled)
+    elseif(CMAKE_CXX_COMPILER_ID STREQUAL "GNU")
+        if(NOT EXISTS "${SECURE_CODING_PGO_DIR}")
+            message(FATAL_ERROR "no profile in ${SECURE_CODING_PGO_DIR}, build the pgo-train target of a GENERATE build first")
+        endif()
+        # sources the training never reached are optimized normally instead of for size
+        add_compile_options(-fprofile-use=${SECURE_CODING_PGO_DIR} -fprofile-partial-training -Wno-missing-profile)
+    else()
+        message(FATAL_ERROR "SECURE_CODING_PGO needs gcc or clang")
+    endif()
+elseif(NOT SECURE_CODING_PGO STREQUAL "OFF")
+    message(FATAL_ERROR "SECURE_CODING_PGO must be OFF, GENERATE or USE, not ${SECURE_CODING_PGO}")
+endif()